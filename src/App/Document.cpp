@@ -56,6 +56,7 @@ recompute path. Also enables more complicated dependencies beyond trees.
 # include <sstream>
 # include <climits>
 # include <bitset>
+# include <deque>
 #endif
 
 #include <boost/graph/topological_sort.hpp>
@@ -69,12 +70,19 @@ recompute path. Also enables more complicated dependencies beyond trees.
 
 #include <QCoreApplication>
 #include <QCryptographicHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
 
 
 #include "Document.h"
 #include "Application.h"
 #include "DocumentObject.h"
 #include "MergeDocuments.h"
+#include "PropertyGeo.h"
 #include <App/DocumentPy.h>
 
 #include <Base/Console.h>
@@ -128,6 +136,38 @@ typedef Traits::edge_descriptor Edge;
 
 namespace App {
 
+// A node of the recompute schedule, see Document::recompute()
+struct RecomputeNode
+{
+    DocumentObject* object;
+    /// indices of the nodes that depend on this node
+    std::vector<std::size_t> dependents;
+    /// number of dependencies that are part of the schedule
+    int pending;
+    /// whether the object must be executed or is only passed through
+    bool execute;
+};
+
+/** The outcome of executing a feature. Features executed in a worker thread hand
+ * it over to the thread running the recompute which reports it.
+ */
+struct RecomputeResult
+{
+    enum Level { None, Warning, Error };
+
+    RecomputeResult() : executed(false), returnCode(0), level(None), abort(false) {}
+
+    /// whether the feature was executed at all
+    bool executed;
+    /// the failure to add to the recompute log, 0 on success
+    DocumentObjectExecReturn* returnCode;
+    /// message for the console
+    std::string message;
+    Level level;
+    /// whether the recompute must be stopped
+    bool abort;
+};
+
 // Pimpl class
 struct DocumentP
 {
@@ -137,16 +177,44 @@ struct DocumentP
     DocumentObject* activeObject;
     Transaction *activeUndoTransaction;
     int iTransactionMode;
-    std::map<Vertex,DocumentObject*> vertexMap;
     bool rollback;
     bool undoing; ///< document in the middle of undo or redo
     std::bitset<32> StatusBits;
     int iUndoMode;
-    unsigned int UndoMemSize;
+    std::size_t UndoMemSize; // limit in byte, 0 = unlimited
     unsigned int UndoMaxStackSize;
     DependencyList DepList;
     std::map<DocumentObject*,Vertex> VertexObjectList;
 
+    // Incrementally maintained dependency graph. Only the objects whose links
+    // have changed since the last update are re-examined in _updateDependencyGraph()
+    std::map<DocumentObject*, std::vector<DocumentObject*> > depOutList;
+    std::map<DocumentObject*, std::vector<DocumentObject*> > depInList;
+    std::set<DocumentObject*> depDirty;
+    bool depDirtyAll;
+
+    // Objects depending on an object by expressions. Expressions reference objects
+    // by name, so this is rebuilt in getInList() after expressions, labels or the
+    // set of objects have changed.
+    std::map<const DocumentObject*, std::vector<DocumentObject*> > exprInList;
+    bool exprInListValid;
+    QMutex exprInListMutex;
+    // Results of getInListRecursive(). They are dropped together with exprInList
+    // and whenever a link property changes the back-links of an object.
+    std::map<const DocumentObject*, std::vector<DocumentObject*> > inListRecursive;
+    std::size_t inListRevision;
+
+    // State of a running recompute
+    std::vector<RecomputeNode> recomputeNodes;
+    std::map<DocumentObject*, std::size_t> recomputeIndex;
+    // Set while features are executed in worker threads
+    QThread* recomputeThread;
+    QMutex recomputeMutex;
+    QWaitCondition recomputeDone;
+    std::vector<std::pair<std::size_t, RecomputeResult> > recomputeFinished;
+    std::map<const DocumentObject*, std::vector<const Property*> > pendingChanges;
+    std::vector<std::string> pendingRemovals;
+
     DocumentP() {
         activeObject = 0;
         activeUndoTransaction = 0;
@@ -158,9 +226,164 @@ struct DocumentP
         iUndoMode = 0;
         UndoMemSize = 0;
         UndoMaxStackSize = 20;
+        depDirtyAll = false;
+        exprInListValid = false;
+        inListRevision = 0;
+        recomputeThread = 0;
+    }
+
+    void invalidateExprInList() {
+        QMutexLocker locker(&exprInListMutex);
+        exprInListValid = false;
+        inListRecursive.clear();
+        ++inListRevision;
+    }
+
+    void invalidateInListRecursive() {
+        QMutexLocker locker(&exprInListMutex);
+        inListRecursive.clear();
+        ++inListRevision;
     }
 };
 
+/** Executes a feature and catches all exceptions. Nothing is reported and the
+ * status of the feature is not changed here, so it can be used in worker threads.
+ */
+void Document::_executeFeature(DocumentObject* Feat, RecomputeResult& result)
+{
+#ifdef FC_LOGFEATUREUPDATE
+    std::clog << "Solv: Executing Feature: " << Feat->getNameInDocument() << std::endl;;
+#endif
+
+    result.executed = true;
+    DocumentObjectExecReturn  *returnCode = 0;
+    try {
+        returnCode = Feat->ExpressionEngine.execute();
+        if (returnCode != DocumentObject::StdReturn) {
+            returnCode->Which = Feat;
+            result.returnCode = returnCode;
+#ifdef FC_DEBUG
+            result.message = returnCode->Why + "\n";
+            result.level = RecomputeResult::Error;
+#endif
+            result.abort = true;
+            return;
+        }
+
+        returnCode = Feat->recompute();
+    }
+    catch(Base::AbortException &e){
+        result.message = std::string("Exception (") + Base::Console().Time() + "): " + e.what() + " \n";
+        result.level = RecomputeResult::Error;
+        result.returnCode = new DocumentObjectExecReturn("User abort",Feat);
+        result.abort = true;
+        return;
+    }
+    catch (const Base::MemoryException& e) {
+        std::stringstream str;
+        str << "Memory exception in feature '" << Feat->getNameInDocument() << "' thrown: " << e.what() << "\n";
+        result.message = str.str();
+        result.level = RecomputeResult::Error;
+        result.returnCode = new DocumentObjectExecReturn("Out of memory exception",Feat);
+        result.abort = true;
+        return;
+    }
+    catch (Base::Exception &e) {
+        result.message = std::string("Exception (") + Base::Console().Time() + "): " + e.what() + " \n";
+        result.level = RecomputeResult::Error;
+        result.returnCode = new DocumentObjectExecReturn(e.what(),Feat);
+        return;
+    }
+    catch (std::exception &e) {
+        std::stringstream str;
+        str << "exception in Feature \"" << Feat->getNameInDocument() << "\" thrown: " << e.what() << "\n";
+        result.message = str.str();
+        result.level = RecomputeResult::Warning;
+        result.returnCode = new DocumentObjectExecReturn(e.what(),Feat);
+        return;
+    }
+#ifndef FC_DEBUG
+    catch (...) {
+        std::stringstream str;
+        str << "App::Document::_RecomputeFeature(): Unknown exception in Feature \""
+            << Feat->getNameInDocument() << "\" thrown\n";
+        result.message = str.str();
+        result.level = RecomputeResult::Error;
+        result.returnCode = new DocumentObjectExecReturn("Unknown exeption!");
+        result.abort = true;
+        return;
+    }
+#endif
+
+    // error code
+    if (returnCode != DocumentObject::StdReturn) {
+        returnCode->Which = Feat;
+        result.returnCode = returnCode;
+#ifdef FC_DEBUG
+        result.message = returnCode->Why + "\n";
+        result.level = RecomputeResult::Error;
+#endif
+    }
+}
+
+/** Reports the outcome of executing a feature and sets its error status.
+ * Must be called by the thread running the recompute.
+ */
+bool Document::_reportFeature(DocumentObject* Feat, const RecomputeResult& result)
+{
+    if (result.level == RecomputeResult::Error)
+        Base::Console().Error("%s", result.message.c_str());
+    else if (result.level == RecomputeResult::Warning)
+        Base::Console().Warning("%s", result.message.c_str());
+
+    if (result.returnCode) {
+        addRecomputeLog(result.returnCode);
+        Feat->setError();
+    }
+    else {
+        Feat->resetError();
+    }
+    return result.abort;
+}
+
+/** Executes one feature of the recompute schedule in a thread of the global pool.
+ * The result is handed back to the thread running Document::recompute().
+ */
+class RecomputeTask : public QRunnable
+{
+public:
+    RecomputeTask(DocumentP* d, std::size_t index)
+        : d(d), index(index)
+    {
+    }
+    void run()
+    {
+        RecomputeResult result;
+        DocumentObject* obj = d->recomputeNodes[index].object;
+        try {
+            Document::_executeFeature(obj, result);
+        }
+        catch (...) {
+            std::stringstream str;
+            result.executed = true;
+            str << "App::Document::recompute(): Unknown exception in Feature \""
+                << obj->getNameInDocument() << "\" thrown\n";
+            result.message = str.str();
+            result.level = RecomputeResult::Error;
+            result.returnCode = new DocumentObjectExecReturn("Unknown exception!", obj);
+            result.abort = true;
+        }
+
+        QMutexLocker locker(&d->recomputeMutex);
+        d->recomputeFinished.push_back(std::make_pair(index, result));
+        d->recomputeDone.wakeAll();
+    }
+
+private:
+    DocumentP* d;
+    std::size_t index;
+};
+
 } // namespace App
 
 PROPERTY_SOURCE(App::Document, App::PropertyContainer)
@@ -596,6 +819,8 @@ bool Document::undo(void)
         // applying the undo
         mUndoTransactions.back()->apply(*this,false);
         d->undoing = false;
+        d->depDirtyAll = true;
+        d->invalidateExprInList();
 
         // save the redo
         mRedoTransactions.push_back(d->activeUndoTransaction);
@@ -627,6 +852,8 @@ bool Document::redo(void)
         d->undoing = true;
         mRedoTransactions.back()->apply(*this,true);
         d->undoing = false;
+        d->depDirtyAll = true;
+        d->invalidateExprInList();
         mUndoTransactions.push_back(d->activeUndoTransaction);
         d->activeUndoTransaction = 0;
 
@@ -658,6 +885,24 @@ std::vector<std::string> Document::getAvailableRedoNames() const
     return vList;
 }
 
+std::vector<std::size_t> Document::getAvailableUndoSizes() const
+{
+    std::vector<std::size_t> vList;
+    if (d->activeUndoTransaction)
+        vList.push_back(d->activeUndoTransaction->getDataSize());
+    for (std::list<Transaction*>::const_reverse_iterator It=mUndoTransactions.rbegin();It!=mUndoTransactions.rend();++It)
+        vList.push_back((**It).getDataSize());
+    return vList;
+}
+
+std::vector<std::size_t> Document::getAvailableRedoSizes() const
+{
+    std::vector<std::size_t> vList;
+    for (std::list<Transaction*>::const_reverse_iterator It=mRedoTransactions.rbegin();It!=mRedoTransactions.rend();++It)
+        vList.push_back((**It).getDataSize());
+    return vList;
+}
+
 void Document::openTransaction(const char* name)
 {
     if (d->iUndoMode) {
@@ -709,6 +954,30 @@ void Document::commitTransaction()
             delete mUndoTransactions.front();
             mUndoTransactions.pop_front();
         }
+        _checkUndoLimit();
+    }
+}
+
+void Document::_checkUndoLimit()
+{
+    if (d->UndoMemSize == 0)
+        return;
+
+    // drop the oldest steps until the stack fits into the limit but always
+    // keep the latest one, even if it alone exceeds the limit
+    std::list<Transaction*>::reverse_iterator It = mUndoTransactions.rbegin();
+    std::size_t size = 0;
+    for (; It != mUndoTransactions.rend(); ++It) {
+        size += (*It)->getDataSize();
+        if (size > d->UndoMemSize && It != mUndoTransactions.rbegin())
+            break;
+    }
+
+    std::size_t keep = std::distance(mUndoTransactions.rbegin(), It);
+    // delete from front to back, see clearUndos()
+    while (mUndoTransactions.size() > keep) {
+        delete mUndoTransactions.front();
+        mUndoTransactions.pop_front();
     }
 }
 
@@ -783,14 +1052,28 @@ int Document::getUndoMode(void) const
     return d->iUndoMode;
 }
 
-unsigned int Document::getUndoMemSize (void) const
+std::size_t Document::getUndoMemSize (void) const
 {
-    return d->UndoMemSize;
+    std::size_t size = 0;
+    if (d->activeUndoTransaction)
+        size += d->activeUndoTransaction->getDataSize();
+    std::list<Transaction*>::const_iterator It;
+    for (It = mUndoTransactions.begin(); It != mUndoTransactions.end(); ++It)
+        size += (*It)->getDataSize();
+    for (It = mRedoTransactions.begin(); It != mRedoTransactions.end(); ++It)
+        size += (*It)->getDataSize();
+    return size;
 }
 
-void Document::setUndoLimit(unsigned int UndoMemSize)
+void Document::setUndoLimit(std::size_t UndoMemSize)
 {
     d->UndoMemSize = UndoMemSize;
+    _checkUndoLimit();
+}
+
+std::size_t Document::getUndoLimit(void) const
+{
+    return d->UndoMemSize;
 }
 
 void Document::setMaxUndoStackSize(unsigned int UndoMaxStackSize)
@@ -845,12 +1128,38 @@ void Document::onChanged(const Property* prop)
 
 void Document::onBeforeChangeProperty(const TransactionalObject *Who, const Property *What)
 {
-    if (d->activeUndoTransaction && !d->rollback)
+    if (d->activeUndoTransaction && !d->rollback) {
+        // properties may be changed by features executed in worker threads
+        QMutexLocker locker(&d->recomputeMutex);
         d->activeUndoTransaction->addObjectChange(Who,What);
+    }
 }
 
 void Document::onChangedProperty(const DocumentObject *Who, const Property *What)
 {
+    // a changed link invalidates the dependencies of the object
+    bool linkChanged = What == &Who->ExpressionEngine ||
+        What->isDerivedFrom(PropertyLink::getClassTypeId()) ||
+        What->isDerivedFrom(PropertyLinkSub::getClassTypeId()) ||
+        What->isDerivedFrom(PropertyLinkList::getClassTypeId()) ||
+        What->isDerivedFrom(PropertyLinkSubList::getClassTypeId());
+
+    DocumentObject* obj = const_cast<DocumentObject*>(Who);
+    if (What == &Who->ExpressionEngine || What == &Who->Label)
+        d->invalidateExprInList();
+    {
+        // properties may be changed by features executed in worker threads
+        QMutexLocker locker(&d->recomputeMutex);
+        // objects removed from the document are not tracked any more
+        if (linkChanged && d->depOutList.find(obj) != d->depOutList.end())
+            d->depDirty.insert(obj);
+        // the observers are notified by the thread running the recompute
+        if (d->recomputeThread && QThread::currentThread() != d->recomputeThread) {
+            d->pendingChanges[Who].push_back(What);
+            return;
+        }
+    }
+
     signalChangedObject(*Who, *What);
 }
 
@@ -961,6 +1270,13 @@ Document::Document(void)
     ADD_PROPERTY_TYPE(TipName,(""),0,PropertyType(Prop_Hidden|Prop_ReadOnly),
         "Link of the tip object of the document");
     Uid.touch();
+
+    bool parallel = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Document")->GetBool("ParallelRecompute", false);
+    setStatus(Document::ParallelRecompute, parallel);
+    bool deferred = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Document")->GetBool("DeferredLoading", false);
+    setStatus(Document::DeferredLoading, deferred);
 }
 
 Document::~Document()
@@ -978,6 +1294,10 @@ Document::~Document()
 #endif
 
     d->objectArray.clear();
+    // the objects are destroyed together, so they needn't remove their back-links
+    for (it = d->objectMap.begin(); it != d->objectMap.end(); ++it) {
+        it->second->setStatus(ObjectStatus::Destroy, true);
+    }
     for (it = d->objectMap.begin(); it != d->objectMap.end(); ++it) {
         delete(it->second);
     }
@@ -1232,6 +1552,10 @@ Document::readObjects(Base::XMLReader& reader)
     }
     reader.readEndElement("ObjectData");
 
+    // the links are only complete now
+    d->depDirtyAll = true;
+    d->invalidateExprInList();
+
     return objs;
 }
 
@@ -1279,7 +1603,7 @@ unsigned int Document::getMemSize (void) const
     size += PropertyContainer::getMemSize();
 
     // Undo Redo size
-    size += getUndoMemSize();
+    size += static_cast<unsigned int>(getUndoMemSize());
 
     return size;
 }
@@ -1317,9 +1641,13 @@ bool Document::saveCopy(const char* file)
 // Save the document under the name it has been opened
 bool Document::save (void)
 {
-    int compression = App::GetApplication().GetParameterGroupByPath
-        ("User parameter:BaseApp/Preferences/Document")->GetInt("CompressionLevel",3);
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Document");
+    int compression = hGrp->GetInt("CompressionLevel",3);
     compression = Base::clamp<int>(compression, Z_NO_COMPRESSION, Z_BEST_COMPRESSION);
+    // binary attachments like meshes or point clouds hardly shrink, so store them by default
+    int binaryCompression = hGrp->GetInt("BinaryCompressionLevel",Z_NO_COMPRESSION);
+    binaryCompression = Base::clamp<int>(binaryCompression, Z_NO_COMPRESSION, Z_BEST_COMPRESSION);
 
     if (*(FileName.getValue()) != '\0') {
         // Save the name of the tip object in order to handle in Restore()
@@ -1337,6 +1665,17 @@ bool Document::save (void)
                 ("User parameter:BaseApp/Preferences/Document")->GetASCII("prefAuthor","");
             LastModifiedBy.setValue(Author.c_str());
         }
+        // the project file gets replaced, so read in what is still pending from it
+        // and refuse to save if that fails as otherwise the data would be lost
+        PropertyComplexGeoData::loadDeferredFiles(FileName.getValue());
+        for (std::vector<DocumentObject*>::const_iterator it = d->objectArray.begin(); it != d->objectArray.end(); ++it) {
+            if (!PropertyComplexGeoData::loadDeferredData(*it)) {
+                std::stringstream str;
+                str << "Data of '" << (*it)->getNameInDocument() << "' couldn't be read from the project file";
+                throw Base::FileException(str.str().c_str());
+            }
+        }
+
         // make a tmp. file where to save the project data first and then rename to
         // the actual file name. This may be useful if overwriting an existing file
         // fails so that the data of the work up to now isn't lost.
@@ -1352,6 +1691,7 @@ bool Document::save (void)
 
             writer.setComment("FreeCAD Document");
             writer.setLevel(compression);
+            writer.setBinaryLevel(binaryCompression);
             writer.putNextEntry("Document.xml");
 
             Document::Save(writer);
@@ -1445,12 +1785,14 @@ void Document::restore (void)
     for (std::vector<DocumentObject*>::iterator obj = d->objectArray.begin(); obj != d->objectArray.end(); ++obj) {
         signalDeletedObject(*(*obj));
         signalTransactionRemove(*(*obj), 0);
+        (*obj)->setStatus(ObjectStatus::Destroy, true);
     }
     for (std::vector<DocumentObject*>::iterator obj = d->objectArray.begin(); obj != d->objectArray.end(); ++obj) {
         delete *obj;
     }
     d->objectArray.clear();
     d->objectMap.clear();
+    d->invalidateExprInList();
     d->activeObject = 0;
 
     Base::FileInfo fi(FileName.getValue());
@@ -1466,6 +1808,7 @@ void Document::restore (void)
 
     if (!reader.isValid())
         throw Base::FileException("Error reading compression file",FileName.getValue());
+    reader.setDeferredLoading(testStatus(Document::DeferredLoading));
 
     GetApplication().signalStartRestoreDocument(*this);
 
@@ -1559,22 +1902,85 @@ int Document::countObjects(void) const
    return static_cast<int>(d->objectArray.size());
 }
 
+namespace {
+bool nameLess(const DocumentObject* a, const DocumentObject* b)
+{
+    return strcmp(a->getNameInDocument(), b->getNameInDocument()) < 0;
+}
+}
+
 std::vector<App::DocumentObject*> Document::getInList(const DocumentObject* me) const
 {
     // result list
     std::vector<App::DocumentObject*> result;
-    // go through all objects
-    for (std::map<std::string,DocumentObject*>::const_iterator It = d->objectMap.begin(); It != d->objectMap.end();++It) {
-        // get the outList and search if me is in that list
-        std::vector<DocumentObject*> OutList = It->second->getOutList();
-        for (std::vector<DocumentObject*>::const_iterator It2=OutList.begin();It2!=OutList.end();++It2)
-            if (*It2 && *It2 == me)
-                // add the parent object
-                result.push_back(It->second);
+    // the link properties register their owner at the linked objects
+    for (std::vector<DocumentObject*>::const_iterator It = me->_inList.begin(); It != me->_inList.end(); ++It) {
+        if ((*It)->getDocument() == this)
+            result.push_back(*It);
     }
+
+    // and the objects using me in an expression
+    {
+        QMutexLocker locker(&d->exprInListMutex);
+        if (!d->exprInListValid) {
+            d->exprInList.clear();
+            for (std::vector<DocumentObject*>::const_iterator It = d->objectArray.begin(); It != d->objectArray.end(); ++It) {
+                if ((*It)->ExpressionEngine.numExpressions() == 0)
+                    continue;
+                std::vector<DocumentObject*> deps;
+                (*It)->ExpressionEngine.getDocumentObjectDeps(deps);
+                for (std::vector<DocumentObject*>::const_iterator It2 = deps.begin(); It2 != deps.end(); ++It2)
+                    d->exprInList[*It2].push_back(*It);
+            }
+            d->exprInListValid = true;
+        }
+
+        std::map<const DocumentObject*, std::vector<DocumentObject*> >::const_iterator pos = d->exprInList.find(me);
+        if (pos != d->exprInList.end())
+            result.insert(result.end(), pos->second.begin(), pos->second.end());
+    }
+
+    // same order as the objects in the document
+    std::stable_sort(result.begin(), result.end(), nameLess);
+    return result;
+}
+
+std::vector<App::DocumentObject*> Document::getInListRecursive(const DocumentObject* me) const
+{
+    std::size_t revision;
+    {
+        QMutexLocker locker(&d->exprInListMutex);
+        std::map<const DocumentObject*, std::vector<DocumentObject*> >::const_iterator pos = d->inListRecursive.find(me);
+        if (pos != d->inListRecursive.end())
+            return pos->second;
+        revision = d->inListRevision;
+    }
+
+    std::set<DocumentObject*> visited;
+    std::vector<DocumentObject*> result;
+    std::vector<DocumentObject*> pending = getInList(me);
+    while (!pending.empty()) {
+        DocumentObject* obj = pending.back();
+        pending.pop_back();
+        if (visited.insert(obj).second) {
+            result.push_back(obj);
+            std::vector<DocumentObject*> inList = getInList(obj);
+            pending.insert(pending.end(), inList.begin(), inList.end());
+        }
+    }
+
+    // don't keep the result if a link has changed in the meantime
+    QMutexLocker locker(&d->exprInListMutex);
+    if (revision == d->inListRevision)
+        d->inListRecursive[me] = result;
     return result;
 }
 
+void Document::_backLinksChanged(void)
+{
+    d->invalidateInListRecursive();
+}
+
 namespace boost {
 // recursive helper function to get all dependencies
 void out_edges_recursive(const Vertex& v, const DependencyList& g, std::set<Vertex>& out)
@@ -1717,6 +2123,81 @@ void Document::_rebuildDependencyList(void)
     }
 }
 
+void Document::_updateDependencyGraph(void)
+{
+    if (d->depDirtyAll) {
+        d->depOutList.clear();
+        d->depInList.clear();
+        d->depDirty.clear();
+        for (std::vector<DocumentObject*>::iterator it = d->objectArray.begin(); it != d->objectArray.end(); ++it) {
+            d->depOutList[*it];
+            d->depDirty.insert(*it);
+        }
+        d->depDirtyAll = false;
+    }
+
+    for (std::set<DocumentObject*>::iterator it = d->depDirty.begin(); it != d->depDirty.end(); ++it) {
+        DocumentObject* obj = *it;
+        std::vector<DocumentObject*>& outList = d->depOutList[obj];
+
+        // drop the old edges
+        for (std::vector<DocumentObject*>::iterator jt = outList.begin(); jt != outList.end(); ++jt) {
+            std::vector<DocumentObject*>& inList = d->depInList[*jt];
+            inList.erase(std::remove(inList.begin(), inList.end(), obj), inList.end());
+        }
+
+        // and add the current ones, only objects of this document take part in a recompute
+        outList.clear();
+        std::vector<DocumentObject*> links = obj->getOutList();
+        for (std::vector<DocumentObject*>::iterator jt = links.begin(); jt != links.end(); ++jt) {
+            if (*jt && d->depOutList.find(*jt) != d->depOutList.end())
+                outList.push_back(*jt);
+        }
+        std::sort(outList.begin(), outList.end());
+        outList.erase(std::unique(outList.begin(), outList.end()), outList.end());
+
+        for (std::vector<DocumentObject*>::iterator jt = outList.begin(); jt != outList.end(); ++jt)
+            d->depInList[*jt].push_back(obj);
+    }
+
+    d->depDirty.clear();
+}
+
+void Document::_removeFromDependencyGraph(DocumentObject* pcObject)
+{
+    d->invalidateExprInList();
+
+    std::map<DocumentObject*, std::vector<DocumentObject*> >::iterator it;
+    it = d->depOutList.find(pcObject);
+    if (it != d->depOutList.end()) {
+        for (std::vector<DocumentObject*>::iterator jt = it->second.begin(); jt != it->second.end(); ++jt) {
+            std::vector<DocumentObject*>& inList = d->depInList[*jt];
+            inList.erase(std::remove(inList.begin(), inList.end(), pcObject), inList.end());
+        }
+        d->depOutList.erase(it);
+    }
+
+    // the objects linking to the removed object must be re-examined
+    it = d->depInList.find(pcObject);
+    if (it != d->depInList.end()) {
+        for (std::vector<DocumentObject*>::iterator jt = it->second.begin(); jt != it->second.end(); ++jt) {
+            std::vector<DocumentObject*>& outList = d->depOutList[*jt];
+            outList.erase(std::remove(outList.begin(), outList.end(), pcObject), outList.end());
+            d->depDirty.insert(*jt);
+        }
+        d->depInList.erase(it);
+    }
+
+    d->depDirty.erase(pcObject);
+
+    // recompute of document is running
+    std::map<DocumentObject*, std::size_t>::iterator pos = d->recomputeIndex.find(pcObject);
+    if (pos != d->recomputeIndex.end()) {
+        d->recomputeNodes[pos->second].object = 0; // just nullify the pointer
+        d->recomputeIndex.erase(pos);
+    }
+}
+
 void Document::recompute()
 {
     // The 'SkipRecompute' flag can be (tmp.) set to avoid to many
@@ -1730,105 +2211,281 @@ void Document::recompute()
         delete *it;
     _RecomputeLog.clear();
 
-    // updates the dependency graph
-    _rebuildDependencyList();
+    // updates the dependency graph, only objects with changed links are visited
+    _updateDependencyGraph();
 
-    std::list<Vertex> make_order;
-    DependencyList::out_edge_iterator j, jend;
+    std::vector<RecomputeNode>& nodes = d->recomputeNodes;
+    std::map<DocumentObject*, std::size_t>& index = d->recomputeIndex;
+    nodes.clear();
+    index.clear();
 
+    // the touched objects and the objects which ask to be executed are the roots of the recompute
+    for (std::vector<DocumentObject*>::iterator it = d->objectArray.begin(); it != d->objectArray.end(); ++it) {
+        DocumentObject* Cur = *it;
+        bool mustExecute = Cur->mustExecute() == 1 || Cur->ExpressionEngine.depsAreTouched();
+        if (mustExecute || Cur->isTouched()) {
+            RecomputeNode node;
+            node.object = Cur;
+            node.pending = 0;
+            node.execute = mustExecute;
+            index[Cur] = nodes.size();
+            nodes.push_back(node);
+        }
+    }
 
-    try {
-        // this sort gives the execute
-        boost::topological_sort(d->DepList, std::front_inserter(make_order));
+    // add everything downstream of them
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        const std::vector<DocumentObject*>& inList = d->depInList[nodes[i].object];
+        for (std::vector<DocumentObject*>::const_iterator it = inList.begin(); it != inList.end(); ++it) {
+            if (index.find(*it) == index.end()) {
+                RecomputeNode node;
+                node.object = *it;
+                node.pending = 0;
+                node.execute = true;
+                index[*it] = nodes.size();
+                nodes.push_back(node);
+            }
+        }
     }
-    catch (const std::exception& e) {
-        std::cerr << "Document::recompute: " << e.what() << std::endl;
-        return;
+
+    // connect the nodes, an object with a dependency in the schedule must be recomputed
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        const std::vector<DocumentObject*>& outList = d->depOutList[nodes[i].object];
+        for (std::vector<DocumentObject*>::const_iterator it = outList.begin(); it != outList.end(); ++it) {
+            std::map<DocumentObject*, std::size_t>::iterator jt = index.find(*it);
+            if (jt != index.end()) {
+                nodes[jt->second].dependents.push_back(i);
+                nodes[i].pending++;
+                nodes[i].execute = true;
+            }
+        }
     }
 
-    // caching vertex to DocObject
-    for (std::map<DocumentObject*,Vertex>::const_iterator It1= d->VertexObjectList.begin();It1 != d->VertexObjectList.end(); ++It1)
-        d->vertexMap[It1->second] = It1->first;
+    // this sort gives the execute order
+    std::vector<std::size_t> make_order;
+    std::vector<int> pending(nodes.size());
+    make_order.reserve(nodes.size());
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        pending[i] = nodes[i].pending;
+        if (pending[i] == 0)
+            make_order.push_back(i);
+    }
+    for (std::size_t i = 0; i < make_order.size(); ++i) {
+        const std::vector<std::size_t>& dependents = nodes[make_order[i]].dependents;
+        for (std::vector<std::size_t>::const_iterator it = dependents.begin(); it != dependents.end(); ++it) {
+            if (--pending[*it] == 0)
+                make_order.push_back(*it);
+        }
+    }
 
-#ifdef FC_LOGFEATUREUPDATE
-    std::clog << "make ordering: " << std::endl;
-#endif
+    if (make_order.size() != nodes.size()) {
+        // the objects left over are part of a cycle or depend on one
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            if (pending[i] > 0) {
+                DocumentObject* Cur = nodes[i].object;
+                Base::Console().Error("Document::recompute: Cyclic dependency of '%s'\n", Cur->getNameInDocument());
+                addRecomputeLog(new DocumentObjectExecReturn("Cyclic dependency", Cur));
+                Cur->setError();
+            }
+        }
+        nodes.clear();
+        index.clear();
+        return;
+    }
 
-    std::set<DocumentObject*> recomputeList;
+    // mark all objects to be recomputed as touched before the first one gets executed
+    for (std::vector<RecomputeNode>::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        if (it->execute)
+            it->object->touch();
+    }
 
-    for (std::list<Vertex>::reverse_iterator i = make_order.rbegin();i != make_order.rend(); ++i) {
-        DocumentObject* Cur = d->vertexMap[*i];
-        if (!Cur || !isIn(Cur)) continue;
 #ifdef FC_LOGFEATUREUPDATE
-        std::clog << Cur->getNameInDocument() << " dep on:" ;
+    std::clog << "Have to recompute the following document objects" << std::endl;
+    for (std::vector<std::size_t>::const_iterator it = make_order.begin(); it != make_order.end(); ++it) {
+        if (nodes[*it].execute)
+            std::clog << "  " << nodes[*it].object->getNameInDocument() << std::endl;
+    }
 #endif
-        bool NeedUpdate = false;
 
-        // ask the object if it should be recomputed
-        if (Cur->mustExecute() == 1 || Cur->ExpressionEngine.depsAreTouched()) {
-#ifdef FC_LOGFEATUREUPDATE
-            std::clog << "[touched]";
-#endif
-            NeedUpdate = true;
+    bool aborted = false;
+    if (testStatus(Document::ParallelRecompute) && nodes.size() > 1 &&
+        QThreadPool::globalInstance()->maxThreadCount() > 1) {
+        // deferred data must not be read from several threads at once, so
+        // read in everything the executed objects may access beforehand
+        std::set<DocumentObject*> visited;
+        std::vector<DocumentObject*> stack;
+        for (std::vector<RecomputeNode>::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+            if (it->object)
+                stack.push_back(it->object);
+        }
+        while (!stack.empty()) {
+            DocumentObject* obj = stack.back();
+            stack.pop_back();
+            if (!obj || !visited.insert(obj).second)
+                continue;
+            PropertyComplexGeoData::loadDeferredData(obj);
+            std::vector<DocumentObject*> outList = obj->getOutList();
+            stack.insert(stack.end(), outList.begin(), outList.end());
         }
-        else {// if (Cur->mustExecute() == -1)
-            // update if one of the dependencies is touched
-            for (boost::tie(j, jend) = out_edges(*i, d->DepList); j != jend; ++j) {
-                DocumentObject* Test = d->vertexMap[target(*j, d->DepList)];
 
-                if (!Test) continue;
-#ifdef FC_LOGFEATUREUPDATE
-                std::clog << " " << Test->getNameInDocument();
-#endif
-                if (Test->isTouched()) {
-                    NeedUpdate = true;
-#ifdef FC_LOGFEATUREUPDATE
-                    std::clog << "[touched]";
-#endif
+        aborted = _recomputeParallel();
+    }
+    else {
+        for (std::vector<std::size_t>::const_iterator it = make_order.begin(); it != make_order.end(); ++it) {
+            DocumentObject* Cur = nodes[*it].object;
+            if (!Cur)
+                continue;
+            if (nodes[*it].execute || Cur->ExpressionEngine.depsAreTouched()) {
+                if (_recomputeFeature(Cur)) {
+                    // if somthing happen break execution of recompute
+                    aborted = true;
+                    break;
                 }
             }
         }
-        // if one touched recompute
-        if (NeedUpdate) {
-            Cur->touch();
-#ifdef FC_LOGFEATUREUPDATE
-            std::clog << " => Recompute feature";
-#endif
-            recomputeList.insert(Cur);
-        }
-#ifdef FC_LOGFEATUREUPDATE
-        std::clog << std::endl;
-#endif
     }
 
-#ifdef FC_LOGFEATUREUPDATE
-    std::clog << "Have to recompute the following document objects" << std::endl;
-    for (std::set<DocumentObject*>::const_iterator it = recomputeList.begin(); it != recomputeList.end(); ++it) {
-        std::clog << "  " << (*it)->getNameInDocument() << std::endl;
+    if (aborted) {
+        nodes.clear();
+        index.clear();
+        return;
     }
-#endif
 
-    for (std::list<Vertex>::reverse_iterator i = make_order.rbegin();i != make_order.rend(); ++i) {
-        DocumentObject* Cur = d->vertexMap[*i];
+    // reset all touched
+    for (std::vector<DocumentObject*>::iterator it = d->objectArray.begin(); it != d->objectArray.end(); ++it)
+        (*it)->purgeTouched();
+    nodes.clear();
+    index.clear();
+
+    signalRecomputed(*this);
+}
+
+/** Runs the recompute schedule prepared by recompute() on the global thread pool.
+ * A feature is started as soon as all of its dependencies are done, so independent
+ * branches of the graph are executed at the same time. Features flagged with
+ * ObjectStatus::NoParallelRecompute are executed by the calling thread.
+ * Returns true if the recompute was aborted.
+ */
+bool Document::_recomputeParallel()
+{
+    std::vector<RecomputeNode>& nodes = d->recomputeNodes;
+    std::vector<int> pending(nodes.size());
+    std::deque<std::size_t> ready, serial;
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        pending[i] = nodes[i].pending;
+        if (pending[i] == 0)
+            ready.push_back(i);
+    }
+
+    std::size_t finished = 0;
+    int running = 0;
+    bool aborted = false;
+
+    // Observers and Python features are run by this thread with the interpreter
+    // locked. It's only released while waiting for the workers, so that features
+    // executed there may enter the interpreter, too.
+    Base::PyGILStateLocker lock;
+    QMutexLocker locker(&d->recomputeMutex);
+    d->recomputeThread = QThread::currentThread();
+    d->recomputeFinished.clear();
+
+    while (finished < nodes.size()) {
+        std::vector<std::pair<std::size_t, RecomputeResult> > done;
+
+        // hand out everything that is ready to run
+        while (!ready.empty() && !aborted) {
+            std::size_t i = ready.front();
+            ready.pop_front();
+            DocumentObject* Cur = nodes[i].object;
+            if (!Cur || !(nodes[i].execute || Cur->ExpressionEngine.depsAreTouched())) {
+                done.push_back(std::make_pair(i, RecomputeResult()));
+            }
+            else if (Cur->testStatus(App::NoParallelRecompute)) {
+                serial.push_back(i);
+            }
+            else {
+                running++;
+                QThreadPool::globalInstance()->start(new RecomputeTask(d, i));
+            }
+        }
+
+        if (done.empty()) {
+            if (!serial.empty() && !aborted) {
+                std::size_t i = serial.front();
+                serial.pop_front();
+                RecomputeResult result;
+                locker.unlock();
+                _executeFeature(nodes[i].object, result);
+                locker.relock();
+                done.push_back(std::make_pair(i, result));
+            }
+            else if (d->recomputeFinished.empty()) {
+                if (running == 0)
+                    break; // aborted and all workers are done
+                Base::PyGILStateRelease unlock;
+                d->recomputeDone.wait(&d->recomputeMutex);
+            }
+        }
 
-        if (recomputeList.find(Cur) != recomputeList.end() ||
-                Cur->ExpressionEngine.depsAreTouched()) {
-            if ( _recomputeFeature(Cur)) {
-                // if somthing happen break execution of recompute
-                d->vertexMap.clear();
-                return;
+        running -= static_cast<int>(d->recomputeFinished.size());
+        done.insert(done.end(), d->recomputeFinished.begin(), d->recomputeFinished.end());
+        d->recomputeFinished.clear();
+
+        for (std::vector<std::pair<std::size_t, RecomputeResult> >::iterator it = done.begin(); it != done.end(); ++it) {
+            RecomputeNode& node = nodes[it->first];
+
+            // notify the observers about the changes made in the worker thread
+            std::vector<const Property*> changes;
+            if (node.object) {
+                std::map<const DocumentObject*, std::vector<const Property*> >::iterator jt;
+                jt = d->pendingChanges.find(node.object);
+                if (jt != d->pendingChanges.end()) {
+                    changes.swap(jt->second);
+                    d->pendingChanges.erase(jt);
+                }
+            }
+            if (it->second.executed || !changes.empty()) {
+                locker.unlock();
+                // the status and the messages of the feature are set here, too
+                if (it->second.executed && _reportFeature(node.object, it->second))
+                    aborted = true;
+                for (std::vector<const Property*>::iterator jt = changes.begin(); jt != changes.end(); ++jt)
+                    signalChangedObject(*node.object, **jt);
+                locker.relock();
+            }
+
+            finished++;
+            for (std::vector<std::size_t>::iterator jt = node.dependents.begin(); jt != node.dependents.end(); ++jt) {
+                if (--pending[*jt] == 0)
+                    ready.push_back(*jt);
             }
         }
     }
 
-    // reset all touched
-    for (std::map<Vertex,DocumentObject*>::iterator it = d->vertexMap.begin(); it != d->vertexMap.end(); ++it) {
-        if ((it->second) && isIn(it->second))
-            it->second->purgeTouched();
+    d->recomputeThread = 0;
+
+    // changes made to objects other than the executed ones
+    std::map<const DocumentObject*, std::vector<const Property*> > changes;
+    changes.swap(d->pendingChanges);
+    std::vector<std::string> removals;
+    removals.swap(d->pendingRemovals);
+    locker.unlock();
+    for (std::map<const DocumentObject*, std::vector<const Property*> >::iterator it = changes.begin(); it != changes.end(); ++it) {
+        for (std::vector<const Property*>::iterator jt = it->second.begin(); jt != it->second.end(); ++jt)
+            signalChangedObject(*it->first, **jt);
     }
-    d->vertexMap.clear();
 
-    signalRecomputed(*this);
+    // objects removed by features while the workers were running
+    for (std::vector<std::string>::iterator it = removals.begin(); it != removals.end(); ++it)
+        remObject(it->c_str());
+
+    return aborted;
+}
+
+void Document::addRecomputeLog(DocumentObjectExecReturn* returnCode)
+{
+    QMutexLocker locker(&d->recomputeMutex);
+    _RecomputeLog.push_back(returnCode);
 }
 
 const char * Document::getErrorDescription(const App::DocumentObject*Obj) const
@@ -1842,71 +2499,9 @@ const char * Document::getErrorDescription(const App::DocumentObject*Obj) const
 // call the recompute of the Feature and handle the exceptions and errors.
 bool Document::_recomputeFeature(DocumentObject* Feat)
 {
-#ifdef FC_LOGFEATUREUPDATE
-    std::clog << "Solv: Executing Feature: " << Feat->getNameInDocument() << std::endl;;
-#endif
-
-    DocumentObjectExecReturn  *returnCode = 0;
-    try {
-        returnCode = Feat->ExpressionEngine.execute();
-        if (returnCode != DocumentObject::StdReturn) {
-            returnCode->Which = Feat;
-            _RecomputeLog.push_back(returnCode);
-    #ifdef FC_DEBUG
-            Base::Console().Error("%s\n",returnCode->Why.c_str());
-    #endif
-            Feat->setError();
-            return true;
-        }
-
-        returnCode = Feat->recompute();
-    }
-    catch(Base::AbortException &e){
-        e.ReportException();
-        _RecomputeLog.push_back(new DocumentObjectExecReturn("User abort",Feat));
-        Feat->setError();
-        return true;
-    }
-    catch (const Base::MemoryException& e) {
-        Base::Console().Error("Memory exception in feature '%s' thrown: %s\n",Feat->getNameInDocument(),e.what());
-        _RecomputeLog.push_back(new DocumentObjectExecReturn("Out of memory exception",Feat));
-        Feat->setError();
-        return true;
-    }
-    catch (Base::Exception &e) {
-        e.ReportException();
-        _RecomputeLog.push_back(new DocumentObjectExecReturn(e.what(),Feat));
-        Feat->setError();
-        return false;
-    }
-    catch (std::exception &e) {
-        Base::Console().Warning("exception in Feature \"%s\" thrown: %s\n",Feat->getNameInDocument(),e.what());
-        _RecomputeLog.push_back(new DocumentObjectExecReturn(e.what(),Feat));
-        Feat->setError();
-        return false;
-    }
-#ifndef FC_DEBUG
-    catch (...) {
-        Base::Console().Error("App::Document::_RecomputeFeature(): Unknown exception in Feature \"%s\" thrown\n",Feat->getNameInDocument());
-        _RecomputeLog.push_back(new DocumentObjectExecReturn("Unknown exeption!"));
-        Feat->setError();
-        return true;
-    }
-#endif
-
-    // error code
-    if (returnCode == DocumentObject::StdReturn) {
-        Feat->resetError();
-    }
-    else {
-        returnCode->Which = Feat;
-        _RecomputeLog.push_back(returnCode);
-#ifdef FC_DEBUG
-        Base::Console().Error("%s\n",returnCode->Why.c_str());
-#endif
-        Feat->setError();
-    }
-    return false;
+    RecomputeResult result;
+    _executeFeature(Feat, result);
+    return _reportFeature(Feat, result);
 }
 
 void Document::recomputeFeature(DocumentObject* Feat)
@@ -1958,6 +2553,10 @@ DocumentObject * Document::addObject(const char* sType, const char* pObjectName,
     d->objectMap[ObjectName] = pcObject;
     // cache the pointer to the name string in the Object (for performance of DocumentObject::getNameInDocument())
     pcObject->pcNameInDocument = &(d->objectMap.find(ObjectName)->first);
+    pcObject->registerBackLinks(true);
+    d->depOutList[pcObject];
+    d->depDirty.insert(pcObject);
+    d->invalidateExprInList();
     // insert in the vector
     d->objectArray.push_back(pcObject);
     // insert in the adjacence list and referenc through the ConectionMap
@@ -2013,6 +2612,10 @@ void Document::addObject(DocumentObject* pcObject, const char* pObjectName)
     d->objectMap[ObjectName] = pcObject;
     // cache the pointer to the name string in the Object (for performance of DocumentObject::getNameInDocument())
     pcObject->pcNameInDocument = &(d->objectMap.find(ObjectName)->first);
+    pcObject->registerBackLinks(true);
+    d->depOutList[pcObject];
+    d->depDirty.insert(pcObject);
+    d->invalidateExprInList();
     // insert in the vector
     d->objectArray.push_back(pcObject);
 
@@ -2037,6 +2640,10 @@ void Document::_addObject(DocumentObject* pcObject, const char* pObjectName)
     d->objectArray.push_back(pcObject);
     // cache the pointer to the name string in the Object (for performance of DocumentObject::getNameInDocument())
     pcObject->pcNameInDocument = &(d->objectMap.find(ObjectName)->first);
+    pcObject->registerBackLinks(true);
+    d->depOutList[pcObject];
+    d->depDirty.insert(pcObject);
+    d->invalidateExprInList();
 
     // do no transactions if we do a rollback!
     if (!d->rollback) {
@@ -2060,6 +2667,16 @@ void Document::_addObject(DocumentObject* pcObject, const char* pObjectName)
 /// Remove an object out of the document
 void Document::remObject(const char* sName)
 {
+    {
+        // While features are executed in worker threads the objects are removed
+        // by the thread running the recompute once all of them are done.
+        QMutexLocker locker(&d->recomputeMutex);
+        if (d->recomputeThread) {
+            d->pendingRemovals.push_back(sName);
+            return;
+        }
+    }
+
     std::map<std::string,DocumentObject*>::iterator pos = d->objectMap.find(sName);
 
     // name not found?
@@ -2090,15 +2707,7 @@ void Document::remObject(const char* sName)
         signalTransactionRemove(*pos->second, 0);
     }
 
-    if (!d->vertexMap.empty()) {
-        // recompute of document is running
-        for (std::map<Vertex,DocumentObject*>::iterator it = d->vertexMap.begin(); it != d->vertexMap.end(); ++it) {
-            if (it->second == pos->second) {
-                it->second = 0; // just nullify the pointer
-                break;
-            }
-        }
-    }
+    _removeFromDependencyGraph(pos->second);
 
     // Before deleting we must nullify all dependant objects
     breakDependency(pos->second, true);
@@ -2155,6 +2764,8 @@ void Document::_remObject(DocumentObject* pcObject)
     // TODO Check me if it's needed (2015-09-01, Fat-Zer)
     pcObject->StatusBits.reset (ObjectStatus::Delete); // Unset the bit to be on the safe side
 
+    _removeFromDependencyGraph(pcObject);
+
     //remove the tip if needed
     if (Tip.getValue() == pcObject) {
         Tip.setValue(nullptr);
@@ -53,6 +53,8 @@ namespace App
     class DocumentPy; // the python document class
     class Application;
     class Transaction;
+    class RecomputeTask;
+    struct RecomputeResult;
 }
 
 namespace App
@@ -68,6 +70,8 @@ public:
         SkipRecompute = 0,
         KeepTrailingDigits = 1,
         Closable = 2,
+        ParallelRecompute = 3,
+        DeferredLoading = 4,
     };
 
     /** @name Properties */
@@ -277,10 +281,14 @@ public:
     void abortTransaction();
     /// Check if a transaction is open
     bool hasPendingTransaction() const;
-    /// Set the Undo limit in Byte!
-    void setUndoLimit(unsigned int UndoMemSize=0);
+    /** Set the Undo limit in Byte! If the Undo stack exceeds the limit the
+     * oldest transactions are removed. 0 means no limit.
+     */
+    void setUndoLimit(std::size_t UndoMemSize=0);
+    /// Returns the Undo limit in Byte
+    std::size_t getUndoLimit(void) const;
     /// Returns the actual memory consumption of the Undo redo stuff.
-    unsigned int getUndoMemSize (void) const;
+    std::size_t getUndoMemSize (void) const;
     /// Set the Undo limit as stack size
     void setMaxUndoStackSize(unsigned int UndoMaxStackSize=20);
     /// Set the Undo limit as stack size
@@ -291,12 +299,16 @@ public:
     int getAvailableUndos() const;
     /// Returns a list of the Undo names
     std::vector<std::string> getAvailableUndoNames() const;
+    /// Returns the memory in Byte used by each Undo, in the order of getAvailableUndoNames()
+    std::vector<std::size_t> getAvailableUndoSizes() const;
     /// Will UNDO  one step, returns  False if no undo was done (Undos == 0).
     bool undo();
     /// Returns the number of stored Redos. If greater than 0 Redo will be effective.
     int getAvailableRedos() const;
     /// Returns a list of the Redo names.
     std::vector<std::string> getAvailableRedoNames() const;
+    /// Returns the memory in Byte used by each Redo, in the order of getAvailableRedoNames()
+    std::vector<std::size_t> getAvailableRedoSizes() const;
     /// Will REDO  one step, returns  False if no redo was done (Redos == 0).
     bool redo() ;
     //@}
@@ -309,6 +321,8 @@ public:
     bool checkOnCycle(void);
     /// get a list of all objects linking to the given object
     std::vector<App::DocumentObject*> getInList(const DocumentObject* me) const;
+    /// get a list of all objects directly or indirectly linking to the given object
+    std::vector<App::DocumentObject*> getInListRecursive(const DocumentObject* me) const;
     /// Get a complete list of all objects the given objects depend on. The list
     /// also contains the given objects!
     std::vector<App::DocumentObject*> getDependencyList
@@ -328,6 +342,7 @@ public:
     friend class DocumentObject;
     friend class Transaction;
     friend class TransactionDocumentObject;
+    friend class RecomputeTask;
 
     /// Destruction
     virtual ~Document();
@@ -340,6 +355,8 @@ protected:
     void _addObject(DocumentObject* pcObject, const char* pObjectName);
     /// checks if a valid transaction is open
     void _checkTransaction(DocumentObject* pcObject);
+    /// drops the cached in-lists after a link has changed
+    void _backLinksChanged(void);
     void breakDependency(DocumentObject* pcObject, bool clear);
     std::vector<App::DocumentObject*> readObjects(Base::XMLReader& reader);
     void writeObjects(const std::vector<App::DocumentObject*>&, Base::Writer &writer) const;
@@ -351,9 +368,22 @@ protected:
     void onChangedProperty(const DocumentObject *Who, const Property *What);
     /// helper which Recompute only this feature
     bool _recomputeFeature(DocumentObject* Feat);
+    /// executes the feature without reporting anything, may be called from worker threads
+    static void _executeFeature(DocumentObject* Feat, RecomputeResult& result);
+    /// reports the result of _executeFeature(), returns true if the recompute must be stopped
+    bool _reportFeature(DocumentObject* Feat, const RecomputeResult& result);
+    /// executes the prepared recompute schedule on the thread pool
+    bool _recomputeParallel();
+    /// adds an entry to the recompute log
+    void addRecomputeLog(DocumentObjectExecReturn* returnCode);
     void _clearRedos();
+    /// remove the oldest Undos exceeding the Undo limit
+    void _checkUndoLimit();
     /// refresh the internal dependency graph
     void _rebuildDependencyList(void);
+    /// update the edges of all objects whose links have changed
+    void _updateDependencyGraph(void);
+    void _removeFromDependencyGraph(DocumentObject* pcObject);
     std::string getTransientDirectoryName(const std::string& uuid, const std::string& filename) const;
 
 
@@ -24,6 +24,8 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <algorithm>
+# include <set>
 #endif
 
 #include <Base/Writer.h>
@@ -141,16 +143,20 @@ bool DocumentObject::isAttachedToDocument() const
 
 const char* DocumentObject::detachFromDocument()
 {
+    // the object is kept by the undo stack and must not appear in the in-lists
+    if (pcNameInDocument && !testStatus(ObjectStatus::Destroy))
+        registerBackLinks(false);
     const std::string* name = pcNameInDocument;
     pcNameInDocument = 0;
     return name ? name->c_str() : 0;
 }
 
-std::vector<DocumentObject*> DocumentObject::getOutList(void) const
+namespace {
+// collects the objects referenced by the link properties of a container
+void getLinks(const PropertyContainer* container, std::vector<DocumentObject*>& ret)
 {
     std::vector<Property*> List;
-    std::vector<DocumentObject*> ret;
-    getPropertyList(List);
+    container->getPropertyList(List);
     for (std::vector<Property*>::const_iterator It = List.begin();It != List.end(); ++It) {
         if ((*It)->isDerivedFrom(PropertyLinkList::getClassTypeId())) {
             const std::vector<DocumentObject*> &OutList = static_cast<PropertyLinkList*>(*It)->getValues();
@@ -175,6 +181,13 @@ std::vector<DocumentObject*> DocumentObject::getOutList(void) const
                 ret.push_back(static_cast<PropertyLinkSub*>(*It)->getValue());
         }
     }
+}
+}
+
+std::vector<DocumentObject*> DocumentObject::getOutList(void) const
+{
+    std::vector<DocumentObject*> ret;
+    getLinks(this, ret);
 
     // Get document objects that this document object relies on
     ExpressionEngine.getDocumentObjectDeps(ret);
@@ -190,6 +203,43 @@ std::vector<App::DocumentObject*> DocumentObject::getInList(void) const
         return std::vector<App::DocumentObject*>();
 }
 
+std::vector<App::DocumentObject*> DocumentObject::getInListRecursive(void) const
+{
+    if (_pDoc)
+        return _pDoc->getInListRecursive(this);
+    else
+        return std::vector<App::DocumentObject*>();
+}
+
+void DocumentObject::_addBackLink(DocumentObject* obj)
+{
+    _inList.push_back(obj);
+    if (_pDoc)
+        _pDoc->_backLinksChanged();
+}
+
+void DocumentObject::_removeBackLink(DocumentObject* obj)
+{
+    // an object linking several times is listed several times
+    std::vector<DocumentObject*>::iterator it = std::find(_inList.begin(), _inList.end(), obj);
+    if (it != _inList.end())
+        _inList.erase(it);
+    if (_pDoc)
+        _pDoc->_backLinksChanged();
+}
+
+void DocumentObject::registerBackLinks(bool on)
+{
+    std::vector<DocumentObject*> links;
+    getLinks(this, links);
+    for (std::vector<DocumentObject*>::iterator it = links.begin(); it != links.end(); ++it) {
+        if (on)
+            (*it)->_addBackLink(this);
+        else
+            (*it)->_removeBackLink(this);
+    }
+}
+
 DocumentObjectGroup* DocumentObject::getGroup() const
 {
     return dynamic_cast<DocumentObjectGroup*>(GroupExtension::getGroupOfObject(this));
@@ -207,12 +257,16 @@ bool DocumentObject::testIfLinkDAGCompatible(const std::vector<DocumentObject *>
     Document* doc = this->getDocument();
     if (!doc)
         throw Base::Exception("DocumentObject::testIfLinkIsDAG: object is not in any document.");
-    std::vector<App::DocumentObject*> deplist = doc->getDependencyList(linksTo);
-    if( std::find(deplist.begin(),deplist.end(),this) != deplist.end() )
-        //found this in dependency list
-        return false;
-    else
-        return true;
+    // a link to this object or to an object depending on it closes a cycle
+    std::vector<App::DocumentObject*> inList = getInListRecursive();
+    std::set<const App::DocumentObject*> dependents(inList.begin(), inList.end());
+    dependents.insert(this);
+    for (std::vector<DocumentObject*>::const_iterator it = linksTo.begin(); it != linksTo.end(); ++it) {
+        if (dependents.find(*it) != dependents.end())
+            //found this in dependency list
+            return false;
+    }
+    return true;
 }
 
 bool DocumentObject::testIfLinkDAGCompatible(PropertyLinkSubList &linksTo) const
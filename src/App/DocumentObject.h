@@ -50,6 +50,8 @@ enum ObjectStatus {
     Restore = 4,
     Delete = 5,
     PythonCall = 6,
+    NoParallelRecompute = 7,
+    Destroy = 8,
     Expand = 16
 };
 
@@ -131,6 +133,8 @@ public:
     std::vector<App::DocumentObject*> getOutList(void) const;
     /// get all objects link to this object
     std::vector<App::DocumentObject*> getInList(void) const;
+    /// get all objects which directly or indirectly link to this object
+    std::vector<App::DocumentObject*> getInListRecursive(void) const;
     /// get group if object is part of a group, otherwise 0 is returned
     DocumentObjectGroup* getGroup() const;
 
@@ -140,8 +144,7 @@ public:
      * @param objToLinkIn (input). The object this object is to depend on after
      * the link is going to be created.
      * @return true if link can be created (no cycles will be made). False if
-     * the link will cause a circular dependency and break recomputes. Throws an
-     * error if the document already has a circular dependency.
+     * the link will cause a circular dependency and break recomputes.
      * That is, if the return is true, the link is allowed.
      */
     bool testIfLinkDAGCompatible(DocumentObject* linkTo) const;
@@ -198,6 +201,16 @@ public:
 
     const std::string & getOldLabel() const { return oldLabel; }
 
+    /** @name Back-links
+     * The link properties register their owner at the objects they point to,
+     * so that getInList() doesn't need to search the whole document. Only to
+     * be called by the link properties.
+     */
+    //@{
+    void _addBackLink(DocumentObject*);
+    void _removeBackLink(DocumentObject*);
+    //@}
+
 protected:
     /// recompute only this object
     virtual App::DocumentObjectExecReturn *recompute(void);
@@ -221,7 +234,8 @@ protected:
      *  4 - object is marked as 'restoring', i.e. the object gets loaded at the moment
      *  5 - object is marked as 'deleting', i.e. the object gets deleted at the moment
      *  6 - reserved
-     *  7 - reserved
+     *  7 - object must not be recomputed in a worker thread, e.g. it runs Python code
+     *  8 - object is destroyed together with its document, i.e. back-links are not removed
      * 16 - object is marked as 'expanded' in the tree view
      */
     std::bitset<32> StatusBits;
@@ -243,6 +257,10 @@ protected:
     /// get called when object is going to be removed from the document
     virtual void unsetupObject();
 
+private:
+    /// adds or removes the back-links of all links of this object
+    void registerBackLinks(bool on);
+
      /// python object of this class and all descendend
 protected: // attributes
     Py::Object PythonObject;
@@ -259,6 +277,10 @@ protected: // attributes
 
     // pointer to the document name string (for performance)
     const std::string *pcNameInDocument;
+
+private:
+    // objects linking to this one, once for each link
+    std::vector<App::DocumentObject*> _inList;
 };
 
 class AppExport ObjectStatusLocker
@@ -207,6 +207,17 @@ Py::List DocumentObjectPy::getInList(void) const
     return ret;
 }
 
+Py::List DocumentObjectPy::getInListRecursive(void) const
+{
+    Py::List ret;
+    std::vector<DocumentObject*> list = getDocumentObjectPtr()->getInListRecursive();
+
+    for (std::vector<DocumentObject*>::iterator It=list.begin();It!=list.end();++It)
+        ret.append(Py::Object((*It)->getPyObject(), true));
+
+    return ret;
+}
+
 Py::List DocumentObjectPy::getOutList(void) const
 {
     Py::List ret;
@@ -500,9 +500,25 @@ void  DocumentPy::setUndoMode(Py::Int arg)
     getDocumentPtr()->setUndoMode(arg); 
 }
 
-Py::Int DocumentPy::getUndoRedoMemSize(void) const
+Py::Object DocumentPy::getUndoRedoMemSize(void) const
 {
-    return Py::Int((long)getDocumentPtr()->getUndoMemSize());
+    // the sizes may exceed the range of a C long, e.g. on Windows
+    return Py::asObject(PyInt_FromSize_t(getDocumentPtr()->getUndoMemSize()));
+}
+
+Py::Object DocumentPy::getUndoLimit(void) const
+{
+    return Py::asObject(PyInt_FromSize_t(getDocumentPtr()->getUndoLimit()));
+}
+
+void DocumentPy::setUndoLimit(Py::Object arg)
+{
+    Py_ssize_t limit = PyNumber_AsSsize_t(arg.ptr(), PyExc_OverflowError);
+    if (limit == -1 && PyErr_Occurred())
+        throw Py::Exception();
+    if (limit < 0)
+        throw Py::ValueError("Undo limit must not be negative");
+    getDocumentPtr()->setUndoLimit(static_cast<std::size_t>(limit));
 }
 
 Py::Int DocumentPy::getUndoCount(void) const
@@ -526,6 +542,17 @@ Py::List DocumentPy::getUndoNames(void) const
     return res;
 }
 
+Py::List DocumentPy::getUndoSizes(void) const
+{
+    std::vector<std::size_t> vList = getDocumentPtr()->getAvailableUndoSizes();
+    Py::List res;
+
+    for (std::vector<std::size_t>::const_iterator It = vList.begin();It!=vList.end();++It)
+        res.append(Py::asObject(PyInt_FromSize_t(*It)));
+
+    return res;
+}
+
 Py::List DocumentPy::getRedoNames(void) const
 {
     std::vector<std::string> vList = getDocumentPtr()->getAvailableRedoNames();
@@ -537,6 +564,17 @@ Py::List DocumentPy::getRedoNames(void) const
     return res;
 }
 
+Py::List DocumentPy::getRedoSizes(void) const
+{
+    std::vector<std::size_t> vList = getDocumentPtr()->getAvailableRedoSizes();
+    Py::List res;
+
+    for (std::vector<std::size_t>::const_iterator It = vList.begin();It!=vList.end();++It)
+        res.append(Py::asObject(PyInt_FromSize_t(*It)));
+
+    return res;
+}
+
 Py::String  DocumentPy::getDependencyGraph(void) const
 {
     std::stringstream out;
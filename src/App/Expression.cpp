@@ -117,6 +117,41 @@ std::string unquote(const std::string & input)
     return output;
 }
 
+//
+// ExpressionValue class
+//
+
+/**
+  * Convert the value to the representation used by Property::setPathValue(), i.e
+  * a double if the value has no unit, and a Quantity otherwise. Like for
+  * StringExpression, strings are returned as an empty value.
+  */
+
+boost::any ExpressionValue::getValueAsAny() const
+{
+    if (type == String)
+        return boost::any();
+    return quantity.getUnit().isEmpty() ? boost::any(quantity.getValue()) : boost::any(quantity);
+}
+
+/**
+  * Create an expression representing the value.
+  *
+  * @returns A new (Number|Boolean|String)Expression object.
+  */
+
+Expression * ExpressionValue::toExpression(const DocumentObject *owner) const
+{
+    switch (type) {
+    case Boolean:
+        return new BooleanExpression(owner, quantity.getValue() > 0.5);
+    case String:
+        return new StringExpression(owner, text);
+    default:
+        return new NumberExpression(owner, quantity);
+    }
+}
+
 //
 // Expression base-class
 //
@@ -138,6 +173,27 @@ Expression * Expression::parse(const DocumentObject *owner, const std::string &b
     return ExpressionParser::parse(owner, buffer.c_str());
 }
 
+/**
+  * Evaluate the expression into a value. The default implementation goes through
+  * eval(); subclasses override it to avoid creating temporary expressions.
+  *
+  * @returns The result of the evaluation.
+  */
+
+ExpressionValue Expression::evaluate() const
+{
+    std::unique_ptr<Expression> e(eval());
+
+    if (e->isDerivedFrom(BooleanExpression::getClassTypeId()))
+        return ExpressionValue(static_cast<BooleanExpression*>(e.get())->getValue() > 0.5);
+    else if (e->isDerivedFrom(NumberExpression::getClassTypeId()))
+        return ExpressionValue(static_cast<NumberExpression*>(e.get())->getQuantity());
+    else if (e->isDerivedFrom(StringExpression::getClassTypeId()))
+        return ExpressionValue(static_cast<StringExpression*>(e.get())->getText());
+
+    throw ExpressionError("Invalid expression");
+}
+
 //
 // UnitExpression class
 //
@@ -175,6 +231,11 @@ Expression *UnitExpression::eval() const
     return new NumberExpression(owner, quantity);
 }
 
+ExpressionValue UnitExpression::evaluate() const
+{
+    return ExpressionValue(quantity);
+}
+
 /**
   * Simplify the expression. In this case, a NumberExpression is returned,
   * as it cannot be simplified any more.
@@ -340,80 +401,91 @@ static bool definitelyLessThan(double a, double b, double epsilon)
 
 Expression * OperatorExpression::eval() const
 {
-    std::unique_ptr<Expression> e1(left->eval());
-    NumberExpression * v1;
-    std::unique_ptr<Expression> e2(right->eval());
-    NumberExpression * v2;
-    Expression * output;
-    const double epsilon = std::numeric_limits<double>::epsilon();
+    return evaluate().toExpression(owner);
+}
+
+ExpressionValue OperatorExpression::evaluate() const
+{
+    ExpressionValue v1(left->evaluate());
+    ExpressionValue v2(right->evaluate());
+
+    return apply(op, v1, v2);
+}
+
+/**
+  * Apply operator \a op to the values \a v1 and \a v2.
+  *
+  * @returns The result, or throws an ExpressionError if the operator cannot be applied.
+  */
 
-    v1 = freecad_dynamic_cast<NumberExpression>(e1.get());
-    v2 = freecad_dynamic_cast<NumberExpression>(e2.get());
+ExpressionValue OperatorExpression::apply(Operator op, const ExpressionValue &v1, const ExpressionValue &v2)
+{
+    ExpressionValue output;
+    const double epsilon = std::numeric_limits<double>::epsilon();
 
-    if (v1 == 0 || v2 == 0)
+    if (!v1.isNumber() || !v2.isNumber())
         throw ExpressionError("Invalid expression");
 
     switch (op) {
     case ADD:
-        if (v1->getUnit() != v2->getUnit())
+        if (v1.getUnit() != v2.getUnit())
             throw ExpressionError("Incompatible units for + operator");
-        output = new NumberExpression(owner, v1->getQuantity() + v2->getQuantity());
+        output = ExpressionValue(v1.getQuantity() + v2.getQuantity());
         break;
     case SUB:
-        if (v1->getUnit() != v2->getUnit())
+        if (v1.getUnit() != v2.getUnit())
             throw ExpressionError("Incompatible units for - operator");
-        output = new NumberExpression(owner, v1->getQuantity()- v2->getQuantity());
+        output = ExpressionValue(v1.getQuantity()- v2.getQuantity());
         break;
     case MUL:
     case UNIT:
-        output = new NumberExpression(owner, v1->getQuantity() * v2->getQuantity());
+        output = ExpressionValue(v1.getQuantity() * v2.getQuantity());
         break;
     case DIV:
-        output = new NumberExpression(owner, v1->getQuantity() / v2->getQuantity());
+        output = ExpressionValue(v1.getQuantity() / v2.getQuantity());
         break;
     case POW:
-        output = new NumberExpression(owner, v1->getQuantity().pow(v2->getQuantity()) );
+        output = ExpressionValue(v1.getQuantity().pow(v2.getQuantity()) );
         break;
     case EQ:
-        if (v1->getUnit() != v2->getUnit())
+        if (v1.getUnit() != v2.getUnit())
             throw ExpressionError("Incompatible units for the = operator");
-        output = new BooleanExpression(owner, essentiallyEqual(v1->getValue(), v2->getValue(), epsilon) );
+        output = ExpressionValue(essentiallyEqual(v1.getValue(), v2.getValue(), epsilon) );
         break;
     case NEQ:
-        if (v1->getUnit() != v2->getUnit())
+        if (v1.getUnit() != v2.getUnit())
             throw ExpressionError("Incompatible units for the != operator");
-        output = new BooleanExpression(owner, !essentiallyEqual(v1->getValue(), v2->getValue(), epsilon) );
+        output = ExpressionValue(!essentiallyEqual(v1.getValue(), v2.getValue(), epsilon) );
         break;
     case LT:
-        if (v1->getUnit() != v2->getUnit())
+        if (v1.getUnit() != v2.getUnit())
             throw ExpressionError("Incompatible units for the < operator");
-        output = new BooleanExpression(owner, definitelyLessThan(v1->getValue(), v2->getValue(), epsilon) );
+        output = ExpressionValue(definitelyLessThan(v1.getValue(), v2.getValue(), epsilon) );
         break;
     case GT:
-        if (v1->getUnit() != v2->getUnit())
+        if (v1.getUnit() != v2.getUnit())
             throw ExpressionError("Incompatible units for the > operator");
-        output = new BooleanExpression(owner, definitelyGreaterThan(v1->getValue(), v2->getValue(), epsilon) );
+        output = ExpressionValue(definitelyGreaterThan(v1.getValue(), v2.getValue(), epsilon) );
         break;
     case LTE:
-        if (v1->getUnit() != v2->getUnit())
+        if (v1.getUnit() != v2.getUnit())
             throw ExpressionError("Incompatible units for the <= operator");
-        output = new BooleanExpression(owner, definitelyLessThan(v1->getValue(), v2->getValue(), epsilon) ||
-                                       essentiallyEqual(v1->getValue(), v2->getValue(), epsilon));
+        output = ExpressionValue(definitelyLessThan(v1.getValue(), v2.getValue(), epsilon) ||
+                                 essentiallyEqual(v1.getValue(), v2.getValue(), epsilon));
         break;
     case GTE:
-        if (v1->getUnit() != v2->getUnit())
+        if (v1.getUnit() != v2.getUnit())
             throw ExpressionError("Incompatible units for the >= operator");
-        output = new BooleanExpression(owner, essentiallyEqual(v1->getValue(), v2->getValue(), epsilon) ||
-                                       definitelyGreaterThan(v1->getValue(), v2->getValue(), epsilon));
+        output = ExpressionValue(essentiallyEqual(v1.getValue(), v2.getValue(), epsilon) ||
+                                 definitelyGreaterThan(v1.getValue(), v2.getValue(), epsilon));
         break;
     case NEG:
-        output = new NumberExpression(owner, -v1->getQuantity() );
+        output = ExpressionValue(-v1.getQuantity() );
         break;
     case POS:
-        output = new NumberExpression(owner, v1->getQuantity() );
+        output = ExpressionValue(v1.getQuantity() );
         break;
     default:
-        output = 0;
         assert(0);
     }
 
@@ -844,28 +916,34 @@ public:
     }
 };
 
-Expression * FunctionExpression::evalAggregate() const
+ExpressionValue FunctionExpression::evalAggregate() const
 {
-    boost::shared_ptr<Collector> c;
+    SumCollector sum;
+    AverageCollector average;
+    StdDevCollector stddev;
+    CountCollector count;
+    MinCollector minimum;
+    MaxCollector maximum;
+    Collector * c = 0;
 
     switch (f) {
     case SUM:
-        c = boost::shared_ptr<Collector>(new SumCollector());
+        c = &sum;
         break;
     case AVERAGE:
-        c = boost::shared_ptr<Collector>(new AverageCollector());
+        c = &average;
         break;
     case STDDEV:
-        c = boost::shared_ptr<Collector>(new StdDevCollector());
+        c = &stddev;
         break;
     case COUNT:
-        c = boost::shared_ptr<Collector>(new CountCollector());
+        c = &count;
         break;
     case MIN:
-        c = boost::shared_ptr<Collector>(new MinCollector());
+        c = &minimum;
         break;
     case MAX:
-        c = boost::shared_ptr<Collector>(new MaxCollector());
+        c = &maximum;
         break;
     default:
         assert(false);
@@ -893,18 +971,17 @@ Expression * FunctionExpression::evalAggregate() const
             } while (range.next());
         }
         else if (args[i]->isDerivedFrom(App::VariableExpression::getClassTypeId())) {
-            std::unique_ptr<Expression> e(args[i]->eval());
-            NumberExpression * n(freecad_dynamic_cast<NumberExpression>(e.get()));
+            ExpressionValue v(args[i]->evaluate());
 
-            if (n)
-                c->collect(n->getQuantity());
+            if (v.isNumber())
+                c->collect(v.getQuantity());
         }
         else if (args[i]->isDerivedFrom(App::NumberExpression::getClassTypeId())) {
             c->collect(static_cast<NumberExpression*>(args[i])->getQuantity());
         }
     }
 
-    return new NumberExpression(owner, c->getQuantity());
+    return ExpressionValue(c->getQuantity());
 }
 
 /**
@@ -915,30 +992,53 @@ Expression * FunctionExpression::evalAggregate() const
   */
 
 Expression * FunctionExpression::eval() const
+{
+    return evaluate().toExpression(owner);
+}
+
+ExpressionValue FunctionExpression::evaluate() const
 {
     // Handle aggregate functions
     if (f > AGGREGATES)
         return evalAggregate();
 
-    std::unique_ptr<Expression> e1(args[0]->eval());
-    std::unique_ptr<Expression> e2(args.size() > 1 ? args[1]->eval() : 0);
-    NumberExpression * v1 = freecad_dynamic_cast<NumberExpression>(e1.get());
-    NumberExpression * v2 = freecad_dynamic_cast<NumberExpression>(e2.get());
+    ExpressionValue v1(args[0]->evaluate());
+
+    if (args.size() > 1) {
+        ExpressionValue v2(args[1]->evaluate());
+
+        return apply(f, v1, &v2);
+    }
+    else
+        return apply(f, v1, 0);
+}
+
+/**
+  * Apply function \a f to the value \a v1, and for functions taking two arguments,
+  * \a v2. The aggregates are not handled here.
+  *
+  * @returns The result, or throws an ExpressionError if the function cannot be applied.
+  */
+
+ExpressionValue FunctionExpression::apply(Function f, const ExpressionValue &v1, const ExpressionValue *v2)
+{
     double output;
     Unit unit;
     double scaler = 1;
 
-    if (v1 == 0)
+    if (!v1.isNumber())
         throw ExpressionError("Invalid argument.");
+    if (v2 && !v2->isNumber())
+        v2 = 0;
 
-    double value = v1->getValue();
+    double value = v1.getValue();
 
     /* Check units and arguments */
     switch (f) {
     case COS:
     case SIN:
     case TAN:
-        if (!(v1->getUnit() == Unit::Angle || v1->getUnit().isEmpty()))
+        if (!(v1.getUnit() == Unit::Angle || v1.getUnit().isEmpty()))
             throw ExpressionError("Unit must be either empty or an angle.");
 
         // Convert value to radians
@@ -948,7 +1048,7 @@ Expression * FunctionExpression::eval() const
     case ACOS:
     case ASIN:
     case ATAN:
-        if (!v1->getUnit().isEmpty())
+        if (!v1.getUnit().isEmpty())
             throw ExpressionError("Unit must be empty.");
         unit = Unit::Angle;
         scaler = 180.0 / M_PI;
@@ -959,7 +1059,7 @@ Expression * FunctionExpression::eval() const
     case SINH:
     case TANH:
     case COSH:
-        if (!v1->getUnit().isEmpty())
+        if (!v1.getUnit().isEmpty())
             throw ExpressionError("Unit must be empty.");
         unit = Unit();
         break;
@@ -968,10 +1068,10 @@ Expression * FunctionExpression::eval() const
     case CEIL:
     case FLOOR:
     case ABS:
-        unit = v1->getUnit();
+        unit = v1.getUnit();
         break;
     case SQRT: {
-        unit = v1->getUnit();
+        unit = v1.getUnit();
 
         // All components of unit must be either zero or dividable by 2
         UnitSignature s = unit.getSignature();
@@ -999,7 +1099,7 @@ Expression * FunctionExpression::eval() const
         if (v2 == 0)
             throw ExpressionError("Invalid second argument.");
 
-        if (v1->getUnit() != v2->getUnit())
+        if (v1.getUnit() != v2->getUnit())
             throw ExpressionError("Units must be equal");
         unit = Unit::Angle;
         scaler = 180.0 / M_PI;
@@ -1009,7 +1109,7 @@ Expression * FunctionExpression::eval() const
             throw ExpressionError("Invalid second argument.");
         if (!v2->getUnit().isEmpty())
             throw ExpressionError("Second argument must have empty unit.");
-        unit = v1->getUnit();
+        unit = v1.getUnit();
         break;
     case POW: {
         if (v2 == 0)
@@ -1020,9 +1120,9 @@ Expression * FunctionExpression::eval() const
 
         // Compute new unit for exponentation
         double exponent = v2->getValue();
-        if (!v1->getUnit().isEmpty()) {
+        if (!v1.getUnit().isEmpty()) {
             if (exponent - boost::math::round(exponent) < 1e-9)
-                unit = v1->getUnit().pow(exponent);
+                unit = v1.getUnit().pow(exponent);
             else
                 throw ExpressionError("Exponent must be an integer when used with a unit");
         }
@@ -1105,7 +1205,7 @@ Expression * FunctionExpression::eval() const
         assert(0);
     }
 
-    return new NumberExpression(owner, Quantity(scaler * output, unit));
+    return ExpressionValue(Quantity(scaler * output, unit));
 }
 
 /**
@@ -1342,6 +1442,11 @@ const Property * VariableExpression::getProperty() const
   */
 
 Expression * VariableExpression::eval() const
+{
+    return evaluate().toExpression(owner);
+}
+
+ExpressionValue VariableExpression::evaluate() const
 {
     const Property * prop = getProperty();
     PropertyContainer * parent = prop->getContainer();
@@ -1349,52 +1454,56 @@ Expression * VariableExpression::eval() const
     if (!parent->isDerivedFrom(App::DocumentObject::getClassTypeId()))
         throw ExpressionError("Property must belong to a document object.");
 
+    // Quantities are by far the most common case; read them directly
+    if (prop->isDerivedFrom(PropertyQuantity::getClassTypeId()))
+        return ExpressionValue(static_cast<const PropertyQuantity*>(prop)->getQuantityValue());
+
     boost::any value = prop->getPathValue(var);
 
     if (value.type() == typeid(Quantity)) {
         Quantity qvalue = boost::any_cast<Quantity>(value);
 
-        return new NumberExpression(owner, qvalue);
+        return ExpressionValue(qvalue);
     }
     else if (value.type() == typeid(double)) {
         double dvalue = boost::any_cast<double>(value);
 
-        return new NumberExpression(owner, Quantity(dvalue));
+        return ExpressionValue(Quantity(dvalue));
     }
     else if (value.type() == typeid(float)) {
         double fvalue = boost::any_cast<float>(value);
 
-        return new NumberExpression(owner, Quantity(fvalue));
+        return ExpressionValue(Quantity(fvalue));
     }
     else if (value.type() == typeid(int)) {
         int ivalue = boost::any_cast<int>(value);
 
-        return new NumberExpression(owner, Quantity(ivalue));
+        return ExpressionValue(Quantity(ivalue));
     }
     else if (value.type() == typeid(long)) {
         long lvalue = boost::any_cast<long>(value);
 
-        return new NumberExpression(owner, Quantity(lvalue));
+        return ExpressionValue(Quantity(lvalue));
     }
     else if (value.type() == typeid(bool)) {
         double bvalue = boost::any_cast<bool>(value) ? 1.0 : 0.0;
 
-        return new NumberExpression(owner, Quantity(bvalue));
+        return ExpressionValue(Quantity(bvalue));
     }
     else if (value.type() == typeid(std::string)) {
         std::string svalue = boost::any_cast<std::string>(value);
 
-        return new StringExpression(owner, svalue);
+        return ExpressionValue(svalue);
     }
     else if (value.type() == typeid(char*)) {
         char* svalue = boost::any_cast<char*>(value);
 
-        return new StringExpression(owner, svalue);
+        return ExpressionValue(std::string(svalue));
     }
     else if (value.type() == typeid(const char*)) {
         const char* svalue = boost::any_cast<const char*>(value);
 
-        return new StringExpression(owner, svalue);
+        return ExpressionValue(std::string(svalue));
     }
 
     throw ExpressionError("Property is of invalid type.");
@@ -1486,6 +1595,11 @@ Expression * StringExpression::eval() const
     return copy();
 }
 
+ExpressionValue StringExpression::evaluate() const
+{
+    return ExpressionValue(text);
+}
+
 /**
   * Simplify the expression. For strings, this is a simple copy of the object.
   */
@@ -1538,16 +1652,20 @@ bool ConditionalExpression::isTouched() const
 
 Expression *ConditionalExpression::eval() const
 {
-    std::unique_ptr<Expression> e(condition->eval());
-    NumberExpression * v = freecad_dynamic_cast<NumberExpression>(e.get());
+    return evaluate().toExpression(owner);
+}
 
-    if (v == 0)
+ExpressionValue ConditionalExpression::evaluate() const
+{
+    ExpressionValue v(condition->evaluate());
+
+    if (!v.isNumber())
         throw ExpressionError("Invalid expression");
 
-    if (fabs(v->getValue()) > 0.5)
-        return trueExpr->eval();
+    if (fabs(v.getValue()) > 0.5)
+        return trueExpr->evaluate();
     else
-        return falseExpr->eval();
+        return falseExpr->evaluate();
 }
 
 Expression *ConditionalExpression::simplify() const
@@ -1624,6 +1742,11 @@ BooleanExpression::BooleanExpression(const DocumentObject *_owner, bool _value)
 {
 }
 
+ExpressionValue BooleanExpression::evaluate() const
+{
+    return ExpressionValue(getValue() > 0.5);
+}
+
 Expression *BooleanExpression::copy() const
 {
     return new BooleanExpression(owner, getValue() > 0.5 ? true : false);
@@ -1690,6 +1813,232 @@ void RangeExpression::setRange(const Range &r)
     range = r;
 }
 
+//
+// CompiledExpression class
+//
+
+CompiledExpression::CompiledExpression(boost::shared_ptr<const Expression> expr)
+    : source(expr)
+    , depth(0)
+    , maxDepth(0)
+{
+    compile(source.get());
+}
+
+void CompiledExpression::emit(OpCode code, int arg, int argc)
+{
+    Instruction i;
+
+    i.code = code;
+    i.arg = arg;
+    i.argc = argc;
+    program.push_back(i);
+
+    switch (code) {
+    case PushConstant:
+    case PushNode:
+        ++depth;
+        break;
+    case ApplyOperator:
+        --depth;
+        break;
+    case ApplyFunction:
+        depth -= argc - 1;
+        break;
+    case JumpIfFalse:
+        --depth;
+        break;
+    default:
+        break;
+    }
+    maxDepth = std::max(maxDepth, depth);
+}
+
+/**
+  * Check whether the instructions emitted since \a start are exactly \a n constants.
+  */
+
+bool CompiledExpression::isConstant(std::size_t start, std::size_t n) const
+{
+    if (program.size() - start != n)
+        return false;
+    for (std::size_t i = start; i < program.size(); ++i) {
+        if (program[i].code != PushConstant)
+            return false;
+    }
+    return true;
+}
+
+/**
+  * Replace the constants emitted since \a start by \a value.
+  */
+
+void CompiledExpression::foldConstants(std::size_t start, int startDepth, const ExpressionValue &value)
+{
+    constants.resize(program[start].arg);
+    program.resize(start);
+    depth = startDepth;
+    constants.push_back(value);
+    emit(PushConstant, static_cast<int>(constants.size()) - 1);
+}
+
+/**
+  * Append the instructions for \a expr to the program. Operators, functions and
+  * conditionals whose operands turn out to be constant are evaluated right away.
+  */
+
+void CompiledExpression::compile(const Expression *expr)
+{
+    const std::size_t start = program.size();
+    const int startDepth = depth;
+
+    if (expr->isDerivedFrom(OperatorExpression::getClassTypeId())) {
+        const OperatorExpression * e = static_cast<const OperatorExpression*>(expr);
+
+        compile(e->getLeft());
+        compile(e->getRight());
+        if (isConstant(start, 2)) {
+            try {
+                foldConstants(start, startDepth,
+                              OperatorExpression::apply(e->getOperator(),
+                                                        constants[program[start].arg],
+                                                        constants[program[start + 1].arg]));
+                return;
+            }
+            catch (Base::Exception &) {
+                // Leave it to the evaluation to report the error
+            }
+        }
+        emit(ApplyOperator, e->getOperator());
+    }
+    else if (expr->isDerivedFrom(FunctionExpression::getClassTypeId()) &&
+             static_cast<const FunctionExpression*>(expr)->getFunction() < FunctionExpression::AGGREGATES) {
+        const FunctionExpression * e = static_cast<const FunctionExpression*>(expr);
+        const std::vector<Expression*> & args = e->getArgs();
+        std::size_t argc = std::min<std::size_t>(args.size(), 2);
+
+        for (std::size_t i = 0; i < argc; ++i)
+            compile(args[i]);
+        if (argc > 0 && isConstant(start, argc)) {
+            try {
+                foldConstants(start, startDepth,
+                              FunctionExpression::apply(e->getFunction(),
+                                                        constants[program[start].arg],
+                                                        argc > 1 ? &constants[program[start + 1].arg] : 0));
+                return;
+            }
+            catch (Base::Exception &) {
+                // Leave it to the evaluation to report the error
+            }
+        }
+        emit(ApplyFunction, e->getFunction(), static_cast<int>(argc));
+    }
+    else if (expr->isDerivedFrom(ConditionalExpression::getClassTypeId())) {
+        const ConditionalExpression * e = static_cast<const ConditionalExpression*>(expr);
+
+        compile(e->getCondition());
+        if (isConstant(start, 1) && constants[program[start].arg].isNumber()) {
+            bool condition = fabs(constants[program[start].arg].getValue()) > 0.5;
+
+            constants.resize(program[start].arg);
+            program.resize(start);
+            depth = startDepth;
+            compile(condition ? e->getTrueExpression() : e->getFalseExpression());
+            return;
+        }
+
+        std::size_t jumpIfFalse = program.size();
+        emit(JumpIfFalse);
+        compile(e->getTrueExpression());
+
+        std::size_t jump = program.size();
+        emit(Jump);
+        program[jumpIfFalse].arg = static_cast<int>(program.size());
+        depth = startDepth;
+        compile(e->getFalseExpression());
+        program[jump].arg = static_cast<int>(program.size());
+    }
+    else if (expr->isDerivedFrom(VariableExpression::getClassTypeId()) ||
+             expr->isDerivedFrom(FunctionExpression::getClassTypeId()) ||
+             expr->isDerivedFrom(RangeExpression::getClassTypeId()) ||
+             !(expr->isDerivedFrom(UnitExpression::getClassTypeId()) ||
+               expr->isDerivedFrom(StringExpression::getClassTypeId()))) {
+        // Depends on the document, evaluate the node itself
+        nodes.push_back(expr);
+        emit(PushNode, static_cast<int>(nodes.size()) - 1);
+    }
+    else {
+        constants.push_back(expr->evaluate());
+        emit(PushConstant, static_cast<int>(constants.size()) - 1);
+    }
+}
+
+/**
+  * Run the program.
+  *
+  * @returns The result of the evaluation, or throws an exception like Expression::evaluate().
+  */
+
+ExpressionValue CompiledExpression::evaluate() const
+{
+    const int localStackSize = 16;
+    std::size_t pc = 0;
+
+    // The value stack is local so that the same program can be evaluated
+    // recursively or from several threads at once. It lives on the C++ stack
+    // unless the program is deeper than usual.
+    ExpressionValue localStack[localStackSize];
+    std::vector<ExpressionValue> heapStack;
+    ExpressionValue * stack = localStack;
+    std::size_t top = 0;
+
+    if (maxDepth > localStackSize) {
+        heapStack.resize(maxDepth);
+        stack = &heapStack[0];
+    }
+
+    while (pc < program.size()) {
+        const Instruction & i = program[pc++];
+
+        switch (i.code) {
+        case PushConstant:
+            stack[top++] = constants[i.arg];
+            break;
+        case PushNode:
+            stack[top++] = nodes[i.arg]->evaluate();
+            break;
+        case ApplyOperator:
+            stack[top - 2] = OperatorExpression::apply(static_cast<OperatorExpression::Operator>(i.arg),
+                                                       stack[top - 2], stack[top - 1]);
+            --top;
+            break;
+        case ApplyFunction: {
+            std::size_t first = top - i.argc;
+            stack[first] = FunctionExpression::apply(static_cast<FunctionExpression::Function>(i.arg),
+                                                     stack[first], i.argc > 1 ? &stack[first + 1] : 0);
+            top = first + 1;
+            break;
+        }
+        case JumpIfFalse: {
+            const ExpressionValue & v = stack[top - 1];
+
+            if (!v.isNumber())
+                throw ExpressionError("Invalid expression");
+            if (!(fabs(v.getValue()) > 0.5))
+                pc = i.arg;
+            --top;
+            break;
+        }
+        case Jump:
+            pc = i.arg;
+            break;
+        }
+    }
+
+    assert(top == 1);
+    return stack[0];
+}
+
 namespace App {
 
 namespace ExpressionParser {
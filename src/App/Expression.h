@@ -24,6 +24,9 @@
 #define EXPRESSION_H
 
 #include <string>
+#include <vector>
+#include <boost/any.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/tuple/tuple.hpp>
 #include <Base/Exception.h>
 #include <Base/Unit.h>
@@ -66,6 +69,54 @@ protected:
     boost::shared_ptr<typename AtomicPropertyChangeInterface<P>::AtomicPropertyChange> signaller;
 };
 
+/**
+  * Value produced by evaluating an expression.
+  *
+  * It holds either a quantity (possibly flagged as boolean) or a string, and is
+  * passed around by value, so evaluation through Expression::evaluate() does not
+  * allocate intermediate expression objects.
+  */
+
+class AppExport ExpressionValue {
+public:
+    enum Type {
+        Number,
+        Boolean,
+        String
+    };
+
+    ExpressionValue() : type(Number) { }
+
+    explicit ExpressionValue(const Base::Quantity & _quantity) : type(Number), quantity(_quantity) { }
+
+    explicit ExpressionValue(bool _value) : type(Boolean), quantity(_value ? 1.0 : 0.0) { }
+
+    explicit ExpressionValue(const std::string & _text) : type(String), text(_text) { }
+
+    Type getType() const { return type; }
+
+    bool isNumber() const { return type != String; }
+
+    bool isString() const { return type == String; }
+
+    const Base::Quantity & getQuantity() const { return quantity; }
+
+    double getValue() const { return quantity.getValue(); }
+
+    const Base::Unit & getUnit() const { return quantity.getUnit(); }
+
+    const std::string & getText() const { return text; }
+
+    boost::any getValueAsAny() const;
+
+    Expression * toExpression(const App::DocumentObject * owner) const;
+
+private:
+    Type type;
+    Base::Quantity quantity;
+    std::string text;
+};
+
 /**
   * Base class for expressions.
   *
@@ -84,6 +135,8 @@ public:
 
     virtual Expression * eval() const = 0;
 
+    virtual ExpressionValue evaluate() const;
+
     virtual std::string toString() const = 0;
 
     static Expression * parse(const App::DocumentObject * owner, const std::string& buffer);
@@ -123,6 +176,8 @@ public:
 
     virtual Expression * eval() const;
 
+    virtual ExpressionValue evaluate() const;
+
     virtual Expression * simplify() const;
 
     virtual std::string toString() const;
@@ -196,6 +251,8 @@ class AppExport BooleanExpression : public NumberExpression {
 public:
     BooleanExpression(const App::DocumentObject *_owner = 0, bool _value = false);
 
+    virtual ExpressionValue evaluate() const;
+
     virtual Expression * copy() const;
 
 };
@@ -234,6 +291,10 @@ public:
 
     virtual Expression * eval() const;
 
+    virtual ExpressionValue evaluate() const;
+
+    static ExpressionValue apply(Operator op, const ExpressionValue & v1, const ExpressionValue & v2);
+
     virtual Expression * simplify() const;
 
     virtual std::string toString() const;
@@ -276,6 +337,8 @@ public:
 
     virtual Expression * eval() const;
 
+    virtual ExpressionValue evaluate() const;
+
     virtual Expression * simplify() const;
 
     virtual std::string toString() const;
@@ -288,6 +351,12 @@ public:
 
     virtual void visit(ExpressionVisitor & v);
 
+    Expression * getCondition() const { return condition; }
+
+    Expression * getTrueExpression() const { return trueExpr; }
+
+    Expression * getFalseExpression() const { return falseExpr; }
+
 protected:
 
     Expression * condition;  /**< Condition */
@@ -351,6 +420,10 @@ public:
 
     virtual Expression * eval() const;
 
+    virtual ExpressionValue evaluate() const;
+
+    static ExpressionValue apply(Function f, const ExpressionValue & v1, const ExpressionValue * v2);
+
     virtual Expression * simplify() const;
 
     virtual std::string toString() const;
@@ -363,8 +436,12 @@ public:
 
     virtual void visit(ExpressionVisitor & v);
 
+    Function getFunction() const { return f; }
+
+    const std::vector<Expression *> & getArgs() const { return args; }
+
 protected:
-    Expression *evalAggregate() const;
+    ExpressionValue evalAggregate() const;
 
     Function f;        /**< Function to execute */
     std::vector<Expression *> args; /** Arguments to function*/
@@ -389,6 +466,8 @@ public:
 
     virtual Expression * eval() const;
 
+    virtual ExpressionValue evaluate() const;
+
     virtual Expression * simplify() const;
 
     virtual std::string toString() const { return var.toString(); }
@@ -432,6 +511,8 @@ public:
 
     virtual Expression * eval() const;
 
+    virtual ExpressionValue evaluate() const;
+
     virtual Expression * simplify() const;
 
     virtual std::string toString() const;
@@ -476,6 +557,56 @@ protected:
     Range range;
 };
 
+/**
+  * Expression compiled into a flat postfix program.
+  *
+  * Constant subexpressions are folded into a constant table, operators and
+  * functions become instructions working on a value stack, and conditionals
+  * become jumps. Only variables, aggregates and other leaves that need the
+  * document refer back to their node in the tree. Running the program thus
+  * neither walks the tree nor allocates expression objects.
+  *
+  * The program keeps a reference to the expression it was compiled from, as it
+  * points into its nodes.
+  */
+
+class AppExport CompiledExpression {
+public:
+    CompiledExpression(boost::shared_ptr<const Expression> expr);
+
+    ExpressionValue evaluate() const;
+
+    bool isCompiledFrom(const boost::shared_ptr<const Expression> & expr) const { return source == expr; }
+
+private:
+    enum OpCode {
+        PushConstant,   /**< Push constants[arg] */
+        PushNode,       /**< Push the value of nodes[arg] */
+        ApplyOperator,  /**< Replace the two topmost values by the result of operator arg */
+        ApplyFunction,  /**< Replace the argc topmost values by the result of function arg */
+        JumpIfFalse,    /**< Pop the topmost value and continue at arg if it is false */
+        Jump            /**< Continue at arg */
+    };
+
+    struct Instruction {
+        OpCode code;
+        int arg;
+        int argc;
+    };
+
+    void compile(const Expression * expr);
+    void emit(OpCode code, int arg = 0, int argc = 0);
+    bool isConstant(std::size_t start, std::size_t n) const;
+    void foldConstants(std::size_t start, int startDepth, const ExpressionValue & value);
+
+    boost::shared_ptr<const Expression> source;
+    std::vector<Instruction> program;
+    std::vector<ExpressionValue> constants;
+    std::vector<const Expression*> nodes;
+    int depth;
+    int maxDepth;
+};
+
 namespace ExpressionParser {
 AppExport Expression * parse(const App::DocumentObject *owner, const char *buffer);
 AppExport UnitExpression * parseUnit(const App::DocumentObject *owner, const char *buffer);
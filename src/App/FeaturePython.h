@@ -70,6 +70,8 @@ public:
         // cannot move this to the initializer list to avoid warning
         imp = new FeaturePythonImp(this);
         props = new DynamicProperty(this);
+        // the Python interpreter is not entered from recompute worker threads
+        this->setStatus(App::NoParallelRecompute, true);
     }
     virtual ~FeaturePythonT() {
         delete imp;
@@ -81,6 +81,7 @@ PropertyExpressionEngine::PropertyExpressionEngine()
     , AtomicPropertyChangeInterface()
     , running(false)
     , validator(0)
+    , evaluationOrderValid(false)
 {
 }
 
@@ -123,6 +124,7 @@ void PropertyExpressionEngine::Paste(const Property &from)
 
     AtomicPropertyChange signaller(*this);
     expressions.clear();
+    invalidateEvaluationOrder();
 
     for (ExpressionMap::const_iterator it = fromee->expressions.begin(); it != fromee->expressions.end(); ++it) {
         expressions[it->first] = ExpressionInfo(boost::shared_ptr<Expression>(it->second.expression->copy()), it->second.comment.c_str());
@@ -279,6 +281,8 @@ void PropertyExpressionEngine::slotObjectRenamed(const DocumentObject &obj)
 
     RelabelDocumentObjectExpressionVisitor<PropertyExpressionEngine> v(*this, obj.getOldLabel(), obj.Label.getStrValue());
 
+    invalidateEvaluationOrder();
+
     for (ExpressionMap::iterator it = expressions.begin(); it != expressions.end(); ++it) {
         bool changed = v.getChanged();
 
@@ -364,11 +368,13 @@ void PropertyExpressionEngine::setValue(const ObjectIdentifier & path, boost::sh
 
         AtomicPropertyChange signaller(*this);
         expressions[usePath] = ExpressionInfo(expr, comment);
+        invalidateEvaluationOrder();
         expressionChanged(usePath);
     }
     else {
         AtomicPropertyChange signaller(*this);
         expressions.erase(usePath);
+        invalidateEvaluationOrder();
         expressionChanged(usePath);
     }
 }
@@ -485,8 +491,21 @@ DocumentObjectExecReturn *App::PropertyExpressionEngine::execute()
 
     resetter r(running);
 
-    // Compute evaluation order
-    std::vector<App::ObjectIdentifier> evaluationOrder = computeEvaluationOrder();
+    // Compute evaluation order, unless the expressions are unchanged since last time
+    if (!evaluationOrderValid) {
+        evaluationOrder = computeEvaluationOrder();
+        evaluationOrderValid = true;
+
+        // Drop compiled expressions that are no longer used
+        CompiledExpressionMap::iterator i = compiledExpressions.begin();
+        while (i != compiledExpressions.end()) {
+            if (expressions.find(i->first) == expressions.end())
+                i = compiledExpressions.erase(i);
+            else
+                ++i;
+        }
+    }
+
     std::vector<ObjectIdentifier>::const_iterator it = evaluationOrder.begin();
 
 #ifdef FC_PROPERTYEXPRESSIONENGINE_LOG
@@ -508,13 +527,21 @@ DocumentObjectExecReturn *App::PropertyExpressionEngine::execute()
         if (parent != docObj)
             throw Base::Exception("Invalid property owner.");
 
-        // Evaluate expression
-        std::unique_ptr<Expression> e(expressions[*it].expression->eval());
+        // Evaluate expression, compiling it first if needed
+        const boost::shared_ptr<Expression> & expression = expressions[*it].expression;
+        boost::shared_ptr<CompiledExpression> program = compiledExpressions[*it];
+
+        if (!program || !program->isCompiledFrom(expression)) {
+            program.reset(new CompiledExpression(expression));
+            compiledExpressions[*it] = program;
+        }
+
+        ExpressionValue e(program->evaluate());
 
 #ifdef FC_PROPERTYEXPRESSIONENGINE_LOG
         {
             Base::Quantity q;
-            boost::any value = e->getValueAsAny();
+            boost::any value = e.getValueAsAny();
 
             if (value.type() == typeid(Base::Quantity))
                 q = boost::any_cast<Base::Quantity>(value);
@@ -530,7 +557,7 @@ DocumentObjectExecReturn *App::PropertyExpressionEngine::execute()
 #endif
 
         /* Set value of property */
-        prop->setPathValue(*it, e->getValueAsAny());
+        prop->setPathValue(*it, e.getValueAsAny());
 
         ++it;
     }
@@ -717,6 +744,7 @@ void PropertyExpressionEngine::renameExpressions(const std::map<ObjectIdentifier
 
     aboutToSetValue();
     expressions = newExpressions;
+    invalidateEvaluationOrder();
     for (ExpressionMap::const_iterator i = expressions.begin(); i != expressions.end(); ++i) 
         expressionChanged(i->first);
     
@@ -730,6 +758,7 @@ void PropertyExpressionEngine::renameExpressions(const std::map<ObjectIdentifier
 
 void PropertyExpressionEngine::renameObjectIdentifiers(const std::map<ObjectIdentifier, ObjectIdentifier> &paths)
 {
+    invalidateEvaluationOrder();
     for (ExpressionMap::iterator it = expressions.begin(); it != expressions.end(); ++it) {
         RenameObjectIdentifierExpressionVisitor<PropertyExpressionEngine> v(*this, paths, it->first);
         it->second.expression->visit(v);
@@ -43,6 +43,7 @@ class DocumentObject;
 class DocumentObjectExecReturn;
 class ObjectIdentifier;
 class Expression;
+class CompiledExpression;
 
 
 class AppExport PropertyExpressionEngine : public App::Property, private App::AtomicPropertyChangeInterface<PropertyExpressionEngine>
@@ -136,9 +137,12 @@ private:
     typedef boost::adjacency_list< boost::listS, boost::vecS, boost::directedS > DiGraph;
     typedef std::pair<int, int> Edge;
     typedef boost::unordered_map<const App::ObjectIdentifier, ExpressionInfo> ExpressionMap;
+    typedef boost::unordered_map<const App::ObjectIdentifier, boost::shared_ptr<CompiledExpression> > CompiledExpressionMap;
 
     std::vector<App::ObjectIdentifier> computeEvaluationOrder();
 
+    void invalidateEvaluationOrder() { evaluationOrderValid = false; }
+
     void buildGraphStructures(const App::ObjectIdentifier &path,
                               const boost::shared_ptr<Expression> expression, boost::unordered_map<App::ObjectIdentifier, int> &nodes,
                               boost::unordered_map<int, App::ObjectIdentifier> &revNodes, std::vector<Edge> &edges) const;
@@ -154,6 +158,12 @@ private:
 
     ExpressionMap restoredExpressions; /**< Expressions are read from file to this map first before they are validated and inserted into the actual map */
 
+    std::vector<App::ObjectIdentifier> evaluationOrder; /**< Evaluation order used by execute(), recomputed when evaluationOrderValid is false */
+
+    bool evaluationOrderValid; /**< False if the expressions changed since evaluationOrder was computed */
+
+    CompiledExpressionMap compiledExpressions; /**< Compiled expressions, checked against their source expression before use */
+
     friend class AtomicPropertyChange;
 
 };
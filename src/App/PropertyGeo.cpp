@@ -25,14 +25,19 @@
 
 #ifndef _PreComp_
 #	include <assert.h>
+#	include <memory>
+#	include <set>
 #endif
 
 /// Here the FreeCAD includes sorted by Base,App,Gui......
 
+#include <Base/Console.h>
 #include <Base/Exception.h>
+#include <Base/FileInfo.h>
 #include <Base/Writer.h>
 #include <Base/Reader.h>
 #include <Base/Stream.h>
+#include <Base/TimeInfo.h>
 #include <Base/Rotation.h>
 #include <Base/Quantity.h>
 #include <Base/Tools.h>
@@ -42,8 +47,16 @@
 
 #include "Placement.h"
 #include "PropertyGeo.h"
+#include "PropertyContainer.h"
+#include "DocumentObject.h"
 #include "ObjectIdentifier.h"
 
+#include <QMutex>
+#include <QMutexLocker>
+#include <zipios++/zipios-config.h>
+#include <zipios++/zipfile.h>
+#include <zipios++/zipinputstream.h>
+
 using namespace App;
 using namespace Base;
 using namespace std;
@@ -319,18 +332,20 @@ void PropertyVectorList::SaveDocFile (Base::Writer &writer) const
     Base::OutputStream str(writer.Stream());
     uint32_t uCt = (uint32_t)getSize();
     str << uCt;
+    // a vector is stored as three coordinates, so the list is an array of coordinates
     if (writer.getFileVersion() > 0) {
-        for (std::vector<Base::Vector3d>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-            str << it->x << it->y << it->z;
-        }
+        static_assert(sizeof(Base::Vector3d) == 3 * sizeof(double), "Base::Vector3d must be stored without padding");
+        str.write(reinterpret_cast<const double*>(_lValueList.data()), 3 * _lValueList.size());
     }
     else {
+        std::vector<float> values;
+        values.reserve(3 * _lValueList.size());
         for (std::vector<Base::Vector3d>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-            float x = (float)it->x;
-            float y = (float)it->y;
-            float z = (float)it->z;
-            str << x << y << z;
+            values.push_back((float)it->x);
+            values.push_back((float)it->y);
+            values.push_back((float)it->z);
         }
+        str.write(values.data(), values.size());
     }
 }
 
@@ -341,15 +356,15 @@ void PropertyVectorList::RestoreDocFile(Base::Reader &reader)
     str >> uCt;
     std::vector<Base::Vector3d> values(uCt);
     if (reader.getFileVersion() > 0) {
-        for (std::vector<Base::Vector3d>::iterator it = values.begin(); it != values.end(); ++it) {
-            str >> it->x >> it->y >> it->z;
-        }
+        static_assert(sizeof(Base::Vector3d) == 3 * sizeof(double), "Base::Vector3d must be stored without padding");
+        str.read(reinterpret_cast<double*>(values.data()), 3 * values.size());
     }
     else {
-        float x,y,z;
-        for (std::vector<Base::Vector3d>::iterator it = values.begin(); it != values.end(); ++it) {
-            str >> x >> y >> z;
-            it->Set(x, y, z);
+        std::vector<float> coords(3 * std::size_t(uCt));
+        str.read(coords.data(), coords.size());
+        const float* xyz = coords.data();
+        for (std::vector<Base::Vector3d>::iterator it = values.begin(); it != values.end(); ++it, xyz += 3) {
+            it->Set(xyz[0], xyz[1], xyz[2]);
         }
     }
     setValues(values);
@@ -717,9 +732,8 @@ Property *PropertyPlacementLink::Copy(void) const
 
 void PropertyPlacementLink::Paste(const Property &from)
 {
-    aboutToSetValue();
-    _pcLink = dynamic_cast<const PropertyPlacementLink&>(from)._pcLink;
-    hasSetValue();
+    // keeps the back-link of the linked object up to date
+    PropertyLink::Paste(dynamic_cast<const PropertyPlacementLink&>(from));
 }
 
 // ------------------------------------------------------------
@@ -740,12 +754,210 @@ PropertyGeometry::~PropertyGeometry()
 
 TYPESYSTEM_SOURCE_ABSTRACT(App::PropertyComplexGeoData , App::PropertyGeometry);
 
-PropertyComplexGeoData::PropertyComplexGeoData()
+struct PropertyComplexGeoData::DeferredFile
+{
+    DeferredFile() : version(0), object(0), failed(false) {}
+
+    std::string archive;
+    std::string file;
+    int version;
+    Base::Persistence* object;
+    /// set if the data couldn't be read, the request is kept then
+    bool failed;
+};
+
+namespace {
+/// A project file from which data is read on demand
+struct DeferredArchive
+{
+    DeferredArchive() : count(0), indexed(false) {}
+
+    /// to detect if the file was replaced after opening
+    Base::TimeInfo modified;
+    /// offsets of the local headers of the entries, read from the central directory
+    std::map<std::string, std::streamoff> offsets;
+    /// number of requests for this file
+    int count;
+    bool indexed;
+};
+}
+
+// All properties whose data is still to be read from a project file and the files
+// themselves. As the data may be requested by worker threads, e.g. during a parallel
+// recompute, they are guarded by a mutex which also serializes the reading.
+static std::set<PropertyComplexGeoData*> _DeferredProperties;
+static std::map<std::string, DeferredArchive> _DeferredArchives;
+static QMutex _DeferredMutex(QMutex::Recursive);
+
+PropertyComplexGeoData::PropertyComplexGeoData() : deferred(0)
 {
 
 }
 
 PropertyComplexGeoData::~PropertyComplexGeoData()
 {
+    discardDeferred();
+}
+
+bool PropertyComplexGeoData::isDeferred() const
+{
+    return deferred.load() != 0;
+}
+
+void PropertyComplexGeoData::deferFile(Base::XMLReader &reader, Base::Persistence* object)
+{
+    if (!reader.isDeferredLoading())
+        return;
+    std::string file = reader.removeFile(object);
+    if (file.empty())
+        return;
+
+    discardDeferred();
+    DeferredFile* request = new DeferredFile();
+    request->archive = reader.getFileName();
+    request->file = file;
+    request->version = reader.DocumentSchema;
+    request->object = object;
+
+    QMutexLocker locker(&_DeferredMutex);
+    DeferredArchive& archive = _DeferredArchives[request->archive];
+    if (archive.count++ == 0)
+        archive.modified = Base::FileInfo(request->archive).lastModified();
+    _DeferredProperties.insert(this);
+    deferred.store(request);
+}
+
+void PropertyComplexGeoData::discardDeferred()
+{
+    if (!deferred.load())
+        return;
 
+    QMutexLocker locker(&_DeferredMutex);
+    DeferredFile* request = deferred.exchange(0);
+    if (request) {
+        _DeferredProperties.erase(this);
+        std::map<std::string, DeferredArchive>::iterator it = _DeferredArchives.find(request->archive);
+        if (it != _DeferredArchives.end() && --it->second.count == 0)
+            _DeferredArchives.erase(it);
+        delete request;
+    }
+}
+
+void PropertyComplexGeoData::loadDeferred() const
+{
+    if (!deferred.load())
+        return;
+
+    QMutexLocker locker(&_DeferredMutex);
+    PropertyComplexGeoData* self = const_cast<PropertyComplexGeoData*>(this);
+    DeferredFile* request = self->deferred.load();
+    if (!request || request->failed)
+        return;
+
+    // take the request while reading because restoring the data sets the value again
+    self->deferred.store(0);
+    DeferredArchive& archive = _DeferredArchives[request->archive];
+    Base::FileInfo fi(request->archive);
+    try {
+        if (fi.lastModified() != archive.modified)
+            throw Base::FileException("Project file was changed or removed after opening", fi);
+
+        Base::ifstream file(fi, std::ios::in | std::ios::binary);
+        if (!archive.indexed) {
+            // read the directory once instead of searching each entry from the start
+            zipios::ZipFile zip(file);
+            zipios::ConstEntries entries = zip.entries();
+            for (zipios::ConstEntries::iterator it = entries.begin(); it != entries.end(); ++it) {
+                const zipios::ZipCDirEntry* entry = static_cast<const zipios::ZipCDirEntry*>(it->get());
+                archive.offsets[entry->getName()] = entry->getLocalHeaderOffset();
+            }
+            archive.indexed = true;
+            file.clear();
+        }
+
+        std::map<std::string, std::streamoff>::iterator pos = archive.offsets.find(request->file);
+        if (pos == archive.offsets.end())
+            throw Base::FileException("Missing embedded file in project file", fi);
+        zipios::ZipInputStream zipstream(file, pos->second);
+
+        // The data was already part of the document when it was opened. So, it's
+        // read in silently without notifying the container and without touching it.
+        bool touched = isTouched();
+        PropertyContainer* container = getContainer();
+        self->setContainer(0);
+        try {
+            Base::Reader reader(zipstream, request->file, request->version);
+            request->object->RestoreDocFile(reader);
+        }
+        catch (...) {
+            self->setContainer(container);
+            throw;
+        }
+        self->setContainer(container);
+        if (!touched)
+            self->purgeTouched();
+    }
+    catch (...) {
+        // Keep the request so that the document refuses to save empty data
+        // in place of the data in the project file
+        request->failed = true;
+        self->deferred.store(request);
+        Base::Console().Error("Reading failed from embedded file: %s (%s)\n",
+            request->file.c_str(), request->archive.c_str());
+        PropertyContainer* container = getContainer();
+        if (container && container->isDerivedFrom(DocumentObject::getClassTypeId()))
+            static_cast<DocumentObject*>(container)->setStatus(App::Error, true);
+        return;
+    }
+
+    _DeferredProperties.erase(self);
+    std::map<std::string, DeferredArchive>::iterator it = _DeferredArchives.find(request->archive);
+    if (it != _DeferredArchives.end() && --it->second.count == 0)
+        _DeferredArchives.erase(it);
+    delete request;
+}
+
+void PropertyComplexGeoData::loadDeferredFiles(const std::string& archive)
+{
+    QMutexLocker locker(&_DeferredMutex);
+    std::vector<PropertyComplexGeoData*> props;
+    for (std::set<PropertyComplexGeoData*>::iterator it = _DeferredProperties.begin(); it != _DeferredProperties.end(); ++it) {
+        if ((*it)->deferred.load()->archive == archive)
+            props.push_back(*it);
+    }
+    for (std::vector<PropertyComplexGeoData*>::iterator it = props.begin(); it != props.end(); ++it)
+        (*it)->loadDeferred();
+}
+
+bool PropertyComplexGeoData::hasDeferredData(const PropertyContainer* container)
+{
+    {
+        QMutexLocker locker(&_DeferredMutex);
+        if (_DeferredProperties.empty())
+            return false;
+    }
+    std::vector<Property*> props;
+    container->getPropertyList(props);
+    for (std::vector<Property*>::iterator it = props.begin(); it != props.end(); ++it) {
+        if ((*it)->isDerivedFrom(PropertyComplexGeoData::getClassTypeId()) &&
+            static_cast<PropertyComplexGeoData*>(*it)->isDeferred())
+            return true;
+    }
+    return false;
+}
+
+bool PropertyComplexGeoData::loadDeferredData(const PropertyContainer* container)
+{
+    std::vector<Property*> props;
+    container->getPropertyList(props);
+    bool loaded = true;
+    for (std::vector<Property*>::iterator it = props.begin(); it != props.end(); ++it) {
+        if ((*it)->isDerivedFrom(PropertyComplexGeoData::getClassTypeId())) {
+            PropertyComplexGeoData* prop = static_cast<PropertyComplexGeoData*>(*it);
+            prop->loadDeferred();
+            if (prop->isDeferred())
+                loaded = false;
+        }
+    }
+    return loaded;
 }
@@ -26,6 +26,7 @@
 
 // Std. configurations
 
+#include <atomic>
 #include <Base/Vector3D.h>
 #include <Base/Matrix.h>
 #include <Base/BoundBox.h>
@@ -37,6 +38,7 @@
 
 namespace Base {
 class Writer;
+class XMLReader;
 }
 
 namespace Data {
@@ -360,6 +362,37 @@ public:
     virtual const Data::ComplexGeoData* getComplexData() const = 0;
     virtual Base::BoundBox3d getBoundingBox() const = 0;
     //@}
+
+    /** @name Deferred loading
+     * If a document is opened with deferred loading the geometric data is not
+     * read from the project file in Restore() but on first access.
+     */
+    //@{
+    /// Checks whether the data is still waiting to be read from the project file
+    bool isDeferred() const;
+    /// Reads the pending data from the project file, does nothing otherwise
+    void loadDeferred() const;
+    /// Reads all pending data from the given project file, e.g. before it gets overwritten
+    static void loadDeferredFiles(const std::string& archive);
+    /// Checks whether any property of the container has pending data
+    static bool hasDeferredData(const PropertyContainer*);
+    /** Reads the pending data of all properties of the container.
+     * Returns false if some data couldn't be read. The object is marked invalid then.
+     */
+    static bool loadDeferredData(const PropertyContainer*);
+    //@}
+
+protected:
+    /** Takes the file registered by \a object from the reader if it
+     * defers loading. Must be called at the end of Restore().
+     */
+    void deferFile(Base::XMLReader &reader, Base::Persistence* object);
+    /// Forgets the pending data, e.g. because a new value was set
+    void discardDeferred();
+
+private:
+    struct DeferredFile;
+    std::atomic<DeferredFile*> deferred;
 };
 
 } // namespace App
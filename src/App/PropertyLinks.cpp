@@ -44,7 +44,52 @@ using namespace App;
 using namespace Base;
 using namespace std;
 
+namespace {
+// The owner of a link property is registered at the linked objects while it is
+// part of a document. Objects destroyed together with their document are skipped
+// because the linked objects may already be gone.
+DocumentObject* backLinkOwner(const Property* prop)
+{
+    PropertyContainer* father = prop->getContainer();
+    if (!father || !father->getTypeId().isDerivedFrom(DocumentObject::getClassTypeId()))
+        return 0;
+    DocumentObject* owner = static_cast<DocumentObject*>(father);
+    if (!owner->getNameInDocument() || owner->testStatus(ObjectStatus::Destroy))
+        return 0;
+    return owner;
+}
+
+void updateBackLink(const Property* prop, DocumentObject* oldLink, DocumentObject* newLink)
+{
+    if (oldLink == newLink)
+        return;
+    DocumentObject* owner = backLinkOwner(prop);
+    if (!owner)
+        return;
+    if (oldLink)
+        oldLink->_removeBackLink(owner);
+    if (newLink)
+        newLink->_addBackLink(owner);
+}
 
+void updateBackLinks(const Property* prop, const std::vector<DocumentObject*>& oldLinks,
+                     const std::vector<DocumentObject*>& newLinks)
+{
+    if (oldLinks == newLinks)
+        return;
+    DocumentObject* owner = backLinkOwner(prop);
+    if (!owner)
+        return;
+    for (std::vector<DocumentObject*>::const_iterator it = oldLinks.begin(); it != oldLinks.end(); ++it) {
+        if (*it)
+            (*it)->_removeBackLink(owner);
+    }
+    for (std::vector<DocumentObject*>::const_iterator it = newLinks.begin(); it != newLinks.end(); ++it) {
+        if (*it)
+            (*it)->_addBackLink(owner);
+    }
+}
+}
 
 
 //**************************************************************************
@@ -67,7 +112,8 @@ PropertyLink::PropertyLink()
 
 PropertyLink::~PropertyLink()
 {
-
+    // in case the property is removed dynamically
+    updateBackLink(this, _pcLink, 0);
 }
 
 //**************************************************************************
@@ -76,6 +122,7 @@ PropertyLink::~PropertyLink()
 void PropertyLink::setValue(App::DocumentObject * lValue)
 {
     aboutToSetValue();
+    updateBackLink(this, _pcLink, lValue);
     _pcLink=lValue;
     hasSetValue();
 }
@@ -164,7 +211,9 @@ Property *PropertyLink::Copy(void) const
 void PropertyLink::Paste(const Property &from)
 {
     aboutToSetValue();
-    _pcLink = dynamic_cast<const PropertyLink&>(from)._pcLink;
+    DocumentObject* link = dynamic_cast<const PropertyLink&>(from)._pcLink;
+    updateBackLink(this, _pcLink, link);
+    _pcLink = link;
     hasSetValue();
 }
 
@@ -185,11 +234,15 @@ PropertyLinkList::PropertyLinkList()
 
 PropertyLinkList::~PropertyLinkList()
 {
-
+    updateBackLinks(this, _lValueList, std::vector<DocumentObject*>());
 }
 
 void PropertyLinkList::setSize(int newSize)
 {
+    if (newSize < getSize()) {
+        std::vector<DocumentObject*> values(_lValueList.begin(), _lValueList.begin() + newSize);
+        updateBackLinks(this, _lValueList, values);
+    }
     _lValueList.resize(newSize);
 }
 
@@ -202,6 +255,7 @@ void PropertyLinkList::setValue(DocumentObject* lValue)
 {
     if (lValue){
         aboutToSetValue();
+        updateBackLinks(this, _lValueList, std::vector<DocumentObject*>(1, lValue));
         _lValueList.resize(1);
         _lValueList[0] = lValue;
         hasSetValue();
@@ -211,10 +265,17 @@ void PropertyLinkList::setValue(DocumentObject* lValue)
 void PropertyLinkList::setValues(const std::vector<DocumentObject*>& lValue)
 {
     aboutToSetValue();
+    updateBackLinks(this, _lValueList, lValue);
     _lValueList = lValue;
     hasSetValue();
 }
 
+void PropertyLinkList::set1Value(const int idx, DocumentObject* value)
+{
+    updateBackLink(this, _lValueList.operator[] (idx), value);
+    _lValueList.operator[] (idx) = value;
+}
+
 PyObject *PropertyLinkList::getPyObject(void)
 {
     int count = getSize();
@@ -315,7 +376,9 @@ Property *PropertyLinkList::Copy(void) const
 void PropertyLinkList::Paste(const Property &from)
 {
     aboutToSetValue();
-    _lValueList = dynamic_cast<const PropertyLinkList&>(from)._lValueList;
+    const std::vector<DocumentObject*>& values = dynamic_cast<const PropertyLinkList&>(from)._lValueList;
+    updateBackLinks(this, _lValueList, values);
+    _lValueList = values;
     hasSetValue();
 }
 
@@ -343,7 +406,7 @@ PropertyLinkSub::PropertyLinkSub()
 
 PropertyLinkSub::~PropertyLinkSub()
 {
-
+    updateBackLink(this, _pcLinkSub, 0);
 }
 
 //**************************************************************************
@@ -352,6 +415,7 @@ PropertyLinkSub::~PropertyLinkSub()
 void PropertyLinkSub::setValue(App::DocumentObject * lValue, const std::vector<std::string> &SubList)
 {
     aboutToSetValue();
+    updateBackLink(this, _pcLinkSub, lValue);
     _pcLinkSub=lValue;
     _cSubList = SubList;
     hasSetValue();
@@ -506,7 +570,9 @@ Property *PropertyLinkSub::Copy(void) const
 void PropertyLinkSub::Paste(const Property &from)
 {
     aboutToSetValue();
-    _pcLinkSub = dynamic_cast<const PropertyLinkSub&>(from)._pcLinkSub;
+    DocumentObject* link = dynamic_cast<const PropertyLinkSub&>(from)._pcLinkSub;
+    updateBackLink(this, _pcLinkSub, link);
+    _pcLinkSub = link;
     _cSubList = dynamic_cast<const PropertyLinkSub&>(from)._cSubList;
     hasSetValue();
 }
@@ -528,11 +594,15 @@ PropertyLinkSubList::PropertyLinkSubList()
 
 PropertyLinkSubList::~PropertyLinkSubList()
 {
-
+    updateBackLinks(this, _lValueList, std::vector<DocumentObject*>());
 }
 
 void PropertyLinkSubList::setSize(int newSize)
 {
+    if (newSize < getSize()) {
+        std::vector<DocumentObject*> values(_lValueList.begin(), _lValueList.begin() + newSize);
+        updateBackLinks(this, _lValueList, values);
+    }
     _lValueList.resize(newSize);
     _lSubList  .resize(newSize);
 }
@@ -546,6 +616,7 @@ void PropertyLinkSubList::setValue(DocumentObject* lValue,const char* SubName)
 {
     if (lValue) {
         aboutToSetValue();
+        updateBackLinks(this, _lValueList, std::vector<DocumentObject*>(1, lValue));
         _lValueList.resize(1);
         _lValueList[0]=lValue;
         _lSubList.resize(1);
@@ -554,6 +625,7 @@ void PropertyLinkSubList::setValue(DocumentObject* lValue,const char* SubName)
     }
     else {
         aboutToSetValue();
+        updateBackLinks(this, _lValueList, std::vector<DocumentObject*>());
         _lValueList.clear();
         _lSubList.clear();
         hasSetValue();
@@ -565,6 +637,7 @@ void PropertyLinkSubList::setValues(const std::vector<DocumentObject*>& lValue,c
     if (lValue.size() != lSubNames.size())
         throw Base::Exception("PropertyLinkSubList::setValues: size of subelements list != size of objects list");
     aboutToSetValue();
+    updateBackLinks(this, _lValueList, lValue);
     _lValueList = lValue;
     _lSubList.resize(lSubNames.size());
     int i = 0;
@@ -578,6 +651,7 @@ void PropertyLinkSubList::setValues(const std::vector<DocumentObject*>& lValue,c
     if (lValue.size() != lSubNames.size())
         throw Base::Exception("PropertyLinkSubList::setValues: size of subelements list != size of objects list");
     aboutToSetValue();
+    updateBackLinks(this, _lValueList, lValue);
     _lValueList = lValue;
     _lSubList   = lSubNames;
     hasSetValue();
@@ -587,7 +661,8 @@ void PropertyLinkSubList::setValue(DocumentObject* lValue, const std::vector<str
 {
     aboutToSetValue();
     std::size_t size = SubList.size();
-    this->_lValueList.clear();
+    std::vector<DocumentObject*> oldValues;
+    oldValues.swap(this->_lValueList);
     this->_lSubList.clear();
     if (size == 0) {
         if (lValue) {
@@ -599,6 +674,7 @@ void PropertyLinkSubList::setValue(DocumentObject* lValue, const std::vector<str
         this->_lSubList = SubList;
         this->_lValueList.insert(this->_lValueList.begin(), size, lValue);
     }
+    updateBackLinks(this, oldValues, this->_lValueList);
     hasSetValue();
 }
 
@@ -851,7 +927,9 @@ Property *PropertyLinkSubList::Copy(void) const
 void PropertyLinkSubList::Paste(const Property &from)
 {
     aboutToSetValue();
-    _lValueList = dynamic_cast<const PropertyLinkSubList&>(from)._lValueList;
+    const std::vector<DocumentObject*>& values = dynamic_cast<const PropertyLinkSubList&>(from)._lValueList;
+    updateBackLinks(this, _lValueList, values);
+    _lValueList = values;
     _lSubList   = dynamic_cast<const PropertyLinkSubList&>(from)._lSubList;
     hasSetValue();
 }
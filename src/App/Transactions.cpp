@@ -85,7 +85,20 @@ Transaction::~Transaction()
 
 unsigned int Transaction::getMemSize (void) const
 {
-    return 0;
+    return static_cast<unsigned int>(getDataSize());
+}
+
+std::size_t Transaction::getDataSize (void) const
+{
+    std::size_t size = 0;
+    TransactionList::const_iterator It;
+    for (It = _Objects.begin(); It != _Objects.end(); ++It) {
+        size += It->second->getDataSize();
+        // a removed object is owned by the transaction
+        if (It->second->status == TransactionObject::New && !It->first->isAttachedToDocument())
+            size += It->first->getMemSize();
+    }
+    return size;
 }
 
 void Transaction::Save (Base::Writer &/*writer*/) const
@@ -279,7 +292,19 @@ void TransactionObject::setProperty(const Property* pcProp)
 
 unsigned int TransactionObject::getMemSize (void) const
 {
-    return 0;
+    return static_cast<unsigned int>(getDataSize());
+}
+
+std::size_t TransactionObject::getDataSize (void) const
+{
+    // Note: Heavy property values like meshes or shapes are shared between
+    // a copy and the original until one of them changes. So, this is the
+    // memory the transaction keeps alive once the properties have changed.
+    std::size_t size = 0;
+    std::map<const Property*,Property*>::const_iterator It;
+    for (It = _PropChangeMap.begin(); It != _PropChangeMap.end(); ++It)
+        size += It->second->getMemSize();
+    return size;
 }
 
 void TransactionObject::Save (Base::Writer &/*writer*/) const
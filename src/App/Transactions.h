@@ -58,6 +58,8 @@ public:
     std::string Name;
 
     virtual unsigned int getMemSize (void) const;
+    /// The memory in byte of the stored data, unlike getMemSize() not limited to 4 GB
+    std::size_t getDataSize (void) const;
     virtual void Save (Base::Writer &writer) const;
     /// This method is used to restore properties from an XML document.
     virtual void Restore(Base::XMLReader &reader);
@@ -96,6 +98,8 @@ public:
     void setProperty(const Property* pcProp);
 
     virtual unsigned int getMemSize (void) const;
+    /// The memory in byte of the stored property values
+    std::size_t getDataSize (void) const;
     virtual void Save (Base::Writer &writer) const;
     /// This method is used to restore properties from an XML document.
     virtual void Restore(Base::XMLReader &reader);
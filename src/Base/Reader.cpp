@@ -64,7 +64,7 @@ using namespace std;
 Base::XMLReader::XMLReader(const char* FileName, std::istream& str) 
   : DocumentSchema(0), ProgramVersion(""), FileVersion(0), Level(0),
     CharacterCount(0), ReadType(None), _File(FileName), _valid(false),
-    _verbose(true)
+    _verbose(true), _deferred(false)
 {
 #ifdef _MSC_VER
     str.imbue(std::locale::empty());
@@ -377,6 +377,26 @@ bool Base::XMLReader::isRegistered(Base::Persistence *Object) const
     return false;
 }
 
+std::string Base::XMLReader::removeFile(Base::Persistence *Object)
+{
+    std::string name;
+    for (std::size_t i = FileList.size(); i > 0; i--) {
+        if (FileList[i-1].Object == Object) {
+            name = FileList[i-1].FileName;
+            FileList.erase(FileList.begin() + (i-1));
+            FileNames.erase(FileNames.begin() + (i-1));
+            break;
+        }
+    }
+
+    return name;
+}
+
+std::string Base::XMLReader::getFileName() const
+{
+    return _File.filePath();
+}
+
 void Base::XMLReader::addName(const char*, const char*)
 {
 }
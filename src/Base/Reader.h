@@ -122,6 +122,11 @@ public:
     bool isValid() const { return _valid; }
     bool isVerbose() const { return _verbose; }
     void setVerbose(bool on) { _verbose = on; }
+    /// allow objects to read their files later on instead of readFiles()
+    bool isDeferredLoading() const { return _deferred; }
+    void setDeferredLoading(bool on) { _deferred = on; }
+    /// the name of the file the reader reads from
+    std::string getFileName() const;
 
     /** @name Parser handling */
     //@{
@@ -161,6 +166,8 @@ public:
     /// get all registered file names
     const std::vector<std::string>& getFilenames() const;
     bool isRegistered(Base::Persistence *Object) const;
+    /// remove the read request of a persistent object and return its file name
+    std::string removeFile(Base::Persistence *Object);
     virtual void addName(const char*, const char*);
     virtual const char* getName(const char*) const;
     virtual bool doNameMapping() const;
@@ -245,6 +252,7 @@ protected:
     XERCES_CPP_NAMESPACE_QUALIFIER XMLPScanToken token;
     bool _valid;
     bool _verbose;
+    bool _deferred;
 
     struct FileEntry {
         std::string FileName;
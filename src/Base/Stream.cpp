@@ -32,6 +32,7 @@
 # include <string>
 # include <cstdio>
 # include <cstring>
+# include <algorithm>
 #ifdef __GNUC__
 # include <stdint.h>
 #endif
@@ -44,6 +45,37 @@
 
 using namespace Base;
 
+namespace {
+
+template <typename T>
+void writeArray(std::ostream& out, const T* data, std::size_t count, bool swap)
+{
+    if (!swap) {
+        out.write(reinterpret_cast<const char*>(data), count * sizeof(T));
+        return;
+    }
+
+    // swap a block at a time not to duplicate large arrays
+    const std::size_t blockSize = 4096;
+    std::vector<T> block(std::min(count, blockSize));
+    for (std::size_t i = 0; i < count; i += blockSize) {
+        std::size_t n = std::min(count - i, blockSize);
+        std::copy(data + i, data + i + n, block.begin());
+        SwapEndian<T>(&block[0], n);
+        out.write(reinterpret_cast<const char*>(&block[0]), n * sizeof(T));
+    }
+}
+
+template <typename T>
+void readArray(std::istream& in, T* data, std::size_t count, bool swap)
+{
+    in.read(reinterpret_cast<char*>(data), count * sizeof(T));
+    if (swap)
+        SwapEndian<T>(data, count);
+}
+
+}
+
 Stream::Stream() : _swap(false)
 {
 }
@@ -144,6 +176,54 @@ OutputStream& OutputStream::operator << (double d)
     return *this;
 }
 
+OutputStream& OutputStream::write(const int16_t* s, std::size_t count)
+{
+    writeArray(_out, s, count, _swap);
+    return *this;
+}
+
+OutputStream& OutputStream::write(const uint16_t* us, std::size_t count)
+{
+    writeArray(_out, us, count, _swap);
+    return *this;
+}
+
+OutputStream& OutputStream::write(const int32_t* i, std::size_t count)
+{
+    writeArray(_out, i, count, _swap);
+    return *this;
+}
+
+OutputStream& OutputStream::write(const uint32_t* ui, std::size_t count)
+{
+    writeArray(_out, ui, count, _swap);
+    return *this;
+}
+
+OutputStream& OutputStream::write(const int64_t* l, std::size_t count)
+{
+    writeArray(_out, l, count, _swap);
+    return *this;
+}
+
+OutputStream& OutputStream::write(const uint64_t* ul, std::size_t count)
+{
+    writeArray(_out, ul, count, _swap);
+    return *this;
+}
+
+OutputStream& OutputStream::write(const float* f, std::size_t count)
+{
+    writeArray(_out, f, count, _swap);
+    return *this;
+}
+
+OutputStream& OutputStream::write(const double* d, std::size_t count)
+{
+    writeArray(_out, d, count, _swap);
+    return *this;
+}
+
 InputStream::InputStream(std::istream &rin) : _in(rin)
 {
 }
@@ -226,6 +306,54 @@ InputStream& InputStream::operator >> (double& d)
     return *this;
 }
 
+InputStream& InputStream::read(int16_t* s, std::size_t count)
+{
+    readArray(_in, s, count, _swap);
+    return *this;
+}
+
+InputStream& InputStream::read(uint16_t* us, std::size_t count)
+{
+    readArray(_in, us, count, _swap);
+    return *this;
+}
+
+InputStream& InputStream::read(int32_t* i, std::size_t count)
+{
+    readArray(_in, i, count, _swap);
+    return *this;
+}
+
+InputStream& InputStream::read(uint32_t* ui, std::size_t count)
+{
+    readArray(_in, ui, count, _swap);
+    return *this;
+}
+
+InputStream& InputStream::read(int64_t* l, std::size_t count)
+{
+    readArray(_in, l, count, _swap);
+    return *this;
+}
+
+InputStream& InputStream::read(uint64_t* ul, std::size_t count)
+{
+    readArray(_in, ul, count, _swap);
+    return *this;
+}
+
+InputStream& InputStream::read(float* f, std::size_t count)
+{
+    readArray(_in, f, count, _swap);
+    return *this;
+}
+
+InputStream& InputStream::read(double* d, std::size_t count)
+{
+    readArray(_in, d, count, _swap);
+    return *this;
+}
+
 // ----------------------------------------------------------------------
 
 ByteArrayOStreambuf::ByteArrayOStreambuf(QByteArray& ba) : _buffer(new QBuffer(&ba))
@@ -80,6 +80,21 @@ public:
     OutputStream& operator << (float f);
     OutputStream& operator << (double d);
 
+    /** @name Arrays
+     * Write \a count values at once. If the byte order needn't be swapped
+     * the whole array is passed to the stream with a single write.
+     */
+    //@{
+    OutputStream& write(const int16_t* s, std::size_t count);
+    OutputStream& write(const uint16_t* us, std::size_t count);
+    OutputStream& write(const int32_t* i, std::size_t count);
+    OutputStream& write(const uint32_t* ui, std::size_t count);
+    OutputStream& write(const int64_t* l, std::size_t count);
+    OutputStream& write(const uint64_t* ul, std::size_t count);
+    OutputStream& write(const float* f, std::size_t count);
+    OutputStream& write(const double* d, std::size_t count);
+    //@}
+
 private:
     OutputStream (const OutputStream&);
     void operator = (const OutputStream&);
@@ -110,6 +125,20 @@ public:
     InputStream& operator >> (float& f);
     InputStream& operator >> (double& d);
 
+    /** @name Arrays
+     * Read \a count values at once with a single read from the stream.
+     */
+    //@{
+    InputStream& read(int16_t* s, std::size_t count);
+    InputStream& read(uint16_t* us, std::size_t count);
+    InputStream& read(int32_t* i, std::size_t count);
+    InputStream& read(uint32_t* ui, std::size_t count);
+    InputStream& read(int64_t* l, std::size_t count);
+    InputStream& read(uint64_t* ul, std::size_t count);
+    InputStream& read(float* f, std::size_t count);
+    InputStream& read(double* d, std::size_t count);
+    //@}
+
     operator bool() const
     {
         // test if _Ipfx succeeded
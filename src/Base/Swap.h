@@ -24,6 +24,12 @@
 #ifndef BASE_SWAP_H
 #define BASE_SWAP_H
 
+#include <cstddef>
+#include <cstring>
+#ifdef __GNUC__
+# include <stdint.h>
+#endif
+
 #define LOW_ENDIAN	(unsigned short) 0x4949 
 #define HIGH_ENDIAN	(unsigned short) 0x4D4D 
 
@@ -58,6 +64,45 @@ void SwapEndian(T& v)
   v = tmp;
 }
 
+inline uint16_t SwapBytes(uint16_t v)
+{
+  return static_cast<uint16_t>((v >> 8) | (v << 8));
+}
+
+inline uint32_t SwapBytes(uint32_t v)
+{
+  return (v >> 24) | ((v >> 8) & 0x0000ff00u) |
+         ((v << 8) & 0x00ff0000u) | (v << 24);
+}
+
+inline uint64_t SwapBytes(uint64_t v)
+{
+  return (uint64_t(SwapBytes(uint32_t(v))) << 32) | SwapBytes(uint32_t(v >> 32));
+}
+
+template <std::size_t N> struct SwapWord;
+template <> struct SwapWord<2> { typedef uint16_t type; };
+template <> struct SwapWord<4> { typedef uint32_t type; };
+template <> struct SwapWord<8> { typedef uint64_t type; };
+
+/**
+ * Swaps the byte order of \a count values of type \a T.
+ * The values are swapped as integers of the same size, a loop
+ * the compiler can vectorize.
+ */
+template <class T>
+void SwapEndian(T* data, std::size_t count)
+{
+  typedef typename SwapWord<sizeof(T)>::type word;
+  char* bytes = reinterpret_cast<char*>(data);
+  for (std::size_t i = 0; i < count; i++, bytes += sizeof(T)) {
+    word w;
+    std::memcpy(&w, bytes, sizeof(T));
+    w = SwapBytes(w);
+    std::memcpy(bytes, &w, sizeof(T));
+  }
+}
+
 } // namespace Base
 
 
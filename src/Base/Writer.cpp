@@ -36,8 +36,15 @@
 #include "Tools.h"
 
 #include <algorithm>
+#include <list>
 #include <locale>
 
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QWaitCondition>
+
 using namespace Base;
 using namespace std;
 using namespace zipios;
@@ -239,8 +246,264 @@ void Writer::decInd(void)
 
 // ----------------------------------------------------------------------------
 
+namespace {
+
+/// The size of the blocks an entry is split into for the compression
+const std::size_t ZipBlockSize = 1 << 20;
+/// The number of bytes of the previous block used as dictionary for a block
+const std::size_t ZipDictSize = 1 << 15;
+/** The serialized data of the entries that may wait for their compression before
+ * writeFiles() blocks. An entry itself is always kept completely in memory, so a
+ * single entry larger than this exceeds the limit until it's written.
+ */
+const std::size_t ZipBufferLimit = std::size_t(256) << 20;
+
+/** Appends the written data to a string which can be taken over without a copy.
+ */
+class StringOStreambuf : public std::streambuf
+{
+public:
+    explicit StringOStreambuf(std::string& str) : str(str)
+    {
+    }
+
+protected:
+    virtual int_type overflow(int_type c)
+    {
+        if (c != traits_type::eof())
+            str.push_back(traits_type::to_char_type(c));
+        return traits_type::not_eof(c);
+    }
+    virtual std::streamsize xsputn(const char* s, std::streamsize num)
+    {
+        str.append(s, static_cast<std::size_t>(num));
+        return num;
+    }
+    virtual pos_type seekoff(off_type off, std::ios_base::seekdir way,
+                             std::ios_base::openmode /*which*/)
+    {
+        // only telling the position is supported
+        if (off != 0 || way == std::ios_base::beg)
+            return pos_type(off_type(-1));
+        return pos_type(off_type(str.size()));
+    }
+
+private:
+    std::string& str;
+};
+
+/// Returns true if the data is not text, e.g. arrays of numbers or images
+bool isBinaryData(const std::string& data)
+{
+    std::size_t count = std::min<std::size_t>(data.size(), 4096);
+    std::size_t control = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (c == 0)
+            return true;
+        if (c < 32 && c != '\t' && c != '\n' && c != '\r')
+            control++;
+    }
+    return control * 100 > count;
+}
+
+struct ZipBlock {
+    const char* data;
+    std::size_t size;
+    std::size_t dictSize;
+    bool last;
+    std::string output;
+    uLong crc;
+    bool ok;
+};
+
+/** Compresses a block of an entry into a part of a raw deflate stream. The part of
+ * the last block finishes the stream, the other ones end on a byte boundary, so that
+ * the parts of all blocks can simply be concatenated. The end of the previous block
+ * is used as dictionary to keep the compression ratio close to the one of a single stream.
+ */
+bool deflateBlock(ZipBlock& block, int level)
+{
+    block.crc = crc32(crc32(0, Z_NULL, 0), reinterpret_cast<const Bytef*>(block.data),
+                      static_cast<uInt>(block.size));
+    if (level == Z_NO_COMPRESSION)
+        return true;
+
+    z_stream zs;
+    zs.zalloc = Z_NULL;
+    zs.zfree = Z_NULL;
+    zs.opaque = Z_NULL;
+    // negative window bits: no zlib header as for zip entries
+    if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+    if (block.dictSize > 0) {
+        deflateSetDictionary(&zs, reinterpret_cast<const Bytef*>(block.data - block.dictSize),
+                             static_cast<uInt>(block.dictSize));
+    }
+
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block.data));
+    zs.avail_in = static_cast<uInt>(block.size);
+    int flush = block.last ? Z_FINISH : Z_SYNC_FLUSH;
+    std::size_t used = 0;
+    int err;
+    do {
+        block.output.resize(used + deflateBound(&zs, zs.avail_in) + 64);
+        zs.next_out = reinterpret_cast<Bytef*>(&block.output[used]);
+        zs.avail_out = static_cast<uInt>(block.output.size() - used);
+        err = deflate(&zs, flush);
+        used = block.output.size() - zs.avail_out;
+    }
+    while (err == Z_OK && zs.avail_out == 0);
+    deflateEnd(&zs);
+
+    block.output.resize(used);
+    return err == (block.last ? Z_STREAM_END : Z_OK);
+}
+
+/// An entry of the archive waiting for the compression of its blocks
+struct ZipEntryJob {
+    std::string fileName;
+    std::string data;
+    int level;
+    std::vector<ZipBlock> blocks;
+    int pending;
+};
+
+/** The queue of entries serialized by ZipWriter::writeFiles(). The blocks of the
+ * entries are compressed on the global thread pool, the entries are written to the
+ * archive in the order they were added. The destructor waits for running tasks.
+ */
+class ZipEntryQueue
+{
+public:
+    ZipEntryQueue() : buffered(0)
+    {
+        parallel = QThreadPool::globalInstance()->maxThreadCount() > 1;
+    }
+    ~ZipEntryQueue()
+    {
+        QMutexLocker locker(&mutex);
+        for (std::list<ZipEntryJob>::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+            while (it->pending > 0)
+                done.wait(&mutex);
+        }
+    }
+
+    void add(const std::string& fileName, std::string& data, int level)
+    {
+        jobs.push_back(ZipEntryJob());
+        ZipEntryJob& job = jobs.back();
+        job.fileName = fileName;
+        job.data.swap(data);
+        job.level = level;
+        buffered += job.data.size();
+
+        std::size_t count = std::max<std::size_t>((job.data.size() + ZipBlockSize - 1) / ZipBlockSize, 1);
+        job.blocks.resize(count);
+        for (std::size_t i = 0; i < count; i++) {
+            ZipBlock& block = job.blocks[i];
+            std::size_t offset = i * ZipBlockSize;
+            block.data = job.data.data() + offset;
+            block.size = std::min(ZipBlockSize, job.data.size() - offset);
+            block.dictSize = std::min(ZipDictSize, offset);
+            block.last = (i + 1 == count);
+            block.crc = 0;
+            block.ok = false;
+        }
+
+        job.pending = parallel ? static_cast<int>(count) : 0;
+        for (std::vector<ZipBlock>::iterator it = job.blocks.begin(); it != job.blocks.end(); ++it) {
+            if (parallel)
+                QThreadPool::globalInstance()->start(new Task(*this, job, *it));
+            else
+                it->ok = deflateBlock(*it, level);
+        }
+    }
+
+    /// Writes the finished entries, waits for unfinished ones while at least limit bytes are buffered
+    void write(zipios::ZipOutputStream& zip, std::size_t limit)
+    {
+        QMutexLocker locker(&mutex);
+        while (!jobs.empty()) {
+            if (jobs.front().pending > 0) {
+                if (buffered < limit)
+                    break;
+                done.wait(&mutex);
+                continue;
+            }
+
+            locker.unlock();
+            writeEntry(zip, jobs.front());
+            buffered -= jobs.front().data.size();
+            jobs.pop_front();
+            locker.relock();
+        }
+    }
+
+private:
+    class Task : public QRunnable
+    {
+    public:
+        Task(ZipEntryQueue& queue, ZipEntryJob& job, ZipBlock& block)
+          : queue(queue), job(job), block(block)
+        {
+        }
+        virtual void run()
+        {
+            bool ok = deflateBlock(block, job.level);
+            QMutexLocker locker(&queue.mutex);
+            block.ok = ok;
+            job.pending--;
+            queue.done.wakeAll();
+        }
+
+    private:
+        ZipEntryQueue& queue;
+        ZipEntryJob& job;
+        ZipBlock& block;
+    };
+
+    static void writeEntry(zipios::ZipOutputStream& zip, ZipEntryJob& job)
+    {
+        uLong crc = crc32(0, Z_NULL, 0);
+        bool compressed = (job.level != Z_NO_COMPRESSION);
+        for (std::vector<ZipBlock>::iterator it = job.blocks.begin(); it != job.blocks.end(); ++it) {
+            crc = crc32_combine(crc, it->crc, static_cast<z_off_t>(it->size));
+            if (!it->ok)
+                compressed = false;
+        }
+
+        uint32 size = static_cast<uint32>(job.data.size());
+        if (compressed) {
+            // the parts of the blocks are written one after another behind the header
+            std::size_t compressedSize = 0;
+            for (std::vector<ZipBlock>::iterator it = job.blocks.begin(); it != job.blocks.end(); ++it)
+                compressedSize += it->output.size();
+            zip.putRawEntry(ZipCDirEntry(job.fileName), DEFLATED,
+                            static_cast<uint32>(compressedSize), size, crc);
+            for (std::vector<ZipBlock>::iterator it = job.blocks.begin(); it != job.blocks.end(); ++it) {
+                zip.putRawData(it->output.data(), static_cast<uint32>(it->output.size()));
+                std::string().swap(it->output);
+            }
+        }
+        else {
+            // stored as it is if requested or if the compression failed
+            zip.putRawEntry(ZipCDirEntry(job.fileName), STORED, size, size, crc);
+            zip.putRawData(job.data.data(), size);
+        }
+    }
+
+    std::list<ZipEntryJob> jobs;
+    std::size_t buffered;
+    bool parallel;
+    QMutex mutex;
+    QWaitCondition done;
+};
+
+}
+
 ZipWriter::ZipWriter(const char* FileName) 
-  : ZipStream(FileName)
+  : ZipStream(FileName), EntryStream(0), Level(Z_DEFAULT_COMPRESSION), BinaryLevel(Z_DEFAULT_COMPRESSION)
 {
 #ifdef _MSC_VER
     ZipStream.imbue(std::locale::empty());
@@ -253,7 +516,7 @@ ZipWriter::ZipWriter(const char* FileName)
 }
 
 ZipWriter::ZipWriter(std::ostream& os) 
-  : ZipStream(os)
+  : ZipStream(os), EntryStream(0), Level(Z_DEFAULT_COMPRESSION), BinaryLevel(Z_DEFAULT_COMPRESSION)
 {
 #ifdef _MSC_VER
     ZipStream.imbue(std::locale::empty());
@@ -267,15 +530,42 @@ ZipWriter::ZipWriter(std::ostream& os)
 
 void ZipWriter::writeFiles(void)
 {
-    // use a while loop because it is possible that while
-    // processing the files new ones can be added
-    size_t index = 0;
-    while (index < FileList.size()) {
-        FileEntry entry = FileList.begin()[index];
-        ZipStream.putNextEntry(entry.FileName);
-        entry.Object->SaveDocFile(*this);
-        index++;
+    // The files are serialized by this thread because SaveDocFile() of the
+    // objects may not be called concurrently. Only the compression is done
+    // by the worker threads. The data of an entry is serialized into a string
+    // that is handed over to the queue without copying it.
+    std::string data;
+    StringOStreambuf buf(data);
+    std::ostream buffer(&buf);
+    buffer.copyfmt(ZipStream);
+    ZipEntryQueue queue;
+    EntryStream = &buffer;
+
+    try {
+        // use a while loop because it is possible that while
+        // processing the files new ones can be added
+        size_t index = 0;
+        while (index < FileList.size()) {
+            FileEntry entry = FileList.begin()[index];
+            data.clear();
+            buffer.clear();
+            entry.Object->SaveDocFile(*this);
+            buffer.flush();
+
+            int level = isBinaryData(data) ? BinaryLevel : Level;
+            queue.add(entry.FileName, data, level);
+            queue.write(ZipStream, ZipBufferLimit);
+            index++;
+        }
+
+        queue.write(ZipStream, 0);
+    }
+    catch (...) {
+        EntryStream = 0;
+        throw;
     }
+
+    EntryStream = 0;
 }
 
 ZipWriter::~ZipWriter()
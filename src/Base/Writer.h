@@ -140,6 +140,12 @@ protected:
 /** The ZipWriter class 
  * This is an important helper class implementation for the store and retrieval system
  * of persistent objects in FreeCAD. 
+ *
+ * The files requested with addFile() are serialized one after the other into memory
+ * by writeFiles(). Their compression runs on the global thread pool while the next
+ * files are serialized, and the compressed entries are appended to the archive in the
+ * order they were requested. Files with binary content use their own compression
+ * level, with Z_NO_COMPRESSION they are stored as they are.
  * \see Base::Persistence
  * \author Juergen Riegel
  */
@@ -152,14 +158,20 @@ public:
 
     virtual void writeFiles(void);
 
-    virtual std::ostream &Stream(void){return ZipStream;}
+    virtual std::ostream &Stream(void){return EntryStream ? *EntryStream : ZipStream;}
 
     void setComment(const char* str){ZipStream.setComment(str);}
-    void setLevel(int level){ZipStream.setLevel( level );}
+    /// Set the compression level of all entries
+    void setLevel(int level){ZipStream.setLevel( level ); Level = level; BinaryLevel = level;}
+    /// Set the compression level of files with binary content, call it after setLevel()
+    void setBinaryLevel(int level){BinaryLevel = level;}
     void putNextEntry(const char* str){ZipStream.putNextEntry(str);}
 
 private:
     zipios::ZipOutputStream ZipStream;
+    std::ostream* EntryStream;
+    int Level;
+    int BinaryLevel;
 };
 
 /** The StringWriter class 
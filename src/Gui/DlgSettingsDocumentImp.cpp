@@ -47,6 +47,8 @@ DlgSettingsDocumentImp::DlgSettingsDocumentImp( QWidget* parent )
     prefCountBackupFiles->setMaximum(INT_MAX);
     prefCompression->setMinimum(Z_NO_COMPRESSION);
     prefCompression->setMaximum(Z_BEST_COMPRESSION);
+    prefBinaryCompression->setMinimum(Z_NO_COMPRESSION);
+    prefBinaryCompression->setMaximum(Z_BEST_COMPRESSION);
     connect( prefLicenseType, SIGNAL(currentIndexChanged(int)), this, SLOT(onLicenseTypeChanged(int)) );
 }
 
@@ -63,9 +65,11 @@ void DlgSettingsDocumentImp::saveSettings()
 {
     prefCheckNewDoc->onSave();
     prefCompression->onSave();
+    prefBinaryCompression->onSave();
 
     prefUndoRedo->onSave();
     prefUndoRedoSize->onSave();
+    prefUndoRedoMemory->onSave();
     prefSaveTransaction->onSave();
     prefDiscardTransaction->onSave();
     prefSaveThumbnail->onSave();
@@ -91,9 +95,11 @@ void DlgSettingsDocumentImp::loadSettings()
 {
     prefCheckNewDoc->onRestore();
     prefCompression->onRestore();
+    prefBinaryCompression->onRestore();
 
     prefUndoRedo->onRestore();
     prefUndoRedoSize->onRestore();
+    prefUndoRedoMemory->onRestore();
     prefSaveTransaction->onRestore();
     prefDiscardTransaction->onRestore();
     prefSaveThumbnail->onRestore();
@@ -24,6 +24,7 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <algorithm>
 # include <QAbstractButton>
 # include <qapplication.h>
 # include <qdir.h>
@@ -172,6 +173,9 @@ Document::Document(App::Document* pcDocument,Application * app)
         d->_pcDocument->setUndoMode(1);
         // set the maximum stack size
         d->_pcDocument->setMaxUndoStackSize(App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Document")->GetInt("MaxUndoSize",20));
+        // set the maximum memory of the stack in MB
+        long maxMemory = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Document")->GetInt("MaxUndoMemory",0);
+        d->_pcDocument->setUndoLimit(static_cast<std::size_t>(std::max<long>(0, maxMemory)) * 1024 * 1024);
     }
 }
 
@@ -865,6 +869,7 @@ void Document::slotFinishRestoreDocument(const App::Document& doc)
     std::map<const App::DocumentObject*,ViewProviderDocumentObject*>::iterator it;
     for (it = d->_ViewProviderMap.begin(); it != d->_ViewProviderMap.end(); ++it) {
         it->second->finishRestoring();
+        it->second->checkDeferredData();
     }
 
     // reset modified flag
@@ -36,6 +36,7 @@
 #include <Base/Console.h>
 #include <App/Material.h>
 #include <App/DocumentObject.h>
+#include <App/PropertyGeo.h>
 #include "Application.h"
 #include "Document.h"
 #include "Selection.h"
@@ -53,7 +54,7 @@ using namespace Gui;
 PROPERTY_SOURCE(Gui::ViewProviderDocumentObject, Gui::ViewProvider)
 
 ViewProviderDocumentObject::ViewProviderDocumentObject()
-  : pcObject(0)
+  : pcObject(0), deferredData(false)
 {
     ADD_PROPERTY(DisplayMode,((long)0));
     ADD_PROPERTY(Visibility,(true));
@@ -81,6 +82,24 @@ void ViewProviderDocumentObject::finishRestoring()
 {
 }
 
+void ViewProviderDocumentObject::checkDeferredData()
+{
+    if (!pcObject || !App::PropertyComplexGeoData::hasDeferredData(pcObject))
+        return;
+    deferredData = true;
+    if (Visibility.getValue())
+        loadDeferredData();
+}
+
+void ViewProviderDocumentObject::loadDeferredData()
+{
+    // the data is read in silently, maybe already by someone else in the meantime,
+    // so the representation must be updated here
+    deferredData = false;
+    App::PropertyComplexGeoData::loadDeferredData(pcObject);
+    updateView();
+}
+
 bool ViewProviderDocumentObject::isAttachedToDocument() const
 {
     return (!testStatus(Detach));
@@ -111,6 +130,8 @@ void ViewProviderDocumentObject::onChanged(const App::Property* prop)
         setActiveMode();
     }
     else if (prop == &Visibility) {
+        if (deferredData && Visibility.getValue())
+            loadDeferredData();
         // use this bit to check whether show() or hide() must be called
         if (Visibility.testStatus(App::Property::User2) == false) {
             Visibility.setStatus(App::Property::User2, true);
@@ -86,6 +86,8 @@ public:
     //@{
     virtual void startRestoring();
     virtual void finishRestoring();
+    /// Reads the deferred data of the object now if visible or otherwise once it gets shown
+    void checkDeferredData();
     //@}
 
 protected:
@@ -134,6 +136,10 @@ protected:
     App::DocumentObject *pcObject;
 
 private:
+    void loadDeferredData();
+
+private:
+    bool deferredData;
     std::vector<const char*> aDisplayEnumsArray;
     std::vector<std::string> aDisplayModesArray;
 };
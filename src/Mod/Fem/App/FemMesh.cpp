@@ -25,11 +25,24 @@
 
 #ifndef _PreComp_
 # include <cstdlib>
+# include <cmath>
+# include <algorithm>
 # include <memory>
 # include <Bnd_Box.hxx>
 # include <BRep_Tool.hxx>
+# include <BRepAdaptor_Curve.hxx>
 # include <BRepBndLib.hxx>
+# include <BRepBuilderAPI_Copy.hxx>
 # include <BRepExtrema_DistShapeShape.hxx>
+# include <BRepMesh_IncrementalMesh.hxx>
+# include <GCPnts_TangentialDeflection.hxx>
+# include <Poly_Triangulation.hxx>
+# include <Standard.hxx>
+# include <Standard_Failure.hxx>
+# include <Standard_Version.hxx>
+# include <TopLoc_Location.hxx>
+# include <TopoDS.hxx>
+# include <TopoDS_Edge.hxx>
 # include <TopoDS_Vertex.hxx>
 # include <BRepBuilderAPI_MakeVertex.hxx>
 # include <gp_Pnt.hxx>
@@ -38,6 +51,7 @@
 #include <Base/Writer.h>
 #include <Base/Reader.h>
 #include <Base/Stream.h>
+#include <Base/Swap.h>
 #include <Base/Exception.h>
 #include <Base/FileInfo.h>
 #include <Base/TimeInfo.h>
@@ -61,6 +75,7 @@
 #include <SMDS_MeshGroup.hxx>
 #include <SMESHDS_GroupBase.hxx>
 #include <SMESHDS_Group.hxx>
+#include <SMESHDS_Mesh.hxx>
 #include <SMDS_PolyhedralVolumeOfNodes.hxx>
 #include <SMDS_VolumeTool.hxx>
 #include <StdMeshers_MaxLength.hxx>
@@ -80,6 +95,11 @@
 
 //to simplify parsing input files we use the boost lib
 #include <boost/tokenizer.hpp>
+#include <boost/bind.hpp>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtConcurrentMap>
 
 
 using namespace Fem;
@@ -126,6 +146,7 @@ FemMesh &FemMesh::operator=(const FemMesh& mesh)
 void FemMesh::copyMeshData(const FemMesh& mesh)
 {
     _Mtrx = mesh._Mtrx;
+    nodeIndex.reset();
 
     // See file SMESH_I/SMESH_Gen_i.cxx in the git repo of smesh at https://git.salome-platform.org
 #if 1
@@ -478,6 +499,8 @@ const SMESH_Mesh* FemMesh::getSMesh() const
 
 SMESH_Mesh* FemMesh::getSMesh()
 {
+    // the caller may modify the mesh
+    nodeIndex.reset();
     return myMesh;
 }
 
@@ -539,6 +562,7 @@ void FemMesh::setStandardHypotheses()
 void FemMesh::compute()
 {
     getGenerator()->Compute(*myMesh, myMesh->GetShapeToMesh());
+    nodeIndex.reset();
 }
 
 std::set<long> FemMesh::getSurfaceNodes(long /*ElemId*/, short /*FaceId*/, float /*Angle*/) const
@@ -705,146 +729,468 @@ std::map<int, int> FemMesh::getccxVolumesByFace(const TopoDS_Face &face) const
     return result;
 }
 
-std::set<int> FemMesh::getNodesBySolid(const TopoDS_Solid &solid) const
+// ----------------------------------------------------------------------------
+
+namespace Fem {
+
+/** A regular grid over the nodes of a FemMesh in absolute coordinates.
+ * It is used to get the nodes close to a sub-shape without going through
+ * all nodes of the mesh.
+ */
+class FemMeshNodeIndex
 {
-    std::set<int> result;
+public:
+    FemMeshNodeIndex(const SMESHDS_Mesh* mesh, const Base::Matrix4D& mat);
+
+    std::size_t countNodes() const
+    { return ids.size(); }
+    int getId(std::size_t index) const
+    { return ids[index]; }
+    const Base::Vector3d& getPoint(std::size_t index) const
+    { return points[index]; }
+    /// Appends the indices of all nodes inside the box
+    void findNodes(const Base::BoundBox3d& box, std::vector<std::size_t>& nodes) const;
+
+private:
+    int getCell(double value, double min, double size, int count) const;
+
+    std::vector<int> ids;
+    std::vector<Base::Vector3d> points;
+    Base::BoundBox3d bbox;
+    int countX, countY, countZ;
+    double sizeX, sizeY, sizeZ;
+    std::vector<std::size_t> offsets;
+    std::vector<std::size_t> elements;
+};
 
-    Bnd_Box box;
-    BRepBndLib::Add(solid, box);
-    // limit where the mesh node belongs to the solid:
-    double limit = box.SquareExtent()/10000.0;
-    //double limit = BRep_Tool::Tolerance(solid);   // does not compile --> no matching function for call to 'BRep_Tool::Tolerance(const TopoDS_Solid&)'
-    box.Enlarge(limit);
+}
 
-    // get the current transform of the FemMesh
-    const Base::Matrix4D Mtrx(getTransform());
+FemMeshNodeIndex::FemMeshNodeIndex(const SMESHDS_Mesh* mesh, const Base::Matrix4D& mat)
+  : countX(1), countY(1), countZ(1), sizeX(1.0), sizeY(1.0), sizeZ(1.0)
+{
+    ids.reserve(mesh->NbNodes());
+    points.reserve(mesh->NbNodes());
 
-    SMDS_NodeIteratorPtr aNodeIter = myMesh->GetMeshDS()->nodesIterator();
+    SMDS_NodeIteratorPtr aNodeIter = mesh->nodesIterator();
     while (aNodeIter->more()) {
         const SMDS_MeshNode* aNode = aNodeIter->next();
         Base::Vector3d vec(aNode->X(),aNode->Y(),aNode->Z());
-        // Apply the matrix to hold the BoundBox in absolute space.
-        vec = Mtrx * vec;
-
-        if (!box.IsOut(gp_Pnt(vec.x,vec.y,vec.z))) {
-            // create a vertex
-            BRepBuilderAPI_MakeVertex aBuilder(gp_Pnt(vec.x,vec.y,vec.z));
-            TopoDS_Shape s = aBuilder.Vertex();
-            // measure distance
-            BRepExtrema_DistShapeShape measure(solid,s);
-            measure.Perform();
-            if (!measure.IsDone() || measure.NbSolution() < 1)
-                continue;
-
-            if (measure.Value() < limit)
-                result.insert(aNode->GetID());
+        // Apply the matrix to hold the nodes in absolute space.
+        vec = mat * vec;
+        ids.push_back(aNode->GetID());
+        points.push_back(vec);
+        bbox.Add(vec);
+    }
+
+    if (points.empty())
+        return;
+
+    // choose the grid size to get about eight nodes per cell
+    double diag = std::max(bbox.CalcDiagonalLength(), 1e-9);
+    double lenX = std::max(bbox.LengthX(), 1e-3 * diag);
+    double lenY = std::max(bbox.LengthY(), 1e-3 * diag);
+    double lenZ = std::max(bbox.LengthZ(), 1e-3 * diag);
+    double cells = std::max(1.0, points.size() / 8.0);
+    double side = std::pow(lenX * lenY * lenZ / cells, 1.0 / 3.0);
+    countX = std::min(std::max(static_cast<int>(std::ceil(lenX / side)), 1), 1024);
+    countY = std::min(std::max(static_cast<int>(std::ceil(lenY / side)), 1), 1024);
+    countZ = std::min(std::max(static_cast<int>(std::ceil(lenZ / side)), 1), 1024);
+    sizeX = lenX / countX;
+    sizeY = lenY / countY;
+    sizeZ = lenZ / countZ;
+
+    // sort the nodes into the cells
+    std::vector<std::size_t> cellOfNode(points.size());
+    offsets.assign(std::size_t(countX) * countY * countZ + 1, 0);
+    for (std::size_t i = 0; i < points.size(); i++) {
+        const Base::Vector3d& p = points[i];
+        std::size_t cell = (std::size_t(getCell(p.z, bbox.MinZ, sizeZ, countZ)) * countY +
+                            getCell(p.y, bbox.MinY, sizeY, countY)) * countX +
+                            getCell(p.x, bbox.MinX, sizeX, countX);
+        cellOfNode[i] = cell;
+        offsets[cell + 1]++;
+    }
+    for (std::size_t i = 1; i < offsets.size(); i++)
+        offsets[i] += offsets[i - 1];
+
+    elements.resize(points.size());
+    std::vector<std::size_t> pos(offsets.begin(), offsets.end() - 1);
+    for (std::size_t i = 0; i < points.size(); i++)
+        elements[pos[cellOfNode[i]]++] = i;
+}
+
+int FemMeshNodeIndex::getCell(double value, double min, double size, int count) const
+{
+    int cell = static_cast<int>((value - min) / size);
+    return std::min(std::max(cell, 0), count - 1);
+}
+
+void FemMeshNodeIndex::findNodes(const Base::BoundBox3d& box, std::vector<std::size_t>& nodes) const
+{
+    if (points.empty() || !box.Intersect(bbox))
+        return;
+
+    int minX = getCell(box.MinX, bbox.MinX, sizeX, countX);
+    int maxX = getCell(box.MaxX, bbox.MinX, sizeX, countX);
+    int minY = getCell(box.MinY, bbox.MinY, sizeY, countY);
+    int maxY = getCell(box.MaxY, bbox.MinY, sizeY, countY);
+    int minZ = getCell(box.MinZ, bbox.MinZ, sizeZ, countZ);
+    int maxZ = getCell(box.MaxZ, bbox.MinZ, sizeZ, countZ);
+
+    for (int z = minZ; z <= maxZ; z++) {
+        for (int y = minY; y <= maxY; y++) {
+            for (int x = minX; x <= maxX; x++) {
+                std::size_t cell = (std::size_t(z) * countY + y) * countX + x;
+                for (std::size_t i = offsets[cell]; i < offsets[cell + 1]; i++) {
+                    if (box.IsInBox(points[elements[i]]))
+                        nodes.push_back(elements[i]);
+                }
+            }
         }
     }
-    return result;
 }
 
-std::set<int> FemMesh::getNodesByFace(const TopoDS_Face &face) const
+namespace {
+
+/** The search for the nodes of one sub-shape. The shape is approximated by
+ * triangles or segments to reduce the nodes that need an exact check.
+ */
+struct NodeQuery
 {
+    TopoDS_Shape shape;
+    /// max. distance of a node to the shape
+    double limit;
+    /// max. distance of a node to the approximation
+    double band;
+    Base::BoundBox3d box;
+    bool isVertex;
+    Base::Vector3d vertex;
+    /// three points per triangle
+    std::vector<Base::Vector3d> triangles;
+    /// two points per segment
+    std::vector<Base::Vector3d> segments;
+    std::vector<std::size_t> candidates;
     std::set<int> result;
 
+    NodeQuery() : limit(0.0), band(0.0), isVertex(false)
+    {
+    }
+};
+
+struct NodeCheck
+{
+    NodeQuery* query;
+    std::size_t node;
+    Base::Vector3d point;
+    bool inside;
+};
+
+Base::BoundBox3d getShapeBoundBox(const TopoDS_Shape& shape, double enlarge)
+{
     Bnd_Box box;
-    BRepBndLib::Add(face, box);
-    // limit where the mesh node belongs to the face:
-    double limit = BRep_Tool::Tolerance(face);
-    box.Enlarge(limit);
+    BRepBndLib::Add(shape, box);
+    if (box.IsVoid())
+        return Base::BoundBox3d();
+
+    double xMin, yMin, zMin, xMax, yMax, zMax;
+    box.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+    Base::BoundBox3d bbox(xMin, yMin, zMin, xMax, yMax, zMax);
+    bbox.Enlarge(enlarge);
+    return bbox;
+}
 
-    // get the current transform of the FemMesh
-    const Base::Matrix4D Mtrx(getTransform());
+double distanceToSegment(const Base::Vector3d& p, const Base::Vector3d& a, const Base::Vector3d& b)
+{
+    Base::Vector3d ab = b - a;
+    double len2 = ab.Sqr();
+    double t = len2 > 0.0 ? ((p - a) * ab) / len2 : 0.0;
+    t = std::min(std::max(t, 0.0), 1.0);
+    return (p - (a + ab * t)).Length();
+}
 
-    SMDS_NodeIteratorPtr aNodeIter = myMesh->GetMeshDS()->nodesIterator();
-    while (aNodeIter->more()) {
-        const SMDS_MeshNode* aNode = aNodeIter->next();
-        Base::Vector3d vec(aNode->X(),aNode->Y(),aNode->Z());
-        // Apply the matrix to hold the BoundBox in absolute space.
-        vec = Mtrx * vec;
-
-        if (!box.IsOut(gp_Pnt(vec.x,vec.y,vec.z))) {
-            // create a vertex
-            BRepBuilderAPI_MakeVertex aBuilder(gp_Pnt(vec.x,vec.y,vec.z));
-            TopoDS_Shape s = aBuilder.Vertex();
-            // measure distance
-            BRepExtrema_DistShapeShape measure(face,s);
-            measure.Perform();
-            if (!measure.IsDone() || measure.NbSolution() < 1)
-                continue;
-
-            if (measure.Value() < limit)
-                result.insert(aNode->GetID());
-        }
+double distanceToTriangle(const Base::Vector3d& p, const Base::Vector3d& a,
+                          const Base::Vector3d& b, const Base::Vector3d& c)
+{
+    // See Ericson, Real-Time Collision Detection, closest point on triangle
+    Base::Vector3d ab = b - a;
+    Base::Vector3d ac = c - a;
+    Base::Vector3d ap = p - a;
+    double d1 = ab * ap;
+    double d2 = ac * ap;
+    if (d1 <= 0.0 && d2 <= 0.0)
+        return ap.Length();
+
+    Base::Vector3d bp = p - b;
+    double d3 = ab * bp;
+    double d4 = ac * bp;
+    if (d3 >= 0.0 && d4 <= d3)
+        return bp.Length();
+
+    Base::Vector3d cp = p - c;
+    double d5 = ab * cp;
+    double d6 = ac * cp;
+    if (d6 >= 0.0 && d5 <= d6)
+        return cp.Length();
+
+    double vc = d1 * d4 - d3 * d2;
+    double vb = d5 * d2 - d1 * d6;
+    double va = d3 * d6 - d5 * d4;
+    double sum = va + vb + vc;
+    if (vc <= 0.0 || vb <= 0.0 || va <= 0.0 || sum <= 0.0) {
+        // the closest point lies on an edge (or the triangle is degenerated)
+        return std::min(distanceToSegment(p, a, b),
+               std::min(distanceToSegment(p, b, c), distanceToSegment(p, c, a)));
     }
 
-    return result;
+    double v = vb / sum;
+    double w = vc / sum;
+    return (p - (a + ab * v + ac * w)).Length();
 }
 
-std::set<int> FemMesh::getNodesByEdge(const TopoDS_Edge &edge) const
+// Sets up the query, a face without a tessellation is meshed on a copy so
+// that the shape of the caller is left unchanged
+void prepareQuery(NodeQuery& query, const TopoDS_Shape& shape)
 {
-    std::set<int> result;
+    query.shape = shape;
+    if (shape.IsNull())
+        return;
 
-    Bnd_Box box;
-    BRepBndLib::Add(edge, box);
-    // limit where the mesh node belongs to the edge:
-    double limit = BRep_Tool::Tolerance(edge);
-    box.Enlarge(limit);
+    switch (shape.ShapeType()) {
+    case TopAbs_VERTEX:
+        {
+            const TopoDS_Vertex& vertex = TopoDS::Vertex(shape);
+            gp_Pnt pnt = BRep_Tool::Pnt(vertex);
+            query.isVertex = true;
+            query.limit = BRep_Tool::Tolerance(vertex);
+            query.vertex.Set(pnt.X(), pnt.Y(), pnt.Z());
+            query.box = Base::BoundBox3d(query.vertex, query.limit);
+        }   break;
+    case TopAbs_EDGE:
+        {
+            const TopoDS_Edge& edge = TopoDS::Edge(shape);
+            // limit where the mesh node belongs to the edge:
+            query.limit = BRep_Tool::Tolerance(edge);
+            query.box = getShapeBoundBox(edge, query.limit);
+            if (!query.box.IsValid() || BRep_Tool::Degenerated(edge))
+                break;
 
-    // get the current transform of the FemMesh
-    const Base::Matrix4D Mtrx(getTransform());
+            double deflection = std::max(query.box.CalcDiagonalLength() * 0.001, query.limit);
+            BRepAdaptor_Curve curve(edge);
+            GCPnts_TangentialDeflection discretizer(curve, 0.1, deflection);
+            int count = discretizer.NbPoints();
+            for (int i = 1; i < count; i++) {
+                gp_Pnt p1 = discretizer.Value(i);
+                gp_Pnt p2 = discretizer.Value(i + 1);
+                query.segments.push_back(Base::Vector3d(p1.X(), p1.Y(), p1.Z()));
+                query.segments.push_back(Base::Vector3d(p2.X(), p2.Y(), p2.Z()));
+            }
+            query.band = query.limit + 2.0 * deflection;
+        }   break;
+    case TopAbs_FACE:
+        {
+            const TopoDS_Face& face = TopoDS::Face(shape);
+            // limit where the mesh node belongs to the face:
+            query.limit = BRep_Tool::Tolerance(face);
+            query.box = getShapeBoundBox(face, query.limit);
+            if (!query.box.IsValid())
+                break;
 
-    SMDS_NodeIteratorPtr aNodeIter = myMesh->GetMeshDS()->nodesIterator();
-    while (aNodeIter->more()) {
-        const SMDS_MeshNode* aNode = aNodeIter->next();
-        Base::Vector3d vec(aNode->X(),aNode->Y(),aNode->Z());
-        // Apply the matrix to hold the BoundBox in absolute space.
-        vec = Mtrx * vec;
-
-        if (!box.IsOut(gp_Pnt(vec.x,vec.y,vec.z))) {
-            // create a vertex
-            BRepBuilderAPI_MakeVertex aBuilder(gp_Pnt(vec.x,vec.y,vec.z));
-            TopoDS_Shape s = aBuilder.Vertex();
-            // measure distance
-            BRepExtrema_DistShapeShape measure(edge,s);
-            measure.Perform();
-            if (!measure.IsDone() || measure.NbSolution() < 1)
-                continue;
-
-            if (measure.Value() < limit)
-                result.insert(aNode->GetID());
+            // use an existing tessellation if there is one
+            double deflection = std::max(query.box.CalcDiagonalLength() * 0.001, query.limit);
+            TopLoc_Location loc;
+            Handle(Poly_Triangulation) tria = BRep_Tool::Triangulation(face, loc);
+            if (tria.IsNull()) {
+                BRepBuilderAPI_Copy copy(face);
+                TopoDS_Face meshed = TopoDS::Face(copy.Shape());
+                BRepMesh_IncrementalMesh mesh(meshed, deflection);
+                tria = BRep_Tool::Triangulation(meshed, loc);
+            }
+            if (tria.IsNull())
+                break;
+
+            deflection = std::max(deflection, tria->Deflection());
+            gp_Trsf trsf = loc.Transformation();
+            const TColgp_Array1OfPnt& nodes = tria->Nodes();
+            const Poly_Array1OfTriangle& triangles = tria->Triangles();
+            query.triangles.reserve(3 * triangles.Length());
+            for (int i = triangles.Lower(); i <= triangles.Upper(); i++) {
+                Standard_Integer n[3];
+                triangles(i).Get(n[0], n[1], n[2]);
+                for (int j = 0; j < 3; j++) {
+                    gp_Pnt p = nodes(n[j]).Transformed(trsf);
+                    query.triangles.push_back(Base::Vector3d(p.X(), p.Y(), p.Z()));
+                }
+            }
+            query.band = query.limit + 2.0 * deflection;
+        }   break;
+    case TopAbs_SOLID:
+        {
+            Bnd_Box box;
+            BRepBndLib::Add(shape, box);
+            // limit where the mesh node belongs to the solid:
+            query.limit = box.IsVoid() ? 0.0 : box.SquareExtent()/10000.0;
+            query.box = getShapeBoundBox(shape, query.limit);
+        }   break;
+    default:
+        break;
+    }
+}
+
+// Collects the nodes close to the approximation of the shape
+void collectCandidates(const FemMeshNodeIndex& index, NodeQuery& query)
+{
+    if (!query.box.IsValid())
+        return;
+
+    std::vector<std::size_t> nodes;
+    if (query.isVertex) {
+        // the distance to a vertex is exact
+        double limit = query.limit * query.limit;
+        index.findNodes(query.box, nodes);
+        for (std::vector<std::size_t>::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+            if (Base::DistanceP2(query.vertex, index.getPoint(*it)) <= limit)
+                query.result.insert(index.getId(*it));
+        }
+        return;
+    }
+    else if (!query.triangles.empty()) {
+        for (std::size_t i = 0; i + 2 < query.triangles.size(); i += 3) {
+            const Base::Vector3d& a = query.triangles[i];
+            const Base::Vector3d& b = query.triangles[i+1];
+            const Base::Vector3d& c = query.triangles[i+2];
+            Base::BoundBox3d box;
+            box.Add(a);
+            box.Add(b);
+            box.Add(c);
+            box.Enlarge(query.band);
+
+            nodes.clear();
+            index.findNodes(box, nodes);
+            for (std::vector<std::size_t>::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+                if (distanceToTriangle(index.getPoint(*it), a, b, c) <= query.band)
+                    query.candidates.push_back(*it);
+            }
         }
     }
+    else if (!query.segments.empty()) {
+        for (std::size_t i = 0; i + 1 < query.segments.size(); i += 2) {
+            const Base::Vector3d& a = query.segments[i];
+            const Base::Vector3d& b = query.segments[i+1];
+            Base::BoundBox3d box;
+            box.Add(a);
+            box.Add(b);
+            box.Enlarge(query.band);
+
+            nodes.clear();
+            index.findNodes(box, nodes);
+            for (std::vector<std::size_t>::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+                if (distanceToSegment(index.getPoint(*it), a, b) <= query.band)
+                    query.candidates.push_back(*it);
+            }
+        }
+    }
+    else {
+        index.findNodes(query.box, query.candidates);
+    }
 
-    return result;
+    std::sort(query.candidates.begin(), query.candidates.end());
+    query.candidates.erase(std::unique(query.candidates.begin(), query.candidates.end()),
+                           query.candidates.end());
 }
 
-std::set<int> FemMesh::getNodesByVertex(const TopoDS_Vertex &vertex) const
+// Measures the exact distance of a candidate to the shape
+void checkNode(NodeCheck& check)
 {
-    std::set<int> result;
-
-    double limit = BRep_Tool::Tolerance(vertex);
-    limit *= limit; // use square to improve speed
-    gp_Pnt pnt = BRep_Tool::Pnt(vertex);
-    Base::Vector3d node(pnt.X(), pnt.Y(), pnt.Z());
+    check.inside = false;
+    try {
+        // create a vertex
+        BRepBuilderAPI_MakeVertex aBuilder(gp_Pnt(check.point.x,check.point.y,check.point.z));
+        TopoDS_Shape s = aBuilder.Vertex();
+        // measure distance
+        BRepExtrema_DistShapeShape measure(check.query->shape,s);
+        measure.Perform();
+        if (!measure.IsDone() || measure.NbSolution() < 1)
+            return;
+
+        check.inside = (measure.Value() < check.query->limit);
+    }
+    catch (Standard_Failure&) {
+    }
+}
 
-    // get the current transform of the FemMesh
-    const Base::Matrix4D Mtrx(getTransform());
+}
 
-    SMDS_NodeIteratorPtr aNodeIter = myMesh->GetMeshDS()->nodesIterator();
-    while (aNodeIter->more()) {
-        const SMDS_MeshNode* aNode = aNodeIter->next();
-        Base::Vector3d vec(aNode->X(),aNode->Y(),aNode->Z());
-        vec = Mtrx * vec;
+const FemMeshNodeIndex& FemMesh::getNodeIndex() const
+{
+    // the index is dropped by all methods that may modify the mesh, several
+    // objects of a parallel recompute may ask for it at the same time
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+    if (!nodeIndex)
+        nodeIndex.reset(new FemMeshNodeIndex(myMesh->GetMeshDS(), getTransform()));
+    return *nodeIndex;
+}
 
-        if (Base::DistanceP2(node, vec) <= limit) {
-            result.insert(aNode->GetID());
+std::vector<std::set<int> > FemMesh::getNodesByShapes(const std::vector<TopoDS_Shape>& shapes) const
+{
+    const FemMeshNodeIndex& index = getNodeIndex();
+
+    std::vector<NodeQuery> queries(shapes.size());
+    for (std::size_t i = 0; i < shapes.size(); i++)
+        prepareQuery(queries[i], shapes[i]);
+
+    // find the candidates of all shapes in parallel
+    QtConcurrent::blockingMap(queries, boost::bind(&collectCandidates, boost::cref(index), _1));
+
+    // then run the exact checks of all candidates in parallel
+    std::vector<NodeCheck> checks;
+    for (std::vector<NodeQuery>::iterator it = queries.begin(); it != queries.end(); ++it) {
+        for (std::vector<std::size_t>::iterator jt = it->candidates.begin(); jt != it->candidates.end(); ++jt) {
+            NodeCheck check;
+            check.query = &(*it);
+            check.node = *jt;
+            check.point = index.getPoint(*jt);
+            check.inside = false;
+            checks.push_back(check);
         }
     }
 
+#if OCC_VERSION_HEX < 0x070000
+    Standard::SetReentrant(Standard_True);
+#endif
+    QtConcurrent::blockingMap(checks, &checkNode);
+
+    std::vector<std::set<int> > result(queries.size());
+    for (std::vector<NodeCheck>::iterator it = checks.begin(); it != checks.end(); ++it) {
+        if (it->inside)
+            it->query->result.insert(index.getId(it->node));
+    }
+    for (std::size_t i = 0; i < queries.size(); i++)
+        result[i].swap(queries[i].result);
+
     return result;
 }
 
+std::set<int> FemMesh::getNodesBySolid(const TopoDS_Solid &solid) const
+{
+    return getNodesByShapes(std::vector<TopoDS_Shape>(1, solid)).front();
+}
+
+std::set<int> FemMesh::getNodesByFace(const TopoDS_Face &face) const
+{
+    return getNodesByShapes(std::vector<TopoDS_Shape>(1, face)).front();
+}
+
+std::set<int> FemMesh::getNodesByEdge(const TopoDS_Edge &edge) const
+{
+    return getNodesByShapes(std::vector<TopoDS_Shape>(1, edge)).front();
+}
+
+std::set<int> FemMesh::getNodesByVertex(const TopoDS_Vertex &vertex) const
+{
+    return getNodesByShapes(std::vector<TopoDS_Shape>(1, vertex)).front();
+}
+
 std::list<int> FemMesh::getElementNodes(int id) const
 {
     std::list<int> result;
@@ -862,6 +1208,7 @@ void FemMesh::readNastran(const std::string &Filename)
     Base::Console().Log("Start: FemMesh::readNastran() =================================\n");
 
     _Mtrx = Base::Matrix4D();
+    nodeIndex.reset();
 
     std::ifstream inputfile;
     inputfile.open(Filename.c_str());
@@ -1035,6 +1382,7 @@ void FemMesh::read(const char *FileName)
 {
     Base::FileInfo File(FileName);
     _Mtrx = Base::Matrix4D();
+    nodeIndex.reset();
 
     // checking on the file
     if (!File.isReadable())
@@ -1376,7 +1724,7 @@ void FemMesh::Save (Base::Writer &writer) const
     if (!writer.isForceXML()) {
         //See SaveDocFile(), RestoreDocFile()
         writer.Stream() << writer.ind() << "<FemMesh file=\"" ;
-        writer.Stream() << writer.addFile("FemMesh.unv", this) << "\"";
+        writer.Stream() << writer.addFile("FemMesh.bin", this) << "\"";
         writer.Stream() << " a11=\"" <<  _Mtrx[0][0] << "\" a12=\"" <<  _Mtrx[0][1] << "\" a13=\"" <<  _Mtrx[0][2] << "\" a14=\"" <<  _Mtrx[0][3] << "\"";
         writer.Stream() << " a21=\"" <<  _Mtrx[1][0] << "\" a22=\"" <<  _Mtrx[1][1] << "\" a23=\"" <<  _Mtrx[1][2] << "\" a24=\"" <<  _Mtrx[1][3] << "\"";
         writer.Stream() << " a31=\"" <<  _Mtrx[2][0] << "\" a32=\"" <<  _Mtrx[2][1] << "\" a33=\"" <<  _Mtrx[2][2] << "\" a34=\"" <<  _Mtrx[2][3] << "\"";
@@ -1427,24 +1775,18 @@ void FemMesh::Restore(Base::XMLReader &reader)
 
 void FemMesh::SaveDocFile (Base::Writer &writer) const
 {
-    // create a temporary file and copy the content to the zip stream
-    Base::FileInfo fi(App::Application::getTempFileName().c_str());
-
-    myMesh->ExportUNV(fi.filePath().c_str());
-
-    Base::ifstream file(fi, std::ios::in | std::ios::binary);
-    if (file){
-        std::streambuf* buf = file.rdbuf();
-        writer.Stream() << buf;
-    }
-
-    file.close();
-    // remove temp file
-    fi.deleteFile();
+    writeBinary(writer.Stream());
 }
 
 void FemMesh::RestoreDocFile(Base::Reader &reader)
 {
+    // older documents contain the mesh as UNV file
+    Base::FileInfo name(reader.getFileName());
+    if (!name.hasExtension("unv")) {
+        readBinary(reader);
+        return;
+    }
+
     // create a temporary file and copy the content from the zip stream
     Base::FileInfo fi(App::Application::getTempFileName().c_str());
 
@@ -1456,11 +1798,272 @@ void FemMesh::RestoreDocFile(Base::Reader &reader)
 
     // read the shape from the temp file
     myMesh->UNVToMesh(fi.filePath().c_str());
+    nodeIndex.reset();
 
     // delete the temp file
     fi.deleteFile();
 }
 
+// ----------------------------------------------------------------------------
+
+namespace {
+
+// Magic number and version of the binary format of SaveDocFile()
+const uint32_t FemMeshMagic = 0x46454D42;
+const uint32_t FemMeshVersion = 1;
+
+// Element flags of the binary format
+enum ElementFlags {
+    ElemPoly      = 1,
+    ElemPolyhedra = 2,
+    ElemBall      = 4
+};
+
+template <typename T>
+void writeArray(Base::OutputStream& str, const std::vector<T>& data)
+{
+    str << static_cast<uint32_t>(data.size());
+    str.write(data.data(), data.size());
+}
+
+template <typename T>
+void readArray(Base::InputStream& str, std::vector<T>& data)
+{
+    uint32_t count = 0;
+    str >> count;
+    if (!str)
+        throw Base::FileException("Unexpected end of FEM mesh data");
+    data.resize(count);
+    str.read(data.data(), data.size());
+    if (!str)
+        throw Base::FileException("Unexpected end of FEM mesh data");
+}
+
+void writeString(Base::OutputStream& str, const std::string& text)
+{
+    std::vector<uint8_t> chars(text.begin(), text.end());
+    str << static_cast<uint32_t>(chars.size());
+    for (std::vector<uint8_t>::iterator it = chars.begin(); it != chars.end(); ++it)
+        str << *it;
+}
+
+std::string readString(Base::InputStream& str)
+{
+    uint32_t length = 0;
+    str >> length;
+    std::string text;
+    text.reserve(length);
+    for (uint32_t i = 0; i < length && str; i++) {
+        uint8_t ch = 0;
+        str >> ch;
+        text.push_back(static_cast<char>(ch));
+    }
+    if (!str)
+        throw Base::FileException("Unexpected end of FEM mesh data");
+    return text;
+}
+
+}
+
+void FemMesh::writeBinary(std::ostream& out) const
+{
+    const SMESHDS_Mesh* meshDS = myMesh->GetMeshDS();
+    Base::OutputStream str(out);
+
+    str << FemMeshMagic;
+    str << FemMeshVersion;
+
+    // nodes
+    std::vector<int32_t> nodeIds;
+    std::vector<double> nodePoints;
+    nodeIds.reserve(meshDS->NbNodes());
+    nodePoints.reserve(3 * meshDS->NbNodes());
+    SMDS_NodeIteratorPtr aNodeIter = meshDS->nodesIterator();
+    while (aNodeIter->more()) {
+        const SMDS_MeshNode* aNode = aNodeIter->next();
+        nodeIds.push_back(aNode->GetID());
+        nodePoints.push_back(aNode->X());
+        nodePoints.push_back(aNode->Y());
+        nodePoints.push_back(aNode->Z());
+    }
+    writeArray(str, nodeIds);
+    writeArray(str, nodePoints);
+
+    // elements: id, type and flags, the number of nodes and the nodes of each element
+    std::vector<int32_t> elemInfo, elemSizes, elemNodes, quantities;
+    std::vector<double> diameters;
+    SMDS_ElemIteratorPtr aElemIter = meshDS->elementsIterator();
+    while (aElemIter->more()) {
+        const SMDS_MeshElement* elem = aElemIter->next();
+        if (elem->GetType() == SMDSAbs_Node)
+            continue;
+
+        int32_t flags = elem->IsPoly() ? ElemPoly : 0;
+        if (elem->GetEntityType() == SMDSEntity_Polyhedra) {
+            flags |= ElemPolyhedra;
+            const std::vector<int>& quant = static_cast<const SMDS_VtkVolume*>(elem)->GetQuantities();
+            quantities.push_back(static_cast<int32_t>(quant.size()));
+            quantities.insert(quantities.end(), quant.begin(), quant.end());
+        }
+        else if (elem->GetEntityType() == SMDSEntity_Ball) {
+            flags |= ElemBall;
+            diameters.push_back(static_cast<const SMDS_BallElement*>(elem)->GetDiameter());
+        }
+
+        elemInfo.push_back(elem->GetID());
+        elemInfo.push_back(static_cast<int32_t>(elem->GetType()));
+        elemInfo.push_back(flags);
+        elemSizes.push_back(elem->NbNodes());
+        SMDS_ElemIteratorPtr nIt = elem->nodesIterator();
+        while (nIt->more())
+            elemNodes.push_back(nIt->next()->GetID());
+    }
+    writeArray(str, elemInfo);
+    writeArray(str, elemSizes);
+    writeArray(str, elemNodes);
+    writeArray(str, quantities);
+    writeArray(str, diameters);
+
+    // groups
+    std::vector<SMESH_Group*> groups;
+    SMESH_Mesh::GroupIteratorPtr gIt = myMesh->GetGroups();
+    while (gIt->more())
+        groups.push_back(gIt->next());
+
+    str << static_cast<uint32_t>(groups.size());
+    for (std::vector<SMESH_Group*>::iterator it = groups.begin(); it != groups.end(); ++it) {
+        const SMESHDS_GroupBase* groupDS = (*it)->GetGroupDS();
+        // Groups on geometry or on a filter are stored with their current elements,
+        // they are restored as standalone groups
+        if (!dynamic_cast<const SMESHDS_Group*>(groupDS)) {
+            Base::Console().Log("FEM mesh group '%s' is saved as standalone group\n", (*it)->GetName());
+        }
+        writeString(str, (*it)->GetName());
+        str << static_cast<int32_t>(groupDS->GetType());
+
+        std::vector<int32_t> ids;
+        SMDS_ElemIteratorPtr eIt = groupDS->GetElements();
+        while (eIt->more())
+            ids.push_back(eIt->next()->GetID());
+        writeArray(str, ids);
+    }
+}
+
+void FemMesh::readBinary(std::istream& in)
+{
+    Base::InputStream str(in);
+    uint32_t magic = 0;
+    str >> magic;
+    if (!str)
+        throw Base::FileException("Unexpected end of FEM mesh data");
+    if (magic != FemMeshMagic) {
+        // written on a machine with the other byte order
+        Base::SwapEndian(magic);
+        if (magic != FemMeshMagic)
+            throw Base::FileException("Unknown FEM mesh format");
+        str.setByteOrder(str.byteOrder() == Base::Stream::BigEndian
+            ? Base::Stream::LittleEndian : Base::Stream::BigEndian);
+    }
+    uint32_t version = 0;
+    str >> version;
+    if (version > FemMeshVersion)
+        throw Base::FileException("Unsupported version of the FEM mesh format");
+
+    std::vector<int32_t> nodeIds;
+    std::vector<double> nodePoints;
+    readArray(str, nodeIds);
+    readArray(str, nodePoints);
+    if (nodePoints.size() != 3 * nodeIds.size())
+        throw Base::FileException("Invalid FEM mesh data");
+
+    std::vector<int32_t> elemInfo, elemSizes, elemNodes, quantities;
+    std::vector<double> diameters;
+    readArray(str, elemInfo);
+    readArray(str, elemSizes);
+    readArray(str, elemNodes);
+    readArray(str, quantities);
+    readArray(str, diameters);
+    if (elemInfo.size() != 3 * elemSizes.size())
+        throw Base::FileException("Invalid FEM mesh data");
+
+    SMESHDS_Mesh* meshDS = myMesh->GetMeshDS();
+    SMESH_MeshEditor editor(myMesh);
+
+    for (std::size_t i = 0; i < nodeIds.size(); i++)
+        meshDS->AddNodeWithID(nodePoints[3*i], nodePoints[3*i+1], nodePoints[3*i+2], nodeIds[i]);
+
+    std::size_t nodePos = 0, quantPos = 0, ballPos = 0;
+    std::vector<const SMDS_MeshNode*> nodes;
+    for (std::size_t i = 0; i < elemSizes.size(); i++) {
+        int ID = elemInfo[3*i];
+        SMDSAbs_ElementType type = static_cast<SMDSAbs_ElementType>(elemInfo[3*i+1]);
+        int flags = elemInfo[3*i+2];
+
+        std::size_t count = static_cast<std::size_t>(elemSizes[i]);
+        if (nodePos + count > elemNodes.size())
+            throw Base::FileException("Invalid FEM mesh data");
+        nodes.resize(count);
+        for (std::size_t j = 0; j < count; j++) {
+            nodes[j] = meshDS->FindNode(elemNodes[nodePos++]);
+            if (!nodes[j])
+                throw Base::FileException("Invalid FEM mesh data");
+        }
+
+        if (flags & ElemPolyhedra) {
+            if (quantPos >= quantities.size() ||
+                quantPos + 1 + quantities[quantPos] > quantities.size())
+                throw Base::FileException("Invalid FEM mesh data");
+            std::vector<int> quant(quantities.begin() + quantPos + 1,
+                                   quantities.begin() + quantPos + 1 + quantities[quantPos]);
+            quantPos += 1 + quant.size();
+            meshDS->AddPolyhedralVolumeWithID(nodes, quant, ID);
+        }
+        else if (flags & ElemBall) {
+            if (ballPos >= diameters.size())
+                throw Base::FileException("Invalid FEM mesh data");
+            SMESH_MeshEditor::ElemFeatures elemFeat;
+            elemFeat.Init(diameters[ballPos++]);
+            elemFeat.SetID(ID);
+            editor.AddElement(nodes, elemFeat);
+        }
+        else {
+            SMESH_MeshEditor::ElemFeatures elemFeat(type, (flags & ElemPoly) != 0);
+            elemFeat.SetID(ID);
+            editor.AddElement(nodes, elemFeat);
+        }
+    }
+
+    uint32_t groupCount = 0;
+    str >> groupCount;
+    for (uint32_t i = 0; i < groupCount; i++) {
+        std::string name = readString(str);
+        int32_t groupType = 0;
+        str >> groupType;
+        std::vector<int32_t> ids;
+        readArray(str, ids);
+
+        int aId;
+        SMESH_Group* newGroupObj = myMesh->AddGroup(static_cast<SMDSAbs_ElementType>(groupType), name.c_str(), aId);
+        SMESHDS_Group* newGroupDS = dynamic_cast<SMESHDS_Group*>(newGroupObj->GetGroupDS());
+        if (!newGroupDS) {
+            Base::Console().Warning("Elements of FEM mesh group '%s' cannot be restored\n", name.c_str());
+            continue;
+        }
+
+        SMDS_MeshGroup& smdsGroup = newGroupDS->SMDSGroup();
+        for (std::vector<int32_t>::iterator it = ids.begin(); it != ids.end(); ++it) {
+            const SMDS_MeshElement* elem = (groupType == SMDSAbs_Node)
+                ? static_cast<const SMDS_MeshElement*>(meshDS->FindNode(*it))
+                : meshDS->FindElement(*it);
+            if (elem)
+                smdsGroup.Add(elem);
+        }
+    }
+
+    meshDS->Modified();
+    nodeIndex.reset();
+}
+
 void FemMesh::transformGeometry(const Base::Matrix4D& rclTrf)
 {
     //We perform a translation and rotation of the current active Mesh object
@@ -1473,12 +2076,14 @@ void FemMesh::transformGeometry(const Base::Matrix4D& rclTrf)
         current_node = clMatrix * current_node;
         myMesh->GetMeshDS()->MoveNode(aNode,current_node.x,current_node.y,current_node.z);
     }
+    nodeIndex.reset();
 }
 
 void FemMesh::setTransform(const Base::Matrix4D& rclTrf)
 {
     // Placement handling, no geometric transformation
     _Mtrx = rclTrf;
+    nodeIndex.reset();
 }
 
 Base::Matrix4D FemMesh::getTransform(void) const
@@ -30,6 +30,7 @@
 
 #include <vector>
 #include <list>
+#include <set>
 #include <boost/shared_ptr.hpp>
 
 class SMESH_Gen;
@@ -44,6 +45,8 @@ class TopoDS_Solid;
 namespace Fem
 {
 
+class FemMeshNodeIndex;
+
 typedef boost::shared_ptr<SMESH_Hypothesis> SMESH_HypothesisPtr;
 
 /** The representation of a FemMesh
@@ -96,6 +99,11 @@ public:
     std::set<int> getNodesByEdge(const TopoDS_Edge &edge) const;
     /// retrieving by vertex
     std::set<int> getNodesByVertex(const TopoDS_Vertex &vertex) const;
+    /** retrieving by several vertices, edges, faces or solids at once
+     * The shapes are approximated by their tessellation so that only the nodes close
+     * to it are checked exactly. The checks of all shapes run in parallel.
+     */
+    std::vector<std::set<int> > getNodesByShapes(const std::vector<TopoDS_Shape>& shapes) const;
     /// retrieving node IDs by element ID
     std::list<int> getElementNodes(int id) const;
     /// retrieving face IDs number by face
@@ -149,6 +157,10 @@ public:
 private:
     void copyMeshData(const FemMesh&);
     void readNastran(const std::string &Filename);
+    const FemMeshNodeIndex& getNodeIndex() const;
+    /// compact binary format of the nodes, elements and groups used by SaveDocFile()
+    void writeBinary(std::ostream&) const;
+    void readBinary(std::istream&);
 
 private:
     /// positioning matrix
@@ -156,6 +168,8 @@ private:
     SMESH_Mesh *myMesh;
 
     std::list<SMESH_HypothesisPtr> hypoth;
+    /// spatial index of the nodes, built on demand
+    mutable boost::shared_ptr<FemMeshNodeIndex> nodeIndex;
 };
 
 } //namespace Part
@@ -56,6 +56,7 @@ void PropertyFemMesh::setValuePtr(FemMesh* mesh)
     // before calling hasSetValue()
     Base::Reference<FemMesh> tmp(_FemMesh);
     aboutToSetValue();
+    discardDeferred();
     _FemMesh = mesh;
     hasSetValue();
 }
@@ -63,34 +64,45 @@ void PropertyFemMesh::setValuePtr(FemMesh* mesh)
 void PropertyFemMesh::setValue(const FemMesh& sh)
 {
     aboutToSetValue();
+    discardDeferred();
     *_FemMesh = sh;
     hasSetValue();
 }
 
 const FemMesh &PropertyFemMesh::getValue(void)const
 {
+    loadDeferred();
     return *_FemMesh;
 }
 
 const Data::ComplexGeoData* PropertyFemMesh::getComplexData() const
 {
+    loadDeferred();
     return (FemMesh*)_FemMesh;
 }
 
 Base::BoundBox3d PropertyFemMesh::getBoundingBox() const
 {
+    loadDeferred();
     return _FemMesh->getBoundBox();
 }
 
 void PropertyFemMesh::transformGeometry(const Base::Matrix4D &rclMat)
 {
+    loadDeferred();
     aboutToSetValue();
     _FemMesh->transformGeometry(rclMat);
     hasSetValue();
 }
 
+void PropertyFemMesh::setTransform(const Base::Matrix4D &rclTrf)
+{
+    _FemMesh->setTransform(rclTrf);
+}
+
 PyObject *PropertyFemMesh::getPyObject(void)
 {
+    loadDeferred();
     FemMeshPy* mesh = new FemMeshPy(&*_FemMesh);
     mesh->setConst();
     return mesh;
@@ -115,6 +127,7 @@ void PropertyFemMesh::setPyObject(PyObject *value)
 
 App::Property *PropertyFemMesh::Copy(void) const
 {
+    loadDeferred();
     PropertyFemMesh *prop = new PropertyFemMesh();
     prop->_FemMesh = this->_FemMesh;
     return prop;
@@ -123,6 +136,7 @@ App::Property *PropertyFemMesh::Copy(void) const
 void PropertyFemMesh::Paste(const App::Property &from)
 {
     aboutToSetValue();
+    discardDeferred();
     _FemMesh = dynamic_cast<const PropertyFemMesh&>(from)._FemMesh;
     hasSetValue();
 }
@@ -134,16 +148,20 @@ unsigned int PropertyFemMesh::getMemSize (void) const
 
 void PropertyFemMesh::Save (Base::Writer &writer) const
 {
+    loadDeferred();
     _FemMesh->Save(writer);
 }
 
 void PropertyFemMesh::Restore(Base::XMLReader &reader)
 {
     _FemMesh->Restore(reader);
+    // the mesh registers its file itself
+    deferFile(reader, (FemMesh*)_FemMesh);
 }
 
 void PropertyFemMesh::SaveDocFile (Base::Writer &writer) const
 {
+    loadDeferred();
     _FemMesh->SaveDocFile(writer);
 }
 
@@ -61,6 +61,8 @@ public:
     /** Returns the bounding box around the underlying mesh kernel */
     Base::BoundBox3d getBoundingBox() const;
     void transformGeometry(const Base::Matrix4D &rclMat);
+    /// Set the placement of the mesh without notifying a change
+    void setTransform(const Base::Matrix4D &rclTrf);
     //@}
 
     /** @name Python interface */
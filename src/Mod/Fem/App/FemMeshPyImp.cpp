@@ -880,6 +880,46 @@ PyObject* FemMeshPy::getNodesByVertex(PyObject *args)
     }
 }
 
+PyObject* FemMeshPy::getNodesByShapes(PyObject *args)
+{
+    PyObject *pW;
+    if (!PyArg_ParseTuple(args, "O", &pW))
+         return 0;
+
+    try {
+        std::vector<TopoDS_Shape> shapes;
+        Py::Sequence list(pW);
+        for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it) {
+            PyObject* item = (*it).ptr();
+            if (!PyObject_TypeCheck(item, &(Part::TopoShapePy::Type))) {
+                PyErr_SetString(PyExc_TypeError, "List of shapes expected");
+                return 0;
+            }
+            shapes.push_back(static_cast<Part::TopoShapePy*>(item)->getTopoShapePtr()->getShape());
+        }
+
+        Py::List ret;
+        std::vector<std::set<int> > resultSets = getFemMeshPtr()->getNodesByShapes(shapes);
+        for (std::vector<std::set<int> >::const_iterator it = resultSets.begin(); it != resultSets.end(); ++it) {
+            Py::List nodes;
+            for (std::set<int>::const_iterator jt = it->begin(); jt != it->end(); ++jt)
+                nodes.append(Py::Int(*jt));
+            ret.append(nodes);
+        }
+
+        return Py::new_reference_to(ret);
+
+    }
+    catch (Standard_Failure) {
+        Handle_Standard_Failure e = Standard_Failure::Caught();
+        PyErr_SetString(Base::BaseExceptionFreeCADError, e->GetMessageString());
+        return 0;
+    }
+    catch (const Py::Exception&) {
+        return 0;
+    }
+}
+
 PyObject* FemMeshPy::getElementNodes(PyObject *args)
 {
     int id;
@@ -954,6 +994,73 @@ PyObject* FemMeshPy::getGroupElements(PyObject *args)
     return Py::new_reference_to(tuple);
 }
 
+PyObject* FemMeshPy::addGroup(PyObject *args)
+{
+    char* name;
+    char* typeString;
+    if (!PyArg_ParseTuple(args, "ss", &name, &typeString))
+         return 0;
+
+    std::map<std::string, SMDSAbs_ElementType> types;
+    types["All"] = SMDSAbs_All;
+    types["Node"] = SMDSAbs_Node;
+    types["Edge"] = SMDSAbs_Edge;
+    types["Face"] = SMDSAbs_Face;
+    types["Volume"] = SMDSAbs_Volume;
+    types["0DElement"] = SMDSAbs_0DElement;
+    types["Ball"] = SMDSAbs_Ball;
+    std::map<std::string, SMDSAbs_ElementType>::iterator it = types.find(typeString);
+    if (it == types.end()) {
+        PyErr_SetString(PyExc_ValueError, "Unknown element type of group");
+        return 0;
+    }
+
+    int aId;
+    SMESH_Group* group = getFemMeshPtr()->getSMesh()->AddGroup(it->second, name, aId);
+    if (!group) {
+        PyErr_SetString(Base::BaseExceptionFreeCADError, "Failed to add group");
+        return 0;
+    }
+    return Py::new_reference_to(Py::Int(aId));
+}
+
+PyObject* FemMeshPy::addGroupElements(PyObject *args)
+{
+    int id;
+    PyObject* list;
+    if (!PyArg_ParseTuple(args, "iO!", &id, &PyList_Type, &list))
+         return 0;
+
+    SMESH_Mesh* mesh = getFemMeshPtr()->getSMesh();
+    SMESH_Group* group = mesh->GetGroup(id);
+    SMESHDS_Group* groupDS = group ? dynamic_cast<SMESHDS_Group*>(group->GetGroupDS()) : 0;
+    if (!groupDS) {
+        PyErr_SetString(PyExc_ValueError, "No standalone group with this ID");
+        return 0;
+    }
+
+    try {
+        const SMESHDS_Mesh* meshDS = mesh->GetMeshDS();
+        Py::Sequence ids(list);
+        for (Py::Sequence::iterator it = ids.begin(); it != ids.end(); ++it) {
+            int elemId = static_cast<int>(Py::Int(*it));
+            const SMDS_MeshElement* elem = (groupDS->GetType() == SMDSAbs_Node)
+                ? static_cast<const SMDS_MeshElement*>(meshDS->FindNode(elemId))
+                : meshDS->FindElement(elemId);
+            if (!elem || (groupDS->GetType() != SMDSAbs_All && elem->GetType() != groupDS->GetType())) {
+                PyErr_Format(PyExc_ValueError, "No element %d of the group type", elemId);
+                return 0;
+            }
+            groupDS->Add(elem);
+        }
+    }
+    catch (Py::Exception&) {
+        return 0;
+    }
+
+    Py_Return;
+}
+
 // ===== Atributes ============================================================
 
 Py::Dict FemMeshPy::getNodes(void) const
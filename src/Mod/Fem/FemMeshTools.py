@@ -59,9 +59,13 @@ def get_femelements_by_references(femmesh, femelement_table, references, femnode
 def get_femnodes_by_references(femmesh, references):
     '''get the femnodes for a list of references
     '''
-    references_femnodes = []
+    ref_shapes = []
     for ref in references:
-        references_femnodes += get_femnodes_by_refshape(femmesh, ref)
+        ref_shapes += get_refshapes(ref)
+    # the nodes of all reference shapes are searched with one call
+    references_femnodes = []
+    for ref_femnodes in femmesh.getNodesByShapes(ref_shapes):
+        references_femnodes += ref_femnodes
 
     # return references_femnodes  # keeps duplicate nodes, keeps node order
 
@@ -71,23 +75,24 @@ def get_femnodes_by_references(femmesh, references):
 
 def get_femnodes_by_refshape(femmesh, ref):
     nodes = []
+    for ref_femnodes in femmesh.getNodesByShapes(get_refshapes(ref)):
+        nodes += ref_femnodes
+    return nodes
+
+
+def get_refshapes(ref):
+    shapes = []
     for refelement in ref[1]:
         if refelement:
             r = ref[0].Shape.getElement(refelement)  # Vertex, Edge, Face
         else:
             r = ref[0].Shape  # solid
         print('  ReferenceShape : ', r.ShapeType, ', ', ref[0].Name, ', ', ref[0].Label, ' --> ', refelement)
-        if r.ShapeType == 'Vertex':
-            nodes += femmesh.getNodesByVertex(r)
-        elif r.ShapeType == 'Edge':
-            nodes += femmesh.getNodesByEdge(r)
-        elif r.ShapeType == 'Face':
-            nodes += femmesh.getNodesByFace(r)
-        elif r.ShapeType == 'Solid':
-            nodes += femmesh.getNodesBySolid(r)
+        if r.ShapeType in ('Vertex', 'Edge', 'Face', 'Solid'):
+            shapes.append(r)
         else:
             print('  No Vertice, Edge, Face or Solid as reference shapes!')
-    return nodes
+    return shapes
 
 
 def get_femelement_table(femmesh):
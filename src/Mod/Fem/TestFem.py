@@ -523,6 +523,108 @@ class TherMechFemTest(unittest.TestCase):
         pass
 
 
+class FemMeshTest(unittest.TestCase):
+
+    def setUp(self):
+        try:
+            FreeCAD.setActiveDocument("FemMeshTest")
+        except:
+            FreeCAD.newDocument("FemMeshTest")
+        finally:
+            FreeCAD.setActiveDocument("FemMeshTest")
+        self.active_doc = FreeCAD.ActiveDocument
+        self.box = self.active_doc.addObject("Part::Box", "Box")
+        self.active_doc.recompute()
+        self.mesh = Fem.FemMesh()
+        with open(mesh_points_file, 'r') as points_file:
+            reader = csv.reader(points_file)
+            for p in reader:
+                self.mesh.addNode(float(p[1]), float(p[2]), float(p[3]), int(p[0]))
+
+        with open(mesh_volumes_file, 'r') as volumes_file:
+            reader = csv.reader(volumes_file)
+            for v in reader:
+                self.mesh.addVolume([int(v[2]), int(v[1]), int(v[3]), int(v[4]), int(v[5]),
+                                    int(v[7]), int(v[6]), int(v[9]), int(v[8]), int(v[10])],
+                                    int(v[0]))
+
+    def nodes_by_distance(self, shape, limit):
+        # the nodes whose distance to the shape is below the limit, checked node by node
+        import Part
+        nodes = []
+        for id, pnt in self.mesh.Nodes.items():
+            if shape.distToShape(Part.Vertex(pnt))[0] < limit:
+                nodes.append(id)
+        return sorted(nodes)
+
+    def test_nodes_by_face(self):
+        for face in self.box.Shape.Faces:
+            expected = self.nodes_by_distance(face, face.Tolerance)
+            self.assertTrue(len(expected) > 0)
+            self.assertEqual(sorted(self.mesh.getNodesByFace(face)), expected)
+
+    def test_nodes_by_edge(self):
+        for edge in self.box.Shape.Edges:
+            expected = self.nodes_by_distance(edge, edge.Tolerance)
+            self.assertTrue(len(expected) > 0)
+            self.assertEqual(sorted(self.mesh.getNodesByEdge(edge)), expected)
+
+    def test_nodes_by_vertex(self):
+        for vertex in self.box.Shape.Vertexes:
+            expected = self.nodes_by_distance(vertex, vertex.Tolerance)
+            self.assertEqual(len(expected), 1)
+            self.assertEqual(sorted(self.mesh.getNodesByVertex(vertex)), expected)
+
+    def test_nodes_by_solid(self):
+        solid = self.box.Shape.Solids[0]
+        limit = solid.BoundBox.DiagonalLength ** 2 / 10000.0
+        expected = self.nodes_by_distance(solid, limit)
+        self.assertEqual(len(expected), self.mesh.NodeCount)
+        self.assertEqual(sorted(self.mesh.getNodesBySolid(solid)), expected)
+
+    def test_nodes_after_modification(self):
+        face = self.box.Shape.Faces[0]
+        before = self.mesh.getNodesByFace(face)
+        # a node on the face added after the first query must be found
+        id = max(self.mesh.Nodes.keys()) + 1
+        pnt = face.Surface.value(*face.Surface.parameter(face.CenterOfMass))
+        self.mesh.addNode(pnt.x, pnt.y, pnt.z, id)
+        after = self.mesh.getNodesByFace(face)
+        self.assertTrue(id not in before)
+        self.assertEqual(sorted(after), sorted(list(before) + [id]))
+
+    def test_save_restore(self):
+        node_group = self.mesh.addGroup("Corners", "Node")
+        self.mesh.addGroupElements(node_group, [1, 2, 3])
+        volume_group = self.mesh.addGroup("Volumes", "Volume")
+        self.mesh.addGroupElements(volume_group, list(self.mesh.Volumes)[:10])
+        mesh_object = self.active_doc.addObject('Fem::FemMeshObject', mesh_name)
+        mesh_object.FemMesh = self.mesh
+
+        file_name = temp_dir + '/FemMeshTest.FCStd'
+        self.active_doc.saveAs(file_name)
+        FreeCAD.closeDocument("FemMeshTest")
+        doc = FreeCAD.openDocument(file_name)
+        try:
+            mesh = doc.getObject(mesh_name).FemMesh
+            self.assertEqual(mesh.Nodes, self.mesh.Nodes)
+            self.assertEqual(mesh.Volumes, self.mesh.Volumes)
+            for id in self.mesh.Volumes:
+                self.assertEqual(mesh.getElementNodes(id), self.mesh.getElementNodes(id))
+            self.assertEqual(mesh.GroupCount, self.mesh.GroupCount)
+            for id in self.mesh.Groups:
+                self.assertEqual(mesh.getGroupName(id), self.mesh.getGroupName(id))
+                self.assertEqual(mesh.getGroupElementType(id), self.mesh.getGroupElementType(id))
+                self.assertEqual(mesh.getGroupElements(id), self.mesh.getGroupElements(id))
+        finally:
+            FreeCAD.closeDocument(doc.Name)
+            FreeCAD.newDocument("FemMeshTest")
+
+    def tearDown(self):
+        FreeCAD.closeDocument("FemMeshTest")
+        pass
+
+
 # helpers
 def open_cube_test():
     cube_file = test_file_dir + '/cube.fcstd'
@@ -25,11 +25,14 @@
 #include <gp_Pnt.hxx>
 #include <BRepExtrema_DistShapeShape.hxx>
 #include <BRepBuilderAPI_MakeVertex.hxx>
+#include <Standard.hxx>
+#include <Standard_Version.hxx>
 #include <TopoDS_Vertex.hxx>
 
-#include <QEventLoop>
+#include <QAtomicInt>
 #include <QFuture>
-#include <QFutureWatcher>
+#include <QMutexLocker>
+#include <QSemaphore>
 #include <QtConcurrentMap>
 
 #include <boost/signals.hpp>
@@ -37,7 +40,6 @@
 
 #include <Base/Console.h>
 #include <Base/Exception.h>
-#include <Base/FutureWatcherProgress.h>
 #include <Base/Parameter.h>
 #include <Base/Sequencer.h>
 #include <Base/Tools.h>
@@ -74,8 +76,10 @@ unsigned long InspectActualMesh::countPoints() const
 
 Base::Vector3f InspectActualMesh::getPoint(unsigned long index)
 {
-    _iter.Set(index);
-    return *_iter;
+    // work on a copy because the points are requested from several threads
+    MeshCore::MeshPointIterator iter(_iter);
+    iter.Set(index);
+    return *iter;
 }
 
 // ----------------------------------------------------------------
@@ -176,15 +180,19 @@ namespace Inspection {
             assert((rulX < _ulCtGridsX) && (rulY < _ulCtGridsY) && (rulZ < _ulCtGridsZ));
         }
 
-        void AddFacet (const MeshCore::MeshGeomFacet &rclFacet, unsigned long ulFacetIndex)
+        void GetGridsOfElement (unsigned long ulIndex, std::vector<unsigned long> &raulGrids) const
         {
+            MeshCore::MeshGeomFacet clFacet = _pclMesh->GetFacet(ulIndex);
+            for (int i = 0; i < 3; i++)
+                clFacet._aclPoints[i] = _transform * clFacet._aclPoints[i];
+
             unsigned long ulX, ulY, ulZ;
             unsigned long ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
 
             Base::BoundBox3f clBB;
-            clBB.Add(rclFacet._aclPoints[0]);
-            clBB.Add(rclFacet._aclPoints[1]);
-            clBB.Add(rclFacet._aclPoints[2]);
+            clBB.Add(clFacet._aclPoints[0]);
+            clBB.Add(clFacet._aclPoints[1]);
+            clBB.Add(clFacet._aclPoints[2]);
 
             Pos(Base::Vector3f(clBB.MinX,clBB.MinY,clBB.MinZ), ulX1, ulY1, ulZ1);
             Pos(Base::Vector3f(clBB.MaxX,clBB.MaxY,clBB.MaxZ), ulX2, ulY2, ulZ2);
@@ -194,20 +202,18 @@ namespace Inspection {
                 for (ulX = ulX1; ulX <= ulX2; ulX++) {
                     for (ulY = ulY1; ulY <= ulY2; ulY++) {
                         for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++) {
-                            if (rclFacet.IntersectBoundingBox(GetBoundBox(ulX, ulY, ulZ)))
-                                _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
+                            if (clFacet.IntersectBoundingBox(GetBoundBox(ulX, ulY, ulZ)))
+                                raulGrids.push_back(GetIndexToPosition(ulX, ulY, ulZ));
                         }
                     }
                 }
             }
             else
-                _aulGrid[ulX1][ulY1][ulZ1].insert(ulFacetIndex);
+                raulGrids.push_back(GetIndexToPosition(ulX1, ulY1, ulZ1));
         }
 
         void InitGrid (void)
         {
-            unsigned long i, j;
-
             Base::BoundBox3f clBBMesh = _pclMesh->GetBoundBox().Transformed(_transform);
 
             float fLengthX = clBBMesh.LengthX(); 
@@ -223,61 +229,247 @@ namespace Inspection {
             _fGridLenZ = (1.0f + fLengthZ) / float(_ulCtGridsZ);
             _fMinZ = clBBMesh.MinZ - 0.5f;
 
-            _aulGrid.clear();
-            _aulGrid.resize(_ulCtGridsX);
-            for (i = 0; i < _ulCtGridsX; i++) {
-                _aulGrid[i].resize(_ulCtGridsY);
-                for (j = 0; j < _ulCtGridsY; j++)
-                    _aulGrid[i][j].resize(_ulCtGridsZ);
-            }
+            _aulGridOffsets.assign(_ulCtGridsX * _ulCtGridsY * _ulCtGridsZ + 1, 0);
+            _aulGridElements.clear();
         }
 
         void RebuildGrid (void)
         {
             _ulCtElements = _pclMesh->CountFacets();
             InitGrid();
- 
-            unsigned long i = 0;
-            MeshCore::MeshFacetIterator clFIter(*_pclMesh);
-            clFIter.Transform(_transform);
-            for (clFIter.Init(); clFIter.More(); clFIter.Next()) {
-                AddFacet(*clFIter, i++);
-            }
+            FillGrid();
         }
 
     private:
         Base::Matrix4D _transform;
     };
+
+    /**
+     * Bounding volume hierarchy over the transformed facets of a mesh. The facets are
+     * stored in the order of the leaves as base point, edges and normal so that a leaf
+     * is scanned linearly without going back to the mesh kernel. The tree is only read
+     * after construction and thus can be queried from several threads at once.
+     */
+    class MeshInspectTree
+    {
+    public:
+        MeshInspectTree (const MeshCore::MeshKernel &mesh, const Base::Matrix4D& m)
+        {
+            unsigned long ctFacets = mesh.CountFacets();
+            if (ctFacets == 0)
+                return;
+
+            std::vector<Facet> facets(ctFacets);
+            std::vector<Base::BoundBox3f> boxes(ctFacets);
+            std::vector<Base::Vector3f> centers(ctFacets);
+            for (unsigned long i = 0; i < ctFacets; i++) {
+                MeshCore::MeshGeomFacet facet = mesh.GetFacet(i);
+                for (int j = 0; j < 3; j++) {
+                    facet._aclPoints[j] = m * facet._aclPoints[j];
+                    boxes[i].Add(facet._aclPoints[j]);
+                }
+                facets[i].base = facet._aclPoints[0];
+                facets[i].edge0 = facet._aclPoints[1] - facet._aclPoints[0];
+                facets[i].edge1 = facet._aclPoints[2] - facet._aclPoints[0];
+                facets[i].normal = facet.GetNormal();
+                centers[i] = boxes[i].GetCenter();
+            }
+
+            std::vector<unsigned long> indices(ctFacets);
+            std::generate(indices.begin(), indices.end(), Base::iotaGen<unsigned long>(0));
+            _nodes.reserve(2 * (ctFacets / LeafSize + 1));
+            _facets.reserve(ctFacets);
+            BuildNode(indices.begin(), indices.end(), facets, boxes, centers);
+        }
+
+        /** Returns the distance of \a point to the nearest facet. The distance is negative if
+         * the point lies behind the facet and FLT_MAX if the mesh is empty.
+         */
+        float NearestDistance (const Base::Vector3f& point) const
+        {
+            if (_nodes.empty())
+                return FLT_MAX;
+
+            float fMinDist = FLT_MAX;
+            const Facet* nearest = 0;
+
+            // the depth of the tree is logarithmic in the number of facets
+            unsigned long stack[128];
+            int top = 0;
+            stack[top++] = 0;
+            while (top > 0) {
+                unsigned long index = stack[--top];
+                const Node& node = _nodes[index];
+                if (SqrDistance(node.box, point) >= fMinDist)
+                    continue;
+
+                if (node.count > 0) {
+                    const Facet* it = &_facets[node.first];
+                    const Facet* end = it + node.count;
+                    for (; it != end; ++it) {
+                        float fDist = SqrDistance(*it, point);
+                        if (fDist < fMinDist) {
+                            fMinDist = fDist;
+                            nearest = it;
+                        }
+                    }
+                }
+                else {
+                    // visit the nearer child first
+                    unsigned long left = index + 1;
+                    unsigned long right = node.first;
+                    float fLeft = SqrDistance(_nodes[left].box, point);
+                    float fRight = SqrDistance(_nodes[right].box, point);
+                    if (fLeft < fRight) {
+                        std::swap(left, right);
+                        std::swap(fLeft, fRight);
+                    }
+                    if (fLeft < fMinDist)
+                        stack[top++] = left;
+                    if (fRight < fMinDist)
+                        stack[top++] = right;
+                }
+            }
+
+            if (!nearest)
+                return FLT_MAX;
+            fMinDist = sqrt(fMinDist);
+            if (point.DistanceToPlane(nearest->base, nearest->normal) <= 0)
+                fMinDist = -fMinDist;
+            return fMinDist;
+        }
+
+    private:
+        static const unsigned long LeafSize = 4;
+
+        struct Node
+        {
+            Base::BoundBox3f box;
+            unsigned long first; // first facet of a leaf or the right child of an inner node
+            unsigned long count; // number of facets of a leaf, 0 for inner nodes
+        };
+
+        struct Facet
+        {
+            Base::Vector3f base, edge0, edge1, normal;
+        };
+
+        struct CenterLess
+        {
+            CenterLess(const std::vector<Base::Vector3f>& c, int a) : centers(c), axis(a) {}
+            bool operator() (unsigned long i, unsigned long j) const
+            { return centers[i][axis] < centers[j][axis]; }
+            const std::vector<Base::Vector3f>& centers;
+            int axis;
+        };
+
+        unsigned long BuildNode (std::vector<unsigned long>::iterator begin,
+                                 std::vector<unsigned long>::iterator end,
+                                 const std::vector<Facet>& facets,
+                                 const std::vector<Base::BoundBox3f>& boxes,
+                                 const std::vector<Base::Vector3f>& centers)
+        {
+            unsigned long index = _nodes.size();
+            _nodes.push_back(Node());
+
+            Base::BoundBox3f box, centerBox;
+            for (std::vector<unsigned long>::iterator it = begin; it != end; ++it) {
+                box.Add(boxes[*it]);
+                centerBox.Add(centers[*it]);
+            }
+            _nodes[index].box = box;
+
+            unsigned long count = end - begin;
+            if (count <= LeafSize) {
+                _nodes[index].first = _facets.size();
+                _nodes[index].count = count;
+                for (std::vector<unsigned long>::iterator it = begin; it != end; ++it)
+                    _facets.push_back(facets[*it]);
+                return index;
+            }
+
+            // split at the median of the longest axis
+            int axis = 0;
+            if (centerBox.LengthY() > centerBox.LengthX())
+                axis = 1;
+            if (centerBox.LengthZ() > std::max<float>(centerBox.LengthX(), centerBox.LengthY()))
+                axis = 2;
+            std::vector<unsigned long>::iterator mid = begin + count / 2;
+            std::nth_element(begin, mid, end, CenterLess(centers, axis));
+
+            BuildNode(begin, mid, facets, boxes, centers);
+            unsigned long right = BuildNode(mid, end, facets, boxes, centers);
+            _nodes[index].first = right;
+            _nodes[index].count = 0;
+            return index;
+        }
+
+        static float SqrDistance (const Base::BoundBox3f& box, const Base::Vector3f& p)
+        {
+            float dx = std::max<float>(std::max<float>(box.MinX - p.x, p.x - box.MaxX), 0.0f);
+            float dy = std::max<float>(std::max<float>(box.MinY - p.y, p.y - box.MaxY), 0.0f);
+            float dz = std::max<float>(std::max<float>(box.MinZ - p.z, p.z - box.MaxZ), 0.0f);
+            return dx * dx + dy * dy + dz * dz;
+        }
+
+        // squared distance to the closest point of the facet by its Voronoi regions
+        static float SqrDistance (const Facet& f, const Base::Vector3f& p)
+        {
+            Base::Vector3f ap = p - f.base;
+            float d1 = f.edge0 * ap;
+            float d2 = f.edge1 * ap;
+            if (d1 <= 0.0f && d2 <= 0.0f)
+                return ap.Sqr();
+
+            Base::Vector3f bp = ap - f.edge0;
+            float d3 = f.edge0 * bp;
+            float d4 = f.edge1 * bp;
+            if (d3 >= 0.0f && d4 <= d3)
+                return bp.Sqr();
+
+            float vc = d1 * d4 - d3 * d2;
+            if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+                return (ap - f.edge0 * (d1 / (d1 - d3))).Sqr();
+
+            Base::Vector3f cp = ap - f.edge1;
+            float d5 = f.edge0 * cp;
+            float d6 = f.edge1 * cp;
+            if (d6 >= 0.0f && d5 <= d6)
+                return cp.Sqr();
+
+            float vb = d5 * d2 - d1 * d6;
+            if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+                return (ap - f.edge1 * (d2 / (d2 - d6))).Sqr();
+
+            float va = d3 * d6 - d5 * d4;
+            if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+                return (bp - (f.edge1 - f.edge0) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)))).Sqr();
+
+            float sum = va + vb + vc;
+            if (sum <= 0.0f) // degenerated facet
+                return std::min<float>(ap.Sqr(), std::min<float>(bp.Sqr(), cp.Sqr()));
+            return (ap - f.edge0 * (vb / sum) - f.edge1 * (vc / sum)).Sqr();
+        }
+
+        std::vector<Node> _nodes;
+        std::vector<Facet> _facets;
+    };
 }
 
-InspectNominalMesh::InspectNominalMesh(const Mesh::MeshObject& rMesh, float offset) : _iter(rMesh.getKernel())
+InspectNominalMesh::InspectNominalMesh(const Mesh::MeshObject& rMesh, float offset)
 {
     const MeshCore::MeshKernel& kernel = rMesh.getKernel();
-    _iter.Transform(rMesh.getTransform());
-
-    // Max. limit of grid elements
-    float fMaxGridElements=8000000.0f;
     Base::BoundBox3f box = kernel.GetBoundBox().Transformed(rMesh.getTransform());
 
-    // estimate the minimum allowed grid length
-    float fMinGridLen = (float)pow((box.LengthX()*box.LengthY()*box.LengthZ()/fMaxGridElements), 0.3333f);
-    float fGridLen = 5.0f * MeshCore::MeshAlgorithm(kernel).GetAverageEdgeLength();
-
-    // We want to avoid to get too small grid elements otherwise building up the grid structure would take
-    // too much time and memory. 
-    // Having quite a dense grid speeds up more the following algorithms extremely. Due to the issue above it's
-    // always a compromise between speed and memory usage.
-    fGridLen = std::max<float>(fMinGridLen, fGridLen);
-
-    // build up grid structure to speed up algorithms
-    _pGrid = new MeshInspectGrid(kernel, fGridLen, rMesh.getTransform());
+    // build up the facet tree to speed up the search for the nearest facet
+    _pTree = new MeshInspectTree(kernel, rMesh.getTransform());
     _box = box;
     _box.Enlarge(offset);
 }
 
 InspectNominalMesh::~InspectNominalMesh()
 {
-    delete this->_pGrid;
+    delete this->_pTree;
 }
 
 float InspectNominalMesh::getDistance(const Base::Vector3f& point)
@@ -285,28 +477,7 @@ float InspectNominalMesh::getDistance(const Base::Vector3f& point)
     if (!_box.IsInBox(point))
         return FLT_MAX; // must be inside bbox
 
-    std::vector<unsigned long> indices;
-    //_pGrid->GetElements(point, indices);
-    if (indices.empty()) {
-        std::set<unsigned long> inds;
-        _pGrid->MeshGrid::SearchNearestFromPoint(point, inds);
-        indices.insert(indices.begin(), inds.begin(), inds.end());
-    }
-
-    float fMinDist=FLT_MAX;
-    bool positive = true;
-    for (std::vector<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
-        _iter.Set(*it);
-        float fDist = _iter->DistanceToPoint(point);
-        if (fabs(fDist) < fabs(fMinDist)) {
-            fMinDist = fDist;
-            positive = point.DistanceToPlane(_iter->_aclPoints[0], _iter->GetNormal()) > 0;
-        }
-    }
-
-    if (!positive)
-        fMinDist = -fMinDist;
-    return fMinDist;
+    return _pTree->NearestDistance(point);
 }
 
 // ----------------------------------------------------------------
@@ -366,14 +537,15 @@ float InspectNominalFastMesh::getDistance(const Base::Vector3f& point)
         _pGrid->GetHull(ulX, ulY, ulZ, ulLevel, indices);
 #endif
 
+    MeshCore::MeshFacetIterator iter(_iter);
     float fMinDist=FLT_MAX;
     bool positive = true;
     for (std::set<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
-        _iter.Set(*it);
-        float fDist = _iter->DistanceToPoint(point);
+        iter.Set(*it);
+        float fDist = iter->DistanceToPoint(point);
         if (fabs(fDist) < fabs(fMinDist)) {
             fMinDist = fDist;
-            positive = point.DistanceToPlane(_iter->_aclPoints[0], _iter->GetNormal()) > 0;
+            positive = point.DistanceToPlane(iter->_aclPoints[0], iter->GetNormal()) > 0;
         }
     }
 
@@ -421,23 +593,54 @@ float InspectNominalPoints::getDistance(const Base::Vector3f& point)
 
 InspectNominalShape::InspectNominalShape(const TopoDS_Shape& shape, float /*radius*/) : _rShape(shape)
 {
-    distss = new BRepExtrema_DistShapeShape();
-    distss->LoadS1(_rShape);
-    //distss->SetDeflection(radius);
 }
 
 InspectNominalShape::~InspectNominalShape()
 {
-    delete distss;
+    for (std::vector<BRepExtrema_DistShapeShape*>::iterator it = _algos.begin(); it != _algos.end(); ++it)
+        delete *it;
+}
+
+BRepExtrema_DistShapeShape* InspectNominalShape::acquire()
+{
+    {
+        QMutexLocker locker(&_mutex);
+        if (!_algos.empty()) {
+            BRepExtrema_DistShapeShape* distss = _algos.back();
+            _algos.pop_back();
+            return distss;
+        }
+    }
+
+    // loading the shape decomposes it and computes the bounding boxes of its sub-shapes
+    // which is only done once for each worker thread
+    BRepExtrema_DistShapeShape* distss = new BRepExtrema_DistShapeShape();
+    distss->LoadS1(_rShape);
+    return distss;
+}
+
+void InspectNominalShape::release(BRepExtrema_DistShapeShape* distss)
+{
+    QMutexLocker locker(&_mutex);
+    _algos.push_back(distss);
 }
 
 float InspectNominalShape::getDistance(const Base::Vector3f& point)
 {
-    BRepBuilderAPI_MakeVertex mkVert(gp_Pnt(point.x,point.y,point.z));
-    distss->LoadS2(mkVert.Vertex());
+    // the algorithm keeps its results as state, so it's used by one thread at a time
+    BRepExtrema_DistShapeShape* distss = acquire();
     float fMinDist=FLT_MAX;
-    if (distss->Perform() && distss->NbSolution() > 0)
-        fMinDist = (float)distss->Value();
+    try {
+        BRepBuilderAPI_MakeVertex mkVert(gp_Pnt(point.x,point.y,point.z));
+        distss->LoadS2(mkVert.Vertex());
+        if (distss->Perform() && distss->NbSolution() > 0)
+            fMinDist = (float)distss->Value();
+    }
+    catch (...) {
+        release(distss);
+        throw;
+    }
+    release(distss);
     return fMinDist;
 }
 
@@ -550,9 +753,7 @@ void PropertyDistanceList::SaveDocFile (Base::Writer &writer) const
     Base::OutputStream str(writer.Stream());
     uint32_t uCt = (uint32_t)getSize();
     str << uCt;
-    for (std::vector<float>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-        str << *it;
-    }
+    str.write(_lValueList.data(), _lValueList.size());
 }
 
 void PropertyDistanceList::RestoreDocFile(Base::Reader &reader)
@@ -561,9 +762,7 @@ void PropertyDistanceList::RestoreDocFile(Base::Reader &reader)
     uint32_t uCt=0;
     str >> uCt;
     std::vector<float> values(uCt);
-    for (std::vector<float>::iterator it = values.begin(); it != values.end(); ++it) {
-        str >> *it;
-    }
+    str.read(values.data(), values.size());
     setValues(values);
 }
 
@@ -593,8 +792,8 @@ struct DistanceInspection
 {
 
     DistanceInspection(float radius, InspectActualGeometry*  a,
-                       std::vector<InspectNominalGeometry*> n)
-                    : radius(radius), actual(a), nominal(n)
+                       std::vector<InspectNominalGeometry*> n, std::vector<float>& v)
+                    : radius(radius), actual(a), nominal(n), values(v)
     {
     }
     float mapped(unsigned long index)
@@ -615,10 +814,25 @@ struct DistanceInspection
 
         return fMinDist;
     }
+    // computes the distances of a block of points and reports it as done
+    void mapBlock(const std::pair<unsigned long, unsigned long>& block)
+    {
+        try {
+            for (unsigned long index = block.first; index < block.second; index++)
+                values[index] = mapped(index);
+        }
+        catch (...) {
+            failed.fetchAndStoreRelaxed(1);
+        }
+        finished.release();
+    }
 
     float radius;
     InspectActualGeometry*  actual;
     std::vector<InspectNominalGeometry*> nominal;
+    std::vector<float>& values;
+    QSemaphore finished;
+    QAtomicInt failed;
 };
 
 PROPERTY_SOURCE(Inspection::Feature, App::DocumentObject)
@@ -694,52 +908,51 @@ App::DocumentObjectExecReturn* Feature::execute(void)
             inspectNominal.push_back(nominal);
     }
 
-#if 0 // test with some huge data sets
-    Standard::SetReentrant(Standard_True);
-    std::vector<unsigned long> index(actual->countPoints());
-    std::generate(index.begin(), index.end(), Base::iotaGen<unsigned long>(0));
-    DistanceInspection check(this->SearchRadius.getValue(), actual, inspectNominal);
-    QFuture<float> future = QtConcurrent::mapped
-        (index, boost::bind(&DistanceInspection::mapped, &check, _1));
-    //future.waitForFinished(); // blocks the GUI
-    Base::FutureWatcherProgress progress("Inspecting...", actual->countPoints());
-    QFutureWatcher<float> watcher;
-    QObject::connect(&watcher, SIGNAL(progressValueChanged(int)),
-                     &progress, SLOT(progressValueChanged(int)));
-    watcher.setFuture(future);
-
-    // keep it responsive during computation
-    QEventLoop loop;
-    QObject::connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
-    loop.exec();
-
-    std::vector<float> vals;
-    vals.insert(vals.end(), future.begin(), future.end());
-#else
+    // The points are split into blocks that are computed on the worker threads. The
+    // main thread only waits for finished blocks to move the progress bar on and to
+    // give the user the chance to cancel the inspection.
     unsigned long count = actual->countPoints();
-    std::stringstream str;
-    str << "Inspecting " << this->Label.getValue() << "...";
-    Base::SequencerLauncher seq(str.str().c_str(), count);
+    unsigned long blockSize = std::max<unsigned long>(1, std::min<unsigned long>(4096, count / 1000));
+    std::vector<std::pair<unsigned long, unsigned long> > blocks;
+    blocks.reserve(count / blockSize + 1);
+    for (unsigned long index = 0; index < count; index += blockSize)
+        blocks.push_back(std::make_pair(index, std::min<unsigned long>(index + blockSize, count)));
 
     std::vector<float> vals(count);
-    for (unsigned long index = 0; index < count; index++) {
-        Base::Vector3f pnt = actual->getPoint(index);
+    DistanceInspection check(this->SearchRadius.getValue(), actual, inspectNominal, vals);
 
-        float fMinDist=FLT_MAX;
-        for (std::vector<InspectNominalGeometry*>::iterator it = inspectNominal.begin(); it != inspectNominal.end(); ++it) {
-            float fDist = (*it)->getDistance(pnt);
-            if (fabs(fDist) < fabs(fMinDist))
-                fMinDist = fDist;
+#if OCC_VERSION_HEX < 0x070000
+    Standard::SetReentrant(Standard_True);
+#endif
+    QFuture<void> future = QtConcurrent::map
+        (blocks, boost::bind(&DistanceInspection::mapBlock, &check, _1));
+
+    std::stringstream str;
+    str << "Inspecting " << this->Label.getValue() << "...";
+    try {
+        Base::SequencerLauncher seq(str.str().c_str(), blocks.size());
+        for (std::size_t i = 0; i < blocks.size(); i++) {
+            check.finished.acquire();
+            seq.next(true);
         }
+    }
+    catch (...) {
+        // canceled by the user
+        future.cancel();
+        future.waitForFinished();
+        delete actual;
+        for (std::vector<InspectNominalGeometry*>::iterator it = inspectNominal.begin(); it != inspectNominal.end(); ++it)
+            delete *it;
+        throw;
+    }
+    future.waitForFinished();
 
-        if (fMinDist > this->SearchRadius.getValue())
-            fMinDist = FLT_MAX;
-        else if (-fMinDist > this->SearchRadius.getValue())
-            fMinDist = -FLT_MAX;
-        vals[index] = fMinDist;
-        seq.next();
+    if ((int)check.failed != 0) {
+        delete actual;
+        for (std::vector<InspectNominalGeometry*>::iterator it = inspectNominal.begin(); it != inspectNominal.end(); ++it)
+            delete *it;
+        throw Base::Exception("Failed to compute the distances to the nominal geometry");
     }
-#endif
 
     Distances.setValues(vals);
 
@@ -24,6 +24,7 @@
 #ifndef INSPECTION_FEATURE_H
 #define INSPECTION_FEATURE_H
 
+#include <QMutex>
 #include <App/DocumentObject.h>
 #include <App/PropertyLinks.h>
 #include <App/DocumentObjectGroup.h>
@@ -46,7 +47,9 @@ namespace Part   { class TopoShape;  }
 namespace Inspection
 {
 
-/** Delivers the number of points to be checked and returns the appropriate point to an index. */
+/** Delivers the number of points to be checked and returns the appropriate point to an index.
+ * getPoint() is called from several threads at once and must not modify the object.
+ */
 class InspectionExport InspectActualGeometry
 {
 public:
@@ -93,7 +96,9 @@ private:
     std::vector<Base::Vector3d> points;
 };
 
-/** Calculates the shortest distance of the underlying geometry to a given point. */
+/** Calculates the shortest distance of the underlying geometry to a given point.
+ * getDistance() is called from several threads at once and must not modify the object.
+ */
 class InspectionExport InspectNominalGeometry
 {
 public:
@@ -102,6 +107,8 @@ public:
     virtual float getDistance(const Base::Vector3f&) = 0;
 };
 
+class MeshInspectTree;
+
 class InspectionExport InspectNominalMesh : public InspectNominalGeometry
 {
 public:
@@ -110,8 +117,7 @@ public:
     virtual float getDistance(const Base::Vector3f&);
 
 private:
-    MeshCore::MeshFacetIterator _iter;
-    MeshCore::MeshGrid* _pGrid;
+    MeshInspectTree* _pTree;
     Base::BoundBox3f _box;
 };
 
@@ -149,8 +155,14 @@ public:
     virtual float getDistance(const Base::Vector3f&);
 
 private:
-    BRepExtrema_DistShapeShape* distss;
+    BRepExtrema_DistShapeShape* acquire();
+    void release(BRepExtrema_DistShapeShape*);
+
+private:
     const TopoDS_Shape& _rShape;
+    /// algorithms with the shape already loaded, at most one per worker thread
+    std::vector<BRepExtrema_DistShapeShape*> _algos;
+    QMutex _mutex;
 };
 
 class InspectionExport PropertyDistanceList: public App::PropertyLists
@@ -0,0 +1,144 @@
+#***************************************************************************
+#*                                                                         *
+#*   This file is part of the FreeCAD CAx development system.              *
+#*                                                                         *
+#*   This program is free software; you can redistribute it and/or modify  *
+#*   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#*   as published by the Free Software Foundation; either version 2 of     *
+#*   the License, or (at your option) any later version.                   *
+#*   for detail see the LICENCE text file.                                 *
+#*                                                                         *
+#*   FreeCAD is distributed in the hope that it will be useful,            *
+#*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#*   GNU Library General Public License for more details.                  *
+#*                                                                         *
+#*   You should have received a copy of the GNU Library General Public     *
+#*   License along with FreeCAD; if not, write to the Free Software        *
+#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#*   USA                                                                   *
+#*                                                                         *
+#***************************************************************************/
+
+import FreeCAD, unittest, math, random
+import Mesh, Points, Part, Inspection
+
+
+#---------------------------------------------------------------------------
+# brute force reference computations
+#---------------------------------------------------------------------------
+
+def sub(a, b):
+    return (a[0]-b[0], a[1]-b[1], a[2]-b[2])
+
+def dot(a, b):
+    return a[0]*b[0] + a[1]*b[1] + a[2]*b[2]
+
+def pointTriangleDistance(p, a, b, c):
+    "Distance of point p to the triangle a, b, c"
+    ab = sub(b, a); ac = sub(c, a); ap = sub(p, a)
+    d1 = dot(ab, ap); d2 = dot(ac, ap)
+    if d1 <= 0 and d2 <= 0:
+        return math.sqrt(dot(ap, ap))
+    bp = sub(p, b)
+    d3 = dot(ab, bp); d4 = dot(ac, bp)
+    if d3 >= 0 and d4 <= d3:
+        return math.sqrt(dot(bp, bp))
+    vc = d1*d4 - d3*d2
+    if vc <= 0 and d1 >= 0 and d3 <= 0:
+        v = d1 / (d1 - d3)
+        q = (a[0]+v*ab[0], a[1]+v*ab[1], a[2]+v*ab[2])
+        return math.sqrt(dot(sub(p, q), sub(p, q)))
+    cp = sub(p, c)
+    d5 = dot(ab, cp); d6 = dot(ac, cp)
+    if d6 >= 0 and d5 <= d6:
+        return math.sqrt(dot(cp, cp))
+    vb = d5*d2 - d1*d6
+    if vb <= 0 and d2 >= 0 and d6 <= 0:
+        w = d2 / (d2 - d6)
+        q = (a[0]+w*ac[0], a[1]+w*ac[1], a[2]+w*ac[2])
+        return math.sqrt(dot(sub(p, q), sub(p, q)))
+    va = d3*d6 - d5*d4
+    if va <= 0 and (d4 - d3) >= 0 and (d5 - d6) >= 0:
+        bc = sub(c, b)
+        w = (d4 - d3) / ((d4 - d3) + (d5 - d6))
+        q = (b[0]+w*bc[0], b[1]+w*bc[1], b[2]+w*bc[2])
+        return math.sqrt(dot(sub(p, q), sub(p, q)))
+    denom = 1.0 / (va + vb + vc)
+    v = vb * denom; w = vc * denom
+    q = (a[0]+ab[0]*v+ac[0]*w, a[1]+ab[1]*v+ac[1]*w, a[2]+ab[2]*v+ac[2]*w)
+    return math.sqrt(dot(sub(p, q), sub(p, q)))
+
+def pointBoxDistance(p, box):
+    "Distance of point p to the solid box"
+    dx = max(box.XMin - p[0], 0, p[0] - box.XMax)
+    dy = max(box.YMin - p[1], 0, p[1] - box.YMax)
+    dz = max(box.ZMin - p[2], 0, p[2] - box.ZMax)
+    return math.sqrt(dx*dx + dy*dy + dz*dz)
+
+
+#---------------------------------------------------------------------------
+# define the functions to test the FreeCAD inspection module
+#---------------------------------------------------------------------------
+
+
+class InspectionDistanceCases(unittest.TestCase):
+    def setUp(self):
+        self.Doc = FreeCAD.newDocument("InspectionTest")
+        random.seed(42)
+
+    def addPoints(self, count, size):
+        pts = Points.Points()
+        pts.addPoints([FreeCAD.Vector(random.uniform(-size, size),
+                                      random.uniform(-size, size),
+                                      random.uniform(-size, size)) for i in range(count)])
+        feature = self.Doc.addObject("Points::Feature", "Actual")
+        feature.Points = pts
+        return feature
+
+    def addInspection(self, actual, nominal):
+        inspect = self.Doc.addObject("Inspection::Feature", "Inspection")
+        inspect.Actual = actual
+        inspect.Nominals = [nominal]
+        inspect.SearchRadius = 1000.0
+        self.Doc.recompute()
+        return inspect
+
+    def testMeshAgainstBruteForce(self):
+        # enough points to be split into several blocks for the worker threads
+        actual = self.addPoints(2500, 8.0)
+        nominal = self.Doc.addObject("Mesh::Feature", "Nominal")
+        nominal.Mesh = Mesh.createSphere(5.0, 12)
+        inspect = self.addInspection(actual, nominal)
+
+        facets = [f.Points for f in nominal.Mesh.Facets]
+        distances = inspect.Distances
+        points = actual.Points.Points
+        self.failUnless(len(distances) == len(points))
+        for p, d in zip(points, distances):
+            p = (p.x, p.y, p.z)
+            ref = min(pointTriangleDistance(p, f[0], f[1], f[2]) for f in facets)
+            self.failUnless(abs(abs(d) - ref) < 1e-3 * max(1.0, ref),
+                            "Distance %f differs from brute force result %f" % (abs(d), ref))
+
+    def testShapeAgainstBruteForce(self):
+        actual = self.addPoints(200, 8.0)
+        nominal = self.Doc.addObject("Part::Box", "Nominal")
+        nominal.Length = 4.0
+        nominal.Width = 6.0
+        nominal.Height = 2.0
+        inspect = self.addInspection(actual, nominal)
+
+        box = nominal.Shape.BoundBox
+        distances = inspect.Distances
+        points = actual.Points.Points
+        self.failUnless(len(distances) == len(points))
+        for p, d in zip(points, distances):
+            ref = pointBoxDistance((p.x, p.y, p.z), box)
+            if ref == 0:
+                continue # inside the solid
+            self.failUnless(abs(d - ref) < 1e-3 * max(1.0, ref),
+                            "Distance %f differs from brute force result %f" % (d, ref))
+
+    def tearDown(self):
+        FreeCAD.closeDocument("InspectionTest")
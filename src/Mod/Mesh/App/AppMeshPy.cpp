@@ -157,7 +157,8 @@ private:
         PyMem_Free(Name);
 
         std::unique_ptr<MeshObject> mesh(new MeshObject);
-        mesh->load(EncodedName.c_str());
+        if (!mesh->load(EncodedName.c_str()))
+            throw Py::RuntimeError(std::string("Cannot read mesh from file '") + EncodedName + "'");
         return Py::asObject(new MeshPy(mesh.release()));
     }
     Py::Object open(const Py::Tuple& args)
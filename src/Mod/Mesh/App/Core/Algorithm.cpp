@@ -27,6 +27,10 @@
 # include <algorithm>
 #endif
 
+#include <QThread>
+#include <QtConcurrentMap>
+#include <boost/bind.hpp>
+
 #include "Algorithm.h"
 #include "Approximation.h"
 #include "Elements.h"
@@ -619,7 +623,7 @@ void MeshAlgorithm::SplitBoundaryLoops(const std::vector<unsigned long>& rBound,
 bool MeshAlgorithm::FillupHole(const std::vector<unsigned long>& boundary, 
                                AbstractPolygonTriangulator& cTria, 
                                MeshFacetArray& rFaces, MeshPointArray& rPoints,
-                               int level, const MeshRefPointToFacets* pP2FStructure) const
+                               int level, const MeshCompactPointToFacets* pP2FStructure) const
 {
     if (boundary.front() == boundary.back()) {
         // first and last vertex are identical
@@ -636,8 +640,8 @@ bool MeshAlgorithm::FillupHole(const std::vector<unsigned long>& boundary,
     unsigned long refPoint0 = *(boundary.begin());
     unsigned long refPoint1 = *(boundary.begin()+1);
     if (pP2FStructure) {
-        const std::set<unsigned long>& ring1 = (*pP2FStructure)[refPoint0];
-        const std::set<unsigned long>& ring2 = (*pP2FStructure)[refPoint1];
+        MeshCompactPointToFacets::Row ring1 = (*pP2FStructure)[refPoint0];
+        MeshCompactPointToFacets::Row ring2 = (*pP2FStructure)[refPoint1];
         std::vector<unsigned long> f_int;
         std::set_intersection(ring1.begin(), ring1.end(), ring2.begin(), ring2.end(),
             std::back_insert_iterator<std::vector<unsigned long> >(f_int));
@@ -1956,3 +1960,425 @@ MeshRefNormalToPoints::operator[] (unsigned long pos) const
 {
     return _norm[pos];
 }
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+typedef std::pair<unsigned long, unsigned long> IndexRange;
+
+/**
+ * Splits the index range [0, count) into a few chunks per thread. Rows can have very
+ * different lengths so more chunks than threads help to balance the work.
+ */
+std::vector<IndexRange> SplitIndexRange(unsigned long count)
+{
+    unsigned long chunks = static_cast<unsigned long>(std::max<int>(QThread::idealThreadCount(), 1)) * 4;
+    unsigned long step = std::max<unsigned long>((count + chunks - 1) / chunks, 1024);
+    std::vector<IndexRange> ranges;
+    for (unsigned long i = 0; i < count; i += step)
+        ranges.push_back(IndexRange(i, std::min<unsigned long>(i + step, count)));
+    return ranges;
+}
+
+/**
+ * Fills a MeshIndexRows table in two passes: the first pass counts the entries of
+ * each row, the second one writes them to the flat index array. Both passes run in
+ * parallel. \a Collector must provide operator()(unsigned long row, std::vector<unsigned long>&)
+ * returning the sorted and unique entries of a row.
+ */
+template <class Collector>
+class MeshIndexRowsBuilder
+{
+public:
+    MeshIndexRowsBuilder(const Collector& c, unsigned long count)
+      : collector(c), sizes(count, 0), rows(0)
+    {
+    }
+    void Build(MeshIndexRows& table)
+    {
+        std::vector<IndexRange> ranges = SplitIndexRange(static_cast<unsigned long>(sizes.size()));
+        QtConcurrent::blockingMap(ranges, boost::bind(&MeshIndexRowsBuilder::Count, this, _1));
+        table.Allocate(sizes);
+        rows = &table;
+        QtConcurrent::blockingMap(ranges, boost::bind(&MeshIndexRowsBuilder::Fill, this, _1));
+        rows = 0;
+    }
+
+private:
+    void Count(const IndexRange& range)
+    {
+        std::vector<unsigned long> row;
+        for (unsigned long i = range.first; i < range.second; i++) {
+            collector(i, row);
+            sizes[i] = static_cast<unsigned long>(row.size());
+        }
+    }
+    void Fill(const IndexRange& range)
+    {
+        std::vector<unsigned long> row;
+        for (unsigned long i = range.first; i < range.second; i++) {
+            collector(i, row);
+            if (!row.empty())
+                std::copy(row.begin(), row.end(), rows->Data(i));
+        }
+    }
+
+private:
+    const Collector& collector;
+    std::vector<unsigned long> sizes;
+    MeshIndexRows* rows;
+};
+
+/** Collects the points connected with a point by an edge. */
+class PointToPointsCollector
+{
+public:
+    PointToPointsCollector(const MeshFacetArray& f, const MeshIndexRows& p2f)
+      : facets(f), pointToFacets(p2f)
+    {
+    }
+    void operator()(unsigned long pos, std::vector<unsigned long>& row) const
+    {
+        row.clear();
+        MeshIndexRows::Row faces = pointToFacets[pos];
+        for (MeshIndexRows::const_iterator it = faces.begin(); it != faces.end(); ++it) {
+            const MeshFacet& face = facets[*it];
+            for (int i = 0; i < 3; i++) {
+                if (face._aulPoints[i] != pos)
+                    row.push_back(face._aulPoints[i]);
+            }
+        }
+        std::sort(row.begin(), row.end());
+        row.erase(std::unique(row.begin(), row.end()), row.end());
+    }
+
+private:
+    const MeshFacetArray& facets;
+    const MeshIndexRows& pointToFacets;
+};
+
+/** Collects the facets sharing at least one point with a facet, including the facet itself. */
+class FacetToFacetsCollector
+{
+public:
+    FacetToFacetsCollector(const MeshFacetArray& f, const MeshIndexRows& p2f)
+      : facets(f), pointToFacets(p2f)
+    {
+    }
+    void operator()(unsigned long pos, std::vector<unsigned long>& row) const
+    {
+        row.clear();
+        const MeshFacet& face = facets[pos];
+        for (int i = 0; i < 3; i++) {
+            MeshIndexRows::Row faces = pointToFacets[face._aulPoints[i]];
+            row.insert(row.end(), faces.begin(), faces.end());
+        }
+        std::sort(row.begin(), row.end());
+        row.erase(std::unique(row.begin(), row.end()), row.end());
+    }
+
+private:
+    const MeshFacetArray& facets;
+    const MeshIndexRows& pointToFacets;
+};
+
+} // namespace
+
+MeshIndexRows::const_iterator MeshIndexRows::Row::find(unsigned long value) const
+{
+    const_iterator it = std::lower_bound(_begin, _end, value);
+    if (it != _end && *it == value)
+        return it;
+    return _end;
+}
+
+void MeshIndexRows::Allocate(const std::vector<unsigned long>& rowSizes)
+{
+    _modified.clear();
+    _offsets.resize(rowSizes.size() + 1);
+    _offsets[0] = 0;
+    for (std::size_t i = 0; i < rowSizes.size(); i++)
+        _offsets[i+1] = _offsets[i] + rowSizes[i];
+    _indices.resize(_offsets.back());
+}
+
+MeshIndexRows::Row MeshIndexRows::operator[] (unsigned long row) const
+{
+    if (!_modified.empty()) {
+        std::map<unsigned long, std::vector<unsigned long> >::const_iterator it = _modified.find(row);
+        if (it != _modified.end()) {
+            const std::vector<unsigned long>& values = it->second;
+            if (values.empty())
+                return Row();
+            return Row(&values[0], &values[0] + values.size());
+        }
+    }
+
+    if (_indices.empty())
+        return Row();
+    const unsigned long* base = &_indices[0];
+    return Row(base + _offsets[row], base + _offsets[row+1]);
+}
+
+void MeshIndexRows::Clear()
+{
+    _offsets.clear();
+    _indices.clear();
+    _modified.clear();
+}
+
+std::vector<unsigned long>& MeshIndexRows::ModifiableRow(unsigned long row)
+{
+    std::map<unsigned long, std::vector<unsigned long> >::iterator it = _modified.find(row);
+    if (it != _modified.end())
+        return it->second;
+
+    Row values = (*this)[row];
+    std::vector<unsigned long>& copy = _modified[row];
+    copy.assign(values.begin(), values.end());
+    return copy;
+}
+
+void MeshIndexRows::Insert(unsigned long row, unsigned long value)
+{
+    std::vector<unsigned long>& values = ModifiableRow(row);
+    std::vector<unsigned long>::iterator it = std::lower_bound(values.begin(), values.end(), value);
+    if (it == values.end() || *it != value)
+        values.insert(it, value);
+}
+
+void MeshIndexRows::Erase(unsigned long row, unsigned long value)
+{
+    std::vector<unsigned long>& values = ModifiableRow(row);
+    std::vector<unsigned long>::iterator it = std::lower_bound(values.begin(), values.end(), value);
+    if (it != values.end() && *it == value)
+        values.erase(it);
+}
+
+void MeshIndexRows::Compact()
+{
+    if (_modified.empty())
+        return;
+
+    unsigned long count = CountRows();
+    std::vector<unsigned long> offsets(count + 1);
+    std::vector<unsigned long> indices;
+    indices.reserve(_indices.size());
+    for (unsigned long i = 0; i < count; i++) {
+        Row values = (*this)[i];
+        offsets[i] = static_cast<unsigned long>(indices.size());
+        indices.insert(indices.end(), values.begin(), values.end());
+    }
+    offsets[count] = static_cast<unsigned long>(indices.size());
+
+    _offsets.swap(offsets);
+    _indices.swap(indices);
+    _modified.clear();
+}
+
+//----------------------------------------------------------------------------
+
+void MeshCompactPointToFacets::Rebuild (void)
+{
+    _rows.Clear();
+
+    const MeshPointArray& rPoints = _rclMesh.GetPoints();
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
+
+    // count the facets of each point
+    std::vector<unsigned long> count(rPoints.size(), 0);
+    for (MeshFacetArray::_TConstIterator pFIter = rFacets.begin(); pFIter != rFacets.end(); ++pFIter) {
+        unsigned long ulP0 = pFIter->_aulPoints[0];
+        unsigned long ulP1 = pFIter->_aulPoints[1];
+        unsigned long ulP2 = pFIter->_aulPoints[2];
+        count[ulP0]++;
+        if (ulP1 != ulP0)
+            count[ulP1]++;
+        if (ulP2 != ulP0 && ulP2 != ulP1)
+            count[ulP2]++;
+    }
+
+    _rows.Allocate(count);
+
+    // the facets are visited in ascending order so that each row is sorted
+    std::fill(count.begin(), count.end(), 0);
+    MeshFacetArray::_TConstIterator pFBegin = rFacets.begin();
+    for (MeshFacetArray::_TConstIterator pFIter = rFacets.begin(); pFIter != rFacets.end(); ++pFIter) {
+        unsigned long index = pFIter - pFBegin;
+        unsigned long ulP0 = pFIter->_aulPoints[0];
+        unsigned long ulP1 = pFIter->_aulPoints[1];
+        unsigned long ulP2 = pFIter->_aulPoints[2];
+        _rows.Data(ulP0)[count[ulP0]++] = index;
+        if (ulP1 != ulP0)
+            _rows.Data(ulP1)[count[ulP1]++] = index;
+        if (ulP2 != ulP0 && ulP2 != ulP1)
+            _rows.Data(ulP2)[count[ulP2]++] = index;
+    }
+}
+
+Base::Vector3f MeshCompactPointToFacets::GetNormal(unsigned long pos) const
+{
+    Row n = _rows[pos];
+    Base::Vector3f normal;
+    MeshGeomFacet f;
+    for (Row::const_iterator it = n.begin(); it != n.end(); ++it) {
+        f = _rclMesh.GetFacet(*it);
+        normal += f.Area() * f.GetNormal();
+    }
+
+    normal.Normalize();
+    return normal;
+}
+
+std::set<unsigned long> MeshCompactPointToFacets::NeighbourPoints(const std::vector<unsigned long>& pt, int level) const
+{
+    std::set<unsigned long> cp,nb,lp;
+    cp.insert(pt.begin(), pt.end());
+    lp.insert(pt.begin(), pt.end());
+    MeshFacetArray::_TConstIterator f_it = _rclMesh.GetFacets().begin();
+    for (int i=0; i < level; i++) {
+        std::set<unsigned long> cur;
+        for (std::set<unsigned long>::iterator it = lp.begin(); it != lp.end(); ++it) {
+            Row ft = _rows[*it];
+            for (Row::const_iterator jt = ft.begin(); jt != ft.end(); ++jt) {
+                for (int j = 0; j < 3; j++) {
+                    unsigned long index = f_it[*jt]._aulPoints[j];
+                    if (cp.find(index) == cp.end() && nb.find(index) == nb.end()) {
+                        nb.insert(index);
+                        cur.insert(index);
+                    }
+                }
+            }
+        }
+
+        lp = cur;
+        if (lp.empty())
+            break;
+    }
+    return nb;
+}
+
+void MeshCompactPointToFacets::Neighbours (unsigned long ulFacetInd, float fMaxDist, MeshCollector& collect) const
+{
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
+    Base::Vector3f clCenter = _rclMesh.GetFacet(ulFacetInd).GetGravityPoint();
+    float fMaxDist2 = fMaxDist * fMaxDist;
+
+    // Use an explicit stack instead of recursion, the set of reached facets doesn't
+    // depend on the visiting order.
+    std::set<unsigned long> visited;
+    std::vector<unsigned long> stack;
+    stack.push_back(ulFacetInd);
+    while (!stack.empty()) {
+        unsigned long index = stack.back();
+        stack.pop_back();
+        if (visited.find(index) != visited.end())
+            continue;
+
+        const MeshFacet& face = rFacets[index];
+        if (Base::DistanceP2(clCenter, _rclMesh.GetFacet(face).GetGravityPoint()) > fMaxDist2)
+            continue;
+
+        visited.insert(index);
+        collect.Append(_rclMesh, index);
+        for (int i = 0; i < 3; i++) {
+            Row f = _rows[face._aulPoints[i]];
+            for (Row::const_iterator j = f.begin(); j != f.end(); ++j) {
+                if (visited.find(*j) == visited.end())
+                    stack.push_back(*j);
+            }
+        }
+    }
+}
+
+MeshFacetArray::_TConstIterator
+MeshCompactPointToFacets::GetFacet (unsigned long index) const
+{
+    return _rclMesh.GetFacets().begin() + index;
+}
+
+void MeshCompactPointToFacets::AddNeighbour(unsigned long pos, unsigned long facet)
+{
+    _rows.Insert(pos, facet);
+}
+
+void MeshCompactPointToFacets::RemoveNeighbour(unsigned long pos, unsigned long facet)
+{
+    _rows.Erase(pos, facet);
+}
+
+void MeshCompactPointToFacets::Compact()
+{
+    _rows.Compact();
+}
+
+//----------------------------------------------------------------------------
+
+void MeshCompactFacetToFacets::Rebuild (void)
+{
+    _rows.Clear();
+
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
+    MeshCompactPointToFacets vertexFace(_rclMesh);
+    FacetToFacetsCollector collector(rFacets, vertexFace.GetRows());
+    MeshIndexRowsBuilder<FacetToFacetsCollector> builder(collector, static_cast<unsigned long>(rFacets.size()));
+    builder.Build(_rows);
+}
+
+//----------------------------------------------------------------------------
+
+void MeshCompactPointToPoints::Rebuild (void)
+{
+    _rows.Clear();
+
+    const MeshPointArray& rPoints = _rclMesh.GetPoints();
+    MeshCompactPointToFacets vertexFace(_rclMesh);
+    PointToPointsCollector collector(_rclMesh.GetFacets(), vertexFace.GetRows());
+    MeshIndexRowsBuilder<PointToPointsCollector> builder(collector, static_cast<unsigned long>(rPoints.size()));
+    builder.Build(_rows);
+}
+
+Base::Vector3f MeshCompactPointToPoints::GetNormal(unsigned long pos) const
+{
+    const MeshPointArray& rPoints = _rclMesh.GetPoints();
+    MeshCore::PlaneFit pf;
+    pf.AddPoint(rPoints[pos]);
+    Row cv = _rows[pos];
+    for (Row::const_iterator cv_it = cv.begin(); cv_it != cv.end(); ++cv_it) {
+        pf.AddPoint(rPoints[*cv_it]);
+    }
+
+    pf.Fit();
+
+    Base::Vector3f normal = pf.GetNormal();
+    normal.Normalize();
+    return normal;
+}
+
+float MeshCompactPointToPoints::GetAverageEdgeLength(unsigned long index) const
+{
+    const MeshPointArray& rPoints = _rclMesh.GetPoints();
+    float len=0.0f;
+    Row n = _rows[index];
+    const Base::Vector3f& p = rPoints[index];
+    for (Row::const_iterator it = n.begin(); it != n.end(); ++it) {
+        len += Base::Distance(p, rPoints[*it]);
+    }
+    return (len/n.size());
+}
+
+void MeshCompactPointToPoints::AddNeighbour(unsigned long pos, unsigned long point)
+{
+    _rows.Insert(pos, point);
+}
+
+void MeshCompactPointToPoints::RemoveNeighbour(unsigned long pos, unsigned long point)
+{
+    _rows.Erase(pos, point);
+}
+
+void MeshCompactPointToPoints::Compact()
+{
+    _rows.Compact();
+}
@@ -47,6 +47,7 @@ class MeshKernel;
 class MeshFacetGrid;
 class MeshFacetArray;
 class MeshRefPointToFacets;
+class MeshCompactPointToFacets;
 class AbstractPolygonTriangulator;
 
 /**
@@ -167,7 +168,7 @@ public:
   bool FillupHole(const std::vector<unsigned long>& boundary,
                   AbstractPolygonTriangulator& cTria,
                   MeshFacetArray& rFaces, MeshPointArray& rPoints,
-                  int level, const MeshRefPointToFacets* pP2FStructure=0) const;
+                  int level, const MeshCompactPointToFacets* pP2FStructure=0) const;
   /** Sets to all facets in \a raulInds the properties in raulProps. 
    * \note Both arrays must have the same size.
    */
@@ -509,6 +510,181 @@ protected:
     std::vector<Base::Vector3f> _norm;
 };
 
+/**
+ * The MeshIndexRows class stores a list of index rows in compressed sparse row format:
+ * one offsets array and one flat array with the indices of all rows. Each row is kept
+ * sorted so that look-ups can be done with a binary search.
+ * Rows can be modified with Insert() and Erase(). Modified rows are kept in a separate
+ * overlay until Compact() merges them back into the flat arrays.
+ * \note A Row returned by operator[] becomes invalid when the table is modified.
+ */
+class MeshExport MeshIndexRows
+{
+public:
+    typedef const unsigned long* const_iterator;
+
+    /** A read-only view on a single row. */
+    class Row
+    {
+    public:
+        typedef MeshIndexRows::const_iterator const_iterator;
+        typedef const_iterator iterator;
+
+        Row() : _begin(0), _end(0) {}
+        Row(const_iterator b, const_iterator e) : _begin(b), _end(e) {}
+
+        const_iterator begin() const { return _begin; }
+        const_iterator end() const { return _end; }
+        std::size_t size() const { return _end - _begin; }
+        bool empty() const { return _begin == _end; }
+        unsigned long operator[] (std::size_t i) const { return _begin[i]; }
+        /// Returns an iterator to \a value or end() if the row doesn't contain it.
+        const_iterator find(unsigned long value) const;
+        std::size_t count(unsigned long value) const
+        { return find(value) != _end ? 1 : 0; }
+
+    private:
+        const_iterator _begin;
+        const_iterator _end;
+    };
+
+    MeshIndexRows() {}
+
+    /// Allocates the table for the given row sizes. The rows must be filled with Data() afterwards.
+    void Allocate(const std::vector<unsigned long>& rowSizes);
+    /// Writable start of row \a row after Allocate(). Each row must be filled sorted and unique.
+    unsigned long* Data(unsigned long row)
+    { return &_indices[0] + _offsets[row]; }
+    unsigned long CountRows() const
+    { return _offsets.empty() ? 0 : static_cast<unsigned long>(_offsets.size() - 1); }
+    Row operator[] (unsigned long row) const;
+    void Clear();
+
+    /// Adds \a value to row \a row. The row is moved to the overlay.
+    void Insert(unsigned long row, unsigned long value);
+    /// Removes \a value from row \a row. The row is moved to the overlay.
+    void Erase(unsigned long row, unsigned long value);
+    /// Returns true if rows were modified since the last Compact().
+    bool IsModified() const
+    { return !_modified.empty(); }
+    /// Merges the modified rows back into the flat arrays.
+    void Compact();
+
+private:
+    std::vector<unsigned long>& ModifiableRow(unsigned long row);
+
+private:
+    std::vector<unsigned long> _offsets; /**< Start of each row, the last entry is the total size. */
+    std::vector<unsigned long> _indices; /**< The indices of all rows. */
+    std::map<unsigned long, std::vector<unsigned long> > _modified; /**< Rows changed since the last Compact(). */
+};
+
+/**
+ * The MeshCompactPointToFacets class provides the same information as MeshRefPointToFacets
+ * but stores it in a MeshIndexRows table which is much more compact than one std::set per
+ * point. The rows are sorted by facet index.
+ * AddNeighbour() and RemoveNeighbour() modify the table in an overlay that is merged back
+ * with Compact().
+ * \note If the underlying mesh kernel gets changed this structure becomes invalid and must
+ * be rebuilt.
+ */
+class MeshExport MeshCompactPointToFacets
+{
+public:
+    typedef MeshIndexRows::Row Row;
+
+    /// Construction
+    MeshCompactPointToFacets (const MeshKernel &rclM) : _rclMesh(rclM)
+    { Rebuild(); }
+    /// Destruction
+    ~MeshCompactPointToFacets (void)
+    { }
+
+    /// Rebuilds up data structure
+    void Rebuild (void);
+    Row operator[] (unsigned long pos) const
+    { return _rows[pos]; }
+    /// Gives access to the raw table e.g. to build derived structures.
+    const MeshIndexRows& GetRows() const
+    { return _rows; }
+    MeshFacetArray::_TConstIterator GetFacet (unsigned long) const;
+    std::set<unsigned long> NeighbourPoints(const std::vector<unsigned long>& , int level) const;
+    void Neighbours (unsigned long ulFacetInd, float fMaxDist, MeshCollector& collect) const;
+    Base::Vector3f GetNormal(unsigned long) const;
+    void AddNeighbour(unsigned long, unsigned long);
+    void RemoveNeighbour(unsigned long, unsigned long);
+    void Compact();
+
+protected:
+    const MeshKernel  &_rclMesh; /**< The mesh kernel. */
+    MeshIndexRows _rows;
+};
+
+/**
+ * The MeshCompactFacetToFacets class provides the same information as MeshRefFacetToFacets
+ * stored in a MeshIndexRows table. The rows are filled in parallel.
+ * \note If the underlying mesh kernel gets changed this structure becomes invalid and must
+ * be rebuilt.
+ */
+class MeshExport MeshCompactFacetToFacets
+{
+public:
+    typedef MeshIndexRows::Row Row;
+
+    /// Construction
+    MeshCompactFacetToFacets (const MeshKernel &rclM) : _rclMesh(rclM)
+    { Rebuild(); }
+    /// Destruction
+    ~MeshCompactFacetToFacets (void)
+    { }
+    /// Rebuilds up data structure
+    void Rebuild (void);
+
+    /// Returns the facets sharing one or more points with the facet with
+    /// index \a ulFacetIndex.
+    Row operator[] (unsigned long pos) const
+    { return _rows[pos]; }
+
+protected:
+    const MeshKernel  &_rclMesh; /**< The mesh kernel. */
+    MeshIndexRows _rows;
+};
+
+/**
+ * The MeshCompactPointToPoints class provides the same information as MeshRefPointToPoints
+ * stored in a MeshIndexRows table. The rows are filled in parallel.
+ * AddNeighbour() and RemoveNeighbour() modify the table in an overlay that is merged back
+ * with Compact().
+ * \note If the underlying mesh kernel gets changed this structure becomes invalid and must
+ * be rebuilt.
+ */
+class MeshExport MeshCompactPointToPoints
+{
+public:
+    typedef MeshIndexRows::Row Row;
+
+    /// Construction
+    MeshCompactPointToPoints (const MeshKernel &rclM) : _rclMesh(rclM)
+    { Rebuild(); }
+    /// Destruction
+    ~MeshCompactPointToPoints (void)
+    { }
+
+    /// Rebuilds up data structure
+    void Rebuild (void);
+    Row operator[] (unsigned long pos) const
+    { return _rows[pos]; }
+    Base::Vector3f GetNormal(unsigned long) const;
+    float GetAverageEdgeLength(unsigned long) const;
+    void AddNeighbour(unsigned long, unsigned long);
+    void RemoveNeighbour(unsigned long, unsigned long);
+    void Compact();
+
+protected:
+    const MeshKernel  &_rclMesh; /**< The mesh kernel. */
+    MeshIndexRows _rows;
+};
+
 }; // namespace MeshCore 
 
 #endif  // MESH_ALGORITHM_H 
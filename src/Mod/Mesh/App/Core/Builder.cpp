@@ -30,6 +30,9 @@
 #include <Base/Sequencer.h>
 #include <Base/Exception.h>
 
+#include <QThread>
+#include <QtConcurrentMap>
+
 #include "Builder.h"
 #include "MeshKernel.h"
 
@@ -253,3 +256,176 @@ void MeshBuilder::Finish (bool freeMemory)
 
     _meshKernel.RecalcBoundBox();
 }
+
+// ----------------------------------------------------------------------------
+
+namespace MeshCore {
+
+/** Sorts the chunks of an array in parallel and merges them pairwise. */
+template <class T>
+class ParallelSort
+{
+public:
+    typedef typename std::vector<T>::iterator Iterator;
+    struct Range
+    {
+        Iterator first, middle, last;
+    };
+
+    static void Sort(std::vector<T>& data)
+    {
+        std::size_t count = data.size();
+        std::size_t chunks = static_cast<std::size_t>(std::max<int>(QThread::idealThreadCount(), 1)) * 2;
+        if (count < 65536 || chunks < 2) {
+            std::sort(data.begin(), data.end());
+            return;
+        }
+
+        std::size_t step = (count + chunks - 1) / chunks;
+        std::vector<std::size_t> bounds;
+        for (std::size_t i = 0; i < count; i += step)
+            bounds.push_back(i);
+        bounds.push_back(count);
+
+        std::vector<Range> ranges;
+        for (std::size_t i = 0; i + 1 < bounds.size(); i++)
+            ranges.push_back(MakeRange(data, bounds[i], bounds[i+1], bounds[i+1]));
+        QtConcurrent::blockingMap(ranges, &ParallelSort::SortRange);
+
+        while (bounds.size() > 2) {
+            std::vector<Range> merges;
+            std::vector<std::size_t> next;
+            std::size_t i = 0;
+            for (; i + 2 < bounds.size(); i += 2) {
+                merges.push_back(MakeRange(data, bounds[i], bounds[i+1], bounds[i+2]));
+                next.push_back(bounds[i]);
+            }
+            // an odd chunk is merged in the next round
+            if (i + 1 < bounds.size())
+                next.push_back(bounds[i]);
+            next.push_back(count);
+
+            QtConcurrent::blockingMap(merges, &ParallelSort::MergeRange);
+            bounds.swap(next);
+        }
+    }
+
+private:
+    static Range MakeRange(std::vector<T>& data, std::size_t first, std::size_t middle, std::size_t last)
+    {
+        Range range;
+        range.first = data.begin() + first;
+        range.middle = data.begin() + middle;
+        range.last = data.begin() + last;
+        return range;
+    }
+    static void SortRange(Range& range)
+    {
+        std::sort(range.first, range.last);
+    }
+    static void MergeRange(Range& range)
+    {
+        std::inplace_merge(range.first, range.middle, range.last);
+    }
+};
+
+}
+
+MeshFastBuilder::MeshFastBuilder (MeshKernel& kernel) : _meshKernel(kernel), _seq(0)
+{
+}
+
+MeshFastBuilder::~MeshFastBuilder (void)
+{
+    delete this->_seq;
+}
+
+void MeshFastBuilder::Initialize (unsigned long ctFacets)
+{
+    _vertices.clear();
+    _vertices.reserve(3 * ctFacets);
+
+    delete this->_seq;
+    this->_seq = new Base::SequencerLauncher("create mesh structure...", ctFacets);
+}
+
+void MeshFastBuilder::AddFacet (const MeshGeomFacet& facet)
+{
+    Base::Vector3f facetPoints[4] = { facet._aclPoints[0], facet._aclPoints[1], facet._aclPoints[2], facet.GetNormal() };
+    AddFacet(facetPoints);
+}
+
+void MeshFastBuilder::AddFacet (const Base::Vector3f* facetPoints)
+{
+    this->_seq->next(true); // allow to cancel
+
+    // adjust circulation direction
+    int order[3] = { 0, 1, 2 };
+    if ((((facetPoints[1] - facetPoints[0]) % (facetPoints[2] - facetPoints[0])) * facetPoints[3]) < 0.0f)
+        std::swap(order[1], order[2]);
+
+    for (int i = 0; i < 3; i++) {
+        const Base::Vector3f& pt = facetPoints[order[i]];
+        Vertex v;
+        v.x = pt.x;
+        v.y = pt.y;
+        v.z = pt.z;
+        v.i = _vertices.size();
+        _vertices.push_back(v);
+    }
+}
+
+void MeshFastBuilder::SortVertices (std::vector<Vertex>& vertices)
+{
+    ParallelSort<Vertex>::Sort(vertices);
+}
+
+void MeshFastBuilder::Finish ()
+{
+    unsigned long ctVertices = _vertices.size();
+    std::vector<Base::Vector3f> groupPoints;
+    std::vector<unsigned long> group(ctVertices);
+
+    // vertices with the same coordinates are adjacent after sorting
+    SortVertices(_vertices);
+    for (unsigned long i = 0; i < ctVertices; i++) {
+        const Vertex& v = _vertices[i];
+        if (i == 0 || !_vertices[i-1].IsSamePoint(v))
+            groupPoints.push_back(Base::Vector3f(v.x, v.y, v.z));
+        group[v.i] = groupPoints.size() - 1;
+    }
+
+    // free the memory of the vertices immediately
+    { std::vector<Vertex>().swap(_vertices); }
+
+    // create the points in the order they are used by the facets and skip degenerated facets
+    std::vector<unsigned long> index(groupPoints.size(), ULONG_MAX);
+    MeshPointArray points;
+    points.reserve(groupPoints.size());
+    MeshFacetArray facets;
+    facets.reserve(ctVertices / 3);
+    for (unsigned long i = 0; i + 2 < ctVertices; i += 3) {
+        unsigned long g0 = group[i];
+        unsigned long g1 = group[i+1];
+        unsigned long g2 = group[i+2];
+        if (g0 == g1 || g0 == g2 || g1 == g2)
+            continue;
+
+        MeshFacet face;
+        unsigned long groups[3] = { g0, g1, g2 };
+        for (int j = 0; j < 3; j++) {
+            unsigned long& idx = index[groups[j]];
+            if (idx == ULONG_MAX) {
+                idx = points.size();
+                points.push_back(MeshPoint(groupPoints[groups[j]]));
+            }
+            face._aulPoints[j] = idx;
+        }
+        facets.push_back(face);
+    }
+
+    delete this->_seq;
+    this->_seq = 0;
+
+    _meshKernel.Adopt(points, facets, true);
+}
@@ -164,6 +164,75 @@ private:
     float _fSaveTolerance;
 };
 
+/**
+ * Class for creating the mesh structure from a large number of facets, e.g. when importing a file.
+ * Unlike MeshBuilder it doesn't look up the vertices while adding the facets. All vertices are
+ * collected first and Finish() welds them by sorting their coordinates in parallel.
+ * \note Only vertices with exactly the same coordinates are merged, there is no tolerance.
+ * \code
+ * // Sample Code for building a mesh structure
+ * MeshFastBuilder builder(someMeshReference);
+ * builder.Initialize(numberOfFacets);
+ * ...
+ * for (...)
+ *   builder.AddFacet(...);
+ * ...
+ * builder.Finish();
+ * \endcode
+ */
+class MeshExport MeshFastBuilder
+{
+private:
+    struct Vertex
+    {
+        float x, y, z;
+        unsigned long i;
+
+        bool operator < (const Vertex &v) const
+        {
+            if (x != v.x)
+                return x < v.x;
+            if (y != v.y)
+                return y < v.y;
+            if (z != v.z)
+                return z < v.z;
+            return i < v.i;
+        }
+        bool IsSamePoint (const Vertex &v) const
+        {
+            return x == v.x && y == v.y && z == v.z;
+        }
+    };
+
+    MeshKernel& _meshKernel;
+    std::vector<Vertex> _vertices;
+    Base::SequencerLauncher* _seq;
+
+    static void SortVertices(std::vector<Vertex>&);
+
+public:
+    MeshFastBuilder(MeshKernel &rclM);
+    ~MeshFastBuilder(void);
+
+    /** Initializes the class. Must be done before adding facets
+     * @param ctFacets count of facets.
+     */
+    void Initialize (unsigned long ctFacets);
+    /** Add new facet
+     */
+    void AddFacet (const MeshGeomFacet& facet);
+    /** Add new facet
+     * @param facetPoints Array of vectors (size 4) in order of vec1, vec2,
+     *                    vec3, normal. The orientation of the facet is
+     *                    adjusted to the normal.
+     */
+    void AddFacet (const Base::Vector3f* facetPoints);
+    /** Finishes building up the mesh structure. Must be done after adding facets.
+     * Degenerated facets are skipped and the neighbourhood is computed.
+     */
+    void Finish ();
+};
+
 } // namespace MeshCore
 
 #endif 
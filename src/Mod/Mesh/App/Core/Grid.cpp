@@ -27,6 +27,10 @@
 # include <algorithm>
 #endif
 
+#include <QThread>
+#include <QtConcurrentMap>
+#include <boost/bind.hpp>
+
 #include "Grid.h"
 #include "Iterator.h"
 
@@ -62,7 +66,8 @@ void MeshGrid::Attach (const MeshKernel &rclM)
 
 void MeshGrid::Clear (void)
 {
-  _aulGrid.clear();
+  _aulGridOffsets.clear();
+  _aulGridElements.clear();
   _pclMesh = NULL;  
 }
 
@@ -93,8 +98,6 @@ void MeshGrid::InitGrid (void)
 {
   assert(_pclMesh != NULL);
 
-  unsigned long i, j;
-
   // Grid Laengen berechnen wenn nicht initialisiert
   //
   if ((_ulCtGridsX == 0) || (_ulCtGridsY == 0) || (_ulCtGridsZ == 0))
@@ -128,13 +131,61 @@ void MeshGrid::InitGrid (void)
   }
 
   // Daten-Struktur anlegen
-  _aulGrid.clear();
-  _aulGrid.resize(_ulCtGridsX);
-  for (i = 0; i < _ulCtGridsX; i++)
+  _aulGridOffsets.assign(_ulCtGridsX * _ulCtGridsY * _ulCtGridsZ + 1, 0);
+  _aulGridElements.clear();
+}
+
+void MeshGrid::FillGrid (void)
+{
+  unsigned long ulCtGrids = _ulCtGridsX * _ulCtGridsY * _ulCtGridsZ;
+  unsigned long ulCtElements = HasElements();
+
+  // split the elements into a few chunks per thread, each chunk collects its grid assignments
+  unsigned long ulCtChunks = static_cast<unsigned long>(std::max<int>(QThread::idealThreadCount(), 1)) * 4;
+  unsigned long ulStep = std::max<unsigned long>((ulCtElements + ulCtChunks - 1) / ulCtChunks, 1024);
+  std::vector<GridChunk> aclChunks;
+  for (unsigned long i = 0; i < ulCtElements; i += ulStep)
+  {
+    GridChunk clChunk;
+    clChunk.ulBegin = i;
+    clChunk.ulEnd = std::min<unsigned long>(i + ulStep, ulCtElements);
+    aclChunks.push_back(clChunk);
+  }
+
+  QtConcurrent::blockingMap(aclChunks, boost::bind(&MeshGrid::FillGridChunk, this, _1));
+
+  // count the elements per grid
+  std::vector<unsigned long> aulOffsets(ulCtGrids + 1, 0);
+  for (std::vector<GridChunk>::iterator it = aclChunks.begin(); it != aclChunks.end(); ++it)
+  {
+    for (std::vector<std::pair<unsigned long, unsigned long> >::iterator jt = it->aclEntries.begin(); jt != it->aclEntries.end(); ++jt)
+      aulOffsets[jt->first + 1]++;
+  }
+  for (unsigned long i = 0; i < ulCtGrids; i++)
+    aulOffsets[i + 1] += aulOffsets[i];
+
+  // the chunks are in ascending order so the elements of each grid end up sorted
+  std::vector<unsigned long> aulElements(aulOffsets.back());
+  std::vector<unsigned long> aulPos(aulOffsets.begin(), aulOffsets.end() - 1);
+  for (std::vector<GridChunk>::iterator it = aclChunks.begin(); it != aclChunks.end(); ++it)
+  {
+    for (std::vector<std::pair<unsigned long, unsigned long> >::iterator jt = it->aclEntries.begin(); jt != it->aclEntries.end(); ++jt)
+      aulElements[aulPos[jt->first]++] = jt->second;
+  }
+
+  _aulGridOffsets.swap(aulOffsets);
+  _aulGridElements.swap(aulElements);
+}
+
+void MeshGrid::FillGridChunk (GridChunk &rclChunk) const
+{
+  std::vector<unsigned long> aulGrids;
+  for (unsigned long i = rclChunk.ulBegin; i < rclChunk.ulEnd; i++)
   {
-    _aulGrid[i].resize(_ulCtGridsY);
-    for (j = 0; j < _ulCtGridsY; j++)
-      _aulGrid[i][j].resize(_ulCtGridsZ);
+    aulGrids.clear();
+    GetGridsOfElement(i, aulGrids);
+    for (std::vector<unsigned long>::iterator it = aulGrids.begin(); it != aulGrids.end(); ++it)
+      rclChunk.aclEntries.push_back(std::make_pair(*it, i));
   }
 }
 
@@ -155,7 +206,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsig
     {
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
-        raulElements.insert(raulElements.end(), _aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+        raulElements.insert(raulElements.end(), GetElementsBegin(i, j, k), GetElementsEnd(i, j, k));
       }
     }
   }  
@@ -190,7 +241,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsig
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
         if (Base::DistanceP2(GetBoundBox(i, j, k).GetCenter(), rclOrg) < fMinDistP2)
-          raulElements.insert(raulElements.end(), _aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+          raulElements.insert(raulElements.end(), GetElementsBegin(i, j, k), GetElementsEnd(i, j, k));
       }
     }
   }  
@@ -221,7 +272,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::set<unsigned
     {
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
-        raulElements.insert(_aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+        raulElements.insert(GetElementsBegin(i, j, k), GetElementsEnd(i, j, k));
       }
     }
   }  
@@ -478,7 +529,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsY; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[nX][i][j].begin(), _aulGrid[nX][i][j].end());
+              raclInd.insert(GetElementsBegin(nX, i, j), GetElementsEnd(nX, i, j));
           }
           nX++;
         }
@@ -492,9 +543,9 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsY; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[nX][i][j].begin(), _aulGrid[nX][i][j].end());
+              raclInd.insert(GetElementsBegin(nX, i, j), GetElementsEnd(nX, i, j));
           }
-          nX++;
+          nX--;
         }
         break;
       }
@@ -506,7 +557,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[i][nY][j].begin(), _aulGrid[i][nY][j].end());
+              raclInd.insert(GetElementsBegin(i, nY, j), GetElementsEnd(i, nY, j));
           }
           nY++;
         }
@@ -520,7 +571,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[i][nY][j].begin(), _aulGrid[i][nY][j].end());
+              raclInd.insert(GetElementsBegin(i, nY, j), GetElementsEnd(i, nY, j));
           }
           nY--;
         }
@@ -534,7 +585,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsY; j++)
-              raclInd.insert(_aulGrid[i][j][nZ].begin(), _aulGrid[i][j][nZ].end());
+              raclInd.insert(GetElementsBegin(i, j, nZ), GetElementsEnd(i, j, nZ));
           }
           nZ++;
         }
@@ -548,7 +599,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsY; j++)
-              raclInd.insert(_aulGrid[i][j][nZ].begin(), _aulGrid[i][j][nZ].end());
+              raclInd.insert(GetElementsBegin(i, j, nZ), GetElementsEnd(i, j, nZ));
           }
           nZ--;
         }
@@ -614,11 +665,12 @@ void MeshGrid::GetHull (unsigned long ulX, unsigned long ulY, unsigned long ulZ,
 unsigned long MeshGrid::GetElements (unsigned long ulX, unsigned long ulY, unsigned long ulZ,  
                                      std::set<unsigned long> &raclInd) const
 {
-  const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
-  if (rclSet.size() > 0)
+  const unsigned long* pBegin = GetElementsBegin(ulX, ulY, ulZ);
+  const unsigned long* pEnd = GetElementsEnd(ulX, ulY, ulZ);
+  if (pBegin != pEnd)
   {
-    raclInd.insert(rclSet.begin(), rclSet.end());
-    return rclSet.size();
+    raclInd.insert(pBegin, pEnd);
+    return pEnd - pBegin;
   }
 
   return 0;
@@ -630,9 +682,7 @@ unsigned long MeshGrid::GetElements(const Base::Vector3f &rclPoint, std::vector<
   if (!CheckPosition(rclPoint, ulX, ulY, ulZ))
     return 0;
 
-  aulFacets.resize(_aulGrid[ulX][ulY][ulZ].size());
-
-  std::copy(_aulGrid[ulX][ulY][ulZ].begin(), _aulGrid[ulX][ulY][ulZ].end(), aulFacets.begin());
+  aulFacets.assign(GetElementsBegin(ulX, ulY, ulZ), GetElementsEnd(ulX, ulY, ulZ));
   return aulFacets.size();
 }
 
@@ -737,15 +787,41 @@ void MeshFacetGrid::RebuildGrid (void)
   InitGrid();
  
   // Daten-Struktur fuellen
-  MeshFacetIterator clFIter(*_pclMesh);
+  FillGrid();
+}
+
+void MeshFacetGrid::GetGridsOfElement (unsigned long ulIndex, std::vector<unsigned long> &raulGrids) const
+{
+  MeshGeomFacet clFacet = _pclMesh->GetFacet(ulIndex);
+
+  unsigned long ulX, ulY, ulZ;
+  unsigned long ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
+
+  Base::BoundBox3f clBB;
+  clBB.Add(clFacet._aclPoints[0]);
+  clBB.Add(clFacet._aclPoints[1]);
+  clBB.Add(clFacet._aclPoints[2]);
+
+  Pos(Base::Vector3f(clBB.MinX,clBB.MinY,clBB.MinZ), ulX1, ulY1, ulZ1);
+  Pos(Base::Vector3f(clBB.MaxX,clBB.MaxY,clBB.MaxZ), ulX2, ulY2, ulZ2);
 
-  unsigned long i = 0;
-  for (clFIter.Init(); clFIter.More(); clFIter.Next())
+  // falls Facet ueber mehrere BB reicht
+  if ((ulX1 < ulX2) || (ulY1 < ulY2) || (ulZ1 < ulZ2))
   {
-//    AddFacet(*clFIter, i++, 2.0f);
-    AddFacet(*clFIter, i++);
+    for (ulX = ulX1; ulX <= ulX2; ulX++)
+    {
+      for (ulY = ulY1; ulY <= ulY2; ulY++)
+      {
+        for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++)
+        {
+          if (clFacet.IntersectBoundingBox(GetBoundBox(ulX, ulY, ulZ)))
+            raulGrids.push_back(GetIndexToPosition(ulX, ulY, ulZ));
+        }
+      }
+    }
   }
-
+  else
+    raulGrids.push_back(GetIndexToPosition(ulX1, ulY1, ulZ1));
 }
 
 unsigned long MeshFacetGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt) const
@@ -946,8 +1022,8 @@ void MeshFacetGrid::SearchNearestFacetInGrid(unsigned long ulX, unsigned long ul
                                              const Base::Vector3f &rclPt, float &rfMinDist,
                                              unsigned long &rulFacetInd) const
 {
-  const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
-  for (std::set<unsigned long>::const_iterator pI = rclSet.begin(); pI != rclSet.end(); ++pI)
+  const unsigned long* pEnd = GetElementsEnd(ulX, ulY, ulZ);
+  for (const unsigned long* pI = GetElementsBegin(ulX, ulY, ulZ); pI != pEnd; ++pI)
   {
     float fDist = _pclMesh->GetFacet(*pI).DistanceToPoint(rclPt);
     if (fDist < rfMinDist)
@@ -992,13 +1068,13 @@ MeshPointGrid::MeshPointGrid (const MeshKernel &rclM, float fGridLen)
           std::max<unsigned long>((unsigned long)(clBBMesh.LengthZ() / fGridLen), 1));
 }
 
-void MeshPointGrid::AddPoint (const MeshPoint &rclPt, unsigned long ulPtIndex, float fEpsilon)
+void MeshPointGrid::GetGridsOfElement (unsigned long ulIndex, std::vector<unsigned long> &raulGrids) const
 {
-  (void)fEpsilon;
+  const MeshPoint& rclPt = _pclMesh->GetPoints()[ulIndex];
   unsigned long ulX, ulY, ulZ;
   Pos(Base::Vector3f(rclPt.x, rclPt.y, rclPt.z), ulX, ulY, ulZ);
   if ( (ulX < _ulCtGridsX) && (ulY < _ulCtGridsY) && (ulZ < _ulCtGridsZ) )
-    _aulGrid[ulX][ulY][ulZ].insert(ulPtIndex);
+    raulGrids.push_back(GetIndexToPosition(ulX, ulY, ulZ));
 }
 
 void MeshPointGrid::Validate (const MeshKernel &rclMesh)
@@ -1049,14 +1125,7 @@ void MeshPointGrid::RebuildGrid (void)
   InitGrid();
  
   // Daten-Struktur fuellen
-
-  MeshPointIterator cPIter(*_pclMesh);
-
-  unsigned long i = 0;
-  for (cPIter.Init(); cPIter.More(); cPIter.Next())
-  {
-    AddPoint(*cPIter, i++);
-  }
+  FillGrid();
 }
 
 void MeshPointGrid::Pos (const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const
@@ -1118,7 +1187,7 @@ bool MeshGridIterator::InitOnRay (const Base::Vector3f &rclPt, const Base::Vecto
   if ((_rclGrid.GetBoundBox().IsInBox(rclPt)) == true)
   {  // Voxel bestimmen, indem der Startpunkt liegt
     _rclGrid.Position(rclPt, _ulX, _ulY, _ulZ);
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+    raulElements.insert(raulElements.end(), _rclGrid.GetElementsBegin(_ulX, _ulY, _ulZ), _rclGrid.GetElementsEnd(_ulX, _ulY, _ulZ));
     _bValidRay = true;
   }
   else
@@ -1131,7 +1200,7 @@ bool MeshGridIterator::InitOnRay (const Base::Vector3f &rclPt, const Base::Vecto
       else
         _rclGrid.Position(cP1, _ulX, _ulY, _ulZ);
 
-      raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+      raulElements.insert(raulElements.end(), _rclGrid.GetElementsBegin(_ulX, _ulY, _ulZ), _rclGrid.GetElementsEnd(_ulX, _ulY, _ulZ));
       _bValidRay = true;
     }
   }
@@ -1182,7 +1251,7 @@ bool MeshGridIterator::NextOnRay (std::vector<unsigned long> &raulElements)
   if ((_bValidRay == true) && (_rclGrid.CheckPos(_ulX, _ulY, _ulZ) == true))
   {
     GridElement pos(_ulX, _ulY, _ulZ); _cSearchPositions.insert(pos);
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end()); 
+    raulElements.insert(raulElements.end(), _rclGrid.GetElementsBegin(_ulX, _ulY, _ulZ), _rclGrid.GetElementsEnd(_ulX, _ulY, _ulZ)); 
   }
   else
     _bValidRay = false;  // Strahl ausgetreten
@@ -25,6 +25,7 @@
 #define MESH_GRID_H
 
 #include <set>
+#include <vector>
 
 #include "MeshKernel.h"
 #include <Base/Vector3D.h>
@@ -96,6 +97,11 @@ public:
   /** Returns the indices of the elements in the given grid. */
   unsigned long GetElements (unsigned long ulX, unsigned long ulY, unsigned long ulZ,  std::set<unsigned long> &raclInd) const;
   unsigned long GetElements (const Base::Vector3f &rclPoint, std::vector<unsigned long>& aulFacets) const;
+  /** Returns a pointer to the first element index of the given grid. The indices of a grid are sorted and
+   * stored contiguously up to GetElementsEnd(), so they can be read without copying them. */
+  inline const unsigned long* GetElementsBegin (unsigned long ulX, unsigned long ulY, unsigned long ulZ) const;
+  /** Returns a pointer past the last element index of the given grid. */
+  inline const unsigned long* GetElementsEnd (unsigned long ulX, unsigned long ulY, unsigned long ulZ) const;
   //@}
 
   /** Returns the lengths of the grid elements in x,y and z direction. */
@@ -125,7 +131,7 @@ public:
   bool GetPositionToIndex(unsigned long id, unsigned long& ulX, unsigned long& ulY, unsigned long& ulZ) const;
   /** Returns the number of elements in a given grid. */
   unsigned long GetCtElements(unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
-  { return _aulGrid[ulX][ulY][ulZ].size(); }
+  { return GetElementsEnd(ulX, ulY, ulZ) - GetElementsBegin(ulX, ulY, ulZ); }
   /** Validates the grid structure and rebuilds it if needed. Must be implemented in sub-classes. */
   virtual void Validate (const MeshKernel &rclM) = 0;
   /** Verifies the grid structure and returns false if inconsistencies are found. */
@@ -155,9 +161,27 @@ protected:
   virtual void RebuildGrid (void) = 0;
   /** Returns the number of stored elements. Must be implemented in sub-classes. */
   virtual unsigned long HasElements (void) const = 0;
+  /** Appends the grid indices (see GetIndexToPosition()) of all grid elements the element with index
+   * \a ulIndex belongs to. Must be implemented in sub-classes and must be thread-safe because
+   * FillGrid() calls it from several threads. */
+  virtual void GetGridsOfElement (unsigned long ulIndex, std::vector<unsigned long> &raulGrids) const = 0;
+  /** Fills the grid structure with all HasElements() elements. The elements are assigned to the
+   * grids in parallel and afterwards stored grid by grid in one contiguous array. Must be called
+   * after InitGrid(). */
+  void FillGrid (void);
+
+  /** A range of elements with the grid indices assigned to them, used by FillGrid(). */
+  struct GridChunk
+  {
+    unsigned long ulBegin, ulEnd;
+    std::vector<std::pair<unsigned long, unsigned long> > aclEntries; /**< Pairs of grid and element index. */
+  };
+  /** Assigns the elements of the chunk to the grids. */
+  void FillGridChunk (GridChunk &rclChunk) const;
 
 protected:
-  std::vector<std::vector<std::vector<std::set<unsigned long> > > >  _aulGrid;   /**< Grid data structure. */
+  std::vector<unsigned long> _aulGridOffsets; /**< Start of each grid in _aulGridElements, the last entry is the total size. */
+  std::vector<unsigned long> _aulGridElements;/**< Sorted element indices of all grids, stored grid by grid. */
   const MeshKernel* _pclMesh;     /**< The mesh kernel. */
   unsigned long     _ulCtElements;/**< Number of grid elements for validation issues. */
   unsigned long     _ulCtGridsX;  /**< Number of grid elements in z. */
@@ -224,10 +248,8 @@ protected:
   inline void Pos (const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const;
   /** Returns the grid numbers to the given point \a rclPoint. */
   inline void PosWithCheck (const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const;
-  /** Adds a new facet element to the grid structure. \a rclFacet is the geometric facet and \a ulFacetIndex 
-   * the corresponding index in the mesh kernel. The facet is added to each grid element that intersects 
-   * the facet. */
-  inline void AddFacet (const MeshGeomFacet &rclFacet, unsigned long ulFacetIndex, float fEpsilon = 0.0f);
+  /** Appends the grid indices of all grid elements that intersect the facet with index \a ulIndex. */
+  virtual void GetGridsOfElement (unsigned long ulIndex, std::vector<unsigned long> &raulGrids) const;
   /** Returns the number of stored elements. */
   unsigned long HasElements (void) const
   { return _pclMesh->CountFacets(); }
@@ -268,9 +290,8 @@ public:
   virtual bool Verify() const;
 
 protected:
-  /** Adds a new point element to the grid structure. \a rclPt is the geometric point and \a ulPtIndex 
-   * the corresponding index in the mesh kernel. */
-  void AddPoint (const MeshPoint &rclPt, unsigned long ulPtIndex, float fEpsilon = 0.0f);
+  /** Appends the grid index of the grid element the point with index \a ulIndex lies in. */
+  virtual void GetGridsOfElement (unsigned long ulIndex, std::vector<unsigned long> &raulGrids) const;
   /** Returns the grid numbers to the given point \a rclPoint. */
   void Pos(const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const;
   /** Returns the number of stored elements. */
@@ -295,7 +316,7 @@ public:
   /** Returns indices of the elements in the current grid. */
   void GetElements (std::vector<unsigned long> &raulElements) const
   {
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+    raulElements.insert(raulElements.end(), _rclGrid.GetElementsBegin(_ulX, _ulY, _ulZ), _rclGrid.GetElementsEnd(_ulX, _ulY, _ulZ));
   }
   /** Returns the number of elements in the current grid. */
   unsigned long GetCtElements() const
@@ -391,6 +412,20 @@ inline bool MeshGrid::CheckPos (unsigned long ulX, unsigned long ulY, unsigned l
   return ((ulX < _ulCtGridsX) && (ulY < _ulCtGridsY) && (ulZ < _ulCtGridsZ));
 }
 
+inline const unsigned long* MeshGrid::GetElementsBegin (unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
+{
+  if (_aulGridElements.empty())
+    return 0;
+  return &_aulGridElements[0] + _aulGridOffsets[(ulZ * _ulCtGridsY + ulY) * _ulCtGridsX + ulX];
+}
+
+inline const unsigned long* MeshGrid::GetElementsEnd (unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
+{
+  if (_aulGridElements.empty())
+    return 0;
+  return &_aulGridElements[0] + _aulGridOffsets[(ulZ * _ulCtGridsY + ulY) * _ulCtGridsX + ulX + 1];
+}
+
 // --------------------------------------------------------------
 
 inline void MeshFacetGrid::Pos (const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const
@@ -434,86 +469,6 @@ inline void MeshFacetGrid::PosWithCheck (const Base::Vector3f &rclPoint, unsigne
   assert((rulX < _ulCtGridsX) && (rulY < _ulCtGridsY) && (rulZ < _ulCtGridsZ));
 }
 
-inline void MeshFacetGrid::AddFacet (const MeshGeomFacet &rclFacet, unsigned long ulFacetIndex, float /*fEpsilon*/)
-{
-#if 0
-  unsigned long  i, ulX, ulY, ulZ, ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
-  
-  ulX1 = ulY1 = ulZ1 = ULONG_MAX;
-  ulX2 = ulY2 = ulZ2 = 0;
-
-  for (i = 0; i < 3; i++)
-  {
-    Pos(rclFacet._aclPoints[i], ulX, ulY, ulZ);
-    _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
-    ulX1 = RSmin<unsigned long>(ulX1, ulX); ulY1 = RSmin<unsigned long>(ulY1, ulY); ulZ1 = RSmin<unsigned long>(ulZ1, ulZ);
-    ulX2 = RSmax<unsigned long>(ulX2, ulX); ulY2 = RSmax<unsigned long>(ulY2, ulY); ulZ2 = RSmax<unsigned long>(ulZ2, ulZ);
-  }
-  
-  // falls Facet ueber mehrere BB reicht
-  if ((ulX1 < ulX2) || (ulY1 < ulY2) || (ulZ1 < ulZ2))
-  {
-    for (ulX = ulX1; ulX <= ulX2; ulX++)
-    {
-      for (ulY = ulY1; ulY <= ulY2; ulY++)
-      {
-        for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++)
-        {
-          if (CMeshFacetFunc::BBoxContainFacet(GetBoundBox(ulX, ulY, ulZ), rclFacet) == true)
-            _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
-        }
-      }
-    }
-  }
-#else
-  unsigned long ulX, ulY, ulZ;
-
-  unsigned long ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
-
-  Base::BoundBox3f clBB;
-
-  clBB.Add(rclFacet._aclPoints[0]);
-  clBB.Add(rclFacet._aclPoints[1]);
-  clBB.Add(rclFacet._aclPoints[2]);
-
-  //float fDiagonalLength = clBB.CalcDiagonalLength();
-
-  //clBB.Enlarge(fEpsilon*fDiagonalLength);
-
-  Pos(Base::Vector3f(clBB.MinX,clBB.MinY,clBB.MinZ), ulX1, ulY1, ulZ1);
-  Pos(Base::Vector3f(clBB.MaxX,clBB.MaxY,clBB.MaxZ), ulX2, ulY2, ulZ2);
-  
-  /*
-  if (ulX1 > 0) ulX1--;
-  if (ulY1 > 0) ulY1--;
-  if (ulZ1 > 0) ulZ1--;
-  
-  if (ulX2 < (_ulCtGridsX-1)) ulX2++;
-  if (ulY2 < (_ulCtGridsY-1)) ulY2++;
-  if (ulZ2 < (_ulCtGridsZ-1)) ulZ2++;
-  */
-
-  // falls Facet ueber mehrere BB reicht
-  if ((ulX1 < ulX2) || (ulY1 < ulY2) || (ulZ1 < ulZ2))
-  {
-    for (ulX = ulX1; ulX <= ulX2; ulX++)
-    {
-      for (ulY = ulY1; ulY <= ulY2; ulY++)
-      {
-        for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++)
-        {
-          if ( rclFacet.IntersectBoundingBox( GetBoundBox(ulX, ulY, ulZ) ) )
-            _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
-        }
-      }
-    }
-  }
-  else
-    _aulGrid[ulX1][ulY1][ulZ1].insert(ulFacetIndex);
-
-#endif
-}
-
 } // namespace MeshCore
 
 #endif // MESH_GRID_H
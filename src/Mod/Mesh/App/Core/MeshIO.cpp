@@ -39,10 +39,13 @@
 #include <Base/Sequencer.h>
 #include <Base/Stream.h>
 #include <Base/Placement.h>
+#include <Base/TimeInfo.h>
 #include <Base/Tools.h>
 #include <zipios++/gzipoutputstream.h>
 
 #include <cmath>
+#include <cstring>
+#include <iterator>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
@@ -50,6 +53,9 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
 
+#include <QThread>
+#include <QtConcurrentMap>
+
 
 using namespace MeshCore;
 
@@ -112,6 +118,190 @@ int numDigits(int number)
     return digits;
 }
 
+// Fast parsing of the numbers in the ASCII formats. Unlike std::atof these functions
+// don't depend on the locale, skip leading blanks and advance the passed pointer behind
+// the parsed number.
+static inline const char* skipBlanks(const char* p, const char* end)
+{
+    while (p != end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        ++p;
+    return p;
+}
+
+static inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static bool parseInt(const char*& p, const char* end, long& value)
+{
+    const char* s = skipBlanks(p, end);
+    bool negative = false;
+    if (s != end && (*s == '-' || *s == '+')) {
+        negative = (*s == '-');
+        ++s;
+    }
+    if (s == end || !isDigit(*s))
+        return false;
+
+    long v = 0;
+    while (s != end && isDigit(*s)) {
+        v = 10 * v + (*s - '0');
+        ++s;
+    }
+
+    value = negative ? -v : v;
+    p = s;
+    return true;
+}
+
+static bool parseFloat(const char*& p, const char* end, float& value)
+{
+    static const double powers[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char* start = skipBlanks(p, end);
+    const char* s = start;
+    bool negative = false;
+    if (s != end && (*s == '-' || *s == '+')) {
+        negative = (*s == '-');
+        ++s;
+    }
+
+    // count the significant digits to know whether the mantissa is exact
+    double mantissa = 0.0;
+    int exponent = 0;
+    int significant = 0;
+    bool digits = false;
+    while (s != end && isDigit(*s)) {
+        if (significant > 0 || *s != '0')
+            significant++;
+        mantissa = 10.0 * mantissa + (*s - '0');
+        digits = true;
+        ++s;
+    }
+    if (s != end && *s == '.') {
+        ++s;
+        while (s != end && isDigit(*s)) {
+            if (significant > 0 || *s != '0')
+                significant++;
+            mantissa = 10.0 * mantissa + (*s - '0');
+            exponent--;
+            digits = true;
+            ++s;
+        }
+    }
+    if (!digits)
+        return false;
+
+    if (s != end && (*s == 'e' || *s == 'E')) {
+        const char* e = s + 1;
+        bool negExp = false;
+        if (e != end && (*e == '-' || *e == '+')) {
+            negExp = (*e == '-');
+            ++e;
+        }
+        if (e != end && isDigit(*e)) {
+            int exp = 0;
+            while (e != end && isDigit(*e)) {
+                if (exp < 10000)
+                    exp = 10 * exp + (*e - '0');
+                ++e;
+            }
+            exponent += negExp ? -exp : exp;
+            s = e;
+        }
+    }
+
+    double v = mantissa;
+    if (significant <= 15 && exponent >= -22 && exponent <= 22) {
+        // the mantissa and the power of ten are exact doubles, so a single
+        // multiplication or division gives the correctly rounded result
+        if (exponent < 0)
+            v /= powers[-exponent];
+        else if (exponent > 0)
+            v *= powers[exponent];
+        if (negative)
+            v = -v;
+    }
+    else {
+        // too many digits for the fast path, let the library do the rounding
+        std::istringstream str(std::string(start, s));
+        str.imbue(std::locale::classic());
+        if (!(str >> v))
+            return false;
+    }
+
+    value = static_cast<float>(v);
+    p = s;
+    return true;
+}
+
+// Checks case-insensitively for the keyword followed by a blank or the end of the line
+static bool parseKeyword(const char*& p, const char* end, const char* keyword)
+{
+    const char* s = p;
+    for (; *keyword; ++keyword, ++s) {
+        if (s == end || tolower(*s) != *keyword)
+            return false;
+    }
+    if (s != end && *s != ' ' && *s != '\t' && *s != '\r' && *s != '\n')
+        return false;
+    p = s;
+    return true;
+}
+
+static bool parseVector(const char*& p, const char* end, Base::Vector3f& v)
+{
+    const char* s = p;
+    if (!parseFloat(s, end, v.x) || !parseFloat(s, end, v.y) || !parseFloat(s, end, v.z))
+        return false;
+    p = s;
+    return true;
+}
+
+static inline bool isEndOfLine(const char* p, const char* end)
+{
+    p = skipBlanks(p, end);
+    return p == end || *p == '\n';
+}
+
+static bool parseOBJPoint(const char* p, const char* end, Base::Vector3f& point)
+{
+    const char* s = skipBlanks(p, end);
+    return parseKeyword(s, end, "v") && parseVector(s, end, point) && isEndOfLine(s, end);
+}
+
+// Parses a face with the vertex groups 'v', 'v/vt', 'v//vn' or 'v/vt/vn' and returns the number
+// of vertices. Only triangles and quads are accepted, otherwise 0 is returned.
+static int parseOBJFace(const char* p, const char* end, long* indices)
+{
+    const char* s = skipBlanks(p, end);
+    if (!parseKeyword(s, end, "f"))
+        return 0;
+
+    int ct = 0;
+    while (!isEndOfLine(s, end)) {
+        if (ct == 4)
+            return 0;
+        long index, other;
+        if (!parseInt(s, end, index))
+            return 0;
+        for (int i = 0; i < 2 && s != end && *s == '/'; i++) {
+            ++s;
+            if (s != end && *s != '/')
+                parseInt(s, end, other);
+        }
+        if (s != end && *s != ' ' && *s != '\t' && *s != '\r' && *s != '\n')
+            return 0;
+        indices[ct++] = index;
+    }
+
+    return ct;
+}
+
 /* Usage by CMeshNastran, CMeshCadmouldFE. Added by Sergey Sukhov (26.04.2002)*/
 struct NODE {float x, y, z;};
 struct TRIA {int iV[3];};
@@ -149,6 +339,7 @@ bool MeshInput::LoadAny(const char* FileName)
         throw Base::FileException("No permission on the file",FileName);
 
     Base::ifstream str(fi, std::ios::in | std::ios::binary);
+    Base::TimeInfo start;
 
     if (fi.hasExtension("bms")) {
         _rclMesh.Read(str);
@@ -181,6 +372,15 @@ bool MeshInput::LoadAny(const char* FileName)
             throw Base::FileException("File extension not supported",FileName);
         }
 
+        if (ok) {
+            float seconds = Base::TimeInfo::diffTimeF(start);
+            str.clear();
+            std::streamoff bytes = str.rdbuf()->pubseekoff(0, std::ios::end, std::ios::in);
+            double megabytes = static_cast<double>(bytes) / 1048576.0;
+            Base::Console().Log("Loaded '%s' (%.1f MB) in %.3f s (%.1f MB/s)\n", FileName,
+                megabytes, seconds, seconds > 0.0f ? megabytes / seconds : 0.0);
+        }
+
         return ok;
     }
 }
@@ -277,9 +477,6 @@ bool MeshInput::LoadSTL (std::istream &rstrIn)
 bool MeshInput::LoadOBJ (std::istream &rstrIn)
 {
     boost::regex rx_g("^g\\s+([\\x21-\\x7E]+)\\s*$");
-    boost::regex rx_p("^v\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                        "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                        "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
     boost::regex rx_c("^v\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
                         "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
                         "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
@@ -290,13 +487,6 @@ bool MeshInput::LoadOBJ (std::istream &rstrIn)
                         "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
                         "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
                         "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    boost::regex rx_f3("^f\\s+([-+]?[0-9]+)/?[-+]?[0-9]*/?[-+]?[0-9]*"
-                         "\\s+([-+]?[0-9]+)/?[-+]?[0-9]*/?[-+]?[0-9]*"
-                         "\\s+([-+]?[0-9]+)/?[-+]?[0-9]*/?[-+]?[0-9]*\\s*$");
-    boost::regex rx_f4("^f\\s+([-+]?[0-9]+)/?[-+]?[0-9]*/?[-+]?[0-9]*"
-                         "\\s+([-+]?[0-9]+)/?[-+]?[0-9]*/?[-+]?[0-9]*"
-                         "\\s+([-+]?[0-9]+)/?[-+]?[0-9]*/?[-+]?[0-9]*"
-                         "\\s+([-+]?[0-9]+)/?[-+]?[0-9]*/?[-+]?[0-9]*\\s*$");
     boost::cmatch what;
 
     unsigned long segment=0;
@@ -306,6 +496,9 @@ bool MeshInput::LoadOBJ (std::istream &rstrIn)
     std::string line;
     float fX, fY, fZ;
     int  i1=1,i2=1,i3=1,i4=1;
+    long indices[4];
+    int ctIndices;
+    Base::Vector3f point;
     MeshFacet item;
 
     if (!rstrIn || rstrIn.bad() == true)
@@ -320,50 +513,21 @@ bool MeshInput::LoadOBJ (std::istream &rstrIn)
     std::string groupName;
 
     while (std::getline(rstrIn, line)) {
+        // vertices and faces are the most frequent lines and therefore parsed directly
+        const char* beg = line.c_str();
+        const char* end = beg + line.size();
+        if (parseOBJPoint(beg, end, point)) {
+            meshPoints.push_back(MeshPoint(point));
+            continue;
+        }
+        ctIndices = parseOBJFace(beg, end, indices);
+
         // when a group name comes don't make it lower case
-        if (!line.empty() && line[0] != 'g') {
+        if (ctIndices == 0 && !line.empty() && line[0] != 'g') {
             for (std::string::iterator it = line.begin(); it != line.end(); ++it)
                 *it = tolower(*it);
         }
-        if (boost::regex_match(line.c_str(), what, rx_p)) {
-            fX = (float)std::atof(what[1].first);
-            fY = (float)std::atof(what[4].first);
-            fZ = (float)std::atof(what[7].first);
-            meshPoints.push_back(MeshPoint(Base::Vector3f(fX, fY, fZ)));
-        }
-        else if (boost::regex_match(line.c_str(), what, rx_c)) {
-            fX = (float)std::atof(what[1].first);
-            fY = (float)std::atof(what[4].first);
-            fZ = (float)std::atof(what[7].first);
-            float r = std::min<int>(std::atof(what[10].first),255) / 255.0f;
-            float g = std::min<int>(std::atof(what[11].first),255) / 255.0f;
-            float b = std::min<int>(std::atof(what[12].first),255) / 255.0f;
-            meshPoints.push_back(MeshPoint(Base::Vector3f(fX, fY, fZ)));
-
-            App::Color c(r,g,b);
-            unsigned long prop = static_cast<uint32_t>(c.getPackedValue());
-            meshPoints.back().SetProperty(prop);
-            rgb_value = MeshIO::PER_VERTEX;
-        }
-        else if (boost::regex_match(line.c_str(), what, rx_t)) {
-            fX = (float)std::atof(what[1].first);
-            fY = (float)std::atof(what[4].first);
-            fZ = (float)std::atof(what[7].first);
-            float r = static_cast<float>(std::atof(what[10].first));
-            float g = static_cast<float>(std::atof(what[13].first));
-            float b = static_cast<float>(std::atof(what[16].first));
-            meshPoints.push_back(MeshPoint(Base::Vector3f(fX, fY, fZ)));
-
-            App::Color c(r,g,b);
-            unsigned long prop = static_cast<uint32_t>(c.getPackedValue());
-            meshPoints.back().SetProperty(prop);
-            rgb_value = MeshIO::PER_VERTEX;
-        }
-        else if (boost::regex_match(line.c_str(), what, rx_g)) {
-            new_segment = true;
-            groupName = Base::Tools::escapedUnicodeToUtf8(what[1].first);
-        }
-        else if (boost::regex_match(line.c_str(), what, rx_f3)) {
+        if (ctIndices == 3) {
             // starts a new segment
             if (new_segment) {
                 if (!groupName.empty()) {
@@ -375,17 +539,17 @@ bool MeshInput::LoadOBJ (std::istream &rstrIn)
             }
 
             // 3-vertex face
-            i1 = std::atoi(what[1].first);
+            i1 = static_cast<int>(indices[0]);
             i1 = i1 > 0 ? i1-1 : i1+static_cast<int>(meshPoints.size());
-            i2 = std::atoi(what[2].first);
+            i2 = static_cast<int>(indices[1]);
             i2 = i2 > 0 ? i2-1 : i2+static_cast<int>(meshPoints.size());
-            i3 = std::atoi(what[3].first);
+            i3 = static_cast<int>(indices[2]);
             i3 = i3 > 0 ? i3-1 : i3+static_cast<int>(meshPoints.size());
             item.SetVertices(i1,i2,i3);
             item.SetProperty(segment);
             meshFacets.push_back(item);
         }
-        else if (boost::regex_match(line.c_str(), what, rx_f4)) {
+        else if (ctIndices == 4) {
             // starts a new segment
             if (new_segment) {
                 if (!groupName.empty()) {
@@ -397,13 +561,13 @@ bool MeshInput::LoadOBJ (std::istream &rstrIn)
             }
 
             // 4-vertex face
-            i1 = std::atoi(what[1].first);
+            i1 = static_cast<int>(indices[0]);
             i1 = i1 > 0 ? i1-1 : i1+static_cast<int>(meshPoints.size());
-            i2 = std::atoi(what[2].first);
+            i2 = static_cast<int>(indices[1]);
             i2 = i2 > 0 ? i2-1 : i2+static_cast<int>(meshPoints.size());
-            i3 = std::atoi(what[3].first);
+            i3 = static_cast<int>(indices[2]);
             i3 = i3 > 0 ? i3-1 : i3+static_cast<int>(meshPoints.size());
-            i4 = std::atoi(what[4].first);
+            i4 = static_cast<int>(indices[3]);
             i4 = i4 > 0 ? i4-1 : i4+static_cast<int>(meshPoints.size());
 
             item.SetVertices(i1,i2,i3);
@@ -414,6 +578,38 @@ bool MeshInput::LoadOBJ (std::istream &rstrIn)
             item.SetProperty(segment);
             meshFacets.push_back(item);
         }
+        else if (boost::regex_match(line.c_str(), what, rx_c)) {
+            fX = (float)std::atof(what[1].first);
+            fY = (float)std::atof(what[4].first);
+            fZ = (float)std::atof(what[7].first);
+            float r = std::min<int>(std::atof(what[10].first),255) / 255.0f;
+            float g = std::min<int>(std::atof(what[11].first),255) / 255.0f;
+            float b = std::min<int>(std::atof(what[12].first),255) / 255.0f;
+            meshPoints.push_back(MeshPoint(Base::Vector3f(fX, fY, fZ)));
+
+            App::Color c(r,g,b);
+            unsigned long prop = static_cast<uint32_t>(c.getPackedValue());
+            meshPoints.back().SetProperty(prop);
+            rgb_value = MeshIO::PER_VERTEX;
+        }
+        else if (boost::regex_match(line.c_str(), what, rx_t)) {
+            fX = (float)std::atof(what[1].first);
+            fY = (float)std::atof(what[4].first);
+            fZ = (float)std::atof(what[7].first);
+            float r = static_cast<float>(std::atof(what[10].first));
+            float g = static_cast<float>(std::atof(what[13].first));
+            float b = static_cast<float>(std::atof(what[16].first));
+            meshPoints.push_back(MeshPoint(Base::Vector3f(fX, fY, fZ)));
+
+            App::Color c(r,g,b);
+            unsigned long prop = static_cast<uint32_t>(c.getPackedValue());
+            meshPoints.back().SetProperty(prop);
+            rgb_value = MeshIO::PER_VERTEX;
+        }
+        else if (boost::regex_match(line.c_str(), what, rx_g)) {
+            new_segment = true;
+            groupName = Base::Tools::escapedUnicodeToUtf8(what[1].first);
+        }
     }
 
     // now get back the colors from the vertex property
@@ -836,6 +1032,26 @@ bool MeshInput::LoadPLY (std::istream &inp)
     if (rgb_colors != 0 && rgb_colors != 3)
         return false;
 
+    // look up the positions of the used properties once
+    std::size_t index_x = 0, index_y = 0, index_z = 0;
+    std::size_t index_r = 0, index_g = 0, index_b = 0;
+    for (std::size_t i = 0; i < vertex_props.size(); i++) {
+        const std::string& name = vertex_props[i].first;
+        if (name == "x")
+            index_x = i;
+        else if (name == "y")
+            index_y = i;
+        else if (name == "z")
+            index_z = i;
+        else if (name == "red")
+            index_r = i;
+        else if (name == "green")
+            index_g = i;
+        else if (name == "blue")
+            index_b = i;
+    }
+    std::vector<float> prop_values(vertex_props.size());
+
     // only if set per vertex
     if (rgb_colors == 3) {
         rgb_value = MeshIO::PER_VERTEX;
@@ -846,57 +1062,30 @@ bool MeshInput::LoadPLY (std::istream &inp)
     }
 
     if (format == ascii) {
-        boost::regex rx_d("(([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?))\\s*");
-        boost::regex rx_s("\\b([-+]?[0-9]+)\\s*");
-        boost::regex rx_u("\\b([0-9]+)\\s*");
-        boost::regex rx_f("^\\s*3\\s+([0-9]+)\\s+([0-9]+)\\s+([0-9]+)\\s*");
-        boost::smatch what;
-
         for (std::size_t i = 0; i < v_count && std::getline(inp, line); i++) {
             // go through the vertex properties
-            std::map<std::string, float> prop_values;
+            const char* p = line.c_str();
+            const char* end = p + line.size();
             for (std::vector<std::pair<std::string, Number> >::iterator it = vertex_props.begin(); it != vertex_props.end(); ++it) {
+                float& value = prop_values[it - vertex_props.begin()];
                 switch (it->second) {
                 case int8:
                 case int16:
                 case int32:
-                    {
-                        if (boost::regex_search(line, what, rx_s)) {
-                            int v;
-                            v = boost::lexical_cast<int>(what[1]);
-                            prop_values[it->first] = static_cast<float>(v);
-                            line = line.substr(what[0].length());
-                        }
-                        else {
-                            return false;
-                        }
-                    } break;
                 case uint8:
                 case uint16:
                 case uint32:
                     {
-                        if (boost::regex_search(line, what, rx_u)) {
-                            int v;
-                            v = boost::lexical_cast<int>(what[1]);
-                            prop_values[it->first] = static_cast<float>(v);
-                            line = line.substr(what[0].length());
-                        }
-                        else {
+                        long v;
+                        if (!parseInt(p, end, v))
                             return false;
-                        }
+                        value = static_cast<float>(v);
                     } break;
                 case float32:
                 case float64:
                     {
-                        if (boost::regex_search(line, what, rx_d)) {
-                            double v;
-                            v = boost::lexical_cast<double>(what[1]);
-                            prop_values[it->first] = static_cast<float>(v);
-                            line = line.substr(what[0].length());
-                        }
-                        else {
+                        if (!parseFloat(p, end, value))
                             return false;
-                        }
                     } break;
                 default:
                     return false;
@@ -904,25 +1093,25 @@ bool MeshInput::LoadPLY (std::istream &inp)
             }
 
             Base::Vector3f pt;
-            pt.x = (prop_values["x"]);
-            pt.y = (prop_values["y"]);
-            pt.z = (prop_values["z"]);
+            pt.x = (prop_values[index_x]);
+            pt.y = (prop_values[index_y]);
+            pt.z = (prop_values[index_z]);
             meshPoints.push_back(pt);
 
             if (_material && (rgb_value == MeshIO::PER_VERTEX)) {
-                float r = (prop_values["red"]) / 255.0f;
-                float g = (prop_values["green"]) / 255.0f;
-                float b = (prop_values["blue"]) / 255.0f;
+                float r = (prop_values[index_r]) / 255.0f;
+                float g = (prop_values[index_g]) / 255.0f;
+                float b = (prop_values[index_b]) / 255.0f;
                 _material->diffuseColor.push_back(App::Color(r, g, b));
             }
         }
 
-        int f1, f2, f3;
+        long n, f1, f2, f3;
         for (std::size_t i = 0; i < f_count && std::getline(inp, line); i++) {
-            if (boost::regex_search(line, what, rx_f)) {
-                f1 = boost::lexical_cast<int>(what[1]);
-                f2 = boost::lexical_cast<int>(what[2]);
-                f3 = boost::lexical_cast<int>(what[3]);
+            const char* p = line.c_str();
+            const char* end = p + line.size();
+            if (parseInt(p, end, n) && n == 3 && parseInt(p, end, f1) &&
+                parseInt(p, end, f2) && parseInt(p, end, f3)) {
                 meshFacets.push_back(MeshFacet(f1,f2,f3));
             }
         }
@@ -937,48 +1126,47 @@ bool MeshInput::LoadPLY (std::istream &inp)
 
         for (std::size_t i = 0; i < v_count; i++) {
             // go through the vertex properties
-            std::map<std::string, float> prop_values;
             for (std::vector<std::pair<std::string, Number> >::iterator it = vertex_props.begin(); it != vertex_props.end(); ++it) {
                 switch (it->second) {
                 case int8:
                     {
                         int8_t v; is >> v;
-                        prop_values[it->first] = static_cast<float>(v);
+                        prop_values[it - vertex_props.begin()] = static_cast<float>(v);
                     } break;
                 case uint8:
                     {
                         uint8_t v; is >> v;
-                        prop_values[it->first] = static_cast<float>(v);
+                        prop_values[it - vertex_props.begin()] = static_cast<float>(v);
                     } break;
                 case int16:
                     {
                         int16_t v; is >> v;
-                        prop_values[it->first] = static_cast<float>(v);
+                        prop_values[it - vertex_props.begin()] = static_cast<float>(v);
                     } break;
                 case uint16:
                     {
                         uint16_t v; is >> v;
-                        prop_values[it->first] = static_cast<float>(v);
+                        prop_values[it - vertex_props.begin()] = static_cast<float>(v);
                     } break;
                 case int32:
                     {
                         int32_t v; is >> v;
-                        prop_values[it->first] = static_cast<float>(v);
+                        prop_values[it - vertex_props.begin()] = static_cast<float>(v);
                     } break;
                 case uint32:
                     {
                         uint32_t v; is >> v;
-                        prop_values[it->first] = static_cast<float>(v);
+                        prop_values[it - vertex_props.begin()] = static_cast<float>(v);
                     } break;
                 case float32:
                     {
                         float v; is >> v;
-                        prop_values[it->first] = v;
+                        prop_values[it - vertex_props.begin()] = v;
                     } break;
                 case float64:
                     {
                         double v; is >> v;
-                        prop_values[it->first] = static_cast<float>(v);
+                        prop_values[it - vertex_props.begin()] = static_cast<float>(v);
                     } break;
                 default:
                     return false;
@@ -986,15 +1174,15 @@ bool MeshInput::LoadPLY (std::istream &inp)
             }
 
             Base::Vector3f pt;
-            pt.x = (prop_values["x"]);
-            pt.y = (prop_values["y"]);
-            pt.z = (prop_values["z"]);
+            pt.x = (prop_values[index_x]);
+            pt.y = (prop_values[index_y]);
+            pt.z = (prop_values[index_z]);
             meshPoints.push_back(pt);
 
             if (_material && (rgb_value == MeshIO::PER_VERTEX)) {
-                float r = (prop_values["red"]) / 255.0f;
-                float g = (prop_values["green"]) / 255.0f;
-                float b = (prop_values["blue"]) / 255.0f;
+                float r = (prop_values[index_r]) / 255.0f;
+                float g = (prop_values[index_g]) / 255.0f;
+                float b = (prop_values[index_b]) / 255.0f;
                 _material->diffuseColor.push_back(App::Color(r, g, b));
             }
         }
@@ -1123,70 +1311,132 @@ bool MeshInput::LoadMeshNode (std::istream &rstrIn)
     return true;
 }
 
-/** Loads an ASCII STL file. */
-bool MeshInput::LoadAsciiSTL (std::istream &rstrIn)
+namespace MeshCore {
+
+/** A block of lines of an ASCII STL file that starts with a facet and thus can be parsed
+ * independently of the other blocks.
+ */
+struct AsciiSTLChunk
 {
-    boost::regex rx_p("^\\s*VERTEX\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    boost::regex rx_f("^\\s*FACET\\s+NORMAL\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    boost::cmatch what;
+    const char* begin;
+    const char* end;
+    /// three points and the normal per facet
+    std::vector<Base::Vector3f> facets;
+};
 
-    std::string line;
-    float fX, fY, fZ;
-    unsigned long ulVertexCt, ulFacetCt=0;
-    MeshGeomFacet clFacet;
+}
+
+static void parseAsciiSTLChunk(AsciiSTLChunk& chunk)
+{
+    Base::Vector3f facet[4];
+    int vertexCt = 0;
+
+    const char* end = chunk.end;
+    for (const char* p = chunk.begin; p != end; ) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        eol = eol ? eol : end;
+
+        const char* s = skipBlanks(p, eol);
+        if (parseKeyword(s, eol, "facet")) {
+            Base::Vector3f normal;
+            s = skipBlanks(s, eol);
+            if (parseKeyword(s, eol, "normal") && parseVector(s, eol, normal) && isEndOfLine(s, eol))
+                facet[3] = normal;
+        }
+        else if (parseKeyword(s, eol, "vertex")) {
+            Base::Vector3f point;
+            if (parseVector(s, eol, point) && isEndOfLine(s, eol)) {
+                facet[vertexCt++] = point;
+                if (vertexCt == 3) {
+                    vertexCt = 0;
+                    chunk.facets.insert(chunk.facets.end(), facet, facet + 4);
+                }
+            }
+        }
+
+        p = (eol == end) ? end : eol + 1;
+    }
+}
+
+// Moves the position to the beginning of the next line that starts with the 'facet' keyword
+static const char* findNextFacet(const char* p, const char* end)
+{
+    while (p != end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!eol)
+            return end;
+        p = eol + 1;
+        const char* s = skipBlanks(p, end);
+        if (parseKeyword(s, end, "facet"))
+            return p;
+    }
+    return end;
+}
 
+/** Loads an ASCII STL file.
+ * The whole file is read into memory and split into blocks at facet boundaries which
+ * are parsed in parallel.
+ */
+bool MeshInput::LoadAsciiSTL (std::istream &rstrIn)
+{
     if (!rstrIn || rstrIn.bad() == true)
         return false;
 
-    std::streamoff ulSize = 0;
     std::streambuf* buf = rstrIn.rdbuf();
-    ulSize = buf->pubseekoff(0, std::ios::end, std::ios::in);
-    buf->pubseekoff(0, std::ios::beg, std::ios::in);
-    ulSize -= 20;
+    if (!buf)
+        return false;
 
-    // count facets
-    while (std::getline(rstrIn, line)) {
-        for (std::string::iterator it = line.begin(); it != line.end(); ++it)
-            *it = toupper(*it);
-        if (line.find("ENDFACET") != std::string::npos)
-            ulFacetCt++;
-        // prevent from reading EOF (as I don't know how to reread the file then)
-        if (rstrIn.tellg() > ulSize)
-            break;
-        else if (line.find("ENDSOLID") != std::string::npos)
-            break;
+    std::vector<char> data;
+    std::streamoff ulCurr = buf->pubseekoff(0, std::ios::cur, std::ios::in);
+    std::streamoff ulSize = buf->pubseekoff(0, std::ios::end, std::ios::in);
+    buf->pubseekoff(ulCurr, std::ios::beg, std::ios::in);
+    if (ulCurr >= 0 && ulSize > ulCurr) {
+        data.resize(static_cast<std::size_t>(ulSize - ulCurr));
+        rstrIn.read(&data[0], data.size());
+        data.resize(static_cast<std::size_t>(rstrIn.gcount()));
+    }
+    else {
+        data.assign(std::istreambuf_iterator<char>(rstrIn), std::istreambuf_iterator<char>());
+    }
+
+    if (data.empty())
+        return false;
+
+    // split into blocks of roughly the same size
+    const char* begin = &data[0];
+    const char* end = begin + data.size();
+    std::size_t ctChunks = 1;
+    if (data.size() > 1048576)
+        ctChunks = static_cast<std::size_t>(std::max<int>(QThread::idealThreadCount(), 1)) * 4;
+    std::size_t chunkSize = data.size() / ctChunks + 1;
+
+    std::vector<AsciiSTLChunk> chunks;
+    for (const char* p = begin; p != end; ) {
+        const char* next = end;
+        if (static_cast<std::size_t>(end - p) > chunkSize)
+            next = findNextFacet(p + chunkSize, end);
+
+        AsciiSTLChunk chunk;
+        chunk.begin = p;
+        chunk.end = next;
+        chunks.push_back(chunk);
+        p = next;
     }
 
-    // restart from the beginning
-    buf->pubseekoff(0, std::ios::beg, std::ios::in);
+    QtConcurrent::blockingMap(chunks, parseAsciiSTLChunk);
 
-    MeshBuilder builder(this->_rclMesh);
+    unsigned long ulFacetCt = 0;
+    for (std::vector<AsciiSTLChunk>::iterator it = chunks.begin(); it != chunks.end(); ++it)
+        ulFacetCt += it->facets.size() / 4;
+
+    MeshFastBuilder builder(this->_rclMesh);
     builder.Initialize(ulFacetCt);
 
-    ulVertexCt = 0;
-    while (std::getline(rstrIn, line)) {
-        for (std::string::iterator it = line.begin(); it != line.end(); ++it)
-            *it = toupper(*it);
-        if (boost::regex_match(line.c_str(), what, rx_f)) {
-            fX = (float)std::atof(what[1].first);
-            fY = (float)std::atof(what[4].first);
-            fZ = (float)std::atof(what[7].first);
-            clFacet.SetNormal(Base::Vector3f(fX, fY, fZ));
-        }
-        else if (boost::regex_match(line.c_str(), what, rx_p)) {
-            fX = (float)std::atof(what[1].first);
-            fY = (float)std::atof(what[4].first);
-            fZ = (float)std::atof(what[7].first);
-            clFacet._aclPoints[ulVertexCt++].Set(fX, fY, fZ);
-            if (ulVertexCt == 3) {
-                ulVertexCt = 0;
-                builder.AddFacet(clFacet);
-            }
-        }
+    for (std::vector<AsciiSTLChunk>::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        std::vector<Base::Vector3f>& facets = it->facets;
+        for (std::size_t i = 0; i < facets.size(); i += 4)
+            builder.AddFacet(&facets[i]);
+        std::vector<Base::Vector3f>().swap(facets);
     }
 
     builder.Finish();
@@ -1199,7 +1449,6 @@ bool MeshInput::LoadBinarySTL (std::istream &rstrIn)
 {
     char szInfo[80];
     Base::Vector3f clVects[4];
-    uint16_t usAtt = 0;
     uint32_t ulCt = 0;
 
     if (!rstrIn || rstrIn.bad() == true)
@@ -1214,7 +1463,7 @@ bool MeshInput::LoadBinarySTL (std::istream &rstrIn)
         return false;
 
     // get file size and calculate the number of facets
-    std::streamoff ulSize = 0; 
+    std::streamoff ulSize = -1;
     std::streambuf* buf = rstrIn.rdbuf();
     if (buf) {
         std::streamoff ulCurr;
@@ -1223,24 +1472,37 @@ bool MeshInput::LoadBinarySTL (std::istream &rstrIn)
         buf->pubseekoff(ulCurr, std::ios::beg, std::ios::in);
     }
 
-    uint32_t ulFac = (ulSize - (80 + sizeof(uint32_t))) / 50;
-
-    // compare the calculated with the read value
-    if (ulCt > ulFac)
-        return false;// not a valid STL file
+    // compare the calculated with the read value unless the stream is not seekable
+    if (ulSize >= 0) {
+        std::streamoff ulFac = 0;
+        if (ulSize > static_cast<std::streamoff>(80 + sizeof(uint32_t)))
+            ulFac = (ulSize - (80 + sizeof(uint32_t))) / 50;
+        if (static_cast<std::streamoff>(ulCt) > ulFac)
+            return false;// not a valid STL file
+    }
  
-    MeshBuilder builder(this->_rclMesh);
+    MeshFastBuilder builder(this->_rclMesh);
     builder.Initialize(ulCt);
 
-    for (uint32_t i = 0; i < ulCt; i++) {
-        // read normal, points
-        rstrIn.read((char*)&clVects, sizeof(clVects));
-
-        std::swap(clVects[0], clVects[3]);
-        builder.AddFacet(clVects);
-
-        // overread 2 bytes attribute
-        rstrIn.read((char*)&usAtt, sizeof(usAtt));
+    // read the records (normal, points and 2 bytes attribute) block-wise
+    const uint32_t ulRecord = 50;
+    const uint32_t ulBlock = 4096;
+    std::vector<char> block(ulRecord * ulBlock);
+    for (uint32_t i = 0; i < ulCt; i += ulBlock) {
+        uint32_t ulRead = std::min<uint32_t>(ulBlock, ulCt - i);
+        if (!rstrIn.read(&block[0], ulRecord * ulRead))
+            return false; // truncated file
+
+        const char* record = &block[0];
+        for (uint32_t j = 0; j < ulRead; j++, record += ulRecord) {
+            float values[12];
+            std::memcpy(values, record, sizeof(values));
+            clVects[3].Set(values[0], values[1], values[2]);
+            clVects[0].Set(values[3], values[4], values[5]);
+            clVects[1].Set(values[6], values[7], values[8]);
+            clVects[2].Set(values[9], values[10], values[11]);
+            builder.AddFacet(clVects);
+        }
     }
 
     builder.Finish();
@@ -47,6 +47,29 @@
 
 using namespace MeshCore;
 
+namespace MeshCore {
+/// Flags of the arrays stored by MeshKernel::Write
+enum MeshChunkFlags {
+    MeshChunkNeighbours = 1
+};
+
+/// Start value of the checksum
+static const uint32_t MeshChecksumSeed = 2166136261u;
+/// Number of array entries that are written or read at once, a multiple of three
+static const std::size_t MeshChunkBlock = 3 * 4096;
+
+/** Continues a FNV-1a checksum over 32-bit words. */
+static uint32_t MeshChecksum(uint32_t hash, const void* data, std::size_t count)
+{
+    const uint32_t* words = static_cast<const uint32_t*>(data);
+    for (std::size_t i = 0; i < count; i++) {
+        hash ^= words[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+}
+
 MeshKernel::MeshKernel (void)
 : _bValid(true)
 {
@@ -772,7 +795,7 @@ void MeshKernel::Write (std::ostream &rclOut) const
 
     // Write a header with a "magic number" and a version
     str << (uint32_t)0xA0B0C0D0;
-    str << (uint32_t)0x010000;
+    str << (uint32_t)0x020000;
 
     char szInfo[257]; // needs an additional byte for zero-termination
     strcpy(szInfo, "MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-MESH-"
@@ -781,26 +804,133 @@ void MeshKernel::Write (std::ostream &rclOut) const
                    "MESH-MESH-MESH-\n");
     rclOut.write(szInfo, 256);
 
-    // write the number of points and facets
-    str << (uint32_t)CountPoints() << (uint32_t)CountFacets();
+    // write the number of points and facets and which arrays follow
+    uint32_t uCtPts = (uint32_t)CountPoints();
+    uint32_t uCtFts = (uint32_t)CountFacets();
+    str << uCtPts << uCtFts << (uint32_t)MeshChunkNeighbours;
 
-    // write the data
+    // write the data block-wise straight from the kernel arrays
+    uint32_t checksum = MeshChecksumSeed;
+    std::vector<float> coords;
+    coords.reserve(MeshChunkBlock);
     for (MeshPointArray::_TConstIterator it = _aclPointArray.begin(); it != _aclPointArray.end(); ++it) {
-        str << it->x << it->y << it->z;
+        coords.push_back(it->x);
+        coords.push_back(it->y);
+        coords.push_back(it->z);
+        if (coords.size() == MeshChunkBlock || it + 1 == _aclPointArray.end()) {
+            checksum = MeshChecksum(checksum, &coords[0], coords.size());
+            rclOut.write(reinterpret_cast<const char*>(&coords[0]), coords.size() * sizeof(float));
+            coords.clear();
+        }
     }
 
-    for (MeshFacetArray::_TConstIterator it = _aclFacetArray.begin(); it != _aclFacetArray.end(); ++it) {
-        str << (uint32_t)it->_aulPoints[0] 
-            << (uint32_t)it->_aulPoints[1] 
-            << (uint32_t)it->_aulPoints[2];
-        str << (uint32_t)it->_aulNeighbours[0] 
-            << (uint32_t)it->_aulNeighbours[1] 
-            << (uint32_t)it->_aulNeighbours[2];
+    // first the point indices of all facets, then their neighbours
+    std::vector<uint32_t> indices;
+    indices.reserve(MeshChunkBlock);
+    for (int pass = 0; pass < 2; pass++) {
+        for (MeshFacetArray::_TConstIterator it = _aclFacetArray.begin(); it != _aclFacetArray.end(); ++it) {
+            const unsigned long* values = (pass == 0) ? it->_aulPoints : it->_aulNeighbours;
+            for (int i = 0; i < 3; i++)
+                indices.push_back((uint32_t)values[i]);
+            if (indices.size() == MeshChunkBlock || it + 1 == _aclFacetArray.end()) {
+                checksum = MeshChecksum(checksum, &indices[0], indices.size());
+                rclOut.write(reinterpret_cast<const char*>(&indices[0]), indices.size() * sizeof(uint32_t));
+                indices.clear();
+            }
+        }
     }
 
     str << _clBoundBox.MinX << _clBoundBox.MaxX;
     str << _clBoundBox.MinY << _clBoundBox.MaxY;
     str << _clBoundBox.MinZ << _clBoundBox.MaxZ;
+    str << checksum;
+}
+
+void MeshKernel::ReadChunks (std::istream &rclIn, Base::InputStream &str)
+{
+    // the arrays are stored in the byte order of the writing system
+    bool swapBytes = (str.byteOrder() == Base::Stream::BigEndian);
+    uint32_t open_edge = 0xffffffff; // value to mark an open edge
+
+    char szInfo[256];
+    rclIn.read(szInfo, 256);
+
+    uint32_t uCtPts=0, uCtFts=0, uFlags=0;
+    str >> uCtPts >> uCtFts >> uFlags;
+
+    try {
+        // read the data block-wise straight into the arrays of the new kernel
+        MeshPointArray pointArray;
+        pointArray.resize(uCtPts);
+        MeshFacetArray facetArray;
+        facetArray.resize(uCtFts);
+
+        // the checksum is computed from the data as written
+        uint32_t computed = MeshChecksumSeed;
+        std::vector<float> coords(MeshChunkBlock);
+        for (std::size_t first = 0; first < uCtPts; first += MeshChunkBlock / 3) {
+            std::size_t count = std::min<std::size_t>(MeshChunkBlock / 3, uCtPts - first);
+            if (!rclIn.read(reinterpret_cast<char*>(&coords[0]), 3 * count * sizeof(float)))
+                throw Base::Exception("Reading from stream failed");
+            computed = MeshChecksum(computed, &coords[0], 3 * count);
+            if (swapBytes)
+                Base::SwapEndian(coords.data(), 3 * count);
+            for (std::size_t k = 0; k < count; k++)
+                pointArray[first + k].Set(coords[3 * k], coords[3 * k + 1], coords[3 * k + 2]);
+        }
+
+        // first the point indices of all facets, then their neighbours if stored
+        bool neighbours = (uFlags & MeshChunkNeighbours) != 0;
+        std::vector<uint32_t> indices(MeshChunkBlock);
+        for (int pass = 0; pass < (neighbours ? 2 : 1); pass++) {
+            for (std::size_t first = 0; first < uCtFts; first += MeshChunkBlock / 3) {
+                std::size_t count = std::min<std::size_t>(MeshChunkBlock / 3, uCtFts - first);
+                if (!rclIn.read(reinterpret_cast<char*>(&indices[0]), 3 * count * sizeof(uint32_t)))
+                    throw Base::Exception("Reading from stream failed");
+                computed = MeshChecksum(computed, &indices[0], 3 * count);
+                if (swapBytes)
+                    Base::SwapEndian(indices.data(), 3 * count);
+                const uint32_t* value = &indices[0];
+                for (std::size_t k = 0; k < count; k++) {
+                    MeshFacet& facet = facetArray[first + k];
+                    for (int i = 0; i < 3; i++, value++) {
+                        if (pass == 0) {
+                            if (*value >= uCtPts)
+                                throw Base::Exception("Mesh data is corrupted");
+                            facet._aulPoints[i] = *value;
+                        }
+                        // On systems where an 'unsigned long' is a 64-bit value
+                        // the empty neighbour must be explicitly set to 'ULONG_MAX'
+                        else if (*value < open_edge)
+                            facet._aulNeighbours[i] = *value;
+                        else
+                            facet._aulNeighbours[i] = ULONG_MAX;
+                    }
+                }
+            }
+        }
+
+        Base::BoundBox3f box;
+        uint32_t checksum = 0;
+        str >> box.MinX >> box.MaxX;
+        str >> box.MinY >> box.MaxY;
+        str >> box.MinZ >> box.MaxZ;
+        str >> checksum;
+        if (!rclIn || checksum != computed)
+            throw Base::Exception("Mesh data is corrupted");
+
+        // If we reach this block no exception occurred and we can safely assign the mesh
+        _aclPointArray.swap(pointArray);
+        _aclFacetArray.swap(facetArray);
+        _clBoundBox = box;
+
+        if (!neighbours && uCtFts > 0)
+            RebuildNeighbours(0);
+    }
+    catch (std::exception&) {
+        // Special handling of std::length_error
+        throw Base::Exception("Reading from stream failed");
+    }
 }
 
 void MeshKernel::Read (std::istream &rclIn)
@@ -818,9 +948,18 @@ void MeshKernel::Read (std::istream &rclIn)
     swap_version = version; Base::SwapEndian(swap_version);
     uint32_t open_edge = 0xffffffff; // value to mark an open edge
 
-    // is it the new or old format?
+    // is it the chunk format, the new or old format?
     bool new_format = false;
-    if (magic == 0xA0B0C0D0 && version == 0x010000) {
+    if (magic == 0xA0B0C0D0 && version == 0x020000) {
+        ReadChunks(rclIn, str);
+        return;
+    }
+    else if (swap_magic == 0xA0B0C0D0 && swap_version == 0x020000) {
+        str.setByteOrder(Base::Stream::BigEndian);
+        ReadChunks(rclIn, str);
+        return;
+    }
+    else if (magic == 0xA0B0C0D0 && version == 0x010000) {
         new_format = true;
     }
     else if (swap_magic == 0xA0B0C0D0 && swap_version == 0x010000) {
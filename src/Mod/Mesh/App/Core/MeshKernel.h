@@ -35,6 +35,7 @@
 #include <Base/Matrix.h>
 
 namespace Base{
+  class InputStream;
   class Polygon2d;
   class ViewProjMethod;
 }
@@ -74,7 +75,10 @@ public:
 
     /** @name I/O methods */
     //@{
-    /// Binary streaming of data
+    /** Binary streaming of data.
+     * The points, facets and neighbours are written as raw arrays followed by a checksum.
+     * Read() also accepts the formats of older versions.
+     */
     void Write (std::ostream &rclOut) const;
     void Read (std::istream &rclIn);
     //@}
@@ -428,6 +432,8 @@ protected:
      * doesn't get deleted but marked as invalid.
      */
     void ErasePoint (unsigned long ulIndex, unsigned long ulFacetIndex, bool bOnlySetInvalid = false);
+    /** Reads the arrays of the chunk format after the magic number and version. */
+    void ReadChunks (std::istream &rclIn, Base::InputStream &str);
 
     /** Adjusts the facet's orierntation to the given normal direction. */
     inline void AdjustNormal (MeshFacet &rclFacet, const Base::Vector3f &rclNormal);
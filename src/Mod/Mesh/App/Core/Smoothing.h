@@ -29,8 +29,8 @@
 namespace MeshCore
 {
 class MeshKernel;
-class MeshRefPointToPoints;
-class MeshRefPointToFacets;
+class MeshCompactPointToPoints;
+class MeshCompactPointToFacets;
 
 /** Base class for smoothing algorithms. */
 class MeshExport AbstractSmoothing
@@ -83,10 +83,10 @@ public:
     void SetLambda(double l) { lambda = l;}
 
 protected:
-    void Umbrella(const MeshRefPointToPoints&,
-                  const MeshRefPointToFacets&, double);
-    void Umbrella(const MeshRefPointToPoints&,
-                  const MeshRefPointToFacets&, double,
+    void Umbrella(const MeshCompactPointToPoints&,
+                  const MeshCompactPointToFacets&, double);
+    void Umbrella(const MeshCompactPointToPoints&,
+                  const MeshCompactPointToFacets&, double,
                   const std::vector<unsigned long>&);
 
 protected:
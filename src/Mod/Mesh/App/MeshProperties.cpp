@@ -156,9 +156,8 @@ void PropertyNormalList::SaveDocFile (Base::Writer &writer) const
     Base::OutputStream str(writer.Stream());
     uint32_t uCt = (uint32_t)getSize();
     str << uCt;
-    for (std::vector<Base::Vector3f>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-        str << it->x << it->y << it->z;
-    }
+    static_assert(sizeof(Base::Vector3f) == 3 * sizeof(float), "Base::Vector3f must be stored without padding");
+    str.write(reinterpret_cast<const float*>(_lValueList.data()), 3 * _lValueList.size());
 }
 
 void PropertyNormalList::RestoreDocFile(Base::Reader &reader)
@@ -167,9 +166,8 @@ void PropertyNormalList::RestoreDocFile(Base::Reader &reader)
     uint32_t uCt=0;
     str >> uCt;
     std::vector<Base::Vector3f> values(uCt);
-    for (std::vector<Base::Vector3f>::iterator it = values.begin(); it != values.end(); ++it) {
-        str >> it->x >> it->y >> it->z;
-    }
+    static_assert(sizeof(Base::Vector3f) == 3 * sizeof(float), "Base::Vector3f must be stored without padding");
+    str.read(reinterpret_cast<float*>(values.data()), 3 * values.size());
     setValues(values);
 }
 
@@ -359,11 +357,9 @@ void PropertyCurvatureList::SaveDocFile (Base::Writer &writer) const
     Base::OutputStream str(writer.Stream());
     uint32_t uCt = (uint32_t)getSize();
     str << uCt;
-    for (std::vector<CurvatureInfo>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-        str << it->fMaxCurvature << it->fMinCurvature;
-        str << it->cMaxCurvDir.x << it->cMaxCurvDir.y << it->cMaxCurvDir.z;
-        str << it->cMinCurvDir.x << it->cMinCurvDir.y << it->cMinCurvDir.z;
-    }
+    // the members of CurvatureInfo are eight floats in the order they are stored
+    static_assert(sizeof(CurvatureInfo) == 8 * sizeof(float), "CurvatureInfo must be stored without padding");
+    str.write(reinterpret_cast<const float*>(_lValueList.data()), 8 * _lValueList.size());
 }
 
 void PropertyCurvatureList::RestoreDocFile(Base::Reader &reader)
@@ -372,11 +368,8 @@ void PropertyCurvatureList::RestoreDocFile(Base::Reader &reader)
     uint32_t uCt=0;
     str >> uCt;
     std::vector<CurvatureInfo> values(uCt);
-    for (std::vector<CurvatureInfo>::iterator it = values.begin(); it != values.end(); ++it) {
-        str >> it->fMaxCurvature >> it->fMinCurvature;
-        str >> it->cMaxCurvDir.x >> it->cMaxCurvDir.y >> it->cMaxCurvDir.z;
-        str >> it->cMinCurvDir.x >> it->cMinCurvDir.y >> it->cMinCurvDir.z;
-    }
+    static_assert(sizeof(CurvatureInfo) == 8 * sizeof(float), "CurvatureInfo must be stored without padding");
+    str.read(reinterpret_cast<float*>(values.data()), 8 * values.size());
 
     setValues(values);
 }
@@ -450,55 +443,97 @@ void PropertyMeshKernel::setValuePtr(MeshObject* mesh)
     // before calling hasSetValue()
     Base::Reference<MeshObject> tmp(_meshObject);
     aboutToSetValue();
-    _meshObject = mesh;
+    discardDeferred();
+    setMeshObject(mesh);
     hasSetValue();
 }
 
+void PropertyMeshKernel::setMeshObject(MeshObject* mesh)
+{
+    // let the Python binding follow the mesh object
+    if (meshPyObject) {
+        mesh->ref();
+        meshPyObject->getMeshObjectPtr()->unref();
+        meshPyObject->_pcTwinPointer = mesh;
+    }
+    _meshObject = mesh;
+}
+
+bool PropertyMeshKernel::isMeshShared() const
+{
+    // The mesh object may be shared with copies of this property, e.g. in the
+    // undo stack. In this case it must be copied before it gets modified.
+    int owners = meshPyObject ? 2 : 1;
+    return _meshObject.getRefCount() > owners;
+}
+
+void PropertyMeshKernel::detachMesh()
+{
+    if (isMeshShared())
+        setMeshObject(new MeshObject(*_meshObject));
+}
+
 void PropertyMeshKernel::setValue(const MeshObject& mesh)
 {
     aboutToSetValue();
-    *_meshObject = mesh;
+    discardDeferred();
+    if (isMeshShared())
+        setMeshObject(new MeshObject(mesh));
+    else
+        *_meshObject = mesh;
     hasSetValue();
 }
 
 void PropertyMeshKernel::setValue(const MeshCore::MeshKernel& mesh)
 {
     aboutToSetValue();
-    _meshObject->setKernel(mesh);
+    discardDeferred();
+    if (isMeshShared())
+        setMeshObject(new MeshObject(mesh, _meshObject->getTransform()));
+    else
+        _meshObject->setKernel(mesh);
     hasSetValue();
 }
 
 void PropertyMeshKernel::swapMesh(MeshObject& mesh)
 {
+    loadDeferred();
     aboutToSetValue();
+    detachMesh();
     _meshObject->swap(mesh);
     hasSetValue();
 }
 
 void PropertyMeshKernel::swapMesh(MeshCore::MeshKernel& mesh)
 {
+    loadDeferred();
     aboutToSetValue();
+    detachMesh();
     _meshObject->swap(mesh);
     hasSetValue();
 }
 
 const MeshObject& PropertyMeshKernel::getValue(void)const 
 {
+    loadDeferred();
     return *_meshObject;
 }
 
 const MeshObject* PropertyMeshKernel::getValuePtr(void)const 
 {
+    loadDeferred();
     return (MeshObject*)_meshObject;
 }
 
 const Data::ComplexGeoData* PropertyMeshKernel::getComplexData() const
 {
+    loadDeferred();
     return (MeshObject*)_meshObject;
 }
 
 Base::BoundBox3d PropertyMeshKernel::getBoundingBox() const
 {
+    loadDeferred();
     return _meshObject->getBoundBox();
 }
 
@@ -512,7 +547,9 @@ unsigned int PropertyMeshKernel::getMemSize (void) const
 
 MeshObject* PropertyMeshKernel::startEditing()
 {
+    loadDeferred();
     aboutToSetValue();
+    detachMesh();
     return (MeshObject*)_meshObject;
 }
 
@@ -523,14 +560,24 @@ void PropertyMeshKernel::finishEditing()
 
 void PropertyMeshKernel::transformGeometry(const Base::Matrix4D &rclMat)
 {
+    loadDeferred();
     aboutToSetValue();
+    detachMesh();
     _meshObject->transformGeometry(rclMat);
     hasSetValue();
 }
 
+void PropertyMeshKernel::setTransform(const Base::Matrix4D &rclTrf)
+{
+    detachMesh();
+    _meshObject->setTransform(rclTrf);
+}
+
 void PropertyMeshKernel::setPointIndices(const std::vector<std::pair<unsigned long, Base::Vector3f> >& inds)
 {
+    loadDeferred();
     aboutToSetValue();
+    detachMesh();
     MeshCore::MeshKernel& kernel = _meshObject->getKernel();
     for (std::vector<std::pair<unsigned long, Base::Vector3f> >::const_iterator it = inds.begin(); it != inds.end(); ++it)
         kernel.SetPoint(it->first, it->second);
@@ -539,6 +586,7 @@ void PropertyMeshKernel::setPointIndices(const std::vector<std::pair<unsigned lo
 
 PyObject *PropertyMeshKernel::getPyObject(void)
 {
+    loadDeferred();
     if (!meshPyObject) {
         meshPyObject = new MeshPy(&*_meshObject);
         meshPyObject->setConst(); // set immutable
@@ -574,6 +622,7 @@ void PropertyMeshKernel::setPyObject(PyObject *value)
 
 void PropertyMeshKernel::Save (Base::Writer &writer) const
 {
+    loadDeferred();
     if (writer.isForceXML()) {
         writer.Stream() << writer.ind() << "<Mesh>" << std::endl;
         MeshCore::MeshOutput saver(_meshObject->getKernel());
@@ -602,40 +651,46 @@ void PropertyMeshKernel::Restore(Base::XMLReader &reader)
         kernel.Adopt(points, facets);
 
         aboutToSetValue();
+        detachMesh();
         _meshObject->getKernel().Adopt(points, facets);
         hasSetValue();
     } 
     else {
         // initate a file read
         reader.addFile(file.c_str(),this);
+        deferFile(reader, this);
     }
 }
 
 void PropertyMeshKernel::SaveDocFile (Base::Writer &writer) const
 {
+    loadDeferred();
     _meshObject->save(writer.Stream());
 }
 
 void PropertyMeshKernel::RestoreDocFile(Base::Reader &reader)
 {
     aboutToSetValue();
+    detachMesh();
     _meshObject->load(reader);
     hasSetValue();
 }
 
 App::Property *PropertyMeshKernel::Copy(void) const
 {
-    // Note: Copy the content, do NOT reference the same mesh object
+    loadDeferred();
+    // Note: Reference the same mesh object, it gets copied by the
+    // first of the properties which modifies it
     PropertyMeshKernel *prop = new PropertyMeshKernel();
-    *(prop->_meshObject) = *(this->_meshObject);
+    prop->_meshObject = this->_meshObject;
     return prop;
 }
 
 void PropertyMeshKernel::Paste(const App::Property &from)
 {
-    // Note: Copy the content, do NOT reference the same mesh object
     aboutToSetValue();
+    discardDeferred();
     const PropertyMeshKernel& prop = dynamic_cast<const PropertyMeshKernel&>(from);
-    *(this->_meshObject) = *(prop._meshObject);
+    setMeshObject(prop._meshObject);
     hasSetValue();
 }
@@ -215,6 +215,8 @@ public:
     void finishEditing();
     /// Transform the real mesh data
     void transformGeometry(const Base::Matrix4D &rclMat);
+    /// Set the placement of the mesh without notifying a change
+    void setTransform(const Base::Matrix4D &rclTrf);
     void setPointIndices( const std::vector<std::pair<unsigned long, Base::Vector3f> >& );
     //@}
 
@@ -245,10 +247,18 @@ public:
     void SaveDocFile (Base::Writer &writer) const;
     void RestoreDocFile(Base::Reader &reader);
 
+    /** The copy shares the mesh object with this property until one of
+     * them gets modified.
+     */
     App::Property *Copy(void) const;
     void Paste(const App::Property &from);
     //@}
 
+private:
+    void setMeshObject(MeshObject*);
+    bool isMeshShared() const;
+    void detachMesh();
+
 private:
     Base::Reference<MeshObject> _meshObject;
     MeshPy* meshPyObject;
@@ -83,7 +83,9 @@ int MeshPy::PyInit(PyObject* args, PyObject*)
             if (!ok) return -1;
         }
         else if (PyString_Check(pcObj)) {
-            getMeshObjectPtr()->load(PyString_AsString(pcObj));
+            const char* name = PyString_AsString(pcObj);
+            if (!getMeshObjectPtr()->load(name))
+                throw Base::FileException("Cannot read mesh from file", name);
         }
         else {
             PyErr_Format(PyExc_TypeError, "Cannot create a mesh out of a '%s'",
@@ -137,8 +139,12 @@ PyObject*  MeshPy::read(PyObject *args)
 {
     char* Name;
     if (PyArg_ParseTuple(args, "et", "utf-8", &Name)) {
-        getMeshObjectPtr()->load(Name);
+        std::string EncodedName = std::string(Name);
         PyMem_Free(Name);
+        if (!getMeshObjectPtr()->load(EncodedName.c_str())) {
+            PyErr_Format(Base::BaseExceptionFreeCADError, "Cannot read mesh from file '%s'", EncodedName.c_str());
+            return 0;
+        }
         Py_Return;
     }
 
@@ -173,7 +179,10 @@ PyObject*  MeshPy::read(PyObject *args)
         Base::PyStreambuf buf(input);
         std::istream str(0);
         str.rdbuf(&buf);
-        getMeshObjectPtr()->load(str, format);
+        if (!getMeshObjectPtr()->load(str, format)) {
+            PyErr_SetString(Base::BaseExceptionFreeCADError, "Cannot read mesh from stream");
+            return 0;
+        }
 
         Py_Return;
     }
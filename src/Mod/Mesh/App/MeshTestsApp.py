@@ -1,7 +1,7 @@
 #   (c) Juergen Riegel (juergen.riegel@web.de) 2007      LGPL
 
 import FreeCAD, os, sys, unittest, Mesh
-import thread, time, tempfile, math
+import thread, time, tempfile, math, struct
 
 
 #---------------------------------------------------------------------------
@@ -220,3 +220,342 @@ class PolynomialFitCases(unittest.TestCase):
 
     def tearDown(self):
         pass
+
+
+def laplaceSmoothing(mesh, iterations, stepsize=0.6307):
+    "Reference implementation of the umbrella operator used by Mesh.smooth()"
+    points, faces = mesh.Topology
+    points = [[p.x, p.y, p.z] for p in points]
+    neighbours = [set() for p in points]
+    facets = [0] * len(points)
+    for f in faces:
+        for i in range(3):
+            facets[f[i]] += 1
+            neighbours[f[i]].add(f[(i+1)%3])
+            neighbours[f[i]].add(f[(i+2)%3])
+    for n in range(iterations):
+        for i, p in enumerate(points):
+            nb = sorted(neighbours[i])
+            # border points and points with too few neighbours are kept
+            if len(nb) < 3 or len(nb) != facets[i]:
+                continue
+            w = 1.0 / len(nb)
+            d = [sum(w * (points[j][k] - p[k]) for j in nb) for k in range(3)]
+            points[i] = [p[k] + stepsize * d[k] for k in range(3)]
+    return points
+
+class MeshAdjacencyCases(unittest.TestCase):
+    def checkSmoothing(self, mesh, iterations):
+        reference = laplaceSmoothing(mesh, iterations)
+        mesh.smooth(iterations)
+        points = mesh.Topology[0]
+        self.failUnless(len(points) == len(reference))
+        for p, r in zip(points, reference):
+            self.failUnless((p - FreeCAD.Vector(r[0], r[1], r[2])).Length < 1e-4,
+                            "Smoothed point %s differs from %s" % (p, r))
+
+    def testSmoothClosedMesh(self):
+        mesh = Mesh.createSphere(1.0, 12)
+        # move some points so that the smoothing has something to do
+        mesh.setPoint(0, mesh.Points[0].Vector + FreeCAD.Vector(0.3, 0.2, -0.1))
+        mesh.setPoint(5, mesh.Points[5].Vector + FreeCAD.Vector(-0.2, 0.0, 0.4))
+        self.checkSmoothing(mesh, 3)
+
+    def testSmoothOpenMesh(self):
+        # a 5x5 grid of points with a peak in the middle; the border points must not move
+        n = 5
+        z = lambda i, j: 1.0 if (i, j) == (2, 2) else 0.0
+        triangles = []
+        for i in range(n - 1):
+            for j in range(n - 1):
+                p00 = FreeCAD.Vector(i, j, z(i, j))
+                p10 = FreeCAD.Vector(i + 1, j, z(i + 1, j))
+                p01 = FreeCAD.Vector(i, j + 1, z(i, j + 1))
+                p11 = FreeCAD.Vector(i + 1, j + 1, z(i + 1, j + 1))
+                triangles += [[p00, p10, p11], [p00, p11, p01]]
+        mesh = Mesh.Mesh(triangles)
+        self.failUnless(mesh.CountPoints == n * n)
+        self.checkSmoothing(mesh, 2)
+        for p in mesh.Points:
+            if p.x in (0, n - 1) or p.y in (0, n - 1):
+                self.failUnless(p.z == 0.0)
+            elif (p.x, p.y) == (2, 2):
+                self.failUnless(0.0 < p.z < 1.0)
+
+    def testFillupHoles(self):
+        mesh = Mesh.createSphere(1.0, 12)
+        count = mesh.CountFacets
+        mesh.removeFacets([0])
+        self.failUnless(mesh.CountFacets == count - 1)
+        self.failIf(mesh.isSolid())
+        mesh.fillupHoles(10)
+        self.failUnless(mesh.CountFacets == count)
+        self.failUnless(mesh.isSolid())
+
+
+def planeSectionLength(mesh, base, normal):
+    "Brute force length of the intersection of all facets with a plane"
+    length = 0.0
+    for f in mesh.Facets:
+        pts = [FreeCAD.Vector(p[0], p[1], p[2]) for p in f.Points]
+        dist = [(p - base).dot(normal) for p in pts]
+        cuts = []
+        for i in range(3):
+            a, b = dist[i], dist[(i+1)%3]
+            if (a < 0) != (b < 0):
+                t = a / (a - b)
+                cuts.append(pts[i] + (pts[(i+1)%3] - pts[i]) * t)
+        if len(cuts) == 2:
+            length += (cuts[0] - cuts[1]).Length
+    return length
+
+class MeshGridCases(unittest.TestCase):
+    def checkSections(self, mesh, planes):
+        sections = mesh.crossSections(planes, 1e-4)
+        self.failUnless(len(sections) == len(planes))
+        for (base, normal), section in zip(planes, sections):
+            length = 0.0
+            for polyline in section:
+                for i in range(len(polyline) - 1):
+                    self.failUnless(abs((polyline[i] - base).dot(normal)) < 1e-3)
+                    length += (polyline[i+1] - polyline[i]).Length
+            reference = planeSectionLength(mesh, base, normal)
+            # facets missing in the grid show up as gaps in the section
+            self.failUnless(abs(length - reference) < 1e-3 * max(1.0, reference),
+                            "Section length %f differs from brute force result %f" % (length, reference))
+
+    def testSectionsOfSphere(self):
+        mesh = Mesh.createSphere(10.0, 30)
+        normal = FreeCAD.Vector(0.3, -0.2, 1.0)
+        normal.normalize()
+        planes = [(FreeCAD.Vector(0, 0, z + 0.123), normal) for z in range(-9, 10, 3)]
+        planes.append((FreeCAD.Vector(0.037, 0, 0), FreeCAD.Vector(1, 0, 0)))
+        self.checkSections(mesh, planes)
+
+    def testSectionsOfTranslatedBox(self):
+        # a flat box far off the origin gives grid elements with very different extents
+        mesh = Mesh.createBox(50.0, 2.0, 0.5, 0.4)
+        mesh.addMesh(Mesh.createSphere(1.0, 12))
+        mesh.translate(1000.0, -500.0, 20.0)
+        box = mesh.BoundBox
+        center = box.Center
+        planes = [(FreeCAD.Vector(box.XMin + x + 0.071, center.y, center.z), FreeCAD.Vector(1, 0, 0))
+                  for x in range(0, 50, 4)]
+        planes.append((center + FreeCAD.Vector(0, 0.3, 0), FreeCAD.Vector(0, 1, 0)))
+        self.checkSections(mesh, planes)
+
+
+def toFloat(value):
+    "Round a Python float to single precision like the mesh kernel does"
+    return struct.unpack('<f', struct.pack('<f', value))[0]
+
+class MeshImportCases(unittest.TestCase):
+    def setUp(self):
+        self.files = []
+
+    def writeFile(self, ext, data, mode='w'):
+        fd, name = tempfile.mkstemp(suffix=ext)
+        os.close(fd)
+        with open(name, mode) as f:
+            f.write(data)
+        self.files.append(name)
+        return name
+
+    def checkQuad(self, mesh):
+        # two triangles sharing an edge of the unit square scaled by 0.1
+        self.failUnless(mesh.CountPoints == 4)
+        self.failUnless(mesh.CountFacets == 2)
+        coords = sorted([(p.x, p.y, p.z) for p in mesh.Points])
+        tenth = toFloat(0.1)
+        self.failUnless(coords == sorted([(0.0, 0.0, 0.0), (tenth, 0.0, 0.0),
+                                          (tenth, tenth, 0.0), (0.0, tenth, 0.0)]),
+                        "Unexpected points %s" % coords)
+
+    def testAsciiSTL(self):
+        name = self.writeFile(".stl",
+            "solid quad\n"
+            "  facet normal 0 0 1\n"
+            "    outer loop\n"
+            "      vertex 0 0 0\n"
+            "      vertex 0.1 0 0\n"
+            "      vertex 1.0E-1 100e-3 0\n"
+            "    endloop\n"
+            "  endfacet\n"
+            "  facet normal 0 0 1\n"
+            "    outer loop\n"
+            "      vertex 0 0 0\n"
+            "      vertex 0.1000000000000000055511151231257827 0.1 0\n"
+            "      vertex -0.0 +0.1 0\n"
+            "    endloop\n"
+            "  endfacet\n"
+            "endsolid quad\n")
+        self.checkQuad(Mesh.Mesh(name))
+
+    def binarySTL(self, facets, count=None):
+        if count is None:
+            count = len(facets)
+        data = b"binary quad".ljust(80, b" ") + struct.pack('<I', count)
+        for f in facets:
+            data += struct.pack('<12fH', 0.0, 0.0, 1.0, *(f + (0,)))
+        return data
+
+    def testBinarySTL(self):
+        facets = [(0.0, 0.0, 0.0, 0.1, 0.0, 0.0, 0.1, 0.1, 0.0),
+                  (0.0, 0.0, 0.0, 0.1, 0.1, 0.0, 0.0, 0.1, 0.0)]
+        name = self.writeFile(".stl", self.binarySTL(facets), 'wb')
+        self.checkQuad(Mesh.Mesh(name))
+
+    def testTruncatedBinarySTL(self):
+        facets = [(0.0, 0.0, 0.0, 0.1, 0.0, 0.0, 0.1, 0.1, 0.0),
+                  (0.0, 0.0, 0.0, 0.1, 0.1, 0.0, 0.0, 0.1, 0.0)]
+        # the header announces more facets than the file contains
+        name = self.writeFile(".stl", self.binarySTL(facets, 3), 'wb')
+        mesh = Mesh.Mesh()
+        self.assertRaises(Exception, mesh.read, name)
+        self.failUnless(mesh.CountFacets == 0)
+        self.assertRaises(Exception, Mesh.Mesh, name)
+        # cut off in the middle of the last record
+        data = self.binarySTL(facets)
+        name = self.writeFile(".stl", data[:-20], 'wb')
+        self.assertRaises(Exception, Mesh.Mesh, name)
+
+    def testOBJ(self):
+        name = self.writeFile(".obj",
+            "# quad\n"
+            "v 0 0 0\n"
+            "v 0.1 0 0\n"
+            "v 0.1 0.1 0\n"
+            "v 0 0.1 0\n"
+            "f 1 2 3\n"
+            "f 1 3 4\n")
+        self.checkQuad(Mesh.Mesh(name))
+
+    def testPLY(self):
+        name = self.writeFile(".ply",
+            "ply\n"
+            "format ascii 1.0\n"
+            "element vertex 4\n"
+            "property float x\n"
+            "property float y\n"
+            "property float z\n"
+            "element face 2\n"
+            "property list uchar int vertex_indices\n"
+            "end_header\n"
+            "0 0 0\n"
+            "0.1 0 0\n"
+            "0.1 0.1 0\n"
+            "0 0.1 0\n"
+            "3 0 1 2\n"
+            "3 0 2 3\n")
+        self.checkQuad(Mesh.Mesh(name))
+
+    def testCounts(self):
+        # a closed mesh keeps its counts through a write/read cycle of each format
+        sphere = Mesh.createSphere(1.0, 30)
+        for ext in (".stl", ".ast", ".obj", ".ply"):
+            name = self.writeFile(ext, "")
+            sphere.write(name)
+            mesh = Mesh.Mesh(name)
+            self.failUnless(mesh.CountPoints == sphere.CountPoints,
+                            "%s: %d points instead of %d" % (ext, mesh.CountPoints, sphere.CountPoints))
+            self.failUnless(mesh.CountFacets == sphere.CountFacets,
+                            "%s: %d facets instead of %d" % (ext, mesh.CountFacets, sphere.CountFacets))
+
+    def checkRoundTrip(self, mesh):
+        name = self.writeFile(".bms", "")
+        mesh.write(name)
+        other = Mesh.Mesh(name)
+        self.failUnless(other.CountPoints == mesh.CountPoints)
+        self.failUnless(other.CountFacets == mesh.CountFacets)
+        self.failUnless([p.Vector for p in other.Points] == [p.Vector for p in mesh.Points])
+        self.failUnless([f.PointIndices for f in other.Facets] == [f.PointIndices for f in mesh.Facets])
+        self.failUnless([f.NeighbourIndices for f in other.Facets] == [f.NeighbourIndices for f in mesh.Facets])
+
+    def testBinaryKernelRoundTrip(self):
+        # large enough to be written and read in several blocks
+        self.checkRoundTrip(Mesh.createSphere(1.0, 80))
+        # open edges have no neighbour
+        mesh = Mesh.createBox(1.0, 2.0, 3.0)
+        mesh.removeFacets([0, 5])
+        self.checkRoundTrip(mesh)
+        self.checkRoundTrip(Mesh.Mesh())
+
+    def testCorruptedBinaryKernel(self):
+        name = self.writeFile(".bms", "")
+        Mesh.createSphere(1.0, 20).write(name)
+        with open(name, 'rb') as f:
+            data = bytearray(f.read())
+        # flip a bit in the point coordinates behind the header
+        data[8 + 256 + 12 + 5] ^= 0x10
+        with open(name, 'wb') as f:
+            f.write(data)
+        self.assertRaises(Exception, Mesh.Mesh, name)
+
+    def tearDown(self):
+        for name in self.files:
+            os.remove(name)
+
+
+class MeshUndoCases(unittest.TestCase):
+    def setUp(self):
+        self.Doc = FreeCAD.newDocument("MeshUndoTest")
+        self.Doc.UndoMode = 1
+        self.Doc.openTransaction("Create")
+        self.Feature = self.Doc.addObject("Mesh::Feature", "Mesh")
+        self.Feature.Mesh = Mesh.createSphere(1.0, 12)
+        self.Doc.commitTransaction()
+
+    def points(self, mesh):
+        return [FreeCAD.Vector(p.x, p.y, p.z) for p in mesh.Points]
+
+    def checkPoints(self, mesh, points):
+        self.failUnless(mesh.CountPoints == len(points))
+        for p, q in zip(self.points(mesh), points):
+            self.failUnless((p - q).Length < 1e-6, "Point %s differs from %s" % (p, q))
+
+    def testUndoEditing(self):
+        # the undo snapshot shares the mesh until it gets modified in place
+        mesh = self.Feature.Mesh
+        original = self.points(mesh)
+        self.Doc.openTransaction("Smooth")
+        self.Feature.smooth(3)
+        self.Doc.commitTransaction()
+        smoothed = self.points(self.Feature.Mesh)
+        self.failIf(all((p - q).Length < 1e-6 for p, q in zip(original, smoothed)))
+        self.Doc.undo()
+        self.checkPoints(self.Feature.Mesh, original)
+        # the Python object of the property follows the restored mesh
+        self.checkPoints(mesh, original)
+        self.Doc.redo()
+        self.checkPoints(self.Feature.Mesh, smoothed)
+        self.Doc.undo()
+        self.checkPoints(self.Feature.Mesh, original)
+
+    def testUndoPlacement(self):
+        original = self.points(self.Feature.Mesh)
+        offset = FreeCAD.Vector(1, 2, 3)
+        self.Doc.openTransaction("Move")
+        self.Feature.Placement = FreeCAD.Placement(offset, FreeCAD.Rotation())
+        self.Doc.commitTransaction()
+        self.checkPoints(self.Feature.Mesh, [p + offset for p in original])
+        self.Doc.undo()
+        self.checkPoints(self.Feature.Mesh, original)
+        self.Doc.redo()
+        self.checkPoints(self.Feature.Mesh, [p + offset for p in original])
+
+    def testUndoAssignment(self):
+        original = self.points(self.Feature.Mesh)
+        self.Doc.openTransaction("Replace")
+        self.Feature.Mesh = Mesh.createBox(1.0, 2.0, 3.0)
+        self.Doc.commitTransaction()
+        self.failUnless(self.Feature.Mesh.CountPoints == 8)
+        # modifying the new mesh in place must not touch the snapshot
+        self.Doc.openTransaction("Smooth")
+        self.Feature.smooth(1)
+        self.Doc.commitTransaction()
+        self.Doc.undo()
+        self.Doc.undo()
+        self.checkPoints(self.Feature.Mesh, original)
+
+    def tearDown(self):
+        FreeCAD.closeDocument("MeshUndoTest")
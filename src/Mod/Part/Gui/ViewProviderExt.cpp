@@ -24,6 +24,7 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <set>
 # include <sstream>
 # include <Bnd_Box.hxx>
 # include <Poly_Polygon3D.hxx>
@@ -96,6 +97,10 @@
 # include <QMenu>
 #endif
 
+#include <QtConcurrentMap>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+
 /// Here the FreeCAD includes sorted by Base,App,Gui......
 #include <Base/Console.h>
 #include <Base/Parameter.h>
@@ -125,12 +130,16 @@ using namespace PartGui;
 
 PROPERTY_SOURCE(PartGui::ViewProviderPartExt, Gui::ViewProviderGeometryObject)
 
+namespace {
 
-void ViewProviderPartExt::GetNormals(const TopoDS_Face&  theFace,
-             const Handle(Poly_Triangulation)& aPolyTri,
-             TColgp_Array1OfDir& theNormals)
+// Computes the normals of the triangulation of a face. If the normals are not
+// stored in the triangulation yet, the computed values are returned so that
+// the caller can store them. This function doesn't modify the triangulation
+// and can therefore be called from several threads at once.
+Handle(TShort_HArray1OfShortReal) computeNormals(const TopoDS_Face&  theFace,
+                                                 const Handle(Poly_Triangulation)& aPolyTri,
+                                                 TColgp_Array1OfDir& theNormals)
 {
-    Poly_Connect thePolyConnect(aPolyTri);
     const TColgp_Array1OfPnt&         aNodes   = aPolyTri->Nodes();
 
     if(aPolyTri->HasNormals())
@@ -156,10 +165,11 @@ void ViewProviderPartExt::GetNormals(const TopoDS_Face&  theFace,
             }
         }
 
-        return;
+        return Handle(TShort_HArray1OfShortReal)();
     }
 
     // take in face the surface location
+    Poly_Connect thePolyConnect(aPolyTri);
     const TopoDS_Face      aZeroFace = TopoDS::Face(theFace.Located(TopLoc_Location()));
     Handle(Geom_Surface)   aSurf     = BRep_Tool::Surface(aZeroFace);
     const Standard_Real    aTol      = Precision::Confusion();
@@ -203,8 +213,6 @@ void ViewProviderPartExt::GetNormals(const TopoDS_Face&  theFace,
         aNormals->SetValue(anId + 3, (Standard_ShortReal)theNormals(aNodeIter).Z());
     }
 
-    aPolyTri->SetNormals(aNormals);
-
     if(theFace.Orientation() == TopAbs_REVERSED)
     {
         for(Standard_Integer aNodeIter = aNodes.Lower(); aNodeIter <= aNodes.Upper(); ++aNodeIter)
@@ -212,6 +220,246 @@ void ViewProviderPartExt::GetNormals(const TopoDS_Face&  theFace,
             theNormals.ChangeValue(aNodeIter).Reverse();
         }
     }
+
+    return aNormals;
+}
+
+// The Inventor representation of a shape, i.e. the content of the coordinate,
+// normal, face set, line set and point set nodes of ViewProviderPartExt.
+struct TessellationData
+{
+    TessellationData() : startIndex(0) {}
+
+    std::vector<SbVec3f> verts;
+    std::vector<SbVec3f> norms;
+    std::vector<int32_t> faceIndex;
+    std::vector<int32_t> parts;
+    std::vector<int32_t> lineIndex;
+    int startIndex;
+
+    std::size_t memSize() const
+    {
+        return (verts.size() + norms.size()) * sizeof(SbVec3f) +
+               (faceIndex.size() + parts.size() + lineIndex.size()) * sizeof(int32_t);
+    }
+};
+
+typedef boost::shared_ptr<const TessellationData> TessellationDataPtr;
+
+// Keeps the Inventor representation of the most recently shown shapes, so that
+// re-showing an object with an unchanged shape neither meshes the shape again
+// nor rebuilds the buffers. An entry is identified by the shape (without its
+// location), the deviation and the angular deflection. As the entry holds the
+// shape its TShape cannot be freed and re-used by another shape while the
+// entry is alive.
+// The least recently used entries are dropped when the size of all buffers
+// exceeds the limit set in the parameter 'TessellationCacheSize' (in MB).
+// Because the buffers are only a part of the memory kept by an entry, the
+// entries are also dropped when the last object that has shown the shape is
+// deleted or its document is closed.
+class TessellationCache
+{
+public:
+    static TessellationCache& instance()
+    {
+        static TessellationCache cache;
+        return cache;
+    }
+
+    TessellationDataPtr find(const TopoDS_Shape& shape, double deviation, double angularDeflection,
+                             const App::DocumentObject* owner)
+    {
+        std::pair<Index::iterator, Index::iterator> range = index.equal_range(shape.HashCode(INT_MAX));
+        for (Index::iterator it = range.first; it != range.second; ++it) {
+            Entries::iterator jt = it->second;
+            if (jt->shape.IsEqual(shape) &&
+                jt->deviation == deviation &&
+                jt->angularDeflection == angularDeflection) {
+                // move to the front of the list of recently used entries
+                entries.splice(entries.begin(), entries, jt);
+                jt->owners.insert(owner);
+                return jt->data;
+            }
+        }
+
+        return TessellationDataPtr();
+    }
+
+    void insert(const TopoDS_Shape& shape, double deviation, double angularDeflection,
+                const TessellationDataPtr& data, const App::DocumentObject* owner)
+    {
+        ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+            ("User parameter:BaseApp/Preferences/Mod/Part");
+        long maxSize = hGrp->GetInt("TessellationCacheSize", 128);
+        std::size_t maxBytes = maxSize > 0 ? static_cast<std::size_t>(maxSize) * 1024 * 1024 : 0;
+
+        std::size_t bytes = data->memSize();
+        if (bytes > maxBytes)
+            return;
+
+        Entry entry;
+        entry.shape = shape;
+        entry.deviation = deviation;
+        entry.angularDeflection = angularDeflection;
+        entry.data = data;
+        entry.owners.insert(owner);
+        entries.push_front(entry);
+        index.insert(std::make_pair(shape.HashCode(INT_MAX), entries.begin()));
+        size += bytes;
+
+        while (size > maxBytes)
+            erase(--entries.end());
+    }
+
+private:
+    TessellationCache() : size(0)
+    {
+        App::GetApplication().signalDeletedObject.connect
+            (boost::bind(&TessellationCache::slotDeletedObject, this, _1));
+        App::GetApplication().signalDeleteDocument.connect
+            (boost::bind(&TessellationCache::slotDeleteDocument, this, _1));
+    }
+
+    struct Entry {
+        TopoDS_Shape shape;
+        double deviation;
+        double angularDeflection;
+        TessellationDataPtr data;
+        // the objects that have shown the shape
+        std::set<const App::DocumentObject*> owners;
+    };
+    typedef std::list<Entry> Entries;
+    typedef std::multimap<int, Entries::iterator> Index;
+
+    void erase(Entries::iterator jt)
+    {
+        std::pair<Index::iterator, Index::iterator> range = index.equal_range(jt->shape.HashCode(INT_MAX));
+        for (Index::iterator it = range.first; it != range.second; ++it) {
+            if (it->second == jt) {
+                index.erase(it);
+                break;
+            }
+        }
+        size -= jt->data->memSize();
+        entries.erase(jt);
+    }
+
+    void slotDeletedObject(const App::DocumentObject& obj)
+    {
+        for (Entries::iterator it = entries.begin(); it != entries.end();) {
+            Entries::iterator jt = it++;
+            if (jt->owners.erase(&obj) > 0 && jt->owners.empty())
+                erase(jt);
+        }
+    }
+
+    void slotDeleteDocument(const App::Document& doc)
+    {
+        for (Entries::iterator it = entries.begin(); it != entries.end();) {
+            Entries::iterator jt = it++;
+            for (std::set<const App::DocumentObject*>::iterator ot = jt->owners.begin(); ot != jt->owners.end();) {
+                if ((*ot)->getDocument() == &doc)
+                    jt->owners.erase(ot++);
+                else
+                    ++ot;
+            }
+            if (jt->owners.empty())
+                erase(jt);
+        }
+    }
+
+    Entries entries;
+    Index index;
+    std::size_t size;
+};
+
+// The triangulation of a face and the place of its nodes and triangles in the
+// buffers of TessellationData.
+struct FaceTessellation
+{
+    TopoDS_Face face;
+    Handle(Poly_Triangulation) mesh;
+    TopLoc_Location loc;
+    int nodeOffset;
+    int triaOffset;
+    // normals computed by fillFace() which are not yet stored in the triangulation
+    Handle(TShort_HArray1OfShortReal) normals;
+};
+
+// Fills in the vertices, normals and triangles of a face. Each face writes to
+// its own range of the buffers, so the faces can be handled in parallel.
+void fillFace(FaceTessellation& tess, TessellationData* data)
+{
+    const Poly_Array1OfTriangle& Triangles = tess.mesh->Triangles();
+    const TColgp_Array1OfPnt& Nodes = tess.mesh->Nodes();
+    TColgp_Array1OfDir Normals (Nodes.Lower(), Nodes.Upper());
+    tess.normals = computeNormals(tess.face, tess.mesh, Normals);
+
+    // getting the transformation of the shape/face
+    gp_Trsf myTransf;
+    Standard_Boolean identity = true;
+    if (!tess.loc.IsIdentity()) {
+        identity = false;
+        myTransf = tess.loc.Transformation();
+    }
+
+    SbVec3f* verts = &data->verts[tess.nodeOffset];
+    SbVec3f* norms = &data->norms[tess.nodeOffset];
+    int32_t* index = &data->faceIndex[tess.triaOffset*4];
+
+    // set the vertices and normals at the place of the face
+    for (Standard_Integer i=Nodes.Lower(), j=0; i<=Nodes.Upper(); i++, j++) {
+        gp_Pnt V(Nodes(i));
+        gp_Dir NV(Normals(i));
+        if (!identity) {
+            V.Transform(myTransf);
+            NV.Transform(myTransf);
+        }
+        verts[j].setValue((float)(V.X()),(float)(V.Y()),(float)(V.Z()));
+        norms[j].setValue((float)(NV.X()),(float)(NV.Y()),(float)(NV.Z()));
+    }
+
+    // check orientation
+    TopAbs_Orientation orient = tess.face.Orientation();
+    int nbTriInFace = tess.mesh->NbTriangles();
+    for (int g=1;g<=nbTriInFace;g++) {
+        // Get the triangle
+        Standard_Integer N1,N2,N3;
+        Triangles(g).Get(N1,N2,N3);
+
+        // change orientation of the triangle if the face is reversed
+        if ( orient != TopAbs_FORWARD ) {
+            Standard_Integer tmp = N1;
+            N1 = N2;
+            N2 = tmp;
+        }
+
+        // set the index vector with the 3 point indexes and the end delimiter
+        index[4*(g-1)]   = tess.nodeOffset+N1-1;
+        index[4*(g-1)+1] = tess.nodeOffset+N2-1;
+        index[4*(g-1)+2] = tess.nodeOffset+N3-1;
+        index[4*(g-1)+3] = SO_END_FACE_INDEX;
+    }
+}
+
+// Replaces the content of a multiple-value field with one bulk copy
+template <class Field, class Value>
+void setFieldValues(Field& field, const std::vector<Value>& values)
+{
+    field.setNum(static_cast<int>(values.size()));
+    if (!values.empty())
+        field.setValues(0, static_cast<int>(values.size()), &values[0]);
+}
+
+}
+
+void ViewProviderPartExt::GetNormals(const TopoDS_Face&  theFace,
+             const Handle(Poly_Triangulation)& aPolyTri,
+             TColgp_Array1OfDir& theNormals)
+{
+    Handle(TShort_HArray1OfShortReal) aNormals = computeNormals(theFace, aPolyTri, theNormals);
+    if (!aNormals.IsNull())
+        aPolyTri->SetNormals(aNormals);
 }
 
 //**************************************************************************
@@ -888,288 +1136,230 @@ void ViewProviderPartExt::updateVisual(const TopoDS_Shape& inputShape)
     std::set<int> faceEdges;
 
     try {
-        // calculating the deflection value
-        Bnd_Box bounds;
-        BRepBndLib::Add(cShape, bounds);
-        bounds.SetGap(0.0);
-        Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
-        bounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
-        Standard_Real deflection = ((xMax-xMin)+(yMax-yMin)+(zMax-zMin))/300.0 *
-            Deviation.getValue();
-
-        // create or use the mesh on the data structure
-#if OCC_VERSION_HEX >= 0x060600
         Standard_Real AngDeflectionRads = AngularDeflection.getValue() / 180.0 * M_PI;
-        BRepMesh_IncrementalMesh(cShape,deflection,Standard_False,
-                AngDeflectionRads,Standard_True);
-#else
-        BRepMesh_IncrementalMesh(cShape,deflection);
-#endif
+
         // We must reset the location here because the transformation data
         // are set in the placement property
         TopLoc_Location aLoc;
         cShape.Location(aLoc);
 
-        // count triangles and nodes in the mesh
-        TopTools_IndexedMapOfShape faceMap;
-        TopExp::MapShapes(cShape, TopAbs_FACE, faceMap);
-        for (int i=1; i <= faceMap.Extent(); i++) {
-            Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(TopoDS::Face(faceMap(i)), aLoc);
-            // Note: we must also count empty faces
-            if (!mesh.IsNull()) {
-                numTriangles += mesh->NbTriangles();
-                numNodes     += mesh->NbNodes();
-                numNorms     += mesh->NbNodes();
-            }
-
-            TopExp_Explorer xp;
-            for (xp.Init(faceMap(i),TopAbs_EDGE);xp.More();xp.Next())
-                faceEdges.insert(xp.Current().HashCode(INT_MAX));
-            numFaces++;
-        }
+        // re-use the representation of a shape that has been shown before
+        // Note: The cache is keyed by the deviation and not by the deflection because
+        // the bounding box of a shape changes slightly once it has a triangulation
+        TessellationDataPtr cached = TessellationCache::instance().find
+            (cShape, Deviation.getValue(), AngDeflectionRads, pcObject);
+        boost::shared_ptr<TessellationData> data;
+        if (!cached) {
+            data.reset(new TessellationData());
+
+            // calculating the deflection value
+            Bnd_Box bounds;
+            BRepBndLib::Add(cShape, bounds);
+            bounds.SetGap(0.0);
+            Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
+            bounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+            Standard_Real deflection = ((xMax-xMin)+(yMax-yMin)+(zMax-zMin))/300.0 *
+                Deviation.getValue();
+
+            // create or use the mesh on the data structure
+            // Note: With the last argument the faces are meshed in parallel
+#if OCC_VERSION_HEX >= 0x060600
+            BRepMesh_IncrementalMesh(cShape,deflection,Standard_False,
+                    AngDeflectionRads,Standard_True);
+#else
+            BRepMesh_IncrementalMesh(cShape,deflection);
+#endif
 
-        // get an indexed map of edges
-        TopTools_IndexedMapOfShape edgeMap;
-        TopExp::MapShapes(cShape, TopAbs_EDGE, edgeMap);
-
-         // key is the edge number, value the coord indexes. This is needed to keep the same order as the edges.
-        std::map<int, std::vector<int32_t> > lineSetMap;
-        std::set<int>          edgeIdxSet;
-        std::vector<int32_t>   edgeVector;
-
-        // count and index the edges
-        for (int i=1; i <= edgeMap.Extent(); i++) {
-            edgeIdxSet.insert(i);
-            numEdges++;
-
-            const TopoDS_Edge& aEdge = TopoDS::Edge(edgeMap(i));
-            TopLoc_Location aLoc;
-
-            // handling of the free edge that are not associated to a face
-            // Note: The assumption that if for an edge BRep_Tool::Polygon3D
-            // returns a valid object is wrong. This e.g. happens for ruled
-            // surfaces which gets created by two edges or wires.
-            // So, we have to store the hashes of the edges associated to a face.
-            // If the hash of a given edge is not in this list we know it's really
-            // a free edge.
-            int hash = aEdge.HashCode(INT_MAX);
-            if (faceEdges.find(hash) == faceEdges.end()) {
-                Handle(Poly_Polygon3D) aPoly = BRep_Tool::Polygon3D(aEdge, aLoc);
-                if (!aPoly.IsNull()) {
-                    int nbNodesInEdge = aPoly->NbNodes();
-                    numNodes += nbNodesInEdge;
+            // count triangles and nodes in the mesh
+            TopTools_IndexedMapOfShape faceMap;
+            TopExp::MapShapes(cShape, TopAbs_FACE, faceMap);
+            std::vector<FaceTessellation> faces;
+            faces.reserve(faceMap.Extent());
+            for (int i=1; i <= faceMap.Extent(); i++) {
+                FaceTessellation tess;
+                tess.face = TopoDS::Face(faceMap(i));
+                tess.mesh = BRep_Tool::Triangulation(tess.face, tess.loc);
+                tess.nodeOffset = numNodes;
+                tess.triaOffset = numTriangles;
+                // Note: we must also count empty faces
+                if (!tess.mesh.IsNull()) {
+                    numTriangles += tess.mesh->NbTriangles();
+                    numNodes     += tess.mesh->NbNodes();
+                    numNorms     += tess.mesh->NbNodes();
                 }
-            }
-        }
+                faces.push_back(tess);
 
-        // handling of the vertices
-        TopTools_IndexedMapOfShape vertexMap;
-        TopExp::MapShapes(cShape, TopAbs_VERTEX, vertexMap);
-        numNodes += vertexMap.Extent();
-
-        // create memory for the nodes and indexes
-        coords  ->point      .setNum(numNodes);
-        norm    ->vector     .setNum(numNorms);
-        faceset ->coordIndex .setNum(numTriangles*4);
-        faceset ->partIndex  .setNum(numFaces);
-        // get the raw memory for fast fill up
-        SbVec3f* verts = coords  ->point       .startEditing();
-        SbVec3f* norms = norm    ->vector      .startEditing();
-        int32_t* index = faceset ->coordIndex  .startEditing();
-        int32_t* parts = faceset ->partIndex   .startEditing();
-
-        // preset the normal vector with null vector
-        for (int i=0;i < numNorms;i++)
-            norms[i]= SbVec3f(0.0,0.0,0.0);
-
-        int ii = 0,faceNodeOffset=0,faceTriaOffset=0;
-        for (int i=1; i <= faceMap.Extent(); i++, ii++) {
-            TopLoc_Location aLoc;
-            const TopoDS_Face &actFace = TopoDS::Face(faceMap(i));
-            // get the mesh of the shape
-            Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(actFace,aLoc);
-            if (mesh.IsNull()) continue;
-
-            // getting the transformation of the shape/face
-            gp_Trsf myTransf;
-            Standard_Boolean identity = true;
-            if (!aLoc.IsIdentity()) {
-                identity = false;
-                myTransf = aLoc.Transformation();
+                TopExp_Explorer xp;
+                for (xp.Init(faceMap(i),TopAbs_EDGE);xp.More();xp.Next())
+                    faceEdges.insert(xp.Current().HashCode(INT_MAX));
+                numFaces++;
             }
 
-            // getting size of node and triangle array of this face
-            int nbNodesInFace = mesh->NbNodes();
-            int nbTriInFace   = mesh->NbTriangles();
-            // check orientation
-            TopAbs_Orientation orient = actFace.Orientation();
-
-
-            // cycling through the poly mesh
-            const Poly_Array1OfTriangle& Triangles = mesh->Triangles();
-            const TColgp_Array1OfPnt& Nodes = mesh->Nodes();
-            TColgp_Array1OfDir Normals (Nodes.Lower(), Nodes.Upper());
-            GetNormals(actFace, mesh, Normals);
-            
-            for (int g=1;g<=nbTriInFace;g++) {
-                // Get the triangle
-                Standard_Integer N1,N2,N3;
-                Triangles(g).Get(N1,N2,N3);
-
-                // change orientation of the triangle if the face is reversed
-                if ( orient != TopAbs_FORWARD ) {
-                    Standard_Integer tmp = N1;
-                    N1 = N2;
-                    N2 = tmp;
+            // get an indexed map of edges
+            TopTools_IndexedMapOfShape edgeMap;
+            TopExp::MapShapes(cShape, TopAbs_EDGE, edgeMap);
+
+             // key is the edge number, value the coord indexes. This is needed to keep the same order as the edges.
+            std::map<int, std::vector<int32_t> > lineSetMap;
+            std::set<int>          edgeIdxSet;
+
+            // count and index the edges
+            for (int i=1; i <= edgeMap.Extent(); i++) {
+                edgeIdxSet.insert(i);
+                numEdges++;
+
+                const TopoDS_Edge& aEdge = TopoDS::Edge(edgeMap(i));
+                TopLoc_Location aLoc;
+
+                // handling of the free edge that are not associated to a face
+                // Note: The assumption that if for an edge BRep_Tool::Polygon3D
+                // returns a valid object is wrong. This e.g. happens for ruled
+                // surfaces which gets created by two edges or wires.
+                // So, we have to store the hashes of the edges associated to a face.
+                // If the hash of a given edge is not in this list we know it's really
+                // a free edge.
+                int hash = aEdge.HashCode(INT_MAX);
+                if (faceEdges.find(hash) == faceEdges.end()) {
+                    Handle(Poly_Polygon3D) aPoly = BRep_Tool::Polygon3D(aEdge, aLoc);
+                    if (!aPoly.IsNull()) {
+                        int nbNodesInEdge = aPoly->NbNodes();
+                        numNodes += nbNodesInEdge;
+                    }
                 }
+            }
 
-                // get the 3 points of this triangle
-                gp_Pnt V1(Nodes(N1)), V2(Nodes(N2)), V3(Nodes(N3));
-
-                // get the 3 normals of this triangle
-                gp_Dir NV1(Normals(N1)), NV2(Normals(N2)), NV3(Normals(N3));                
-
-                // transform the vertices and normals to the place of the face
-                if(!identity) {
-                    V1.Transform(myTransf);
-                    V2.Transform(myTransf);
-                    V3.Transform(myTransf);
-                    NV1.Transform(myTransf);
-                    NV2.Transform(myTransf);
-                    NV3.Transform(myTransf);
-                }
+            // handling of the vertices
+            TopTools_IndexedMapOfShape vertexMap;
+            TopExp::MapShapes(cShape, TopAbs_VERTEX, vertexMap);
+            numNodes += vertexMap.Extent();
+
+            // create memory for the nodes and indexes
+            data->verts.resize(numNodes);
+            data->norms.resize(numNorms);
+            data->faceIndex.resize(numTriangles*4);
+            data->parts.resize(numFaces);
+
+            // fill in the triangulation of the faces on the worker threads
+            std::vector<FaceTessellation> meshedFaces;
+            meshedFaces.reserve(faces.size());
+            for (std::vector<FaceTessellation>::iterator it = faces.begin(); it != faces.end(); ++it) {
+                if (!it->mesh.IsNull())
+                    meshedFaces.push_back(*it);
+            }
+#if OCC_VERSION_HEX < 0x070000
+            Standard::SetReentrant(Standard_True);
+#endif
+            QtConcurrent::blockingMap(meshedFaces, boost::bind(&fillFace, _1, data.get()));
 
-                // add the normals for all points of this triangle
-                norms[faceNodeOffset+N1-1] += SbVec3f(NV1.X(),NV1.Y(),NV1.Z());
-                norms[faceNodeOffset+N2-1] += SbVec3f(NV2.X(),NV2.Y(),NV2.Z());
-                norms[faceNodeOffset+N3-1] += SbVec3f(NV3.X(),NV3.Y(),NV3.Z());
-
-                // set the vertices
-                verts[faceNodeOffset+N1-1].setValue((float)(V1.X()),(float)(V1.Y()),(float)(V1.Z()));
-                verts[faceNodeOffset+N2-1].setValue((float)(V2.X()),(float)(V2.Y()),(float)(V2.Z()));
-                verts[faceNodeOffset+N3-1].setValue((float)(V3.X()),(float)(V3.Y()),(float)(V3.Z()));
-
-                // set the index vector with the 3 point indexes and the end delimiter
-                index[faceTriaOffset*4+4*(g-1)]   = faceNodeOffset+N1-1;
-                index[faceTriaOffset*4+4*(g-1)+1] = faceNodeOffset+N2-1;
-                index[faceTriaOffset*4+4*(g-1)+2] = faceNodeOffset+N3-1;
-                index[faceTriaOffset*4+4*(g-1)+3] = SO_END_FACE_INDEX;
+            // store the computed normals in the triangulations for the next time
+            for (std::vector<FaceTessellation>::iterator it = meshedFaces.begin(); it != meshedFaces.end(); ++it) {
+                if (!it->normals.IsNull() && !it->mesh->HasNormals())
+                    it->mesh->SetNormals(it->normals);
             }
 
-            parts[ii] = nbTriInFace; // new part
-
-            // handling the edges lying on this face
-            TopExp_Explorer Exp;
-            for(Exp.Init(actFace,TopAbs_EDGE);Exp.More();Exp.Next()) {
-                const TopoDS_Edge &curEdge = TopoDS::Edge(Exp.Current());
-                // get the overall index of this edge
-                int edgeIndex = edgeMap.FindIndex(curEdge);
-                edgeVector.push_back((int32_t)edgeIndex-1);
-                // already processed this index ?
-                if (edgeIdxSet.find(edgeIndex)!=edgeIdxSet.end()) {
-                    
-                    // this holds the indices of the edge's triangulation to the current polygon
-                    Handle(Poly_PolygonOnTriangulation) aPoly = BRep_Tool::PolygonOnTriangulation(curEdge, mesh, aLoc);
-                    if (aPoly.IsNull())
-                        continue; // polygon does not exist
-                    
-                    // getting the indexes of the edge polygon
-                    const TColStd_Array1OfInteger& indices = aPoly->Nodes();
-                    for (Standard_Integer i=indices.Lower();i <= indices.Upper();i++) {
-                        int nodeIndex = indices(i);
-                        int index = faceNodeOffset+nodeIndex-1;
-                        lineSetMap[edgeIndex].push_back(index);
-
-                        // usually the coordinates for this edge are already set by the
-                        // triangles of the face this edge belongs to. However, there are
-                        // rare cases where some points are only referenced by the polygon
-                        // but not by any triangle. Thus, we must apply the coordinates to
-                        // make sure that everything is properly set.
-                        gp_Pnt p(Nodes(nodeIndex));
-                        if (!identity)
-                            p.Transform(myTransf);
-                        verts[index].setValue((float)(p.X()),(float)(p.Y()),(float)(p.Z()));
+            for (std::size_t ii = 0; ii < faces.size(); ii++) {
+                const FaceTessellation& tess = faces[ii];
+                if (tess.mesh.IsNull()) continue;
+
+                const TopoDS_Face &actFace = tess.face;
+                data->parts[ii] = tess.mesh->NbTriangles(); // new part
+
+                // handling the edges lying on this face
+                TopExp_Explorer Exp;
+                for(Exp.Init(actFace,TopAbs_EDGE);Exp.More();Exp.Next()) {
+                    const TopoDS_Edge &curEdge = TopoDS::Edge(Exp.Current());
+                    // get the overall index of this edge
+                    int edgeIndex = edgeMap.FindIndex(curEdge);
+                    // already processed this index ?
+                    if (edgeIdxSet.find(edgeIndex)!=edgeIdxSet.end()) {
+
+                        // this holds the indices of the edge's triangulation to the current polygon
+                        Handle(Poly_PolygonOnTriangulation) aPoly = BRep_Tool::PolygonOnTriangulation(curEdge, tess.mesh, tess.loc);
+                        if (aPoly.IsNull())
+                            continue; // polygon does not exist
+
+                        // getting the indexes of the edge polygon
+                        // Note: fillFace() has set the coordinates of all nodes of
+                        // the face, including those only referenced by the polygon
+                        const TColStd_Array1OfInteger& indices = aPoly->Nodes();
+                        std::vector<int32_t>& lineCoords = lineSetMap[edgeIndex];
+                        for (Standard_Integer i=indices.Lower();i <= indices.Upper();i++)
+                            lineCoords.push_back(tess.nodeOffset+indices(i)-1);
+
+                        // remove the handled edge index from the set
+                        edgeIdxSet.erase(edgeIndex);
                     }
-
-                    // remove the handled edge index from the set
-                    edgeIdxSet.erase(edgeIndex);
                 }
             }
 
-            edgeVector.push_back(-1);
-            
-            // counting up the per Face offsets
-            faceNodeOffset += nbNodesInFace;
-            faceTriaOffset += nbTriInFace;
-        }
-
-        // handling of the free edges
-        for (int i=1; i <= edgeMap.Extent(); i++) {
-            const TopoDS_Edge& aEdge = TopoDS::Edge(edgeMap(i));
-            Standard_Boolean identity = true;
-            gp_Trsf myTransf;
-            TopLoc_Location aLoc;
-
-            // handling of the free edge that are not associated to a face
-            int hash = aEdge.HashCode(INT_MAX);
-            if (faceEdges.find(hash) == faceEdges.end()) {
-                Handle(Poly_Polygon3D) aPoly = BRep_Tool::Polygon3D(aEdge, aLoc);
-                if (!aPoly.IsNull()) {
-                    if (!aLoc.IsIdentity()) {
-                        identity = false;
-                        myTransf = aLoc.Transformation();
+            int faceNodeOffset = numNorms;
+            SbVec3f* verts = data->verts.empty() ? 0 : &data->verts[0];
+
+            // handling of the free edges
+            for (int i=1; i <= edgeMap.Extent(); i++) {
+                const TopoDS_Edge& aEdge = TopoDS::Edge(edgeMap(i));
+                Standard_Boolean identity = true;
+                gp_Trsf myTransf;
+                TopLoc_Location aLoc;
+
+                // handling of the free edge that are not associated to a face
+                int hash = aEdge.HashCode(INT_MAX);
+                if (faceEdges.find(hash) == faceEdges.end()) {
+                    Handle(Poly_Polygon3D) aPoly = BRep_Tool::Polygon3D(aEdge, aLoc);
+                    if (!aPoly.IsNull()) {
+                        if (!aLoc.IsIdentity()) {
+                            identity = false;
+                            myTransf = aLoc.Transformation();
+                        }
+
+                        const TColgp_Array1OfPnt& aNodes = aPoly->Nodes();
+                        int nbNodesInEdge = aPoly->NbNodes();
+
+                        gp_Pnt pnt;
+                        for (Standard_Integer j=1;j <= nbNodesInEdge;j++) {
+                            pnt = aNodes(j);
+                            if (!identity)
+                                pnt.Transform(myTransf);
+                            int index = faceNodeOffset+j-1;
+                            verts[index].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
+                            lineSetMap[i].push_back(index);
+                        }
+
+                        faceNodeOffset += nbNodesInEdge;
                     }
+                }
+            }
 
-                    const TColgp_Array1OfPnt& aNodes = aPoly->Nodes();
-                    int nbNodesInEdge = aPoly->NbNodes();
-
-                    gp_Pnt pnt;
-                    for (Standard_Integer j=1;j <= nbNodesInEdge;j++) {
-                        pnt = aNodes(j);
-                        if (!identity)
-                            pnt.Transform(myTransf);
-                        int index = faceNodeOffset+j-1;
-                        verts[index].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
-                        lineSetMap[i].push_back(index);
-                    }
+            data->startIndex = faceNodeOffset;
+            for (int i=0; i<vertexMap.Extent(); i++) {
+                const TopoDS_Vertex& aVertex = TopoDS::Vertex(vertexMap(i+1));
+                gp_Pnt pnt = BRep_Tool::Pnt(aVertex);
+                verts[faceNodeOffset+i].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
+            }
 
-                    faceNodeOffset += nbNodesInEdge;
-                }
+            for (std::map<int, std::vector<int32_t> >::iterator it = lineSetMap.begin(); it != lineSetMap.end(); ++it) {
+                data->lineIndex.insert(data->lineIndex.end(), it->second.begin(), it->second.end());
+                data->lineIndex.push_back(-1);
             }
-        }
 
-        nodeset->startIndex.setValue(faceNodeOffset);
-        for (int i=0; i<vertexMap.Extent(); i++) {
-            const TopoDS_Vertex& aVertex = TopoDS::Vertex(vertexMap(i+1));
-            gp_Pnt pnt = BRep_Tool::Pnt(aVertex);
-            verts[faceNodeOffset+i].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
+            TessellationCache::instance().insert(cShape, Deviation.getValue(), AngDeflectionRads, data, pcObject);
+            cached = data;
         }
-
-        // normalize all normals 
-        for (int i = 0; i< numNorms ;i++)
-            norms[i].normalize();
-        
-        std::vector<int32_t> lineSetCoords;
-        for (std::map<int, std::vector<int32_t> >::iterator it = lineSetMap.begin(); it != lineSetMap.end(); ++it) {
-            lineSetCoords.insert(lineSetCoords.end(), it->second.begin(), it->second.end());
-            lineSetCoords.push_back(-1);
+        else {
+            numNodes = static_cast<int>(cached->verts.size());
+            numNorms = static_cast<int>(cached->norms.size());
+            numTriangles = static_cast<int>(cached->faceIndex.size() / 4);
+            numFaces = static_cast<int>(cached->parts.size());
         }
 
-        // preset the index vector size
-        numLines =  lineSetCoords.size();
-        lineset ->coordIndex .setNum(numLines);
-        int32_t* lines = lineset ->coordIndex  .startEditing();
-
-        int l=0;
-        for (std::vector<int32_t>::const_iterator it=lineSetCoords.begin();it!=lineSetCoords.end();++it,l++)
-            lines[l] = *it;
-
-        // end the editing of the nodes
-        coords  ->point       .finishEditing();
-        norm    ->vector      .finishEditing();
-        faceset ->coordIndex  .finishEditing();
-        faceset ->partIndex   .finishEditing();
-        lineset ->coordIndex  .finishEditing();
+        // copy the buffers to the nodes
+        numLines = static_cast<int>(cached->lineIndex.size());
+        setFieldValues(coords  ->point      , cached->verts);
+        setFieldValues(norm    ->vector     , cached->norms);
+        setFieldValues(faceset ->coordIndex , cached->faceIndex);
+        setFieldValues(faceset ->partIndex  , cached->parts);
+        setFieldValues(lineset ->coordIndex , cached->lineIndex);
+        nodeset->startIndex.setValue(cached->startIndex);
     }
     catch (...) {
         Base::Console().Error("Cannot compute Inventor representation for the shape of %s.\n",pcObject->getNameInDocument());
@@ -136,13 +136,14 @@ private:
             pcDoc = App::GetApplication().newDocument(DocName);
 
         try {
-            // read the gcode file
-            std::ifstream filestr(file.filePath().c_str());
-            std::stringstream buffer;
-            buffer << filestr.rdbuf();
-            std::string gcode = buffer.str();
+            // read the gcode file in one go and parse it in place
+            std::ifstream filestr(file.filePath().c_str(), std::ios::in | std::ios::binary);
+            filestr.seekg(0, std::ios::end);
+            std::vector<char> gcode(static_cast<std::size_t>(filestr.tellg()));
+            filestr.seekg(0, std::ios::beg);
+            filestr.read(gcode.data(), gcode.size());
             Toolpath path;
-            path.setFromGCode(gcode);
+            path.setFromGCode(gcode.data(), static_cast<std::size_t>(filestr.gcount()));
             Path::Feature *object = static_cast<Path::Feature *>(pcDoc->addObject("Path::Feature",file.fileNamePure().c_str()));
             object->Path.setValue(path);
             pcDoc->recompute();
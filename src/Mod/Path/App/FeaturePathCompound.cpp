@@ -55,13 +55,14 @@ App::DocumentObjectExecReturn *FeatureCompound::execute(void)
 
     for (std::vector<DocumentObject*>::const_iterator it= Paths.begin();it!=Paths.end();++it) {
         if ((*it)->getTypeId().isDerivedFrom(Path::Feature::getClassTypeId())){
-            const std::vector<Command*> &cmds = static_cast<Path::Feature*>(*it)->Path.getValue().getCommands();
+            const Toolpath &path = static_cast<Path::Feature*>(*it)->Path.getValue();
             const Base::Placement pl = static_cast<Path::Feature*>(*it)->Placement.getValue();
-            for (std::vector<Command*>::const_iterator it2= cmds.begin();it2!=cmds.end();++it2) {
+            for (unsigned int i = 0; i < path.getSize(); i++) {
+                Command cmd = path.getCommand(i);
                 if (UsePlacements.getValue() == true) {
-                    result.addCommand((*it2)->transform(pl));
+                    result.addCommand(cmd.transform(pl));
                 } else {
-                    result.addCommand(**it2);
+                    result.addCommand(cmd);
                 }
             }
         }else
@@ -24,14 +24,21 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <algorithm>
+# include <cctype>
+# include <cstdlib>
 #endif
 
 #include <boost/regex.hpp>
 
+#include <QThread>
+#include <QtConcurrentMap>
+
 #include <Base/Writer.h>
 #include <Base/Reader.h>
 #include <Base/Stream.h>
 #include <Base/Exception.h>
+#include <Base/FileInfo.h>
 
 // KDL stuff - at the moment, not used
 //#include "Mod/Robot/App/kdl_cp/path_line.hpp"
@@ -44,6 +51,602 @@
 using namespace Path;
 using namespace Base;
 
+namespace {
+
+const char slotNames[ToolpathColumns::SlotCount] = {'X', 'Y', 'Z', 'I', 'J', 'K', 'F'};
+
+// GCode parameters have at most one value word per letter
+const int maxArguments = 32;
+const int maxNumberLength = 64;
+
+inline bool isCommandStart(char c)
+{
+    return c == 'G' || c == 'g' || c == 'M' || c == 'm';
+}
+
+// Converts a run of digits, '-' and '.' the way atof() does. Plain decimal
+// numbers with up to 15 digits are exact in a double and converted directly.
+double parseNumber(const char *str, int len)
+{
+    static const double powersOfTen[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+    };
+
+    const char *p = str;
+    const char *end = str + len;
+    bool negative = false;
+    if (p != end && *p == '-') {
+        negative = true;
+        ++p;
+    }
+
+    unsigned long long mantissa = 0;
+    int digits = 0;
+    int decimals = 0;
+    bool point = false;
+    for (; p != end; ++p) {
+        if (*p >= '0' && *p <= '9') {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (point)
+                ++decimals;
+            ++digits;
+        }
+        else if (*p == '.' && !point) {
+            point = true;
+        }
+        else {
+            break;
+        }
+    }
+
+    if (p != end || digits == 0 || digits > 15) {
+        std::string number(str, len);
+        return std::atof(number.c_str());
+    }
+
+    double value = static_cast<double>(mantissa) / powersOfTen[decimals];
+    return negative ? -value : value;
+}
+
+// Adds the command of a GCode piece starting with a G or M word. The result is
+// the same as Command::setFromGCode() but nothing is allocated for the usual
+// 'G1 X1.0 Y2.0' form.
+void parseCommand(const char *begin, const char *end, ToolpathColumns &columns)
+{
+    enum { None, Name, Argument } mode = None;
+    char name[maxNumberLength + 2];
+    int nameLength = 0;
+    char keys[maxArguments];
+    double values[maxArguments];
+    int count = 0;
+    char key = 0;
+    char value[maxNumberLength];
+    int length = 0;
+    bool fallback = false;
+
+    for (const char *p = begin; p != end && !fallback; ++p) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (isdigit(c) || c == '-' || c == '.') {
+            if (length == maxNumberLength)
+                fallback = true;
+            else
+                value[length++] = c;
+        }
+        else if (isalpha(c)) {
+            if (mode == Name) {
+                if (!key || !length)
+                    throw Base::Exception("Badly formatted GCode command");
+                name[0] = key;
+                std::copy(value, value + length, name + 1);
+                nameLength = length + 1;
+                mode = Argument;
+            }
+            else if (mode == None) {
+                mode = Name;
+            }
+            else {
+                if (!key || !length)
+                    throw Base::Exception("Badly formatted GCode argument");
+                if (count == maxArguments) {
+                    fallback = true;
+                    break;
+                }
+                keys[count] = key;
+                values[count++] = parseNumber(value, length);
+            }
+            key = toupper(c);
+            length = 0;
+        }
+        else if (c == ')') {
+            // a stray closing bracket turns the rest into a comment
+            fallback = true;
+        }
+    }
+
+    if (fallback) {
+        Command cmd;
+        cmd.setFromGCode(std::string(begin, end));
+        std::size_t row = columns.addRow(cmd.Name);
+        for (std::map<std::string,double>::const_iterator it = cmd.Parameters.begin(); it != cmd.Parameters.end(); ++it)
+            columns.setParameter(row, it->first, it->second);
+        return;
+    }
+
+    if (!key || !length)
+        throw Base::Exception("Badly formatted GCode argument");
+    if (mode == Name) {
+        name[0] = key;
+        std::copy(value, value + length, name + 1);
+        nameLength = length + 1;
+    }
+    else {
+        keys[count] = key;
+        values[count++] = parseNumber(value, length);
+    }
+
+    std::size_t row = columns.addRow(std::string(name, nameLength));
+    for (int i=0; i<count; i++) {
+        int slot = ToolpathColumns::slotOf(keys[i]);
+        if (slot >= 0)
+            columns.setParameter(row, static_cast<ToolpathColumns::Slot>(slot), values[i]);
+        else
+            columns.setParameter(row, std::string(1, keys[i]), values[i]);
+    }
+}
+
+// Adds a comment command. Like Command::setFromGCode() the name is the whole
+// comment with any nested opening bracket dropped.
+void parseComment(const char *begin, const char *end, ToolpathColumns &columns)
+{
+    std::string name;
+    name.reserve(end - begin);
+    name += *begin;
+    for (const char *p = begin + 1; p != end; ++p) {
+        if (*p != '(')
+            name += *p;
+    }
+    columns.addRow(name);
+}
+
+// Splits the GCode into commands and comments like the original string based
+// implementation of Toolpath::setFromGCode(): a command lasts from a G or M word
+// to the next one or to the next comment, anything else in front of the first
+// command or behind a comment is skipped.
+void parseGCode(const char *begin, const char *end, ToolpathColumns &columns)
+{
+    const char *start = 0;
+    bool comment = false;
+    for (const char *p = begin; p != end; ++p) {
+        char c = *p;
+        if (comment) {
+            if (c == ')') {
+                parseComment(start, p + 1, columns);
+                start = 0;
+                comment = false;
+            }
+        }
+        else if (c == '(' || isCommandStart(c)) {
+            if (start)
+                parseCommand(start, p, columns);
+            start = p;
+            comment = (c == '(');
+        }
+    }
+    if (start && !comment)
+        parseCommand(start, end, columns);
+}
+
+struct GCodeChunk
+{
+    const char *begin;
+    const char *end;
+    ToolpathColumns columns;
+    bool failed;
+    std::string error;
+};
+
+void parseChunk(GCodeChunk &chunk)
+{
+    try {
+        parseGCode(chunk.begin, chunk.end, chunk.columns);
+        chunk.failed = false;
+    }
+    catch (const Base::Exception &e) {
+        chunk.failed = true;
+        chunk.error = e.what();
+    }
+}
+
+// Splits the GCode into the given number of pieces of about the same size.
+// Every piece but the first starts with a command outside of a comment, so
+// that parsing the pieces one after another gives the same as parsing all.
+void splitGCode(const char *begin, const char *end, std::size_t count, std::vector<GCodeChunk> &chunks)
+{
+    std::size_t step = (end - begin) / count;
+    GCodeChunk chunk;
+    chunk.begin = begin;
+    chunk.failed = false;
+    const char *target = begin + step;
+    bool comment = false;
+    for (const char *p = begin; p != end; ++p) {
+        char c = *p;
+        if (comment) {
+            if (c == ')')
+                comment = false;
+        }
+        else if (c == '(' || isCommandStart(c)) {
+            if (p >= target && chunks.size() + 1 < count) {
+                chunk.end = p;
+                chunks.push_back(chunk);
+                chunk.begin = p;
+                target = p + step;
+            }
+            comment = (c == '(');
+        }
+    }
+    chunk.end = end;
+    chunks.push_back(chunk);
+}
+
+void writeString(Base::OutputStream &str, const std::string &value)
+{
+    str << static_cast<uint32_t>(value.size());
+    for (std::string::const_iterator it = value.begin(); it != value.end(); ++it)
+        str << static_cast<int8_t>(*it);
+}
+
+// FNV-1a hash
+void addChecksum(unsigned long &checksum, const void *data, std::size_t size)
+{
+    const unsigned char *bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i=0; i<size; i++) {
+        checksum ^= bytes[i];
+        checksum = (checksum * 16777619UL) & 0xffffffffUL;
+    }
+}
+
+void readString(Base::InputStream &str, std::string &value)
+{
+    uint32_t length = 0;
+    str >> length;
+    value.resize(length);
+    for (std::string::iterator it = value.begin(); it != value.end(); ++it) {
+        int8_t c = 0;
+        str >> c;
+        *it = c;
+    }
+}
+
+}
+
+// ToolpathColumns
+
+ToolpathColumns::ToolpathColumns()
+{
+}
+
+void ToolpathColumns::clear(void)
+{
+    names.clear();
+    opcodeOfName.clear();
+    opcodes.clear();
+    masks.clear();
+    for (int i=0; i<SlotCount; i++)
+        values[i].clear();
+    overflow.clear();
+}
+
+void ToolpathColumns::reserve(std::size_t count)
+{
+    opcodes.reserve(count);
+    masks.reserve(count);
+    for (int i=0; i<SlotCount; i++)
+        values[i].reserve(count);
+}
+
+unsigned int ToolpathColumns::getMemSize(void) const
+{
+    std::size_t size = opcodes.capacity() * sizeof(unsigned int) + masks.capacity();
+    for (int i=0; i<SlotCount; i++)
+        size += values[i].capacity() * sizeof(double);
+    for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it)
+        size += sizeof(std::string) + it->capacity();
+    for (std::map<std::size_t, std::map<std::string,double> >::const_iterator it = overflow.begin(); it != overflow.end(); ++it)
+        size += it->second.size() * (sizeof(std::string) + sizeof(double));
+    return static_cast<unsigned int>(size);
+}
+
+unsigned int ToolpathColumns::getOpcode(const std::string &name)
+{
+    std::map<std::string, unsigned int>::iterator it = opcodeOfName.find(name);
+    if (it == opcodeOfName.end()) {
+        it = opcodeOfName.insert(std::make_pair(name, static_cast<unsigned int>(names.size()))).first;
+        names.push_back(name);
+    }
+    return it->second;
+}
+
+std::size_t ToolpathColumns::addRow(const std::string &name)
+{
+    // toolpaths mostly repeat the previous command
+    if (!opcodes.empty() && names[opcodes.back()] == name)
+        opcodes.push_back(opcodes.back());
+    else
+        opcodes.push_back(getOpcode(name));
+    masks.push_back(0);
+    for (int i=0; i<SlotCount; i++)
+        values[i].push_back(0.0);
+    return opcodes.size() - 1;
+}
+
+void ToolpathColumns::insertRow(std::size_t row, const std::string &name)
+{
+    shiftOverflow(row, true);
+    opcodes.insert(opcodes.begin() + row, getOpcode(name));
+    masks.insert(masks.begin() + row, 0);
+    for (int i=0; i<SlotCount; i++)
+        values[i].insert(values[i].begin() + row, 0.0);
+}
+
+void ToolpathColumns::eraseRow(std::size_t row)
+{
+    overflow.erase(row);
+    shiftOverflow(row, false);
+    opcodes.erase(opcodes.begin() + row);
+    masks.erase(masks.begin() + row);
+    for (int i=0; i<SlotCount; i++)
+        values[i].erase(values[i].begin() + row);
+}
+
+void ToolpathColumns::shiftOverflow(std::size_t row, bool inserted)
+{
+    // renumbers the overflow parameters of the rows behind an inserted or erased one
+    std::map<std::size_t, std::map<std::string,double> >::iterator it = overflow.lower_bound(row);
+    if (it == overflow.end())
+        return;
+    std::map<std::size_t, std::map<std::string,double> > moved(it, overflow.end());
+    overflow.erase(it, overflow.end());
+    for (std::map<std::size_t, std::map<std::string,double> >::const_iterator jt = moved.begin(); jt != moved.end(); ++jt)
+        overflow.insert(overflow.end(), std::make_pair(inserted ? jt->first + 1 : jt->first - 1, jt->second));
+}
+
+void ToolpathColumns::setParameter(std::size_t row, const std::string &key, double value)
+{
+    int slot = key.size() == 1 ? slotOf(key[0]) : -1;
+    if (slot >= 0)
+        setParameter(row, static_cast<Slot>(slot), value);
+    else
+        overflow[row][key] = value;
+}
+
+void ToolpathColumns::append(const ToolpathColumns &other)
+{
+    std::size_t offset = size();
+    std::vector<unsigned int> opcodeMap(other.names.size());
+    for (std::size_t i=0; i<other.names.size(); i++)
+        opcodeMap[i] = getOpcode(other.names[i]);
+
+    reserve(offset + other.size());
+    for (std::vector<unsigned int>::const_iterator it = other.opcodes.begin(); it != other.opcodes.end(); ++it)
+        opcodes.push_back(opcodeMap[*it]);
+    masks.insert(masks.end(), other.masks.begin(), other.masks.end());
+    for (int i=0; i<SlotCount; i++)
+        values[i].insert(values[i].end(), other.values[i].begin(), other.values[i].end());
+    for (std::map<std::size_t, std::map<std::string,double> >::const_iterator it = other.overflow.begin(); it != other.overflow.end(); ++it)
+        overflow.insert(overflow.end(), std::make_pair(it->first + offset, it->second));
+}
+
+bool ToolpathColumns::hasParameter(std::size_t row, const std::string &key) const
+{
+    int slot = key.size() == 1 ? slotOf(key[0]) : -1;
+    if (slot >= 0)
+        return hasParameter(row, static_cast<Slot>(slot));
+    std::map<std::size_t, std::map<std::string,double> >::const_iterator it = overflow.find(row);
+    return it != overflow.end() && it->second.count(key) > 0;
+}
+
+double ToolpathColumns::getParameter(std::size_t row, const std::string &key) const
+{
+    int slot = key.size() == 1 ? slotOf(key[0]) : -1;
+    if (slot >= 0)
+        return values[slot][row];
+    std::map<std::size_t, std::map<std::string,double> >::const_iterator it = overflow.find(row);
+    if (it == overflow.end())
+        return 0.0;
+    std::map<std::string,double>::const_iterator jt = it->second.find(key);
+    return jt != it->second.end() ? jt->second : 0.0;
+}
+
+// the value of a slot that is not set is always 0
+Base::Vector3d ToolpathColumns::getPosition(std::size_t row) const
+{
+    return Base::Vector3d(values[X][row], values[Y][row], values[Z][row]);
+}
+
+Base::Vector3d ToolpathColumns::getCenter(std::size_t row) const
+{
+    return Base::Vector3d(values[I][row], values[J][row], values[K][row]);
+}
+
+void ToolpathColumns::getParameters(std::size_t row, std::map<std::string,double> &parameters) const
+{
+    parameters.clear();
+    for (int i=0; i<SlotCount; i++) {
+        if (masks[row] & (1 << i))
+            parameters[std::string(1, slotNames[i])] = values[i][row];
+    }
+    std::map<std::size_t, std::map<std::string,double> >::const_iterator it = overflow.find(row);
+    if (it != overflow.end())
+        parameters.insert(it->second.begin(), it->second.end());
+}
+
+void ToolpathColumns::setFromGCode(const char *begin, const char *end)
+{
+    clear();
+
+    // parallel parsing only pays off for large files, use at least 1MB per thread
+    int threads = std::max(QThread::idealThreadCount(), 1);
+    std::size_t count = std::min<std::size_t>(threads, (end - begin) >> 20);
+    if (count < 2) {
+        parseGCode(begin, end, *this);
+        return;
+    }
+
+    std::vector<GCodeChunk> chunks;
+    chunks.reserve(count);
+    splitGCode(begin, end, count, chunks);
+    QtConcurrent::blockingMap(chunks, &parseChunk);
+
+    std::size_t total = 0;
+    for (std::vector<GCodeChunk>::const_iterator it = chunks.begin(); it != chunks.end(); ++it)
+        total += it->columns.size();
+    reserve(total);
+    for (std::vector<GCodeChunk>::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        append(it->columns);
+        if (it->failed)
+            throw Base::Exception(it->error);
+    }
+}
+
+void ToolpathColumns::write(Base::OutputStream &str) const
+{
+    str << static_cast<uint32_t>(names.size());
+    for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it)
+        writeString(str, *it);
+
+    str << static_cast<uint32_t>(size());
+    std::vector<uint32_t> codes(opcodes.begin(), opcodes.end());
+    str.write(codes.data(), codes.size());
+    for (std::vector<unsigned char>::const_iterator it = masks.begin(); it != masks.end(); ++it)
+        str << static_cast<uint8_t>(*it);
+    // only the values of set slots are written
+    std::vector<double> slot;
+    for (int i=0; i<SlotCount; i++) {
+        slot.clear();
+        for (std::size_t row=0; row<size(); row++) {
+            if (masks[row] & (1 << i))
+                slot.push_back(values[i][row]);
+        }
+        str.write(slot.data(), slot.size());
+    }
+
+    str << static_cast<uint32_t>(overflow.size());
+    for (std::map<std::size_t, std::map<std::string,double> >::const_iterator it = overflow.begin(); it != overflow.end(); ++it) {
+        str << static_cast<uint32_t>(it->first) << static_cast<uint32_t>(it->second.size());
+        for (std::map<std::string,double>::const_iterator jt = it->second.begin(); jt != it->second.end(); ++jt) {
+            writeString(str, jt->first);
+            str << jt->second;
+        }
+    }
+}
+
+void ToolpathColumns::read(Base::InputStream &str)
+{
+    clear();
+
+    uint32_t count = 0;
+    str >> count;
+    names.resize(count);
+    for (uint32_t i=0; i<count; i++) {
+        readString(str, names[i]);
+        opcodeOfName[names[i]] = i;
+    }
+
+    uint32_t rows = 0;
+    str >> rows;
+    opcodes.resize(rows);
+    masks.resize(rows);
+    for (int i=0; i<SlotCount; i++)
+        values[i].resize(rows, 0.0);
+    std::vector<uint32_t> codes(rows);
+    str.read(codes.data(), codes.size());
+    for (uint32_t row=0; row<rows; row++) {
+        if (codes[row] >= names.size()) {
+            clear();
+            throw Base::Exception("Invalid command in toolpath data");
+        }
+        opcodes[row] = codes[row];
+    }
+    std::size_t counts[SlotCount] = {};
+    for (uint32_t row=0; row<rows; row++) {
+        uint8_t mask = 0;
+        str >> mask;
+        masks[row] = mask;
+        for (int i=0; i<SlotCount; i++) {
+            if (mask & (1 << i))
+                counts[i]++;
+        }
+    }
+    std::vector<double> slot;
+    for (int i=0; i<SlotCount; i++) {
+        slot.resize(counts[i]);
+        str.read(slot.data(), slot.size());
+        std::vector<double>::const_iterator value = slot.begin();
+        for (uint32_t row=0; row<rows; row++) {
+            if (masks[row] & (1 << i))
+                values[i][row] = *value++;
+        }
+    }
+
+    str >> count;
+    for (uint32_t i=0; i<count; i++) {
+        uint32_t row = 0, parameters = 0;
+        str >> row >> parameters;
+        if (row >= rows) {
+            clear();
+            throw Base::Exception("Invalid parameter in toolpath data");
+        }
+        std::map<std::string,double> &map = overflow[row];
+        for (uint32_t j=0; j<parameters; j++) {
+            std::string key;
+            double value = 0.0;
+            readString(str, key);
+            str >> value;
+            map[key] = value;
+        }
+    }
+}
+
+unsigned long ToolpathColumns::getChecksum(std::size_t rows) const
+{
+    unsigned long checksum = 2166136261UL;
+    rows = std::min(rows, size());
+    for (std::size_t row=0; row<rows; row++) {
+        const std::string &name = names[opcodes[row]];
+        addChecksum(checksum, name.c_str(), name.size() + 1);
+        addChecksum(checksum, &masks[row], 1);
+        for (int i=0; i<SlotCount; i++) {
+            if (masks[row] & (1 << i))
+                addChecksum(checksum, &values[i][row], sizeof(double));
+        }
+    }
+    std::map<std::size_t, std::map<std::string,double> >::const_iterator end = overflow.lower_bound(rows);
+    for (std::map<std::size_t, std::map<std::string,double> >::const_iterator it = overflow.begin(); it != end; ++it) {
+        addChecksum(checksum, &it->first, sizeof(std::size_t));
+        for (std::map<std::string,double>::const_iterator jt = it->second.begin(); jt != it->second.end(); ++jt) {
+            addChecksum(checksum, jt->first.c_str(), jt->first.size() + 1);
+            addChecksum(checksum, &jt->second, sizeof(double));
+        }
+    }
+    return checksum;
+}
+
+int ToolpathColumns::slotOf(char key)
+{
+    switch (key) {
+    case 'X': return X;
+    case 'Y': return Y;
+    case 'Z': return Z;
+    case 'I': return I;
+    case 'J': return J;
+    case 'K': return K;
+    case 'F': return F;
+    default:  return -1;
+    }
+}
+
+// Toolpath
+
 TYPESYSTEM_SOURCE(Path::Toolpath , Base::Persistence);
 
 Toolpath::Toolpath()
@@ -51,40 +654,31 @@ Toolpath::Toolpath()
 }
 
 Toolpath::Toolpath(const Toolpath& otherPath)
-:vpcCommands(otherPath.vpcCommands.size())
+:columns(otherPath.columns)
 {
-    operator=(otherPath);
     recalculate();
 }
 
 Toolpath::~Toolpath()
 {
-    clear();
 }
 
 Toolpath &Toolpath::operator=(const Toolpath& otherPath)
 {
-    clear();
-    vpcCommands.resize(otherPath.vpcCommands.size());
-    int i = 0;
-    for (std::vector<Command*>::const_iterator it=otherPath.vpcCommands.begin();it!=otherPath.vpcCommands.end();++it,i++)
-        vpcCommands[i] = new Command(**it);
+    columns = otherPath.columns;
     recalculate();
     return *this;
 }
 
 void Toolpath::clear(void) 
 {
-    for(std::vector<Command*>::iterator it = vpcCommands.begin();it!=vpcCommands.end();++it)
-        delete ( *it );
-    vpcCommands.clear();
+    columns.clear();
     recalculate();
 }
 
 void Toolpath::addCommand(const Command &Cmd)
 {
-    Command *tmp = new Command(Cmd);
-    vpcCommands.push_back(tmp);
+    setCommand(columns.addRow(Cmd.Name), Cmd);
     recalculate();
 }
 
@@ -92,9 +686,9 @@ void Toolpath::insertCommand(const Command &Cmd, int pos)
 {
     if (pos == -1) {
         addCommand(Cmd);
-    } else if (pos <= static_cast<int>(vpcCommands.size())) {
-        Command *tmp = new Command(Cmd);
-        vpcCommands.insert(vpcCommands.begin()+pos,tmp);
+    } else if (pos <= static_cast<int>(columns.size())) {
+        columns.insertRow(pos, Cmd.Name);
+        setCommand(pos, Cmd);
     } else {
         throw Base::Exception("Index not in range");
     }
@@ -103,34 +697,47 @@ void Toolpath::insertCommand(const Command &Cmd, int pos)
 
 void Toolpath::deleteCommand(int pos)
 {
-    if (pos == -1) {
-        //delete(*vpcCommands.rbegin()); // causes crash
-        vpcCommands.pop_back();
-    } else if (pos <= static_cast<int>(vpcCommands.size())) {
-        vpcCommands.erase (vpcCommands.begin()+pos);
+    if (pos == -1 && columns.size() > 0) {
+        columns.eraseRow(columns.size() - 1);
+    } else if (pos >= 0 && pos < static_cast<int>(columns.size())) {
+        columns.eraseRow(pos);
     } else {
         throw Base::Exception("Index not in range");
     }
     recalculate();
 }
 
+Command Toolpath::getCommand(unsigned int pos) const
+{
+    Command cmd;
+    cmd.Name = columns.getName(pos);
+    columns.getParameters(pos, cmd.Parameters);
+    return cmd;
+}
+
+void Toolpath::setCommand(std::size_t row, const Command &Cmd)
+{
+    for (std::map<std::string,double>::const_iterator it = Cmd.Parameters.begin(); it != Cmd.Parameters.end(); ++it)
+        columns.setParameter(row, it->first, it->second);
+}
+
 double Toolpath::getLength()
 {
-    if(vpcCommands.size()==0)
+    if(columns.size()==0)
         return 0;
     double l = 0;
     Vector3d last(0,0,0);
     Vector3d next;
-    for(std::vector<Command*>::const_iterator it = vpcCommands.begin();it!=vpcCommands.end();++it) {
-        std::string name = (*it)->Name;
-        next = (*it)->getPlacement().getPosition();
+    for (std::size_t row=0; row<columns.size(); row++) {
+        const std::string &name = columns.getName(row);
+        next = columns.getPosition(row);
         if ( (name == "G0") || (name == "G00") || (name == "G1") || (name == "G01") ) {
             // straight line
             l += (next - last).Length();
             last = next;
         } else if ( (name == "G2") || (name == "G02") || (name == "G3") || (name == "G03") ) {
             // arc
-            Vector3d center = (*it)->getCenter();
+            Vector3d center = columns.getCenter(row);
             double radius = (last - center).Length();
             double angle = (next - center).GetAngle(last - center);
             l += angle * radius;
@@ -140,71 +747,23 @@ double Toolpath::getLength()
     return l;
 }
 
-void Toolpath::setFromGCode(const std::string instr)
+void Toolpath::setFromGCode(const std::string &instr)
 {
-    clear();
-    
-    // remove comments
-    //boost::regex e("\\(.*?\\)");
-    //std::string str = boost::regex_replace(instr, e, "");
-    std::string str(instr);
-    
-    // split input string by () or G or M commands
-    std::string mode = "command";
-    std::size_t found = str.find_first_of("(gGmM");
-    int last = -1;
-    while (found!=std::string::npos)
-    {
-        if (str[found] == '(') {
-            // start of comment
-            if ( (last > -1) && (mode == "command") ) {
-                // before opening a comment, add the last found command
-                std::string gcodestr = str.substr(last,found-last);
-                Command *tmp = new Command();
-                tmp->setFromGCode(gcodestr);
-                vpcCommands.push_back(tmp);
-            }
-            mode = "comment";
-            last = found;
-            found=str.find_first_of(")",found+1);
-        } else if (str[found] == ')') {
-            // end of comment
-            std::string gcodestr = str.substr(last,found-last+1);
-            Command *tmp = new Command();
-            tmp->setFromGCode(gcodestr);
-            vpcCommands.push_back(tmp);
-            last = -1;
-            found=str.find_first_of("(gGmM",found+1);
-            mode = "command";
-        } else if (mode == "command") {
-            // command
-            if (last > -1) {
-                std::string gcodestr = str.substr(last,found-last);
-                Command *tmp = new Command();
-                tmp->setFromGCode(gcodestr);
-                vpcCommands.push_back(tmp);
-            }
-            last = found;
-            found=str.find_first_of("(gGmM",found+1);
-        }
-    }
-    // add the last command found, if any
-    if (last > -1) {
-        if (mode == "command") {
-            std::string gcodestr = str.substr(last,std::string::npos);
-            Command *tmp = new Command();
-            tmp->setFromGCode(gcodestr);
-            vpcCommands.push_back(tmp);
-        }
-    }
+    setFromGCode(instr.c_str(), instr.size());
+}
+
+void Toolpath::setFromGCode(const char *data, std::size_t size)
+{
+    // on badly formatted GCode the commands in front of the bad one are kept
+    columns.setFromGCode(data, data + size);
     recalculate();
 }
 
 std::string Toolpath::toGCode(void) const
 {
     std::string result;
-    for (std::vector<Command*>::const_iterator it=vpcCommands.begin();it!=vpcCommands.end();++it) {
-        result += (*it)->toGCode();
+    for (unsigned int i = 0; i < getSize(); i++) {
+        result += getCommand(i).toGCode();
         result += "\n";
     }
     return result;
@@ -213,7 +772,7 @@ std::string Toolpath::toGCode(void) const
 void Toolpath::recalculate(void) // recalculates the path cache
 {
     
-    if(vpcCommands.size()==0)
+    if(columns.size()==0)
         return;
         
     // TODO recalculate the KDL stuff. At the moment, this is unused.
@@ -277,7 +836,7 @@ void Toolpath::recalculate(void) // recalculates the path cache
 
 unsigned int Toolpath::getMemSize (void) const
 {
-    return toGCode().size();
+    return columns.getMemSize();
 }
 
 void Toolpath::Save (Writer &writer) const
@@ -286,20 +845,20 @@ void Toolpath::Save (Writer &writer) const
         writer.Stream() << writer.ind() << "<Path count=\"" <<  getSize() <<"\">" << std::endl;
         writer.incInd();
         for(unsigned int i = 0;i<getSize(); i++)
-            vpcCommands[i]->Save(writer);
+            getCommand(i).Save(writer);
         writer.decInd();
         writer.Stream() << writer.ind() << "</Path>" << std::endl;
     } else {
         writer.Stream() << writer.ind()
-            << "<Path file=\"" << writer.addFile((writer.ObjectName+".nc").c_str(), this) << "\"/>" << std::endl;
+            << "<Path file=\"" << writer.addFile((writer.ObjectName+".bin").c_str(), this) << "\"/>" << std::endl;
     }
 }
 
 void Toolpath::SaveDocFile (Base::Writer &writer) const
 {
-    if (toGCode().empty())
-        return;
-    writer.Stream() << toGCode();
+    Base::OutputStream str(writer.Stream());
+    str << static_cast<uint32_t>(1); // format version
+    columns.write(str);
 }
 
 void Toolpath::Restore(XMLReader &reader)
@@ -315,6 +874,24 @@ void Toolpath::Restore(XMLReader &reader)
 
 void Toolpath::RestoreDocFile(Base::Reader &reader)
 {
+    Base::FileInfo file(reader.getFileName());
+    if (file.hasExtension("bin")) {
+        Base::InputStream str(reader);
+        uint32_t version = 0;
+        str >> version;
+        if (version != 1)
+            throw Base::Exception("Unsupported toolpath format");
+        columns.read(str);
+        // a truncated file leaves the columns partly filled
+        if (!str) {
+            clear();
+            throw Base::Exception("Unexpected end of toolpath data");
+        }
+        recalculate();
+        return;
+    }
+
+    // older documents store the path as GCode
     std::string gcode;
     std::string line;
     while (reader >> line) { 
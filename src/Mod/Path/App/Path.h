@@ -30,9 +30,76 @@
 #include <Base/Persistence.h>
 #include <Base/Vector3D.h>
 
+namespace Base {
+class InputStream;
+class OutputStream;
+}
+
 namespace Path
 {
 
+    /** Column-wise storage of a sequence of commands
+     *
+     * Every command is a row made of an opcode, which indexes the table of
+     * command names, and one value per fixed parameter slot. A bit mask per
+     * row tells which slots are set. Parameters without a slot go to an
+     * overflow map.
+     */
+    class PathExport ToolpathColumns
+    {
+        public:
+            enum Slot { X, Y, Z, I, J, K, F, SlotCount };
+
+            ToolpathColumns();
+
+            void clear(void);
+            void reserve(std::size_t);
+            std::size_t size(void) const {return opcodes.size();}
+
+            unsigned int getMemSize(void) const;
+
+            std::size_t addRow(const std::string &name); // adds a command without parameters, returns its row
+            void insertRow(std::size_t row, const std::string &name); // inserts a command without parameters
+            void eraseRow(std::size_t row);
+            void setParameter(std::size_t row, Slot slot, double value)
+            { values[slot][row] = value; masks[row] |= (1 << slot); }
+            void setParameter(std::size_t row, const std::string &key, double value);
+            void append(const ToolpathColumns &); // adds all rows of the other table at the end
+
+            const std::string &getName(std::size_t row) const {return names[opcodes[row]];}
+            bool hasParameter(std::size_t row, Slot slot) const {return (masks[row] & (1 << slot)) != 0;}
+            double getParameter(std::size_t row, Slot slot) const {return values[slot][row];}
+            bool hasParameter(std::size_t row, const std::string &key) const;
+            double getParameter(std::size_t row, const std::string &key) const; // returns 0 if the parameter is not set
+            void getParameters(std::size_t row, std::map<std::string,double> &) const;
+            Base::Vector3d getPosition(std::size_t row) const; // same as Command::getPlacement().getPosition()
+            Base::Vector3d getCenter(std::size_t row) const; // same as Command::getCenter()
+
+            // fills the table from the contents of the given GCode, in parallel for large inputs.
+            // On badly formatted GCode the table holds the commands in front of the bad one
+            // and a Base::Exception is thrown
+            void setFromGCode(const char *begin, const char *end);
+
+            void write(Base::OutputStream &) const;
+            void read(Base::InputStream &);
+
+            // returns a checksum over the first rows, to cheaply find out if a table starts like another one
+            unsigned long getChecksum(std::size_t rows) const;
+
+            static int slotOf(char key); // returns the slot of an upper case parameter name, -1 if it has none
+
+        private:
+            unsigned int getOpcode(const std::string &name);
+            void shiftOverflow(std::size_t row, bool inserted);
+
+            std::vector<std::string> names;
+            std::map<std::string, unsigned int> opcodeOfName;
+            std::vector<unsigned int> opcodes;
+            std::vector<unsigned char> masks;
+            std::vector<double> values[SlotCount];
+            std::map<std::size_t, std::map<std::string,double> > overflow;
+    };
+
     /** The representation of a CNC Toolpath */
     
     class PathExport Toolpath : public Base::Persistence
@@ -60,16 +127,19 @@ namespace Path
             void deleteCommand(int); // deletes a command
             double getLength(void); // return the Length (mm) of the Path
             void recalculate(void); // recalculates the points
-            void setFromGCode(const std::string); // sets the path from the contents of the given GCode string
+            void setFromGCode(const std::string&); // sets the path from the contents of the given GCode string
+            void setFromGCode(const char *data, std::size_t size); // same as above for a GCode buffer
             std::string toGCode(void) const; // gets a gcode string representation from the Path
             
             // shortcut functions
-            unsigned int getSize(void) const{return vpcCommands.size();}
-            const std::vector<Command*> &getCommands(void)const{return vpcCommands;}
-            const Command &getCommand(unsigned int pos)const {return *vpcCommands[pos];}
+            unsigned int getSize(void) const{return columns.size();}
+            Command getCommand(unsigned int pos) const; // returns a copy of the command at the given position
+            const ToolpathColumns &getColumns(void) const {return columns;}
         
         protected:
-            std::vector<Command*> vpcCommands;
+            void setCommand(std::size_t row, const Command &Cmd); // copies the parameters of the command to the row
+
+            ToolpathColumns columns;
             //KDL::Path_Composite *pcPath;
             
         /*
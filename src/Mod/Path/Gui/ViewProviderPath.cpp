@@ -26,6 +26,8 @@
 #ifndef _PreComp_
 # include <Inventor/SbVec3f.h>
 # include <Inventor/nodes/SoSeparator.h>
+# include <Inventor/nodes/SoGroup.h>
+# include <Inventor/nodes/SoLevelOfDetail.h>
 # include <Inventor/nodes/SoTransform.h>
 # include <Inventor/nodes/SoRotation.h>
 # include <Inventor/nodes/SoBaseColor.h>
@@ -37,6 +39,7 @@
 # include <Inventor/nodes/SoMarkerSet.h>
 # include <Inventor/nodes/SoShapeHints.h>
 # include <QFile>
+# include <algorithm>
 #endif
 
 #include "ViewProviderPath.h"
@@ -66,9 +69,64 @@ using namespace PathGui;
 using namespace Path;
 using namespace PartGui;
 
+namespace {
+
+// number of line segments of a chunk
+const int chunkSize = 4096;
+// number of detail levels of a chunk, every level keeps a quarter of the points of the previous one
+const int levelCount = 3;
+// screen area in pixels a segment needs to be drawn in full detail
+const float segmentArea = 4.0f;
+
+// Creates a chunk of the path made of a polyline through the points. The
+// colors are the material indices of the segments. For a chunk that covers
+// only a small area of the screen a decimated line is drawn, which keeps the
+// points where the color changes.
+SoSeparator *createChunk(const SbVec3f *points, int count, const int32_t *colors)
+{
+    SoSeparator *chunk = new SoSeparator();
+    chunk->renderCulling = SoSeparator::ON;
+    SoCoordinate3 *coords = new SoCoordinate3();
+    coords->point.setValues(0, count, points);
+    chunk->addChild(coords);
+
+    SoLevelOfDetail *lod = new SoLevelOfDetail();
+    chunk->addChild(lod);
+    std::size_t segments = 0;
+    for (int level=0; level<levelCount; level++) {
+        int stride = 1 << (2 * level);
+        std::vector<int32_t> index;
+        std::vector<int32_t> material;
+        index.push_back(0);
+        int last = 0;
+        for (int i=1; i<count; i++) {
+            if (i == count - 1 || i % stride == 0 || colors[i] != colors[i - 1]) {
+                material.push_back(colors[last]);
+                index.push_back(i);
+                last = i;
+            }
+        }
+        if (material.empty() || (level > 0 && material.size() == segments))
+            break;
+
+        PartGui::SoBrepEdgeSet *lines = new PartGui::SoBrepEdgeSet();
+        lines->coordIndex.setValues(0, index.size(), &index[0]);
+        lines->materialIndex.setValues(0, material.size(), &material[0]);
+        if (level > 0)
+            lod->screenArea.set1Value(level - 1, segmentArea * segments);
+        lod->addChild(lines);
+        segments = material.size();
+    }
+    return chunk;
+}
+
+}
+
 PROPERTY_SOURCE(PathGui::ViewProviderPath, Gui::ViewProviderGeometryObject)
 
 ViewProviderPath::ViewProviderPath()
+    : commandCount(0), commandChecksum(0), pointCount(0)
+    , absoluteMode(true), absoluteCenterMode(false), firstMove(true)
 {
     ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Mod/Path");
     unsigned long lcol = hGrp->GetUnsigned("DefaultNormalPathColor",11141375UL); // dark green (0,170,0)
@@ -94,8 +152,8 @@ ViewProviderPath::ViewProviderPath()
     pcTransform = new SoTransform();
     pcTransform->ref();
 
-    pcLineCoords = new SoCoordinate3();
-    pcLineCoords->ref();
+    pcLineChunks = new SoGroup();
+    pcLineChunks->ref();
 
     pcMarkerCoords = new SoCoordinate3();
     pcMarkerCoords->ref();
@@ -105,16 +163,12 @@ ViewProviderPath::ViewProviderPath()
     pcDrawStyle->style = SoDrawStyle::LINES;
     pcDrawStyle->lineWidth = LineWidth.getValue();
 
-    pcLines = new PartGui::SoBrepEdgeSet();
-    pcLines->ref();
-    pcLines->coordIndex.setNum(0);
-
     pcLineColor = new SoMaterial;
     pcLineColor->ref();
 
     pcMatBind = new SoMaterialBinding;
     pcMatBind->ref();
-    pcMatBind->value = SoMaterialBinding::OVERALL;
+    pcMatBind->value = SoMaterialBinding::PER_PART_INDEXED;
 
     pcMarkerColor = new SoBaseColor;
     pcMarkerColor->ref();
@@ -127,10 +181,9 @@ ViewProviderPath::~ViewProviderPath()
 {
     pcPathRoot->unref();
     pcTransform->unref();
-    pcLineCoords->unref();
+    pcLineChunks->unref();
     pcMarkerCoords->unref();
     pcDrawStyle->unref();
-    pcLines->unref();
     pcLineColor->unref();
     pcMatBind->unref();
     pcMarkerColor->unref();
@@ -145,8 +198,7 @@ void ViewProviderPath::attach(App::DocumentObject *pcObj)
     linesep->addChild(pcLineColor);
     linesep->addChild(pcMatBind);
     linesep->addChild(pcDrawStyle);
-    linesep->addChild(pcLineCoords);
-    linesep->addChild(pcLines);
+    linesep->addChild(pcLineChunks);
 
     // Draw markers
     SoSeparator* markersep = new SoSeparator;
@@ -185,36 +237,29 @@ void ViewProviderPath::onChanged(const App::Property* prop)
     if (prop == &LineWidth) {
         pcDrawStyle->lineWidth = LineWidth.getValue();
     } else if (prop == &NormalColor) {
-        if (colorindex.size() > 0) {
-            const App::Color& c = NormalColor.getValue();
-            ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Mod/Path");
-            unsigned long rcol = hGrp->GetUnsigned("DefaultRapidPathColor",2852126975UL); // dark red (170,0,0)
-            float rr,rg,rb;
-            rr = ((rcol >> 24) & 0xff) / 255.0; rg = ((rcol >> 16) & 0xff) / 255.0; rb = ((rcol >> 8) & 0xff) / 255.0;
-
-            unsigned long pcol = hGrp->GetUnsigned("DefaultProbePathColor",4293591295UL); // yellow (255,255,5)
-            float pr,pg,pb;
-            pr = ((pcol >> 24) & 0xff) / 255.0; pg = ((pcol >> 16) & 0xff) / 255.0; pb = ((pcol >> 8) & 0xff) / 255.0;
-
-            pcMatBind->value = SoMaterialBinding::PER_PART;
-            // resizing and writing the color vector:
-            pcLineColor->diffuseColor.setNum(colorindex.size());
-            SbColor* colors = pcLineColor->diffuseColor.startEditing();
-            for(unsigned int i=0;i<colorindex.size();i++) {
-                if (colorindex[i] == 0)
-                    colors[i] = SbColor(rr,rg,rb);
-                else if (colorindex[i] == 1)
-                    colors[i] = SbColor(c.r,c.g,c.b);
-                else
-                    colors[i] = SbColor(pr,pg,pb);
-            }
-            pcLineColor->diffuseColor.finishEditing();
-        }
+        const App::Color& c = NormalColor.getValue();
+        ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Mod/Path");
+        unsigned long rcol = hGrp->GetUnsigned("DefaultRapidPathColor",2852126975UL); // dark red (170,0,0)
+        float rr,rg,rb;
+        rr = ((rcol >> 24) & 0xff) / 255.0; rg = ((rcol >> 16) & 0xff) / 255.0; rb = ((rcol >> 8) & 0xff) / 255.0;
+
+        unsigned long pcol = hGrp->GetUnsigned("DefaultProbePathColor",4293591295UL); // yellow (255,255,5)
+        float pr,pg,pb;
+        pr = ((pcol >> 24) & 0xff) / 255.0; pg = ((pcol >> 16) & 0xff) / 255.0; pb = ((pcol >> 8) & 0xff) / 255.0;
+
+        // the segments index these colors by their color index
+        pcLineColor->diffuseColor.setNum(3);
+        SbColor* colors = pcLineColor->diffuseColor.startEditing();
+        colors[0] = SbColor(rr,rg,rb);
+        colors[1] = SbColor(c.r,c.g,c.b);
+        colors[2] = SbColor(pr,pg,pb);
+        pcLineColor->diffuseColor.finishEditing();
     } else if (prop == &MarkerColor) {
         const App::Color& c = MarkerColor.getValue();
         pcMarkerColor->rgb.setValue(c.r,c.g,c.b);
     } else if ( (prop == &ShowFirstRapid) || (prop == &ShowNodes) ) {
         Path::Feature* pcPathObj = static_cast<Path::Feature*>(pcObject);
+        clearPath();
         this->updateData(&pcPathObj->Path);
     } else {
         ViewProviderGeometryObject::onChanged(prop);
@@ -227,34 +272,32 @@ void ViewProviderPath::updateData(const App::Property* prop)
 
     if (prop == &pcPathObj->Path) {
 
-        const Toolpath &tp = pcPathObj->Path.getValue();
-        if(tp.getSize()==0) {
-            pcLineCoords->point.deleteValues(0);
-            pcMarkerCoords->point.deleteValues(0);
+        const ToolpathColumns &tp = pcPathObj->Path.getValue().getColumns();
+        // if commands were only appended, the lines drawn so far are kept and continued
+        if (commandCount > 0 && (commandCount > tp.size() || tp.getChecksum(commandCount) != commandChecksum))
+            clearPath();
+        if (commandCount == tp.size())
             return;
-        }
 
         ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Mod/Part");
         float deviation = hGrp->GetFloat("MeshDeviation",0.2);
         std::vector<Base::Vector3d> points;
         std::vector<Base::Vector3d> markers;
-        Base::Vector3d last(0,0,0);
-        colorindex.clear();
-        bool absolute = true;
-        bool absolutecenter = false;
-        bool first = true;
-
-        for (unsigned int  i = 0; i < tp.getSize(); i++) {
-            Path::Command cmd = tp.getCommand(i);
-            std::string name = cmd.Name;
-            Base::Vector3d next = cmd.getPlacement().getPosition();
+        Base::Vector3d last = lastPoint;
+        bool absolute = absoluteMode;
+        bool absolutecenter = absoluteCenterMode;
+        bool first = firstMove;
+
+        for (std::size_t i = commandCount; i < tp.size(); i++) {
+            const std::string &name = tp.getName(i);
+            Base::Vector3d next = tp.getPosition(i);
             if (!absolute)
                 next = last + next;
-            if (!cmd.has("X"))
+            if (!tp.hasParameter(i, ToolpathColumns::X))
                 next.x = last.x;
-            if (!cmd.has("Y"))
+            if (!tp.hasParameter(i, ToolpathColumns::Y))
                 next.y = last.y;
-            if (!cmd.has("Z"))
+            if (!tp.hasParameter(i, ToolpathColumns::Z))
                 next.z = last.z;
 
             if ( (name == "G0") || (name == "G00") || (name == "G1") || (name == "G01") ) {
@@ -290,9 +333,9 @@ void ViewProviderPath::updateData(const App::Property* prop)
                 else
                     norm.Set(0,0,1);
                 if (absolutecenter)
-                    center = cmd.getCenter();
+                    center = tp.getCenter(i);
                 else
-                    center = (last + cmd.getCenter());
+                    center = (last + tp.getCenter(i));
                 Base::Vector3d next0 = Base::Vector3d(next.x, next.y, 0);
                 Base::Vector3d last0 = Base::Vector3d(last.x, last.y, 0);
                 Base::Vector3d center0 = Base::Vector3d(center.x, center.y, 0);
@@ -347,8 +390,8 @@ void ViewProviderPath::updateData(const App::Property* prop)
             } else if ((name=="G81")||(name=="G82")||(name=="G83")||(name=="G84")||(name=="G85")||(name=="G86")||(name=="G89")){
                 // drill,tap,bore
                 double r = 0;
-                if (cmd.has("R"))
-                    r = cmd.getValue("R");
+                if (tp.hasParameter(i, "R"))
+                    r = tp.getParameter(i, "R");
                 Base::Vector3d p1(next.x,next.y,last.z);
 //                Base::Vector3d p1(next.x,next.y,r);
                 points.push_back(p1);
@@ -365,8 +408,8 @@ void ViewProviderPath::updateData(const App::Property* prop)
                     markers.push_back(next);
                 colorindex.push_back(1);
                 double q;
-                if (cmd.has("Q")) {
-                    q = cmd.getValue("Q");
+                if (tp.hasParameter(i, "Q")) {
+                    q = tp.getParameter(i, "Q");
                     double tempz = r;
                     while (tempz > next.z) {
                         Base::Vector3d temp(next.x,next.y,tempz);
@@ -392,28 +435,24 @@ void ViewProviderPath::updateData(const App::Property* prop)
                 colorindex.push_back(0);
             }}
 
-        if (!points.empty()) {
-            pcLineCoords->point.deleteValues(0);
-            pcLineCoords->point.setNum(points.size());
-            std::vector<int> ei;
-            for(unsigned int i=0;i<points.size();i++) {
-                pcLineCoords->point.set1Value(i,points[i].x,points[i].y,points[i].z);
-                ei.push_back(i);
-            }
-            int* segs = &ei[0];
-            pcLines->coordIndex.setNum(points.size());
-            pcLines->coordIndex.setValues(0,points.size(),(const int32_t*)segs);
-
-            pcMarkerCoords->point.deleteValues(0);
-
-            pcMarkerCoords->point.setNum(markers.size());
+        lastPoint = last;
+        absoluteMode = absolute;
+        absoluteCenterMode = absolutecenter;
+        firstMove = first;
+        commandCount = tp.size();
+        commandChecksum = tp.getChecksum(commandCount);
+
+        if (!points.empty())
+            appendLines(points);
+        if (!markers.empty()) {
+            int count = pcMarkerCoords->point.getNum();
+            pcMarkerCoords->point.setNum(count + markers.size());
+            SbVec3f* coords = pcMarkerCoords->point.startEditing();
             for(unsigned int i=0;i<markers.size();i++)
-                pcMarkerCoords->point.set1Value(i,markers[i].x,markers[i].y,markers[i].z);
-
-            // update the coloring after we changed the color vector
-            NormalColor.touch();
-            recomputeBoundingBox();
+                coords[count + i].setValue(markers[i].x,markers[i].y,markers[i].z);
+            pcMarkerCoords->point.finishEditing();
         }
+        recomputeBoundingBox();
 
     } else if ( prop == &pcPathObj->Placement) {
 
@@ -427,6 +466,55 @@ void ViewProviderPath::updateData(const App::Property* prop)
     }
 }
 
+void ViewProviderPath::clearPath()
+{
+    pcLineChunks->removeAllChildren();
+    pcMarkerCoords->point.deleteValues(0);
+    colorindex.clear();
+    commandCount = 0;
+    commandChecksum = 0;
+    pointCount = 0;
+    lastPoint = Base::Vector3d(0,0,0);
+    absoluteMode = true;
+    absoluteCenterMode = false;
+    firstMove = true;
+}
+
+void ViewProviderPath::appendLines(const std::vector<Base::Vector3d> &points)
+{
+    // the lines of a chunk that is not full are drawn again with the new ones,
+    // otherwise the new chunk starts at the end of the last one
+    std::vector<SbVec3f> coords;
+    int num = pcLineChunks->getNumChildren();
+    if (num > 0) {
+        SoSeparator* chunk = static_cast<SoSeparator*>(pcLineChunks->getChild(num - 1));
+        const SoMFVec3f& last = static_cast<SoCoordinate3*>(chunk->getChild(0))->point;
+        if (last.getNum() <= chunkSize) {
+            coords.assign(last.getValues(0), last.getValues(0) + last.getNum());
+            pcLineChunks->removeChild(num - 1);
+        }
+        else {
+            coords.push_back(last[last.getNum() - 1]);
+        }
+    }
+    std::size_t offset = pointCount - coords.size();
+    for (std::vector<Base::Vector3d>::const_iterator it = points.begin(); it != points.end(); ++it)
+        coords.push_back(SbVec3f(it->x, it->y, it->z));
+    pointCount += points.size();
+
+    // the color of a segment is the color index with the same position
+    std::vector<int32_t> colors(coords.size(), 1);
+    for (std::size_t i = 0; i + 1 < coords.size() && offset + i < colorindex.size(); i++)
+        colors[i] = colorindex[offset + i];
+
+    for (std::size_t begin = 0; ; begin += chunkSize) {
+        std::size_t end = std::min<std::size_t>(begin + chunkSize + 1, coords.size());
+        pcLineChunks->addChild(createChunk(&coords[begin], end - begin, &colors[begin]));
+        if (end == coords.size())
+            break;
+    }
+}
+
 void ViewProviderPath::recomputeBoundingBox()
 {
     // update the boundbox
@@ -440,17 +528,21 @@ void ViewProviderPath::recomputeBoundingBox()
     Path::Feature* pcPathObj = static_cast<Path::Feature*>(pcObject);
     Base::Placement pl = *(&pcPathObj->Placement.getValue());
     Base::Vector3d pt;
-    for (int i=0;i<pcLineCoords->point.getNum();i++) {
-        pt.x = pcLineCoords->point[i].getValue()[0];
-        pt.y = pcLineCoords->point[i].getValue()[1];
-        pt.z = pcLineCoords->point[i].getValue()[2];
-        pl.multVec(pt,pt);
-        if (pt.x < MinX)  MinX = pt.x;
-        if (pt.y < MinY)  MinY = pt.y;
-        if (pt.z < MinZ)  MinZ = pt.z;
-        if (pt.x > MaxX)  MaxX = pt.x;
-        if (pt.y > MaxY)  MaxY = pt.y;
-        if (pt.z > MaxZ)  MaxZ = pt.z;
+    for (int j=0;j<pcLineChunks->getNumChildren();j++) {
+        SoSeparator* chunk = static_cast<SoSeparator*>(pcLineChunks->getChild(j));
+        const SoMFVec3f& coords = static_cast<SoCoordinate3*>(chunk->getChild(0))->point;
+        for (int i=0;i<coords.getNum();i++) {
+            pt.x = coords[i].getValue()[0];
+            pt.y = coords[i].getValue()[1];
+            pt.z = coords[i].getValue()[2];
+            pl.multVec(pt,pt);
+            if (pt.x < MinX)  MinX = pt.x;
+            if (pt.y < MinY)  MinY = pt.y;
+            if (pt.z < MinZ)  MinZ = pt.z;
+            if (pt.x > MaxX)  MaxX = pt.x;
+            if (pt.y > MaxY)  MaxY = pt.y;
+            if (pt.z > MaxZ)  MaxZ = pt.z;
+        }
     }
     pcBoundingBox->minBounds.setValue(MinX, MinY, MinZ);
     pcBoundingBox->maxBounds.setValue(MaxX, MaxY, MaxZ);
@@ -28,7 +28,9 @@
 #include <Gui/SoFCSelection.h>
 #include <Gui/ViewProviderPythonFeature.h>
 #include <Mod/Part/Gui/SoBrepEdgeSet.h>
+#include <Base/Vector3D.h>
 
+class SoGroup;
 class SoCoordinate3;
 class SoDrawStyle;  
 class SoMaterial;
@@ -68,17 +70,30 @@ protected:
 
     virtual void onChanged(const App::Property* prop);
  
+    /// removes all lines and markers
+    void clearPath();
+    /// adds the points to the line chunks, the last chunk is rebuilt if it is not full
+    void appendLines(const std::vector<Base::Vector3d> &points);
+
     Gui::SoFCSelection    * pcPathRoot;
     SoTransform           * pcTransform;
-    SoCoordinate3         * pcLineCoords;
+    SoGroup               * pcLineChunks;
     SoCoordinate3         * pcMarkerCoords;
     SoDrawStyle           * pcDrawStyle;
-    PartGui::SoBrepEdgeSet         * pcLines;
     SoMaterial            * pcLineColor;
     SoBaseColor           * pcMarkerColor;
     SoMaterialBinding     * pcMatBind;
     std::vector<int>        colorindex;
 
+    // the drawn commands and the state after the last one
+    std::size_t             commandCount;
+    unsigned long           commandChecksum;
+    std::size_t             pointCount;
+    Base::Vector3d          lastPoint;
+    bool                    absoluteMode;
+    bool                    absoluteCenterMode;
+    bool                    firstMove;
+
  };
  
  typedef Gui::ViewProviderPythonFeatureT<ViewProviderPath> ViewProviderPathPython;
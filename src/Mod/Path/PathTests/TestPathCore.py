@@ -0,0 +1,117 @@
+# -*- coding: utf-8 -*-
+
+# ***************************************************************************
+# *                                                                         *
+# *   Copyright (c) 2017 FreeCAD Developers                                 *
+# *                                                                         *
+# *   This program is free software; you can redistribute it and/or modify  *
+# *   it under the terms of the GNU Lesser General Public License (LGPL)    *
+# *   as published by the Free Software Foundation; either version 2 of     *
+# *   the License, or (at your option) any later version.                   *
+# *   for detail see the LICENCE text file.                                 *
+# *                                                                         *
+# *   This program is distributed in the hope that it will be useful,       *
+# *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+# *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+# *   GNU Library General Public License for more details.                  *
+# *                                                                         *
+# *   You should have received a copy of the GNU Library General Public     *
+# *   License along with this program; if not, write to the Free Software   *
+# *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+# *   USA                                                                   *
+# *                                                                         *
+# ***************************************************************************
+
+import FreeCAD
+import Path
+import os
+import tempfile
+import zipfile
+
+from PathTests.PathTestUtils import PathTestBase
+
+class TestPathCore(PathTestBase):
+    """Test the GCode parser of Path.Path."""
+
+    def test00(self):
+        """Verify commands, parameters and comments read from GCode."""
+        path = Path.Path("(start) G0 Z5\nM3 S12000\ng1 x1.5 Y-2 z-.25 F300 (row 1)\nG2 X3 Y0 I0.75 J1 K0\n")
+        self.assertEqual([c.Name for c in path.Commands], ['(start)', 'G0', 'M3', 'G1', '(row 1)', 'G2'])
+        self.assertEqual(path.Commands[0].Parameters, {})
+        self.assertEqual(path.Commands[2].Parameters, {'S': 12000.0})
+        self.assertEqual(path.Commands[3].Parameters, {'X': 1.5, 'Y': -2.0, 'Z': -0.25, 'F': 300.0})
+        self.assertEqual(path.Commands[5].Parameters, {'X': 3.0, 'Y': 0.0, 'I': 0.75, 'J': 1.0, 'K': 0.0})
+
+    def test01(self):
+        """Verify that badly formatted GCode is reported."""
+        path = Path.Path()
+        self.assertRaises(Exception, path.setFromGCode, "G1 X1 G X2")
+        self.assertEqual(path.Size, 1)
+        self.assertRaises(Exception, path.setFromGCode, "G1 X")
+
+    def surfacingJob(self, count):
+        lines = ["G0 Z5.0000", "M3 S12000"]
+        for i in range(count):
+            if i % 5000 == 0:
+                lines.append("(row %d)" % (i // 5000))
+            lines.append("G1 X%.4f Y%.4f Z%.4f" % ((i % 1000) * 0.1, (i // 1000) * 0.1, -1.0 + 0.001 * (i % 777)))
+        return lines
+
+    def test02(self):
+        """Verify that large surfacing jobs are parsed completely."""
+        for count in [50000, 200000]:
+            lines = self.surfacingJob(count)
+            path = Path.Path("\n".join(lines))
+
+            self.assertEqual(path.Size, len(lines))
+            last = path.Commands[-1]
+            self.assertEqual(last.Name, 'G1')
+            self.assertRoughly(last.Parameters['X'], 99.9)
+            self.assertRoughly(last.Parameters['Y'], (count - 1) // 1000 * 0.1)
+
+    def test03(self):
+        """Verify that edited commands are saved and restored with all parameters."""
+        path = Path.Path("G0 X1 Y2\nM6 T2\nG81 X3 Y4 Z-1 R2 Q0.5\n")
+        path.insertCommand(Path.Command('G1', {'X': 5.0, 'TOOL': 1.0}), 1)
+        path.deleteCommand(0)
+        path.addCommands(Path.Command('G2', {'X': 0.0, 'Y': 0.0, 'I': -1.0}))
+        expected = [(c.Name, c.Parameters) for c in path.Commands]
+        self.assertEqual(expected[0], ('G1', {'X': 5.0, 'TOOL': 1.0}))
+        self.assertEqual(expected[1], ('M6', {'T': 2.0}))
+
+        doc = FreeCAD.newDocument('TestPathCore')
+        obj = doc.addObject('Path::Feature', 'Toolpath')
+        obj.Path = path
+        fileName = os.path.join(tempfile.gettempdir(), 'TestPathCore.FCStd')
+        doc.saveAs(fileName)
+        FreeCAD.closeDocument(doc.Name)
+
+        doc = FreeCAD.openDocument(fileName)
+        restored = doc.getObject('Toolpath').Path
+        self.assertEqual([(c.Name, c.Parameters) for c in restored.Commands], expected)
+        self.assertRoughly(restored.Length, path.Length)
+        FreeCAD.closeDocument(doc.Name)
+        os.remove(fileName)
+
+    def test04(self):
+        """Verify that a truncated toolpath file is not restored partly."""
+        doc = FreeCAD.newDocument('TestPathCore')
+        obj = doc.addObject('Path::Feature', 'Toolpath')
+        obj.Path = Path.Path("G0 X1 Y2\nG1 X3 Y4 Z-1\nG1 X5 Y6 Z-2\n" * 100)
+        fileName = os.path.join(tempfile.gettempdir(), 'TestPathCore.FCStd')
+        doc.saveAs(fileName)
+        FreeCAD.closeDocument(doc.Name)
+
+        # cut the binary toolpath file in the middle of its columns
+        with zipfile.ZipFile(fileName) as archive:
+            entries = [(info, archive.read(info.filename)) for info in archive.infolist()]
+        with zipfile.ZipFile(fileName, 'w', zipfile.ZIP_DEFLATED) as archive:
+            for info, data in entries:
+                if info.filename.endswith('.bin'):
+                    data = data[:len(data) // 2]
+                archive.writestr(info.filename, data)
+
+        doc = FreeCAD.openDocument(fileName)
+        self.assertEqual(doc.getObject('Toolpath').Path.Size, 0)
+        FreeCAD.closeDocument(doc.Name)
+        os.remove(fileName)
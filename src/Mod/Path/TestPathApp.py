@@ -28,4 +28,5 @@ from PathTests.TestPathPost import PathPostTestCases
 
 from PathTests.TestPathGeom import TestPathGeom
 from PathTests.TestPathDepthParams import depthTestCases
+from PathTests.TestPathCore import TestPathCore
 
@@ -152,9 +152,7 @@ void PropertyGreyValueList::SaveDocFile (Base::Writer &writer) const
     Base::OutputStream str(writer.Stream());
     uint32_t uCt = (uint32_t)getSize();
     str << uCt;
-    for (std::vector<float>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-        str << *it;
-    }
+    str.write(_lValueList.data(), _lValueList.size());
 }
 
 void PropertyGreyValueList::RestoreDocFile(Base::Reader &reader)
@@ -163,9 +161,7 @@ void PropertyGreyValueList::RestoreDocFile(Base::Reader &reader)
     uint32_t uCt=0;
     str >> uCt;
     std::vector<float> values(uCt);
-    for (std::vector<float>::iterator it = values.begin(); it != values.end(); ++it) {
-        str >> *it;
-    }
+    str.read(values.data(), values.size());
     setValues(values);
 }
 
@@ -326,9 +322,8 @@ void PropertyNormalList::SaveDocFile (Base::Writer &writer) const
     Base::OutputStream str(writer.Stream());
     uint32_t uCt = (uint32_t)getSize();
     str << uCt;
-    for (std::vector<Base::Vector3f>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-        str << it->x << it->y << it->z;
-    }
+    static_assert(sizeof(Base::Vector3f) == 3 * sizeof(float), "Base::Vector3f must be stored without padding");
+    str.write(reinterpret_cast<const float*>(_lValueList.data()), 3 * _lValueList.size());
 }
 
 void PropertyNormalList::RestoreDocFile(Base::Reader &reader)
@@ -337,9 +332,8 @@ void PropertyNormalList::RestoreDocFile(Base::Reader &reader)
     uint32_t uCt=0;
     str >> uCt;
     std::vector<Base::Vector3f> values(uCt);
-    for (std::vector<Base::Vector3f>::iterator it = values.begin(); it != values.end(); ++it) {
-        str >> it->x >> it->y >> it->z;
-    }
+    static_assert(sizeof(Base::Vector3f) == 3 * sizeof(float), "Base::Vector3f must be stored without padding");
+    str.read(reinterpret_cast<float*>(values.data()), 3 * values.size());
     setValues(values);
 }
 
@@ -576,12 +570,9 @@ void PropertyCurvatureList::SaveDocFile (Base::Writer &writer) const
     Base::OutputStream str(writer.Stream());
     uint32_t uCt = (uint32_t)getSize();
     str << uCt;
-    if (uCt > 0)
-    for (std::vector<CurvatureInfo>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-        str << it->fMaxCurvature << it->fMinCurvature;
-        str << it->cMaxCurvDir.x << it->cMaxCurvDir.y << it->cMaxCurvDir.z;
-        str << it->cMinCurvDir.x << it->cMinCurvDir.y << it->cMinCurvDir.z;
-    }
+    // the members of CurvatureInfo are eight floats in the order they are stored
+    static_assert(sizeof(CurvatureInfo) == 8 * sizeof(float), "CurvatureInfo must be stored without padding");
+    str.write(reinterpret_cast<const float*>(_lValueList.data()), 8 * _lValueList.size());
 }
 
 void PropertyCurvatureList::RestoreDocFile(Base::Reader &reader)
@@ -590,11 +581,8 @@ void PropertyCurvatureList::RestoreDocFile(Base::Reader &reader)
     uint32_t uCt=0;
     str >> uCt;
     std::vector<CurvatureInfo> values(uCt);
-    for (std::vector<CurvatureInfo>::iterator it = values.begin(); it != values.end(); ++it) {
-        str >> it->fMaxCurvature >> it->fMinCurvature;
-        str >> it->cMaxCurvDir.x >> it->cMaxCurvDir.y >> it->cMaxCurvDir.z;
-        str >> it->cMinCurvDir.x >> it->cMinCurvDir.y >> it->cMinCurvDir.z;
-    }
+    static_assert(sizeof(CurvatureInfo) == 8 * sizeof(float), "CurvatureInfo must be stored without padding");
+    str.read(reinterpret_cast<float*>(values.data()), 8 * values.size());
 
     setValues(values);
 }
@@ -51,25 +51,43 @@ PropertyPointKernel::~PropertyPointKernel()
 {
 }
 
+void PropertyPointKernel::detachPoints()
+{
+    // The points may be shared with copies of this property, e.g. in the undo
+    // stack, or with Python objects. In this case they must be copied before
+    // they get modified.
+    if (_cPoints.getRefCount() > 1) {
+        PointKernel* points = new PointKernel();
+        *points = *_cPoints;
+        _cPoints = points;
+    }
+}
+
 void PropertyPointKernel::setValue(const PointKernel& m)
 {
     aboutToSetValue();
+    discardDeferred();
+    if (_cPoints.getRefCount() > 1)
+        _cPoints = new PointKernel();
     *_cPoints = m;
     hasSetValue();
 }
 
 const PointKernel& PropertyPointKernel::getValue(void) const 
 {
+    loadDeferred();
     return *_cPoints;
 }
 
 const Data::ComplexGeoData* PropertyPointKernel::getComplexData() const
 {
+    loadDeferred();
     return _cPoints;
 }
 
 Base::BoundBox3d PropertyPointKernel::getBoundingBox() const
 {
+    loadDeferred();
     Base::BoundBox3d box;
     for (PointKernel::const_iterator it = _cPoints->begin(); it != _cPoints->end(); ++it)
         box.Add(*it);
@@ -78,6 +96,7 @@ Base::BoundBox3d PropertyPointKernel::getBoundingBox() const
 
 PyObject *PropertyPointKernel::getPyObject(void)
 {
+    loadDeferred();
     PointsPy* points = new PointsPy(&*_cPoints);
     points->setConst(); // set immutable
     return points;
@@ -98,6 +117,7 @@ void PropertyPointKernel::setPyObject(PyObject *value)
 
 void PropertyPointKernel::Save (Base::Writer &writer) const
 {
+    loadDeferred();
     _cPoints->Save(writer);
 }
 
@@ -106,10 +126,7 @@ void PropertyPointKernel::Restore(Base::XMLReader &reader)
     reader.readElement("Points");
     std::string file (reader.getAttribute("file") );
 
-    if (!file.empty()) {
-        // initate a file read
-        reader.addFile(file.c_str(),this);
-    }
+    // set the transformation first, the points may be read later on
     if(reader.DocumentSchema > 3)
     {
         std::string Matrix (reader.getAttribute("mtrx") );
@@ -117,9 +134,15 @@ void PropertyPointKernel::Restore(Base::XMLReader &reader)
         mtrx.fromString(Matrix);
 
         aboutToSetValue();
+        detachPoints();
         _cPoints->setTransform(mtrx);
         hasSetValue();
     }
+    if (!file.empty()) {
+        // initate a file read
+        reader.addFile(file.c_str(),this);
+        deferFile(reader, this);
+    }
 }
 
 void PropertyPointKernel::SaveDocFile (Base::Writer &writer) const
@@ -131,22 +154,25 @@ void PropertyPointKernel::SaveDocFile (Base::Writer &writer) const
 void PropertyPointKernel::RestoreDocFile(Base::Reader &reader)
 {
     aboutToSetValue();
+    detachPoints();
     _cPoints->RestoreDocFile(reader);
     hasSetValue();
 }
 
 App::Property *PropertyPointKernel::Copy(void) const 
 {
+    loadDeferred();
     PropertyPointKernel* prop = new PropertyPointKernel();
-    (*prop->_cPoints) = (*this->_cPoints);
+    prop->_cPoints = this->_cPoints;
     return prop;
 }
 
 void PropertyPointKernel::Paste(const App::Property &from)
 {
     aboutToSetValue();
+    discardDeferred();
     const PropertyPointKernel& prop = dynamic_cast<const PropertyPointKernel&>(from);
-    *(this->_cPoints) = *(prop._cPoints);
+    this->_cPoints = prop._cPoints;
     hasSetValue();
 }
 
@@ -157,7 +183,9 @@ unsigned int PropertyPointKernel::getMemSize (void) const
 
 PointKernel* PropertyPointKernel::startEditing()
 {
+    loadDeferred();
     aboutToSetValue();
+    detachPoints();
     return static_cast<PointKernel*>(_cPoints);
 }
 
@@ -168,6 +196,7 @@ void PropertyPointKernel::finishEditing()
 
 void PropertyPointKernel::removeIndices( const std::vector<unsigned long>& uIndices )
 {
+    loadDeferred();
     // We need a sorted array
     std::vector<unsigned long> uSortedInds = uIndices;
     std::sort(uSortedInds.begin(), uSortedInds.end());
@@ -196,7 +225,15 @@ void PropertyPointKernel::removeIndices( const std::vector<unsigned long>& uIndi
 
 void PropertyPointKernel::transformGeometry(const Base::Matrix4D &rclMat)
 {
+    loadDeferred();
     aboutToSetValue();
+    detachPoints();
     _cPoints->transformGeometry(rclMat);
     hasSetValue();
 }
+
+void PropertyPointKernel::setTransform(const Base::Matrix4D &rclTrf)
+{
+    detachPoints();
+    _cPoints->setTransform(rclTrf);
+}
@@ -62,7 +62,9 @@ public:
 
     /** @name Undo/Redo */
     //@{
-    /// returns a new copy of the property (mainly for Undo/Redo and transactions)
+    /** returns a new copy of the property (mainly for Undo/Redo and transactions)
+     * The copy shares the points with this property until one of them gets modified.
+     */
     App::Property *Copy(void) const;
     /// paste the value from the property (mainly for Undo/Redo and transactions)
     void Paste(const App::Property &from);
@@ -83,9 +85,14 @@ public:
     void finishEditing();
     /// Transform the real 3d point kernel
     void transformGeometry(const Base::Matrix4D &rclMat);
+    /// Set the placement of the points without notifying a change
+    void setTransform(const Base::Matrix4D &rclTrf);
     void removeIndices( const std::vector<unsigned long>& );
     //@}
 
+private:
+    void detachPoints();
+
 private:
     Base::Reference<PointKernel> _cPoints;
 };
@@ -0,0 +1,82 @@
+#***************************************************************************
+#*                                                                         *
+#*   This file is part of the FreeCAD CAx development system.              *
+#*                                                                         *
+#*   This program is free software; you can redistribute it and/or modify  *
+#*   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#*   as published by the Free Software Foundation; either version 2 of     *
+#*   the License, or (at your option) any later version.                   *
+#*   for detail see the LICENCE text file.                                 *
+#*                                                                         *
+#*   FreeCAD is distributed in the hope that it will be useful,            *
+#*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#*   GNU Library General Public License for more details.                  *
+#*                                                                         *
+#*   You should have received a copy of the GNU Library General Public     *
+#*   License along with FreeCAD; if not, write to the Free Software        *
+#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#*   USA                                                                   *
+#*                                                                         *
+#***************************************************************************/
+
+import FreeCAD, unittest
+import Points
+
+
+#---------------------------------------------------------------------------
+# define the functions to test the FreeCAD points module
+#---------------------------------------------------------------------------
+
+
+class PointsUndoCases(unittest.TestCase):
+    def setUp(self):
+        self.Doc = FreeCAD.newDocument("PointsUndoTest")
+        self.Doc.UndoMode = 1
+        pts = Points.Points()
+        pts.addPoints([FreeCAD.Vector(i, i * i, -i) for i in range(100)])
+        self.Doc.openTransaction("Create")
+        self.Feature = self.Doc.addObject("Points::Feature", "Points")
+        self.Feature.Points = pts
+        self.Doc.commitTransaction()
+
+    def checkPoints(self, points):
+        actual = self.Feature.Points.Points
+        self.failUnless(len(actual) == len(points))
+        for p, q in zip(actual, points):
+            self.failUnless((p - q).Length < 1e-6, "Point %s differs from %s" % (p, q))
+
+    def testUndoPlacement(self):
+        # the undo snapshot shares the points until they get modified in place
+        original = self.Feature.Points.Points
+        offset = FreeCAD.Vector(1, 2, 3)
+        self.Doc.openTransaction("Move")
+        self.Feature.Placement = FreeCAD.Placement(offset, FreeCAD.Rotation())
+        self.Doc.commitTransaction()
+        self.checkPoints([p + offset for p in original])
+        self.Doc.undo()
+        self.checkPoints(original)
+        self.Doc.redo()
+        self.checkPoints([p + offset for p in original])
+
+    def testUndoAssignment(self):
+        original = self.Feature.Points.Points
+        pts = Points.Points()
+        pts.addPoints([FreeCAD.Vector(0, 0, i) for i in range(10)])
+        self.Doc.openTransaction("Replace")
+        self.Feature.Points = pts
+        self.Doc.commitTransaction()
+        self.checkPoints(pts.Points)
+        # moving the new points must not touch the snapshot
+        self.Doc.openTransaction("Move")
+        self.Feature.Placement = FreeCAD.Placement(FreeCAD.Vector(5, 0, 0), FreeCAD.Rotation())
+        self.Doc.commitTransaction()
+        self.Doc.undo()
+        self.checkPoints(pts.Points)
+        self.Doc.undo()
+        self.checkPoints(original)
+        self.Doc.redo()
+        self.checkPoints(pts.Points)
+
+    def tearDown(self):
+        FreeCAD.closeDocument("PointsUndoTest")
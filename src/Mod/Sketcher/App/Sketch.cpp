@@ -2344,7 +2344,8 @@ int Sketch::solve(void)
 
     if(isInitMove){
         solvername = "DogLeg"; // DogLeg is used for dragging (same as before)
-        ret = GCSsys.solve(isFine, GCS::DogLeg);        
+        // only the components holding the dragged geometry are re-solved
+        ret = GCSsys.solveIncremental(isFine, GCS::DogLeg);
     }
     else{
         switch (defaultSolver) {
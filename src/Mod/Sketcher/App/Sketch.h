@@ -401,6 +401,7 @@ public:
     inline void setConvergenceRedundant(double conv){GCSsys.convergenceRedundant=conv;}
     inline void setQRAlgorithm(GCS::QRAlgorithm alg){GCSsys.qrAlgorithm=alg;}
     inline void setQRPivotThreshold(double val){GCSsys.qrpivotThreshold=val;}
+    inline void setSparseThreshold(int val){GCSsys.sparseThreshold=val;}
     inline void setLM_eps(double val){GCSsys.LM_eps=val;}
     inline void setLM_eps1(double val){GCSsys.LM_eps1=val;}
     inline void setLM_tau(double val){GCSsys.LM_tau=val;}
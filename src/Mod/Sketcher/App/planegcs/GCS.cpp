@@ -75,6 +75,9 @@
 
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/connected_components.hpp>
+#include <boost/bind.hpp>
+
+#include <QtConcurrentMap>
 
 #ifndef EIGEN_STOCK_FULLPIVLU_COMPUTE
 namespace Eigen {
@@ -181,6 +184,54 @@ namespace GCS
 
 typedef boost::adjacency_list <boost::vecS, boost::vecS, boost::undirectedS> Graph;
 
+namespace {
+
+// A decoupled component of the system, see System::initSolution()
+struct Component
+{
+    SubSystem *subsys;
+    SubSystem *subsysAux;
+    int result;
+};
+
+void solveComponent(Component &comp, System *sys, bool isFine, Algorithm alg, bool isRedundantsolving)
+{
+    if (comp.subsys && comp.subsysAux)
+        comp.result = sys->solve(comp.subsys, comp.subsysAux, isFine, isRedundantsolving);
+    else if (comp.subsys)
+        comp.result = sys->solve(comp.subsys, isFine, alg, isRedundantsolving);
+    else
+        comp.result = sys->solve(comp.subsysAux, isFine, alg, isRedundantsolving);
+}
+
+// Checks whether the constraints of the subsystem are satisfied by the current
+// parameter values, using the success criterion of the algorithm that would
+// solve it. The values are copied to the subsystem so that applying its
+// solution afterwards is a no-op.
+bool isSatisfied(SubSystem *subsys, const System *sys, Algorithm alg, bool isRedundantsolving)
+{
+    if (!subsys || subsys->cSize() == 0)
+        return true;
+
+    Eigen::VectorXd r(subsys->cSize());
+    double err;
+    subsys->redirectParams();
+    subsys->calcResidual(r, err);
+    subsys->revertParams();
+
+    switch (alg) {
+    case BFGS:
+        return err <= smallF;
+    case LevenbergMarquardt:
+        return r.squaredNorm() <= (isRedundantsolving ? sys->LM_epsRedundant : sys->LM_eps);
+    case DogLeg:
+    default:
+        return r.lpNorm<Eigen::Infinity>() <= (isRedundantsolving ? sys->DL_tolfRedundant : sys->DL_tolf);
+    }
+}
+
+}
+
 ///////////////////////////////////////
 // Solver
 ///////////////////////////////////////
@@ -198,6 +249,7 @@ System::System()
   , hasUnknowns(false)
   , hasDiagnosis(false)
   , isInit(false)
+  , isWarm(false)
   , maxIter(100)
   , maxIterRedundant(100)
   , sketchSizeMultiplier(false)
@@ -207,6 +259,7 @@ System::System()
   , qrAlgorithm(EigenSparseQR)
   , dogLegGaussStep(FullPivLU)
   , qrpivotThreshold(1E-13)
+  , sparseThreshold(100)
   , debugMode(Minimal)
   , LM_eps(1E-10)
   , LM_eps1(1E-80)
@@ -1062,6 +1115,7 @@ void System::initSolution(Algorithm alg)
     //   system reduction specified in the previous step
 
     isInit = false;
+    isWarm = false;
     if (!hasUnknowns)
         return;
 
@@ -1213,18 +1267,84 @@ int System::solve(bool isFine, Algorithm alg, bool isRedundantsolving)
     // return success by default in order to permit coincidence constraints to be applied
     // even if no other system has to be solved
     int res = Success;
+    std::vector<Component> components;
     for (int cid=0; cid < int(subSystems.size()); cid++) {
         if ((subSystems[cid] || subSystemsAux[cid]) && !isReset) {
              resetToReference();
              isReset = true;
         }
-        if (subSystems[cid] && subSystemsAux[cid])
-            res = std::max(res, solve(subSystems[cid], subSystemsAux[cid], isFine, isRedundantsolving));
-        else if (subSystems[cid])
-            res = std::max(res, solve(subSystems[cid], isFine, alg, isRedundantsolving));
-        else if (subSystemsAux[cid])
-            res = std::max(res, solve(subSystemsAux[cid], isFine, alg, isRedundantsolving));
+        if (!subSystems[cid] && !subSystemsAux[cid])
+            continue;
+        // components whose parameters did not change since they were solved
+        // last time, e.g. untouched profiles of the sketch, are skipped
+        // with an auxiliary subsystem the component is solved by SQP, which succeeds
+        // like BFGS once the error is below smallF; the auxiliary subsystem has to
+        // meet it as well, otherwise solving could still improve its objective
+        Algorithm check = (subSystems[cid] && subSystemsAux[cid]) ? BFGS : alg;
+        if (isSatisfied(subSystems[cid], this, check, isRedundantsolving) &&
+            isSatisfied(subSystemsAux[cid], this, check, isRedundantsolving))
+            continue;
+        Component comp = { subSystems[cid], subSystemsAux[cid], Success };
+        components.push_back(comp);
+    }
+
+    // the components share no parameters and can be solved at the same time,
+    // unless the iterations are logged
+    bool parallel = components.size() > 1 && debugMode != IterationLevel;
+#ifdef _GCS_EXTRACT_SOLVER_SUBSYSTEM_
+    parallel = false;
+#endif
+    if (parallel) {
+        QtConcurrent::blockingMap(components, boost::bind(&solveComponent, _1, this,
+                                  isFine, alg, isRedundantsolving));
     }
+    else {
+        for (std::vector<Component>::iterator it = components.begin(); it != components.end(); ++it)
+            solveComponent(*it, this, isFine, alg, isRedundantsolving);
+    }
+    for (std::vector<Component>::const_iterator it = components.begin(); it != components.end(); ++it)
+        res = std::max(res, it->result);
+
+    return checkRedundant(res, isRedundantsolving);
+}
+
+int System::solveIncremental(bool isFine, Algorithm alg)
+{
+    if (!isInit)
+        return Failed;
+
+    if (!isWarm) {
+        int res = solve(isFine, alg);
+        isWarm = (res == Success);
+        return res;
+    }
+
+    // The components without auxiliary constraints do not depend on the
+    // moved parameters, their subsystems still hold the last solution which
+    // applySolution() writes back. The other components start from the
+    // current parameter values, i.e. from the last applied solution, and
+    // fall back to the reference configuration if this does not converge.
+    int res = Success;
+    for (int attempt=0; attempt < 2; attempt++) {
+        if (attempt > 0)
+            resetToReference();
+        res = Success;
+        for (int cid=0; cid < int(subSystemsAux.size()); cid++) {
+            if (!subSystemsAux[cid])
+                continue;
+            if (subSystems[cid])
+                res = std::max(res, solve(subSystems[cid], subSystemsAux[cid], isFine));
+            else
+                res = std::max(res, solve(subSystemsAux[cid], isFine, alg));
+        }
+        if (res == Success)
+            break;
+    }
+    return checkRedundant(res, false);
+}
+
+int System::checkRedundant(int res, bool isRedundantsolving)
+{
     if (res == Success) {
         for (std::set<Constraint *>::const_iterator constr=redundant.begin();
              constr != redundant.end(); ++constr){
@@ -1389,10 +1509,17 @@ int System::solve_LM(SubSystem* subsys, bool isRedundantsolving)
         return Success;
 
     Eigen::VectorXd e(csize), e_new(csize); // vector of all function errors (every constraint is one function)
-    Eigen::MatrixXd J(csize, xsize);        // Jacobi of the subsystem
-    Eigen::MatrixXd A(xsize, xsize);
+    Eigen::MatrixXd J;                      // Jacobi of the subsystem
+    Eigen::MatrixXd A;
     Eigen::VectorXd x(xsize), h(xsize), x_new(xsize), g(xsize), diag_A(xsize);
 
+    // for large subsystems J^T J is mostly zero, so it is factorized as a sparse matrix
+    bool useSparse = sparseThreshold >= 0 && xsize >= sparseThreshold;
+    Eigen::SparseMatrix<double> SJ, SA, SI(xsize, xsize);
+    Eigen::SimplicialLDLT< Eigen::SparseMatrix<double> > ldltA;
+    if (useSparse)
+        SI.setIdentity();
+
     subsys->redirectParams();
 
     subsys->getParams(x);
@@ -1438,14 +1565,23 @@ int System::solve_LM(SubSystem* subsys, bool isRedundantsolving)
         }
 
         // J^T J, J^T e
-        subsys->calcJacobi(J);;
+        if (useSparse) {
+            subsys->calcJacobi(SJ);
 
-        A = J.transpose()*J;
-        g = J.transpose()*e;
+            SA = SJ.transpose()*SJ;
+            g = SJ.transpose()*e;
+            diag_A = SA.diagonal();
+        }
+        else {
+            subsys->calcJacobi(J);
+
+            A = J.transpose()*J;
+            g = J.transpose()*e;
+            diag_A = A.diagonal(); // save diagonal entries so that augmentation can be later canceled
+        }
 
         // Compute ||J^T e||_inf
         double g_inf = g.lpNorm<Eigen::Infinity>();
-        diag_A = A.diagonal(); // save diagonal entries so that augmentation can be later canceled
 
         // check for convergence
         if (g_inf <= eps1) {
@@ -1461,13 +1597,32 @@ int System::solve_LM(SubSystem* subsys, bool isRedundantsolving)
         // determine increment using adaptive damping
         int k=0;
         while (k < 50) {
-            // augment normal equations A = A+uI
-            for (int i=0; i < xsize; ++i)
-                A(i,i) += mu;
+            double rel_error;
+            if (useSparse) {
+                // augment normal equations A = A+uI
+                // The pattern of A+uI doesn't depend on u, so it is analysed once per J
+                Eigen::SparseMatrix<double> SAmu = SA + mu*SI;
+                if (k == 0)
+                    ldltA.analyzePattern(SAmu);
+
+                //solve augmented functions A*h=-g
+                ldltA.factorize(SAmu);
+                if (ldltA.info() == Eigen::Success) {
+                    h = ldltA.solve(g);
+                    rel_error = (SAmu*h - g).norm() / g.norm();
+                }
+                else
+                    rel_error = 1.;
+            }
+            else {
+                // augment normal equations A = A+uI
+                for (int i=0; i < xsize; ++i)
+                    A(i,i) += mu;
 
-            //solve augmented functions A*h=-g
-            h = A.fullPivLu().solve(g);
-            double rel_error = (A*h - g).norm() / g.norm();
+                //solve augmented functions A*h=-g
+                h = A.fullPivLu().solve(g);
+                rel_error = (A*h - g).norm() / g.norm();
+            }
 
             // check if solving works
             if (rel_error < 1e-5) {
@@ -1514,8 +1669,10 @@ int System::solve_LM(SubSystem* subsys, bool isRedundantsolving)
 
             mu*=nu;
             nu*=2.0;
-            for (int i=0; i < xsize; ++i) // restore diagonal J^T J entries
-                A(i,i) = diag_A(i);
+            if (!useSparse) {
+                for (int i=0; i < xsize; ++i) // restore diagonal J^T J entries
+                    A(i,i) = diag_A(i);
+            }
 
             k++;
         }
@@ -1583,9 +1740,15 @@ int System::solve_DL(SubSystem* subsys, bool isRedundantsolving)
 
     Eigen::VectorXd x(xsize), x_new(xsize);
     Eigen::VectorXd fx(csize), fx_new(csize);
-    Eigen::MatrixXd Jx(csize, xsize), Jx_new(csize, xsize);
+    Eigen::SparseMatrix<double> Jx(csize, xsize), Jx_new(csize, xsize);
     Eigen::VectorXd g(xsize), h_sd(xsize), h_gn(xsize), h_dl(xsize);
 
+    // for large subsystems the least norm gauss-newton step is computed with a
+    // sparse factorization of J*J^T, whatever dogLegGaussStep is set to
+#ifdef EIGEN_SPARSEQR_COMPATIBLE
+    bool useSparse = sparseThreshold >= 0 && xsize >= sparseThreshold;
+#endif
+
     subsys->redirectParams();
 
     double err;
@@ -1627,16 +1790,33 @@ int System::solve_DL(SubSystem* subsys, bool isRedundantsolving)
             // get the gauss-newton step
             // http://forum.freecadweb.org/viewtopic.php?f=10&t=12769&start=50#p106220
             // https://forum.kde.org/viewtopic.php?f=74&t=129439#p346104
-            switch (dogLegGaussStep){
-                case FullPivLU:
-                    h_gn = Jx.fullPivLu().solve(-fx);
-                    break;
-                case LeastNormFullPivLU:
-                    h_gn = Jx.adjoint()*(Jx*Jx.adjoint()).fullPivLu().solve(-fx);
-                    break;
-                case LeastNormLdlt:
-                    h_gn = Jx.adjoint()*(Jx*Jx.adjoint()).ldlt().solve(-fx);
-                    break;
+            bool hasGaussStep = false;
+#ifdef EIGEN_SPARSEQR_COMPATIBLE
+            if (useSparse) {
+                Eigen::SparseMatrix<double> JJt = Jx*Jx.adjoint();
+                Eigen::SimplicialLDLT< Eigen::SparseMatrix<double> > ldltJJt(JJt);
+                if (ldltJJt.info() == Eigen::Success) {
+                    h_gn = Jx.adjoint()*ldltJJt.solve(-fx);
+                    hasGaussStep = true;
+                }
+                // J*J^T is singular for redundant constraints, use the dense solvers then
+                if (hasGaussStep && !h_gn.allFinite())
+                    hasGaussStep = false;
+            }
+#endif
+            if (!hasGaussStep) {
+                Eigen::MatrixXd J = Jx;
+                switch (dogLegGaussStep){
+                    case FullPivLU:
+                        h_gn = J.fullPivLu().solve(-fx);
+                        break;
+                    case LeastNormFullPivLU:
+                        h_gn = J.adjoint()*(J*J.adjoint()).fullPivLu().solve(-fx);
+                        break;
+                    case LeastNormLdlt:
+                        h_gn = J.adjoint()*(J*J.adjoint()).ldlt().solve(-fx);
+                        break;
+                }
             }
 
             double rel_error = (Jx*h_gn + fx).norm() / fx.norm();
@@ -3497,14 +3677,26 @@ int System::diagnose(Algorithm alg)
     redundant.clear();
     conflictingTags.clear();
     redundantTags.clear();
-    Eigen::MatrixXd J(clist.size(), plist.size());
+    // Only the derivatives with respect to the parameters a constraint
+    // depends on can be non-zero, so only these are evaluated
+    std::vector< Eigen::Triplet<double> > triplets;
     int count=0;
     for (std::vector<Constraint *>::iterator constr=clist.begin(); constr != clist.end(); ++constr) {
         (*constr)->revertParams();
         if ((*constr)->getTag() >= 0) {
             count++;
-            for (int j=0; j < int(plist.size()); j++)
-                J(count-1,j) = (*constr)->grad(plist[j]);
+            VEC_I cols;
+            VEC_pD &cparams = c2p[*constr];
+            for (VEC_pD::const_iterator param=cparams.begin(); param != cparams.end(); ++param) {
+                MAP_pD_I::const_iterator it = pIndex.find(*param);
+                if (it != pIndex.end())
+                    cols.push_back(it->second);
+            }
+            // a parameter may be referenced more than once by a constraint
+            std::sort(cols.begin(), cols.end());
+            cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+            for (VEC_I::const_iterator j=cols.begin(); j != cols.end(); ++j)
+                triplets.push_back(Eigen::Triplet<double>(count-1, *j, (*constr)->grad(plist[*j])));
         }
     }
 
@@ -3512,10 +3704,8 @@ int System::diagnose(Algorithm alg)
     Eigen::SparseMatrix<double> SJ;
 
     if(qrAlgorithm==EigenSparseQR){
-        // this creation is not optimized (done using triplets)
-        // however the time this takes is negligible compared to the
-        // time the QR decomposition itself takes
-        SJ = J.sparseView();
+        SJ.resize(count, plist.size());
+        SJ.setFromTriplets(triplets.begin(), triplets.end());
         SJ.makeCompressed();
     }
 
@@ -3527,6 +3717,13 @@ int System::diagnose(Algorithm alg)
     }
 #endif
 
+    Eigen::MatrixXd J;
+    if (qrAlgorithm==EigenDenseQR) {
+        J.setZero(count, plist.size());
+        for (std::vector< Eigen::Triplet<double> >::const_iterator it=triplets.begin(); it != triplets.end(); ++it)
+            J(it->row(), it->col()) = it->value();
+    }
+
 #ifdef _GCS_DEBUG
     // Debug code starts
     std::stringstream stream;
@@ -3548,8 +3745,8 @@ int System::diagnose(Algorithm alg)
     Eigen::FullPivHouseholderQR<Eigen::MatrixXd> qrJT;
 
     if(qrAlgorithm==EigenDenseQR){
-        if (J.rows() > 0) {
-            qrJT.compute(J.topRows(count).transpose());
+        if (count > 0) {
+            qrJT.compute(J.transpose());
             //Eigen::MatrixXd Q = qrJT.matrixQ ();
             
             paramsNum = qrJT.rows();
@@ -3566,8 +3763,8 @@ int System::diagnose(Algorithm alg)
     }
 #ifdef EIGEN_SPARSEQR_COMPATIBLE
     else if(qrAlgorithm==EigenSparseQR){
-        if (SJ.rows() > 0) {
-            SqrJT.compute(SJ.topRows(count).transpose());
+        if (count > 0) {
+            SqrJT.compute(SJ.transpose());
             // Do not ask for Q Matrix!!
             // At Eigen 3.2 still has a bug that this only works for square matrices
             // if enabled it will crash
@@ -3592,7 +3789,7 @@ int System::diagnose(Algorithm alg)
         std::stringstream stream;
         stream  << (qrAlgorithm==EigenSparseQR?"EigenSparseQR":(qrAlgorithm==EigenDenseQR?"DenseQR":""));
 
-        if (J.rows() > 0) {
+        if (count > 0) {
             stream
 #ifdef EIGEN_SPARSEQR_COMPATIBLE
                     << ", Threads: " << Eigen::nbThreads()
@@ -3620,7 +3817,7 @@ int System::diagnose(Algorithm alg)
         Base::Console().Log(tmp.c_str());
     }
 
-    if (J.rows() > 0) {
+    if (count > 0) {
 #ifdef _GCS_DEBUG_SOLVER_JACOBIAN_QR_DECOMPOSITION_TRIANGULAR_MATRIX
         // Debug code starts
         std::stringstream stream;
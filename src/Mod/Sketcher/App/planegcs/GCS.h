@@ -99,6 +99,9 @@ namespace GCS
         bool hasUnknowns;  // if plist is filled with the unknown parameters
         bool hasDiagnosis; // if dofs, conflictingTags, redundantTags are up to date
         bool isInit;       // if plists, clists, reductionmaps are up to date
+        bool isWarm;       // if the subsystems hold a valid solution of the current partition
+
+        int checkRedundant(int res, bool isRedundantsolving);
 
         int solve_BFGS(SubSystem *subsys, bool isFine=true, bool isRedundantsolving=false);
         int solve_LM(SubSystem *subsys, bool isRedundantsolving=false);
@@ -117,6 +120,7 @@ namespace GCS
         QRAlgorithm qrAlgorithm;
         DogLegGaussStep dogLegGaussStep;
         double qrpivotThreshold;
+        int sparseThreshold; // LM and DogLeg use sparse matrices for subsystems with at least this many parameters, -1 to disable
         DebugMode debugMode;
         double LM_eps;
         double LM_eps1;          
@@ -250,6 +254,12 @@ namespace GCS
         int solve(VEC_pD &params, bool isFine=true, Algorithm alg=DogLeg, bool isRedundantsolving=false);
         int solve(SubSystem *subsys, bool isFine=true, Algorithm alg=DogLeg, bool isRedundantsolving=false);
         int solve(SubSystem *subsysA, SubSystem *subsysB, bool isFine=true, bool isRedundantsolving=false);
+        // Solves the system repeatedly for changing values of the parameters
+        // referenced by constraints with negative tags (e.g. while dragging).
+        // The first call after initSolution solves all components, later calls
+        // only solve the components holding such constraints, starting from
+        // the last solution.
+        int solveIncremental(bool isFine=true, Algorithm alg=DogLeg);
 
         void applySolution();
         void undoSolution();
@@ -272,7 +272,36 @@ void SubSystem::calcJacobi(VEC_pD &params, Eigen::MatrixXd &jacobi)
 
 void SubSystem::calcJacobi(Eigen::MatrixXd &jacobi)
 {
-    calcJacobi(plist, jacobi);
+    // Only evaluate the derivatives with respect to the parameters each
+    // constraint depends on. The column of a parameter is its position in pvals.
+    jacobi.setZero(csize, psize);
+    for (int i=0; i < csize; i++) {
+        std::map<Constraint *,VEC_pD >::const_iterator it = c2p.find(clist[i]);
+        if (it == c2p.end())
+            continue;
+        for (VEC_pD::const_iterator param=it->second.begin();
+             param != it->second.end(); ++param)
+            jacobi(i, int(*param - &pvals[0])) = clist[i]->grad(*param);
+    }
+}
+
+void SubSystem::calcJacobi(Eigen::SparseMatrix<double> &jacobi)
+{
+    // The pattern only depends on c2p. Zero derivatives are stored as well,
+    // so that the pattern stays the same from one iteration to the next.
+    std::vector< Eigen::Triplet<double> > triplets;
+    for (int i=0; i < csize; i++) {
+        std::map<Constraint *,VEC_pD >::const_iterator it = c2p.find(clist[i]);
+        if (it == c2p.end())
+            continue;
+        for (VEC_pD::const_iterator param=it->second.begin();
+             param != it->second.end(); ++param)
+            triplets.push_back(Eigen::Triplet<double>(i, int(*param - &pvals[0]),
+                                                      clist[i]->grad(*param)));
+    }
+
+    jacobi.resize(csize, psize);
+    jacobi.setFromTriplets(triplets.begin(), triplets.end());
 }
 
 void SubSystem::calcGrad(VEC_pD &params, Eigen::VectorXd &grad)
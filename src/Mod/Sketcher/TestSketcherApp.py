@@ -82,6 +82,61 @@ def CreateSlotPlateInnerSet(SketchFeature):
 	SketchFeature.addConstraint(Sketcher.Constraint('Coincident',7,2,8,1)) 
 	SketchFeature.addConstraint(Sketcher.Constraint('Coincident',8,2,5,1))
 	
+def CreateRectanglePatternSet(SketchFeature, count):
+	# a row of rectangles, each one chained to the previous one, so that
+	# the solver has to handle them as one system
+	geometry = []
+	constraints = []
+	for i in range(count):
+		x = i * 20.0
+		g = 4 * i
+		geometry.append(Part.LineSegment(App.Vector(x,0,0),App.Vector(x+10.5,0.3,0)))
+		geometry.append(Part.LineSegment(App.Vector(x+10.5,0.3,0),App.Vector(x+10,7.2,0)))
+		geometry.append(Part.LineSegment(App.Vector(x+10,7.2,0),App.Vector(x-0.4,7,0)))
+		geometry.append(Part.LineSegment(App.Vector(x-0.4,7,0),App.Vector(x,0,0)))
+		constraints.append(Sketcher.Constraint('Coincident',g,2,g+1,1))
+		constraints.append(Sketcher.Constraint('Coincident',g+1,2,g+2,1))
+		constraints.append(Sketcher.Constraint('Coincident',g+2,2,g+3,1))
+		constraints.append(Sketcher.Constraint('Coincident',g+3,2,g,1))
+		constraints.append(Sketcher.Constraint('Horizontal',g))
+		constraints.append(Sketcher.Constraint('Horizontal',g+2))
+		constraints.append(Sketcher.Constraint('Vertical',g+1))
+		constraints.append(Sketcher.Constraint('Vertical',g+3))
+		constraints.append(Sketcher.Constraint('Distance',g,10.0+i%3))
+		constraints.append(Sketcher.Constraint('Distance',g+1,7.0))
+		if i > 0:
+			constraints.append(Sketcher.Constraint('DistanceX',g-4,2,g,1,10.0))
+			constraints.append(Sketcher.Constraint('DistanceY',g-4,2,g,1,0.0))
+	SketchFeature.addGeometry(geometry,False)
+	SketchFeature.addConstraint(constraints)
+
+def CreateIndependentRectanglesSet(SketchFeature, count):
+	# rectangles that share no geometry, each one fully constrained on its own,
+	# so that the solver handles every rectangle as a separate component
+	geometry = []
+	constraints = []
+	for i in range(count):
+		x = i * 20.0
+		g = 4 * i
+		geometry.append(Part.LineSegment(App.Vector(x+0.2,0.1,0),App.Vector(x+10.5,0.3,0)))
+		geometry.append(Part.LineSegment(App.Vector(x+10.5,0.3,0),App.Vector(x+10,7.2,0)))
+		geometry.append(Part.LineSegment(App.Vector(x+10,7.2,0),App.Vector(x-0.4,7,0)))
+		geometry.append(Part.LineSegment(App.Vector(x-0.4,7,0),App.Vector(x+0.2,0.1,0)))
+		constraints.append(Sketcher.Constraint('Coincident',g,2,g+1,1))
+		constraints.append(Sketcher.Constraint('Coincident',g+1,2,g+2,1))
+		constraints.append(Sketcher.Constraint('Coincident',g+2,2,g+3,1))
+		constraints.append(Sketcher.Constraint('Coincident',g+3,2,g,1))
+		constraints.append(Sketcher.Constraint('Horizontal',g))
+		constraints.append(Sketcher.Constraint('Horizontal',g+2))
+		constraints.append(Sketcher.Constraint('Vertical',g+1))
+		constraints.append(Sketcher.Constraint('Vertical',g+3))
+		constraints.append(Sketcher.Constraint('Distance',g,10.0))
+		constraints.append(Sketcher.Constraint('Distance',g+1,7.0))
+		constraints.append(Sketcher.Constraint('DistanceX',g,1,x))
+		constraints.append(Sketcher.Constraint('DistanceY',g,1,0.0))
+	SketchFeature.addGeometry(geometry,False)
+	SketchFeature.addConstraint(constraints)
+
 
 
 #---------------------------------------------------------------------------
@@ -113,9 +168,83 @@ class SketcherSolverTestCases(unittest.TestCase):
 		CreateSlotPlateInnerSet(self.Slot)
 		self.Doc.recompute()
 		self.failUnless(len(self.Slot.Shape.Edges) == 9)
-	
-	
+
+	def checkRectangles(self, sketch, count, widths):
+		# each rectangle sits at its own place with the given or default width
+		for i in range(count):
+			bottom = sketch.Geometry[4*i]
+			side = sketch.Geometry[4*i+1]
+			width = widths.get(i, 10.0)
+			self.failUnless((bottom.StartPoint - App.Vector(i*20.0,0,0)).Length < 1e-7)
+			self.failUnless((bottom.EndPoint - App.Vector(i*20.0+width,0,0)).Length < 1e-7)
+			self.failUnless((side.EndPoint - App.Vector(i*20.0+width,7.0,0)).Length < 1e-7)
+
+	def testIndependentComponents(self):
+		count = 12
+		sketch = self.Doc.addObject('Sketcher::SketchObject','SketchRectangles')
+		CreateIndependentRectanglesSet(sketch, count)
+		self.failUnless(sketch.solve() == 0)
+		self.checkRectangles(sketch, count, {})
+		# solving again without changes keeps every component as it is
+		self.failUnless(sketch.solve() == 0)
+		self.checkRectangles(sketch, count, {})
+		# changing the width of one rectangle only moves that component
+		sketch.setDatum(12*5+8, 14.0)
+		self.failUnless(sketch.solve() == 0)
+		self.checkRectangles(sketch, count, {5: 14.0})
+		sketch.setDatum(12*0+8, 6.0)
+		sketch.setDatum(12*11+8, 3.0)
+		self.failUnless(sketch.solve() == 0)
+		self.checkRectangles(sketch, count, {0: 6.0, 5: 14.0, 11: 3.0})
+		self.Doc.recompute()
+		self.failUnless(len(sketch.Shape.Edges) == 4*count)
+
+	def checkFixedRectangles(self, sketch, indices):
+		for i in indices:
+			self.failUnless((sketch.Geometry[4*i].StartPoint - App.Vector(i*20.0,0,0)).Length < 1e-7)
+			self.failUnless((sketch.Geometry[4*i+1].EndPoint - App.Vector(i*20.0+10.0,7.0,0)).Length < 1e-7)
+
+	def testDragComponent(self):
+		count = 3
+		sketch = self.Doc.addObject('Sketcher::SketchObject','SketchDrag')
+		CreateIndependentRectanglesSet(sketch, count)
+		# free the position of the middle rectangle so that it can be dragged
+		sketch.delConstraint(12*1+11)
+		sketch.delConstraint(12*1+10)
+		self.failUnless(sketch.solve() == 0)
+		# drag its corner in several steps, every step re-solves the dragged component only
+		for step in range(1, 6):
+			target = App.Vector(20.0 + 1.5*step, 0.8*step, 0)
+			sketch.movePoint(4, 1, target)
+			bottom = sketch.Geometry[4]
+			side = sketch.Geometry[5]
+			self.failUnless((bottom.StartPoint - target).Length < 1e-6)
+			self.failUnless((bottom.EndPoint - target - App.Vector(10.0,0,0)).Length < 1e-6)
+			self.failUnless((side.EndPoint - target - App.Vector(10.0,7.0,0)).Length < 1e-6)
+			# the other components keep their solution
+			self.checkFixedRectangles(sketch, (0, 2))
+		# a full solve afterwards agrees with the result of the drag
+		self.failUnless(sketch.solve() == 0)
+		self.failUnless((sketch.Geometry[4].StartPoint - target).Length < 1e-6)
+		self.checkFixedRectangles(sketch, (0, 2))
+
 	def tearDown(self):
 		#closing doc
 		FreeCAD.closeDocument("SketchSolverTest")
 		#print ("omit close document for debuging")
+
+class SketcherSolverPatternCases(unittest.TestCase):
+	def setUp(self):
+		self.Doc = FreeCAD.newDocument("SketchSolverPattern")
+
+	def testRectanglePattern(self):
+		# solves generated sketches of growing size with the sparse Jacobian
+		for count in [10, 40, 160]:
+			sketch = self.Doc.addObject('Sketcher::SketchObject','Pattern%d' % count)
+			CreateRectanglePatternSet(sketch, count)
+			self.failUnless(sketch.solve() == 0)
+			line = sketch.Geometry[4*count-3]
+			self.failUnless(abs(abs(line.EndPoint.y - line.StartPoint.y) - 7.0) < 1e-7)
+
+	def tearDown(self):
+		FreeCAD.closeDocument("SketchSolverPattern")
@@ -30,6 +30,7 @@
 #include <boost/assign.hpp>
 #include <boost/bind.hpp>
 #include <boost/regex.hpp>
+#include <deque>
 #include <App/Document.h>
 #include <App/DocumentObject.h>
 #include <App/Property.h>
@@ -103,6 +104,8 @@ void PropertySheet::clear()
 
     propertyNameToCellMap.clear();
     documentObjectToCellMap.clear();
+    cellToDependantCellsMap.clear();
+    cellToDependencyCellsMap.clear();
     docDeps.clear();
     aliasProp.clear();
     revAliasProp.clear();
@@ -215,6 +218,8 @@ PropertySheet::PropertySheet(const PropertySheet &other)
     , cellToPropertyNameMap(other.cellToPropertyNameMap)
     , documentObjectToCellMap(other.documentObjectToCellMap)
     , cellToDocumentObjectMap(other.cellToDocumentObjectMap)
+    , cellToDependantCellsMap(other.cellToDependantCellsMap)
+    , cellToDependencyCellsMap(other.cellToDependencyCellsMap)
     , docDeps(other.docDeps)
     , documentObjectName(other.documentObjectName)
     , documentName(other.documentName)
@@ -897,6 +902,31 @@ bool PropertySheet::isHidden(CellAddress address) const
     return i != mergedCells.end() && i->second != address;
 }
 
+/**
+  * Decode \a name into \a address if it is a valid cell address. Unlike
+  * stringToAddress() this does not throw for other property names.
+  *
+  * @returns True if \a name is a cell address.
+  */
+
+static bool nameToAddress(const std::string &name, CellAddress &address)
+{
+    static const boost::regex e("\\${0,1}([A-Z]{1,2})\\${0,1}([0-9]{1,5})");
+    boost::cmatch cm;
+
+    if (!boost::regex_match(name.c_str(), cm, e))
+        return false;
+
+    int row = App::validRow(cm[2].str());
+    int col = App::validColumn(cm[1].str());
+
+    if (row < 0 || col < 0)
+        return false;
+
+    address = CellAddress(row, col);
+    return true;
+}
+
 /**
   * Update dependencies of \a expression for cell at \a key.
   *
@@ -960,6 +990,19 @@ void PropertySheet::addDependencies(CellAddress key)
                 // Insert into maps
                 propertyNameToCellMap[propName].insert(key);
                 cellToPropertyNameMap[key].insert(propName);
+
+                // Insert into cell dependency graph
+                cellToDependantCellsMap[j->second].insert(key);
+                cellToDependencyCellsMap[key].insert(j->second);
+            }
+            else {
+                CellAddress address;
+
+                // Insert into cell dependency graph, unless it is some other property of the sheet
+                if (nameToAddress(i->getPropertyName(), address)) {
+                    cellToDependantCellsMap[address].insert(key);
+                    cellToDependencyCellsMap[key].insert(address);
+                }
             }
         }
 
@@ -1021,6 +1064,29 @@ void PropertySheet::removeDependencies(CellAddress key)
 
         cellToDocumentObjectMap.erase(i2);
     }
+
+    /* Remove from cell dependency graph */
+
+    std::map<CellAddress, std::set< CellAddress > >::iterator i3 = cellToDependencyCellsMap.find(key);
+
+    if (i3 != cellToDependencyCellsMap.end()) {
+        std::set< CellAddress >::const_iterator j = i3->second.begin();
+
+        while (j != i3->second.end()) {
+            std::map<CellAddress, std::set< CellAddress > >::iterator k = cellToDependantCellsMap.find(*j);
+
+            if (k != cellToDependantCellsMap.end()) {
+                k->second.erase(key);
+
+                if (k->second.size() == 0)
+                    cellToDependantCellsMap.erase(k);
+            }
+
+            ++j;
+        }
+
+        cellToDependencyCellsMap.erase(i3);
+    }
 }
 
 /**
@@ -1195,6 +1261,81 @@ const std::set<std::string> &PropertySheet::getDeps(CellAddress pos) const
         return empty;
 }
 
+/**
+  * Compute the order in which \a cells and all cells depending on them have to
+  * be recomputed, using the cell dependency graph. Each cell appears once in
+  * \a order, after the cells it depends on. Cells that are part of a circular
+  * dependency, or depend on one, are returned in \a cyclic instead.
+  *
+  * @param cells  Cells that have changed
+  * @param order  Evaluation order
+  * @param cyclic Cells that can not be evaluated
+  */
+
+void PropertySheet::getEvaluationOrder(const std::set<CellAddress> &cells, std::vector<CellAddress> &order, std::set<CellAddress> &cyclic) const
+{
+    std::set<CellAddress> affected(cells);
+    std::deque<CellAddress> queue(cells.begin(), cells.end());
+
+    /* Collect all cells that depend directly or indirectly on the given cells */
+    while (queue.size() > 0) {
+        std::map<CellAddress, std::set< CellAddress > >::const_iterator i = cellToDependantCellsMap.find(queue.front());
+
+        queue.pop_front();
+        if (i == cellToDependantCellsMap.end())
+            continue;
+
+        for (std::set<CellAddress>::const_iterator j = i->second.begin(); j != i->second.end(); ++j) {
+            if (affected.insert(*j).second)
+                queue.push_back(*j);
+        }
+    }
+
+    /* Count the affected cells each affected cell depends on */
+    std::map<CellAddress, int> pending;
+
+    for (std::set<CellAddress>::const_iterator i = affected.begin(); i != affected.end(); ++i) {
+        std::map<CellAddress, std::set< CellAddress > >::const_iterator j = cellToDependencyCellsMap.find(*i);
+        int count = 0;
+
+        if (j != cellToDependencyCellsMap.end()) {
+            for (std::set<CellAddress>::const_iterator k = j->second.begin(); k != j->second.end(); ++k) {
+                if (affected.find(*k) != affected.end())
+                    ++count;
+            }
+        }
+
+        pending[*i] = count;
+        if (count == 0)
+            queue.push_back(*i);
+    }
+
+    /* Sort topologically; a cell is ready when all its dependencies are done */
+    order.clear();
+    order.reserve(affected.size());
+    while (queue.size() > 0) {
+        CellAddress address = queue.front();
+        std::map<CellAddress, std::set< CellAddress > >::const_iterator i = cellToDependantCellsMap.find(address);
+
+        queue.pop_front();
+        order.push_back(address);
+        if (i == cellToDependantCellsMap.end())
+            continue;
+
+        for (std::set<CellAddress>::const_iterator j = i->second.begin(); j != i->second.end(); ++j) {
+            if (--pending[*j] == 0)
+                queue.push_back(*j);
+        }
+    }
+
+    /* Whatever is left is stuck on a cycle */
+    cyclic.clear();
+    for (std::map<CellAddress, int>::const_iterator i = pending.begin(); i != pending.end(); ++i) {
+        if (i->second > 0)
+            cyclic.insert(i->first);
+    }
+}
+
 void PropertySheet::recomputeDependencies(CellAddress key)
 {
     AtomicPropertyChange signaller(*this);
@@ -131,6 +131,8 @@ public:
 
     void recomputeDependencies(App::CellAddress key);
 
+    void getEvaluationOrder(const std::set<App::CellAddress> & cells, std::vector<App::CellAddress> & order, std::set<App::CellAddress> & cyclic) const;
+
     PyObject *getPyObject(void);
 
     void resolveAll();
@@ -213,6 +215,14 @@ private:
     /*! DocumentObject this cell depends on */
     std::map<App::CellAddress, std::set< std::string > > cellToDocumentObjectMap;
 
+    /*! Cell dependency graph, i.e when the cell given in key changes,
+      the set of cells in this sheet that needs to be recomputed.
+      */
+    std::map<App::CellAddress, std::set< App::CellAddress > > cellToDependantCellsMap;
+
+    /*! Cells in this sheet the cell given in key depends on */
+    std::map<App::CellAddress, std::set< App::CellAddress > > cellToDependencyCellsMap;
+
     /*! Other document objects the sheet depends on */
     std::set<App::DocumentObject*> docDeps;
 
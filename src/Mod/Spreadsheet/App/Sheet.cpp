@@ -29,7 +29,6 @@
 #include <boost/range/adaptor/map.hpp>
 #include <boost/range/algorithm/copy.hpp>
 #include <boost/assign.hpp>
-#include <boost/graph/topological_sort.hpp>
 #include <App/Application.h>
 #include <App/Document.h>
 #include <App/DynamicProperty.h>
@@ -57,19 +56,6 @@ using namespace Spreadsheet;
 
 PROPERTY_SOURCE(Spreadsheet::Sheet, App::DocumentObject)
 
-typedef boost::adjacency_list <
-boost::vecS,           // class OutEdgeListS  : a Sequence or an AssociativeContainer
-boost::vecS,           // class VertexListS   : a Sequence or a RandomAccessContainer
-boost::directedS,      // class DirectedS     : This is a directed graph
-boost::no_property,    // class VertexProperty:
-boost::no_property,    // class EdgeProperty:
-boost::no_property,    // class GraphProperty:
-boost::listS           // class EdgeListS:
-> DependencyList;
-typedef boost::graph_traits<DependencyList> Traits;
-typedef Traits::vertex_descriptor Vertex;
-typedef Traits::edge_descriptor Edge;
-
 /**
   * Construct a new Sheet object.
   */
@@ -614,33 +600,30 @@ void Sheet::updateProperty(CellAddress key)
     Cell * cell = getCell(key);
 
     if (cell != 0) {
-        Expression * output;
+        ExpressionValue output;
         const Expression * input = cell->getExpression();
 
         if (input) {
-            output = input->eval();
+            output = input->evaluate();
         }
         else {
             std::string s;
 
             if (cell->getStringContent(s))
-                output = new StringExpression(this, s);
+                output = ExpressionValue(s);
             else
-                output = new StringExpression(this, "");
+                output = ExpressionValue(std::string());
         }
 
-        /* Eval returns either NumberExpression or StringExpression objects */
-        if (freecad_dynamic_cast<NumberExpression>(output)) {
-            NumberExpression * number = static_cast<NumberExpression*>(output);
-            if (number->getUnit().isEmpty())
-                setFloatProperty(key, number->getValue());
+        /* Evaluation returns either a number or a string */
+        if (output.isNumber()) {
+            if (output.getUnit().isEmpty())
+                setFloatProperty(key, output.getValue());
             else
-                setQuantityProperty(key, number->getValue(), number->getUnit());
+                setQuantityProperty(key, output.getValue(), output.getUnit());
         }
         else
-            setStringProperty(key, freecad_dynamic_cast<StringExpression>(output)->getText().c_str());
-
-        delete output;
+            setStringProperty(key, output.getText().c_str());
     }
     else
         clear(key);
@@ -740,78 +723,27 @@ DocumentObjectExecReturn *Sheet::execute(void)
          dirtyCells.insert(*i);
     }
 
-    // Push dirty cells onto queue
-    for (std::set<CellAddress>::const_iterator i = dirtyCells.begin(); i != dirtyCells.end(); ++i) {
-        // Create queue and a graph structure to compute order of evaluation
-        std::deque<CellAddress> workQueue;
-        DependencyList graph;
-        std::map<CellAddress, Vertex> VertexList;
-        std::map<Vertex, CellAddress> VertexIndexList;
-
-        workQueue.push_back(*i);
-
-        while (workQueue.size() > 0) {
-            CellAddress currPos = workQueue.front();
-            std::set<CellAddress> s;
-
-            // Get other cells that depends on the current cell (currPos)
-            providesTo(currPos, s);
-            workQueue.pop_front();
-
-            // Insert into map of CellPos -> Index, if it doesn't exist already
-            if (VertexList.find(currPos) == VertexList.end()) {
-                VertexList[currPos] = add_vertex(graph);
-                VertexIndexList[VertexList[currPos]] = currPos;
-            }
-
-            // Process cells that depend on the current cell
-            std::set<CellAddress>::const_iterator i = s.begin();
-            while (i != s.end()) {
-                // Insert into map of CellPos -> Index, if it doesn't exist already
-                if (VertexList.find(*i) == VertexList.end()) {
-                    VertexList[*i] = add_vertex(graph);
-                    VertexIndexList[VertexList[*i]] = *i;
-                    workQueue.push_back(*i);
-                }
-                // Add edge to graph to signal dependency
-                add_edge(VertexList[currPos], VertexList[*i], graph);
-                ++i;
-            }
-        }
-
-        // Compute cells
-        std::list<Vertex> make_order;
-
-        // Sort graph topologically to find evaluation order
-        try {
-            boost::topological_sort(graph, std::front_inserter(make_order));
-
-            // Recompute cells
-            std::list<Vertex>::const_iterator i = make_order.begin();
-            while (i != make_order.end()) {
-                recomputeCell(VertexIndexList[*i]);
-                ++i;
-            }
-        }
-        catch (std::exception) {
-            // Cycle detected; flag all with errors
+    // Compute one evaluation order for the dirty cells and the cells depending on them
+    std::vector<CellAddress> evaluationOrder;
+    std::set<CellAddress> cyclicCells;
 
-            std::map<CellAddress, Vertex>::const_iterator i = VertexList.begin();
-            while (i != VertexList.end()) {
-                Cell * cell = cells.getValue(i->first);
+    cells.getEvaluationOrder(dirtyCells, evaluationOrder, cyclicCells);
 
-                // Mark as erronous
-                cellErrors.insert(i->first);
+    // Recompute cells
+    for (std::vector<CellAddress>::const_iterator i = evaluationOrder.begin(); i != evaluationOrder.end(); ++i)
+        recomputeCell(*i);
 
-                if (cell)
-                    cell->setException("Circular dependency.");
-                updateProperty(i->first);
-                updateAlias(i->first);
+    // Cycle detected; flag all with errors
+    for (std::set<CellAddress>::const_iterator i = cyclicCells.begin(); i != cyclicCells.end(); ++i) {
+        Cell * cell = cells.getValue(*i);
 
-                ++i;
-            }
-        }
+        // Mark as erronous
+        cellErrors.insert(*i);
 
+        if (cell)
+            cell->setException("Circular dependency.");
+        updateProperty(*i);
+        updateAlias(*i);
     }
 
     // Signal update of column widths
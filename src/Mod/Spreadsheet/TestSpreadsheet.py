@@ -557,6 +557,91 @@ class SpreadsheetCases(unittest.TestCase):
         self.assertEqual(sheet.A17, 0.5)
         self.assertEqual(sheet.A18, 0.5)
         
+    def testCompiledExpressions(self):
+        """ Expressions of the expression engine must evaluate like spreadsheet cells """
+        params = self.doc.addObject('Spreadsheet::Sheet','Params')
+        params.set('A1', '3')
+        params.setAlias('A1', 'x')
+        params.set('A2', '-2.5')
+        params.setAlias('A2', 'y')
+        params.set('A3', '0.5')
+        params.setAlias('A3', 'z')
+        expressions = [
+            'Params.x + Params.y * 2',
+            '(Params.x - 1) ^ 2 / Params.z',
+            '2 ^ 3 ^ 2 + Params.x',
+            '-(Params.x + 1) * +2',
+            'Params.x > Params.y ? Params.x * 2 : Params.y',
+            'Params.x < Params.y ? 1 + 2 : 3 * (4 + Params.z)',
+            'Params.x == 3 ? (Params.y != 0 ? -Params.y : 0) : 1 + Params.z',
+            'sin(30 * Params.z) + cos(pi / 3 * 1rad) + sqrt(Params.x + 1)',
+            'abs(Params.y) + trunc(Params.x / 2) + round(Params.z + 0.1)',
+            'pow(Params.x, 3) - mod(7, Params.x) + atan2(Params.z, 1)',
+            'exp(Params.z) * log(Params.x) + log10(100) + cosh(Params.z) - tanh(Params.y)',
+            'max(Params.x, Params.y, 1) * min(Params.z, 2 * 3) + Params.x * Params.z',
+        ]
+        # the sheet evaluates its cells on the expression tree, the expression
+        # engine of the object runs the compiled programs
+        calc = self.doc.addObject('Spreadsheet::Sheet','Calc')
+        obj = self.doc.addObject('App::FeaturePython','Compiled')
+        for i, expr in enumerate(expressions):
+            calc.set('A%d' % (i + 1), '=' + expr)
+            obj.addProperty('App::PropertyFloat', 'P%d' % i)
+            obj.setExpression('P%d' % i, expr)
+        for x, y, z in [(3, -2.5, 0.5), (2, 4, 2), (3, 0, 0.25)]:
+            params.set('A1', str(x))
+            params.set('A2', str(y))
+            params.set('A3', str(z))
+            self.doc.recompute()
+            for i, expr in enumerate(expressions):
+                self.assertAlmostEqual(getattr(obj, 'P%d' % i), calc.get('A%d' % (i + 1)), 12,
+                                       "%s differs for x=%s, y=%s, z=%s" % (expr, x, y, z))
+        # spot checks against Python
+        params.set('A1', '3')
+        params.set('A2', '-2.5')
+        params.set('A3', '0.5')
+        self.doc.recompute()
+        self.assertAlmostEqual(obj.P0, -2)
+        self.assertAlmostEqual(obj.P1, 8)
+        self.assertAlmostEqual(obj.P2, 67)
+        self.assertAlmostEqual(obj.P3, -8)
+        self.assertAlmostEqual(obj.P4, 6)
+        self.assertAlmostEqual(obj.P5, 13.5)
+        self.assertAlmostEqual(obj.P6, 2.5)
+
+    def testLargeDependencyChain(self):
+        """ Change the cell all others in a large sheet depend on """
+        sheet = self.doc.addObject('Spreadsheet::Sheet','Spreadsheet')
+        sheet.set('A1', '1')
+        for i in range(2, 501):
+            sheet.set('A%d' % i, '=A%d + 1' % (i - 1))
+            sheet.set('B%d' % i, '=A%d * 2 + A1' % i)
+        self.doc.recompute()
+        self.assertEqual(sheet.get('A500'), 500)
+        self.assertEqual(sheet.get('B500'), 1001)
+        sheet.set('A1', '10')
+        self.doc.recompute()
+        self.assertEqual(sheet.get('A500'), 509)
+        self.assertEqual(sheet.get('B500'), 1028)
+
+    def checkRootChange(self, rows):
+        """ Build a sheet of chained cells and recompute it after changing its root cell """
+        sheet = self.doc.addObject('Spreadsheet::Sheet','Chain%d' % rows)
+        sheet.set('A1', '1')
+        for i in range(2, rows + 1):
+            sheet.set('A%d' % i, '=A%d + 1' % (i - 1))
+            sheet.set('B%d' % i, '=A%d * 2 + A1' % i)
+        self.doc.recompute()
+        sheet.set('A1', '10')
+        self.doc.recompute()
+        self.assertEqual(sheet.get('A%d' % rows), rows + 9)
+        self.assertEqual(sheet.get('B%d' % rows), 2 * (rows + 9) + 10)
+
+    def testLargeDependencyChain(self):
+        """ Recompute long chains of dependent cells after a root cell change """
+        self.checkRootChange(500)
+        self.checkRootChange(2500)
+
     def testRemoveRows(self):
         """ Removing rows -- check renaming of internal cells """
         sheet = self.doc.addObject('Spreadsheet::Sheet','Spreadsheet')
@@ -86,6 +86,7 @@ DrawPage::DrawPage(void)
     }
 
     ADD_PROPERTY_TYPE(Scale, (1.0), group, App::Prop_None, "Scale factor for this Page");
+    ADD_PROPERTY_TYPE(AllowCoarseViews, (true), group, App::Prop_None, "Views with CoarseView use the fast polygonal projection. Off projects them exactly for output");
     //TODO: Page should create itself with default Template instead of Cmd figuring it out?
 }
 
@@ -129,6 +130,20 @@ void DrawPage::onChanged(const App::Property* prop)
 
       // TODO: Also update Template graphic.
 
+    } else if (prop == &AllowCoarseViews && !isRestoring()) {
+      // touch the coarse views in the Page and in its groups, they are projected differently now
+      std::vector<App::DocumentObject*> vals = Views.getValues();
+      for (std::size_t i = 0; i < vals.size(); i++) {
+          TechDraw::DrawViewCollection *collection = dynamic_cast<TechDraw::DrawViewCollection *>(vals[i]);
+          if (collection != NULL) {
+              const std::vector<App::DocumentObject*> &members = collection->Views.getValues();
+              vals.insert(vals.end(), members.begin(), members.end());
+          }
+          TechDraw::DrawViewPart *part = dynamic_cast<TechDraw::DrawViewPart *>(vals[i]);
+          if (part != NULL && part->CoarseView.getValue()) {
+              part->CoarseView.touch();
+          }
+      }
     }
     App::DocumentObject::onChanged(prop);
 }
@@ -45,6 +45,7 @@ public:
 
     App::PropertyFloat Scale;
     App::PropertyEnumeration ProjectionType; // First or Third Angle
+    App::PropertyBool AllowCoarseViews;
 
     /** @name methods overide Feature */
     //@{
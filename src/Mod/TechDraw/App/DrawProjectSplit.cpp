@@ -53,6 +53,8 @@
 #include <ShapeFix_ShapeTolerance.hxx>
 #include <ShapeExtend_WireData.hxx>
 #include <ShapeFix_Wire.hxx>
+#include <Standard.hxx>
+#include <Standard_Version.hxx>
 #include <TopoDS.hxx>
 #include <TopoDS_Shape.hxx>
 #include <TopoDS_Face.hxx>
@@ -67,6 +69,9 @@
 #include <cmath>
 #include <GeomLib_Tool.hxx>
 
+#include <QtConcurrentMap>
+#include <boost/bind.hpp>
+
 #include <App/Application.h>
 #include <Base/BoundBox.h>
 #include <Base/Console.h>
@@ -88,6 +93,110 @@
 using namespace TechDraw;
 using namespace std;
 
+namespace {
+
+//! uniform grid over the xy extent of the edge boxes. each cell lists the edges whose box overlaps it.
+class edgeBoxGrid
+{
+public:
+    edgeBoxGrid(const std::vector<Bnd_Box>& boxes);
+    const std::vector<int>& getCandidates(const gp_Pnt& pt) const;
+
+private:
+    double cellPos(double x, double minX) const { return std::floor((x - minX) / cellSize); }
+    int cellCol(double x) const { return std::min(std::max(int(cellPos(x, xMin)), 0), cols - 1); }
+    int cellRow(double y) const { return std::min(std::max(int(cellPos(y, yMin)), 0), rows - 1); }
+
+    double xMin, yMin, cellSize;
+    int cols, rows;
+    std::vector<std::vector<int> > cells;
+    std::vector<int> noCandidates;
+};
+
+edgeBoxGrid::edgeBoxGrid(const std::vector<Bnd_Box>& boxes)
+    : xMin(0.0), yMin(0.0), cellSize(1.0), cols(0), rows(0)
+{
+    Bnd_Box all;
+    int boxCount = 0;
+    for (auto& b: boxes) {
+        if (!b.IsVoid()) {
+            all.Add(b);
+            boxCount++;
+        }
+    }
+    if (all.IsVoid()) {
+        return;
+    }
+
+    //about one edge per cell for edges spread evenly over the view
+    double xMax, yMax, zMin, zMax;
+    all.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+    int side = std::max(1, int(std::sqrt(double(boxCount))));
+    cellSize = std::max(std::max(xMax - xMin, yMax - yMin) / side, Precision::Confusion());
+    cols = int(cellPos(xMax, xMin)) + 1;
+    rows = int(cellPos(yMax, yMin)) + 1;
+    cells.resize(cols * rows);
+
+    for (int i = 0; i < int(boxes.size()); i++) {
+        if (boxes[i].IsVoid()) {
+            continue;
+        }
+        double x0, y0, z0, x1, y1, z1;
+        boxes[i].Get(x0, y0, z0, x1, y1, z1);
+        for (int r = cellRow(y0); r <= cellRow(y1); r++) {
+            for (int c = cellCol(x0); c <= cellCol(x1); c++) {
+                cells[r * cols + c].push_back(i);
+            }
+        }
+    }
+}
+
+//! edges whose box may contain pt, in ascending order
+const std::vector<int>& edgeBoxGrid::getCandidates(const gp_Pnt& pt) const
+{
+    double c = cellPos(pt.X(), xMin);
+    double r = cellPos(pt.Y(), yMin);
+    if (c < 0.0 || r < 0.0 || c >= cols || r >= rows) {
+        return noCandidates;
+    }
+    return cells[int(r) * cols + int(c)];
+}
+
+//! the split points that the end vertices of one edge make on the other edges
+struct edgeSplitJob
+{
+    int iOuter;
+    std::vector<splitPoint> splits;
+};
+
+void findEdgeSplits(edgeSplitJob& job,
+                    const std::vector<TopoDS_Edge>& edges,
+                    const std::vector<Bnd_Box>& boxes,
+                    const edgeBoxGrid& grid)
+{
+    const TopoDS_Edge& outer = edges[job.iOuter];
+    TopoDS_Vertex ends[2] = { TopExp::FirstVertex(outer), TopExp::LastVertex(outer) };
+    for (auto& v: ends) {
+        gp_Pnt pnt = BRep_Tool::Pnt(v);
+        for (int iInner: grid.getCandidates(pnt)) {
+            if ((iInner == job.iOuter) ||
+                boxes[iInner].IsOut(pnt)) {
+                continue;
+            }
+            double param = -1;
+            if (DrawProjectSplit::isOnEdge(edges[iInner],v,param,false)) {
+                splitPoint s;
+                s.i = iInner;
+                s.v = Base::Vector3d(pnt.X(),pnt.Y(),pnt.Z());
+                s.param = param;
+                job.splits.push_back(s);
+            }
+        }
+    }
+}
+
+}
+
 
 //===========================================================================
 // DrawProjectSplit
@@ -164,63 +273,7 @@ std::vector<TopoDS_Edge> DrawProjectSplit::getEdges(TechDrawGeometry::GeometryOb
 
     //HLR algo does not provide all edge intersections for edge endpoints.
     //need to split long edges touched by Vertex of another edge
-    std::vector<splitPoint> splits;
-    std::vector<TopoDS_Edge>::iterator itOuter = origEdges.begin();
-    int iOuter = 0;
-    for (; itOuter != origEdges.end(); ++itOuter, iOuter++) {
-        TopoDS_Vertex v1 = TopExp::FirstVertex((*itOuter));
-        TopoDS_Vertex v2 = TopExp::LastVertex((*itOuter));
-        Bnd_Box sOuter;
-        BRepBndLib::Add(*itOuter, sOuter);
-        sOuter.SetGap(0.1);
-        if (sOuter.IsVoid()) {
-            Base::Console().Message("DPS::Extract Faces - outer Bnd_Box is void\n");
-            continue;
-        }
-        if (DrawUtil::isZeroEdge(*itOuter)) {
-            Base::Console().Message("DPS::extractFaces - outerEdge: %d is ZeroEdge\n",iOuter);   //this is not finding ZeroEdges
-            continue;  //skip zero length edges. shouldn't happen ;)
-        }
-        int iInner = 0;
-        std::vector<TopoDS_Edge>::iterator itInner = faceEdges.begin();
-        for (; itInner != faceEdges.end(); ++itInner,iInner++) {
-            if (iInner == iOuter) {
-                continue;
-            }
-            if (DrawUtil::isZeroEdge((*itInner))) {
-                continue;  //skip zero length edges. shouldn't happen ;)
-            }
-
-            Bnd_Box sInner;
-            BRepBndLib::Add(*itInner, sInner);
-            sInner.SetGap(0.1);
-            if (sInner.IsVoid()) {
-                Base::Console().Log("INFO - DPS::Extract Faces - inner Bnd_Box is void\n");
-                continue;
-            }
-            if (sOuter.IsOut(sInner)) {      //bboxes of edges don't intersect, don't bother
-                continue;
-            }
-
-            double param = -1;
-            if (isOnEdge((*itInner),v1,param,false)) {
-                gp_Pnt pnt1 = BRep_Tool::Pnt(v1);
-                splitPoint s1;
-                s1.i = iInner;
-                s1.v = Base::Vector3d(pnt1.X(),pnt1.Y(),pnt1.Z());
-                s1.param = param;
-                splits.push_back(s1);
-            }
-            if (isOnEdge((*itInner),v2,param,false)) {
-                gp_Pnt pnt2 = BRep_Tool::Pnt(v2);
-                splitPoint s2;
-                s2.i = iInner;
-                s2.v = Base::Vector3d(pnt2.X(),pnt2.Y(),pnt2.Z());
-                s2.param = param;
-                splits.push_back(s2);
-            }
-        } //inner loop
-    }   //outer loop
+    std::vector<splitPoint> splits = findSplitPoints(faceEdges);
 
     std::vector<splitPoint> sorted = sortSplits(splits,true);
     auto last = std::unique(sorted.begin(), sorted.end(), DrawProjectSplit::splitEqual);  //duplicates to back
@@ -283,6 +336,38 @@ bool DrawProjectSplit::isOnEdge(TopoDS_Edge e, TopoDS_Vertex v, double& param, b
 }
 
 
+//! find where the end vertices of the edges touch the interior of other edges.
+//! the edges are indexed in a grid of their bounding boxes, so only the edges near a vertex get tested.
+std::vector<splitPoint> DrawProjectSplit::findSplitPoints(const std::vector<TopoDS_Edge>& edges)
+{
+    std::vector<Bnd_Box> boxes(edges.size());
+    std::vector<edgeSplitJob> jobs;
+    for (int i = 0; i < int(edges.size()); i++) {
+        BRepBndLib::Add(edges[i], boxes[i]);
+        boxes[i].SetGap(0.1);
+        if (boxes[i].IsVoid()) {
+            Base::Console().Log("INFO - DPS::findSplitPoints - Bnd_Box is void for edge %d\n",i);
+            continue;
+        }
+        edgeSplitJob job;
+        job.iOuter = i;
+        jobs.push_back(job);
+    }
+
+    edgeBoxGrid grid(boxes);
+#if OCC_VERSION_HEX < 0x070000
+    Standard::SetReentrant(Standard_True);
+#endif
+    QtConcurrent::blockingMap(jobs, boost::bind(&findEdgeSplits, _1,
+                                                boost::cref(edges), boost::cref(boxes), boost::cref(grid)));
+
+    std::vector<splitPoint> result;
+    for (auto& job: jobs) {
+        result.insert(result.end(), job.splits.begin(), job.splits.end());
+    }
+    return result;
+}
+
 std::vector<TopoDS_Edge> DrawProjectSplit::splitEdges(std::vector<TopoDS_Edge> edges, std::vector<splitPoint> splits)
 {
     std::vector<TopoDS_Edge> result;
@@ -69,6 +69,7 @@
 #include <GeomLib_Tool.hxx>
 
 #include <App/Application.h>
+#include <App/Document.h>
 #include <Base/BoundBox.h>
 #include <Base/Console.h>
 #include <Base/Exception.h>
@@ -78,6 +79,8 @@
 
 #include "DrawUtil.h"
 #include "DrawViewSection.h"
+#include "DrawViewDetail.h"
+#include "DrawPage.h"
 #include "Geometry.h"
 #include "GeometryObject.h"
 #include "DrawViewPart.h"
@@ -107,6 +110,7 @@ DrawViewPart::DrawViewPart(void) : geometryObject(0)
     //properties that affect Geometry
     ADD_PROPERTY_TYPE(Source ,(0),group,App::Prop_None,"3D Shape to view");
     ADD_PROPERTY_TYPE(Direction ,(0,0,1.0)    ,group,App::Prop_None,"Projection direction. The direction you are looking from.");
+    ADD_PROPERTY_TYPE(CoarseView ,(false),group,App::Prop_None,"Fast polygonal projection for drafts on/off");
 
     //properties that affect Appearance
     //visible outline
@@ -166,12 +170,7 @@ App::DocumentObjectExecReturn *DrawViewPart::execute(void)
                                                  Direction.getValue());
     shapeCentroid = Base::Vector3d(inputCenter.X(),inputCenter.Y(),inputCenter.Z());
 
-    TopoDS_Shape mirroredShape;
-    mirroredShape = TechDrawGeometry::mirrorShape(shape,
-                                                  inputCenter,
-                                                  Scale.getValue());
-
-     geometryObject =  buildGeometryObject(mirroredShape,inputCenter);
+     geometryObject =  buildSourceGeometryObject(shape,inputCenter);
 
 #if MOD_TECHDRAW_HANDLE_FACES
     if (handleFaces()) {
@@ -195,6 +194,7 @@ short DrawViewPart::mustExecute() const
     if (!isRestoring()) {
         result  =  (Direction.isTouched()  ||
                     Source.isTouched()  ||
+                    CoarseView.isTouched()  ||
                     Scale.isTouched() ||
                     ScaleType.isTouched());
     }
@@ -218,6 +218,7 @@ TechDrawGeometry::GeometryObject* DrawViewPart::buildGeometryObject(TopoDS_Shape
 {
     TechDrawGeometry::GeometryObject* go = new TechDrawGeometry::GeometryObject(getNameInDocument());
     go->setIsoCount(IsoCount.getValue());
+    go->setCoarse(isCoarse());
 
     Base::Vector3d baseProjDir = Direction.getValue();
     saveParamSpace(baseProjDir);
@@ -225,6 +226,80 @@ TechDrawGeometry::GeometryObject* DrawViewPart::buildGeometryObject(TopoDS_Shape
     go->projectShape(shape,
                      inputCenter,
                      Direction.getValue());
+    extractGeometry(go);
+    return go;
+}
+
+//! project the unscaled source shape. the HLR result is shared with earlier projections of the same
+//! shape and direction, so changes of scale or position don't run the hidden line removal again.
+TechDrawGeometry::GeometryObject* DrawViewPart::buildSourceGeometryObject(TopoDS_Shape source, gp_Pnt& inputCenter)
+{
+    TechDrawGeometry::GeometryObject* go = new TechDrawGeometry::GeometryObject(getNameInDocument());
+    go->setIsoCount(IsoCount.getValue());
+    go->setCoarse(isCoarse());
+
+    Base::Vector3d baseProjDir = Direction.getValue();
+    saveParamSpace(baseProjDir);
+
+    prefetchProjections();
+    go->projectSource(source,
+                      inputCenter,
+                      Direction.getValue(),
+                      Scale.getValue());
+    extractGeometry(go);
+    return go;
+}
+
+//! project the views that wait for the same recompute as this one in parallel.
+//! they find their projections in the cache when they are executed.
+void DrawViewPart::prefetchProjections()
+{
+    App::Document* doc = getDocument();
+    if (!doc || doc->testStatus(App::Document::ParallelRecompute)) {
+        return;                                   //the document runs the views in parallel already
+    }
+
+    std::vector<TechDrawGeometry::projectionKey> keys;
+    std::vector<App::DocumentObject*> views = doc->getObjectsOfType(DrawViewPart::getClassTypeId());
+    for (auto& obj: views) {
+        if ((obj != this) && !obj->isTouched()) {
+            continue;
+        }
+        if (obj->getTypeId().isDerivedFrom(DrawViewSection::getClassTypeId()) ||
+            obj->getTypeId().isDerivedFrom(DrawViewDetail::getClassTypeId())) {
+            continue;                             //these project their own cut shapes
+        }
+        DrawViewPart* view = static_cast<DrawViewPart*>(obj);
+        App::DocumentObject* link = view->Source.getValue();
+        if (!link || !link->getTypeId().isDerivedFrom(Part::Feature::getClassTypeId())) {
+            continue;
+        }
+        TechDrawGeometry::projectionKey key;
+        key.source = static_cast<Part::Feature*>(link)->Shape.getShape().getShape();
+        key.direction = view->Direction.getValue();
+        key.isoCount = view->IsoCount.getValue();
+        key.coarse = view->isCoarse();
+        if (!key.source.IsNull()) {
+            keys.push_back(key);
+        }
+    }
+    TechDrawGeometry::GeometryObject::prefetchProjections(keys);
+}
+
+//! true if the view is projected with the polygonal hidden line remover. a page can switch
+//! its coarse views back to exact projection for output.
+bool DrawViewPart::isCoarse() const
+{
+    if (!CoarseView.getValue()) {
+        return false;
+    }
+    TechDraw::DrawPage* page = findParentPage();
+    return !page || page->AllowCoarseViews.getValue();
+}
+
+//! add the edge classes this view shows to the geometry object
+void DrawViewPart::extractGeometry(TechDrawGeometry::GeometryObject* go)
+{
     go->extractGeometry(TechDrawGeometry::ecHARD,                   //always show the hard&outline visible lines
                         true);
     go->extractGeometry(TechDrawGeometry::ecOUTLINE,
@@ -260,7 +335,6 @@ TechDrawGeometry::GeometryObject* DrawViewPart::buildGeometryObject(TopoDS_Shape
                             false);
     }
     bbox = go->calcBoundingBox();
-    return go;
 }
 
 //! make faces from the existing edge geometry
@@ -290,63 +364,7 @@ void DrawViewPart::extractFaces()
 
     //HLR algo does not provide all edge intersections for edge endpoints.
     //need to split long edges touched by Vertex of another edge
-    std::vector<splitPoint> splits;
-    std::vector<TopoDS_Edge>::iterator itOuter = origEdges.begin();
-    int iOuter = 0;
-    for (; itOuter != origEdges.end(); ++itOuter, iOuter++) {
-        TopoDS_Vertex v1 = TopExp::FirstVertex((*itOuter));
-        TopoDS_Vertex v2 = TopExp::LastVertex((*itOuter));
-        Bnd_Box sOuter;
-        BRepBndLib::Add(*itOuter, sOuter);
-        sOuter.SetGap(0.1);
-        if (sOuter.IsVoid()) {
-            Base::Console().Message("DVP::Extract Faces - outer Bnd_Box is void for %s\n",getNameInDocument());
-            continue;
-        }
-        if (DrawUtil::isZeroEdge(*itOuter)) {
-            Base::Console().Message("DVP::extractFaces - outerEdge: %d is ZeroEdge\n",iOuter);   //this is not finding ZeroEdges
-            continue;  //skip zero length edges. shouldn't happen ;)
-        }
-        int iInner = 0;
-        std::vector<TopoDS_Edge>::iterator itInner = faceEdges.begin();
-        for (; itInner != faceEdges.end(); ++itInner,iInner++) {
-            if (iInner == iOuter) {
-                continue;
-            }
-            if (DrawUtil::isZeroEdge((*itInner))) {
-                continue;  //skip zero length edges. shouldn't happen ;)
-            }
-
-            Bnd_Box sInner;
-            BRepBndLib::Add(*itInner, sInner);
-            sInner.SetGap(0.1);
-            if (sInner.IsVoid()) {
-                Base::Console().Log("INFO - DVP::Extract Faces - inner Bnd_Box is void for %s\n",getNameInDocument());
-                continue;
-            }
-            if (sOuter.IsOut(sInner)) {      //bboxes of edges don't intersect, don't bother
-                continue;
-            }
-
-            double param = -1;
-            if (DrawProjectSplit::isOnEdge((*itInner),v1,param,false)) {
-                gp_Pnt pnt1 = BRep_Tool::Pnt(v1);
-                splitPoint s1;
-                s1.i = iInner;
-                s1.v = Base::Vector3d(pnt1.X(),pnt1.Y(),pnt1.Z());
-                s1.param = param;
-                splits.push_back(s1);
-            }
-            if (DrawProjectSplit::isOnEdge((*itInner),v2,param,false)) {
-                gp_Pnt pnt2 = BRep_Tool::Pnt(v2);
-                splitPoint s2;
-                s2.i = iInner;
-                s2.v = Base::Vector3d(pnt2.X(),pnt2.Y(),pnt2.Z());
-                s2.param = param;
-                splits.push_back(s2);
-            }
-        } //inner loop
-    }   //outer loop
+    std::vector<splitPoint> splits = DrawProjectSplit::findSplitPoints(faceEdges);
 
     std::vector<splitPoint> sorted = DrawProjectSplit::sortSplits(splits,true);
     auto last = std::unique(sorted.begin(), sorted.end(), DrawProjectSplit::splitEqual);  //duplicates to back
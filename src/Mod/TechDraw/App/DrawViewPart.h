@@ -79,6 +79,7 @@ public:
     //App::PropertyBool   OutlinesHidden;
     App::PropertyBool   IsoHidden;
     App::PropertyInteger  IsoCount;
+    App::PropertyBool   CoarseView;
 
     App::PropertyFloat  LineWidth;
     App::PropertyFloat  HiddenWidth;
@@ -139,6 +140,10 @@ protected:
 
     void onChanged(const App::Property* prop);
     TechDrawGeometry::GeometryObject*  buildGeometryObject(TopoDS_Shape shape, gp_Pnt& center);
+    TechDrawGeometry::GeometryObject*  buildSourceGeometryObject(TopoDS_Shape source, gp_Pnt& center);
+    void extractGeometry(TechDrawGeometry::GeometryObject* go);
+    void prefetchProjections();
+    bool isCoarse() const;
     void extractFaces();
 
     //Projection parameter space
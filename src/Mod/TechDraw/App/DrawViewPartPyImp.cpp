@@ -1,7 +1,11 @@
 
 #include "PreCompiled.h"
 
+#include <Mod/Part/App/TopoShape.h>
+#include <Mod/Part/App/TopoShapeEdgePy.h>
+
 #include "DrawViewPart.h"
+#include "Geometry.h"
 
 // inclusion of the generated files (generated out of DrawViewPartPy.xml)
 #include <Mod/TechDraw/App/DrawViewPartPy.h>
@@ -15,6 +19,33 @@ std::string DrawViewPartPy::representation(void) const
     return std::string("<DrawViewPart object>");
 }
 
+static PyObject* getEdges(DrawViewPart* dvp, bool visible)
+{
+    Py::List pEdgeList;
+    const std::vector<TechDrawGeometry::BaseGeom*>& geoms = dvp->getEdgeGeometry();
+    for (auto& g: geoms) {
+        if (g->visible == visible) {
+            PyObject* pEdge = new Part::TopoShapeEdgePy(new Part::TopoShape(g->occEdge));
+            pEdgeList.append(Py::asObject(pEdge));
+        }
+    }
+    return Py::new_reference_to(pEdgeList);
+}
+
+PyObject* DrawViewPartPy::getVisibleEdges(PyObject *args)
+{
+    if (!PyArg_ParseTuple(args, ""))
+        return 0;
+    return getEdges(getDrawViewPartPtr(), true);
+}
+
+PyObject* DrawViewPartPy::getHiddenEdges(PyObject *args)
+{
+    if (!PyArg_ParseTuple(args, ""))
+        return 0;
+    return getEdges(getDrawViewPartPtr(), false);
+}
+
 
 PyObject *DrawViewPartPy::getCustomAttributes(const char* /*attr*/) const
 {
@@ -28,6 +28,7 @@
 
 #include "PreCompiled.h"
 #ifndef _PreComp_
+#include <BRep_Tool.hxx>
 #include <BRepBuilderAPI_MakeWire.hxx>
 #include <BRepBndLib.hxx>
 #include <Bnd_Box.hxx>
@@ -39,10 +40,16 @@
 #include <BRepBuilderAPI_MakeFace.hxx>
 #include <GProp_GProps.hxx>
 #include <BRepGProp.hxx>
+#include <gp_Pnt.hxx>
+#include <Precision.hxx>
 
 #endif
 #include <sstream>
 #include <cmath>
+#include <algorithm>
+#include <unordered_map>
+
+#include <boost/functional/hash.hpp>
 
 #include <Base/Console.h>
 #include <Base/Exception.h>
@@ -53,6 +60,81 @@
 using namespace TechDraw;
 using namespace boost;
 
+namespace {
+
+//! spatial hash of vertex positions. the cells are Precision::Confusion() wide, so any
+//! point that DrawUtil::isSamePoint would match lies in one of the 27 cells around a point.
+class vertexHash
+{
+public:
+    void add(const gp_Pnt& pt);
+    std::vector<int> findSame(const gp_Pnt& pt) const;
+    int findFirst(const gp_Pnt& pt) const;
+
+private:
+    struct cellKey
+    {
+        long long x, y, z;
+        bool operator==(const cellKey& k) const { return x == k.x && y == k.y && z == k.z; }
+    };
+    struct cellKeyHash
+    {
+        std::size_t operator()(const cellKey& k) const
+        {
+            std::size_t seed = 0;
+            boost::hash_combine(seed, k.x);
+            boost::hash_combine(seed, k.y);
+            boost::hash_combine(seed, k.z);
+            return seed;
+        }
+    };
+    static long long cellOf(double d) { return (long long)std::floor(d / Precision::Confusion()); }
+    static cellKey keyOf(const gp_Pnt& pt) { cellKey k = {cellOf(pt.X()), cellOf(pt.Y()), cellOf(pt.Z())}; return k; }
+
+    std::vector<gp_Pnt> points;
+    std::unordered_map<cellKey, std::vector<int>, cellKeyHash> cells;
+};
+
+void vertexHash::add(const gp_Pnt& pt)
+{
+    cells[keyOf(pt)].push_back(points.size());
+    points.push_back(pt);
+}
+
+//! indices of all added points that are the same as pt, in the order they were added
+std::vector<int> vertexHash::findSame(const gp_Pnt& pt) const
+{
+    std::vector<int> result;
+    cellKey k = keyOf(pt);
+    for (long long dx = -1; dx <= 1; dx++) {
+        for (long long dy = -1; dy <= 1; dy++) {
+            for (long long dz = -1; dz <= 1; dz++) {
+                cellKey n = {k.x + dx, k.y + dy, k.z + dz};
+                auto it = cells.find(n);
+                if (it == cells.end()) {
+                    continue;
+                }
+                for (int i: it->second) {
+                    if (points[i].IsEqual(pt,Precision::Confusion())) {
+                        result.push_back(i);
+                    }
+                }
+            }
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+//! index of the first added point that is the same as pt, or -1
+int vertexHash::findFirst(const gp_Pnt& pt) const
+{
+    std::vector<int> same = findSame(pt);
+    return same.empty() ? -1 : same.front();
+}
+
+}
+
 //*******************************************************
 //* edgeVisior methods
 //*******************************************************
@@ -299,21 +381,22 @@ std::vector<TopoDS_Vertex> EdgeWalker:: makeUniqueVList(std::vector<TopoDS_Edge>
 {
     //Base::Console().Message("TRACE - EW::makeUniqueVList()\n");
     std::vector<TopoDS_Vertex> uniqueVert;
+    vertexHash uniquePnts;
     for(auto& e:edges) {
         TopoDS_Vertex v1 = TopExp::FirstVertex(e);
         TopoDS_Vertex v2 = TopExp::LastVertex(e);
-        bool addv1 = true;
-        bool addv2 = true;
-        for (auto v:uniqueVert) {
-            if (DrawUtil::isSamePoint(v,v1))
-                addv1 = false;
-            if (DrawUtil::isSamePoint(v,v2))
-                addv2 = false;
-        }
-        if (addv1)
+        gp_Pnt p1 = BRep_Tool::Pnt(v1);
+        gp_Pnt p2 = BRep_Tool::Pnt(v2);
+        bool addv1 = (uniquePnts.findFirst(p1) < 0);
+        bool addv2 = (uniquePnts.findFirst(p2) < 0);
+        if (addv1) {
             uniqueVert.push_back(v1);
-        if (addv2)
+            uniquePnts.add(p1);
+        }
+        if (addv2) {
             uniqueVert.push_back(v2);
+            uniquePnts.add(p2);
+        }
     }
     return uniqueVert;
 }
@@ -324,12 +407,16 @@ std::vector<WalkerEdge> EdgeWalker::makeWalkerEdges(std::vector<TopoDS_Edge> edg
 {
     //Base::Console().Message("TRACE - EW::makeWalkerEdges()\n");
     m_saveInEdges = edges;
+    vertexHash vertPnts;
+    for (auto& v: verts) {
+        vertPnts.add(BRep_Tool::Pnt(v));
+    }
     std::vector<WalkerEdge> walkerEdges;
     for (auto e:edges) {
         TopoDS_Vertex ev1 = TopExp::FirstVertex(e);
         TopoDS_Vertex ev2 = TopExp::LastVertex(e);
-        int v1dx = findUniqueVert(ev1, verts);
-        int v2dx = findUniqueVert(ev2, verts);
+        int v1dx = std::max(vertPnts.findFirst(BRep_Tool::Pnt(ev1)), 0);     //same as findUniqueVert
+        int v2dx = std::max(vertPnts.findFirst(BRep_Tool::Pnt(ev2)), 0);
         WalkerEdge we;
         we.v1 = v1dx;
         we.v2 = v2dx;
@@ -463,25 +550,29 @@ std::vector<embedItem> EdgeWalker::makeEmbedding(const std::vector<TopoDS_Edge>
 //                            edges.size(),uniqueVList.size());
     std::vector<embedItem> result;
 
-    int iv = 0;
+    //look up the vertices at the ends of each edge instead of testing every edge against every vertex
+    vertexHash vertPnts;
     for (auto& v: uniqueVList) {
-        int ie = 0;
-        std::vector<incidenceItem> iiList;
-        for (auto& e: edges) {
-            double angle = 0;
-            if (DrawUtil::isFirstVert(e,v)) {
-                angle = DrawUtil::angleWithX(e,v);
-                incidenceItem ii(ie, angle, m_saveWalkerEdges[ie].ed);
-                iiList.push_back(ii);
-            } else if (DrawUtil::isLastVert(e,v)) {
-                angle = DrawUtil::angleWithX(e,v);
-                incidenceItem ii(ie, angle, m_saveWalkerEdges[ie].ed);
-                iiList.push_back(ii);
-            } else {
-                //Base::Console().Message("TRACE - EW::makeEmbedding - neither first nor last\n");
-            }
-            ie++;
-       }
+        vertPnts.add(BRep_Tool::Pnt(v));
+    }
+    std::vector<std::vector<incidenceItem> > incidence(uniqueVList.size());
+    int ie = 0;
+    for (auto& e: edges) {
+        std::vector<int> ends = vertPnts.findSame(BRep_Tool::Pnt(TopExp::FirstVertex(e)));
+        std::vector<int> lastEnds = vertPnts.findSame(BRep_Tool::Pnt(TopExp::LastVertex(e)));
+        ends.insert(ends.end(), lastEnds.begin(), lastEnds.end());
+        std::sort(ends.begin(), ends.end());
+        ends.erase(std::unique(ends.begin(), ends.end()), ends.end());    //closed edges touch a vertex once
+        for (int iv: ends) {
+            double angle = DrawUtil::angleWithX(e,uniqueVList[iv]);
+            incidenceItem ii(ie, angle, m_saveWalkerEdges[ie].ed);
+            incidence[iv].push_back(ii);
+        }
+        ie++;
+    }
+
+    int iv = 0;
+    for (auto& iiList: incidence) {
        //sort incidenceList by angle
        iiList = embedItem::sortIncidenceList(iiList,  false);
        embedItem embed(iv, iiList);
@@ -42,7 +42,11 @@
 #include <HLRBRep.hxx>
 #include <HLRBRep_Algo.hxx>
 #include <HLRBRep_HLRToShape.hxx>
+#include <HLRBRep_PolyAlgo.hxx>
+#include <HLRBRep_PolyHLRToShape.hxx>
 #include <HLRAlgo_Projector.hxx>
+#include <Standard.hxx>
+#include <Standard_Version.hxx>
 #include <TopoDS.hxx>
 #include <TopoDS_Shape.hxx>
 #include <TopoDS_Vertex.hxx>
@@ -56,6 +60,11 @@
 
 #include <algorithm>
 #include <chrono>
+#include <list>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtConcurrentMap>
 
 #include <Base/Console.h>
 #include <Base/Exception.h>
@@ -77,10 +86,218 @@ struct EdgePoints {
     TopoDS_Edge edge;
 };
 
+namespace TechDrawGeometry {
+
+//! the edge compounds of a hidden line projection, in view coordinates
+struct hlrOutput
+{
+    TopoDS_Shape visHard;
+    TopoDS_Shape visOutline;
+    TopoDS_Shape visSmooth;
+    TopoDS_Shape visSeam;
+    TopoDS_Shape visIso;
+    TopoDS_Shape hidHard;
+    TopoDS_Shape hidOutline;
+    TopoDS_Shape hidSmooth;
+    TopoDS_Shape hidSeam;
+    TopoDS_Shape hidIso;
+};
+
+}
+
+namespace {
+
+//! projections of unscaled source shapes, most recently used first.
+//! views that only change scale or position reuse these instead of running HLR again.
+struct hlrCacheEntry
+{
+    projectionKey key;
+    gp_Pnt center;
+    hlrOutput hlr;
+};
+
+const std::size_t hlrCacheSize = 32;
+std::list<hlrCacheEntry> hlrCache;
+QMutex hlrCacheMutex;
+
+bool findCachedHLR(const projectionKey& key, const gp_Pnt& center, hlrOutput& hlr)
+{
+    QMutexLocker locker(&hlrCacheMutex);
+    for (auto it = hlrCache.begin(); it != hlrCache.end(); ++it) {
+        if ((it->key == key) && it->center.IsEqual(center, Precision::Confusion())) {
+            hlrCache.splice(hlrCache.begin(), hlrCache, it);
+            hlr = it->hlr;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool isCachedHLR(const projectionKey& key)
+{
+    QMutexLocker locker(&hlrCacheMutex);
+    for (auto& entry: hlrCache) {
+        if (entry.key == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void addCachedHLR(const projectionKey& key, const gp_Pnt& center, const hlrOutput& hlr)
+{
+    QMutexLocker locker(&hlrCacheMutex);
+    hlrCacheEntry entry;
+    entry.key = key;
+    entry.center = center;
+    entry.hlr = hlr;
+    hlrCache.push_front(entry);
+    if (hlrCache.size() > hlrCacheSize) {
+        hlrCache.pop_back();
+    }
+}
+
+//! triangulate the faces for the polygonal hidden line remover, relative to the size of the shape.
+//! an existing triangulation that is fine enough is kept.
+void meshForPolyHLR(const TopoDS_Shape& input)
+{
+    Bnd_Box box;
+    BRepBndLib::Add(input, box);
+    if (box.IsVoid()) {
+        return;
+    }
+    box.SetGap(0.0);
+    double deflection = std::max(sqrt(box.SquareExtent()) * 0.002, Precision::Confusion());
+    BRepMesh_IncrementalMesh(input, deflection, Standard_False, 0.5);
+}
+
+//! hidden line removal on the triangulation of the faces. much faster than the exact algorithm on
+//! freeform shapes, but curved edges become polylines and there are no iso lines.
+void runPolyHLR(const TopoDS_Shape& input, const gp_Ax2& viewAxis, hlrOutput& out)
+{
+    try {
+        meshForPolyHLR(input);
+        Handle_HLRBRep_PolyAlgo brep_hlrPoly = new HLRBRep_PolyAlgo();
+        brep_hlrPoly->Load(input);
+        HLRAlgo_Projector projector( viewAxis );
+        brep_hlrPoly->Projector(projector);
+        brep_hlrPoly->Update();
+
+        HLRBRep_PolyHLRToShape polyhlrToShape;
+        polyhlrToShape.Update(brep_hlrPoly);
+
+        out.visHard    = polyhlrToShape.VCompound();
+        out.visSmooth  = polyhlrToShape.Rg1LineVCompound();
+        out.visSeam    = polyhlrToShape.RgNLineVCompound();
+        out.visOutline = polyhlrToShape.OutLineVCompound();
+        out.hidHard    = polyhlrToShape.HCompound();
+        out.hidSmooth  = polyhlrToShape.Rg1LineHCompound();
+        out.hidSeam    = polyhlrToShape.RgNLineHCompound();
+        out.hidOutline = polyhlrToShape.OutLineHCompound();
+
+        BRepLib::BuildCurves3d(out.visHard);
+        BRepLib::BuildCurves3d(out.visSmooth);
+        BRepLib::BuildCurves3d(out.visSeam);
+        BRepLib::BuildCurves3d(out.visOutline);
+        BRepLib::BuildCurves3d(out.hidHard);
+        BRepLib::BuildCurves3d(out.hidSmooth);
+        BRepLib::BuildCurves3d(out.hidSeam);
+        BRepLib::BuildCurves3d(out.hidOutline);
+    }
+    catch (...) {
+        Standard_Failure::Raise("GeometryObject::projectShape - error occurred while projecting shape with polygons");
+    }
+}
+
+//! run the hidden line remover. safe to call from worker threads.
+void runHLR(const TopoDS_Shape& input, const gp_Ax2& viewAxis, int isoCount, bool coarse, hlrOutput& out)
+{
+    if (coarse) {
+        runPolyHLR(input, viewAxis, out);
+        return;
+    }
+
+    Handle_HLRBRep_Algo brep_hlr = NULL;
+    try {
+        brep_hlr = new HLRBRep_Algo();
+        brep_hlr->Add(input, isoCount);
+        HLRAlgo_Projector projector( viewAxis );
+        brep_hlr->Projector(projector);
+        brep_hlr->Update();
+        brep_hlr->Hide();
+    }
+    catch (...) {
+        Standard_Failure::Raise("GeometryObject::projectShape - error occurred while projecting shape");
+    }
+
+    try {
+        HLRBRep_HLRToShape hlrToShape(brep_hlr);
+
+        out.visHard    = hlrToShape.VCompound();
+        out.visSmooth  = hlrToShape.Rg1LineVCompound();
+        out.visSeam    = hlrToShape.RgNLineVCompound();
+        out.visOutline = hlrToShape.OutLineVCompound();
+        out.visIso     = hlrToShape.IsoLineVCompound();
+        out.hidHard    = hlrToShape.HCompound();
+        out.hidSmooth  = hlrToShape.Rg1LineHCompound();
+        out.hidSeam    = hlrToShape.RgNLineHCompound();
+        out.hidOutline = hlrToShape.OutLineHCompound();
+        out.hidIso     = hlrToShape.IsoLineHCompound();
+
+//need these 3d curves to prevent "zero edges" later
+        BRepLib::BuildCurves3d(out.visHard);
+        BRepLib::BuildCurves3d(out.visSmooth);
+        BRepLib::BuildCurves3d(out.visSeam);
+        BRepLib::BuildCurves3d(out.visOutline);
+        BRepLib::BuildCurves3d(out.visIso);
+        BRepLib::BuildCurves3d(out.hidHard);
+        BRepLib::BuildCurves3d(out.hidSmooth);
+        BRepLib::BuildCurves3d(out.hidSeam);
+        BRepLib::BuildCurves3d(out.hidOutline);
+        BRepLib::BuildCurves3d(out.hidIso);
+    }
+    catch (...) {
+        Standard_Failure::Raise("GeometryObject::projectShape - error occurred while extracting edges");
+    }
+}
+
+//! project an unscaled source shape the way DrawViewPart does, at scale 1
+//! the mirrored shape is a copy of the source, so a coarse projection triangulates the copy and
+//! never the shared source shape of the document object
+void projectUnscaled(const projectionKey& key, const gp_Pnt& center, hlrOutput& out)
+{
+    TopoDS_Shape mirroredShape = mirrorShape(key.source, center, 1.0);
+    Base::Vector3d origin(center.X(),center.Y(),center.Z());
+    runHLR(mirroredShape, getViewAxis(origin,key.direction), key.isoCount, key.coarse, out);
+}
+
+struct projectionJob
+{
+    projectionKey key;
+    gp_Pnt center;
+    hlrOutput hlr;
+    bool done;
+};
+
+void runProjectionJob(projectionJob& job)
+{
+    try {
+        job.center = findCentroid(job.key.source, job.key.direction);
+        projectUnscaled(job.key, job.center, job.hlr);
+        job.done = true;
+    }
+    catch (...) {
+        job.done = false;           //the view reports the error when it is executed
+    }
+}
+
+}
+
 GeometryObject::GeometryObject(const string& parent) :
     Scale(1.f),
     m_parentName(parent),
-    m_isoCount(0)
+    m_isoCount(0),
+    m_coarse(false)
 {
 }
 
@@ -161,53 +378,104 @@ void GeometryObject::projectShape(const TopoDS_Shape& input,
     gp_Ax2 viewAxis = getViewAxis(origin,direction);
     auto start = chrono::high_resolution_clock::now();
 
-    Handle_HLRBRep_Algo brep_hlr = NULL;
-    try {
-        brep_hlr = new HLRBRep_Algo();
-        brep_hlr->Add(input, m_isoCount);
-        HLRAlgo_Projector projector( viewAxis );
-        brep_hlr->Projector(projector);
-        brep_hlr->Update();
-        brep_hlr->Hide();
-    }
-    catch (...) {
-        Standard_Failure::Raise("GeometryObject::projectShape - error occurred while projecting shape");
-    }
+    hlrOutput hlr;
+    runHLR(input, viewAxis, m_isoCount, m_coarse, hlr);
     auto end   = chrono::high_resolution_clock::now();
     auto diff  = end - start;
     double diffOut = chrono::duration <double, milli> (diff).count();
     Base::Console().Log("TIMING - %s GO spent: %.3f millisecs in HLRBRep_Algo & co\n",m_parentName.c_str(),diffOut);
 
-    try {
-        HLRBRep_HLRToShape hlrToShape(brep_hlr);
+    setHLROutput(hlr, 1.0);
+}
 
-        visHard    = hlrToShape.VCompound();
-        visSmooth  = hlrToShape.Rg1LineVCompound();
-        visSeam    = hlrToShape.RgNLineVCompound();
-        visOutline = hlrToShape.OutLineVCompound();
-        visIso     = hlrToShape.IsoLineVCompound();
-        hidHard    = hlrToShape.HCompound();
-        hidSmooth  = hlrToShape.Rg1LineHCompound();
-        hidSeam    = hlrToShape.RgNLineHCompound();
-        hidOutline = hlrToShape.OutLineHCompound();
-        hidIso     = hlrToShape.IsoLineHCompound();
+//!project a source shape that is not mirrored or scaled yet.
+//!the HLR output at scale 1 is cached, so a changed scale only transforms the cached edges.
+void GeometryObject::projectSource(const TopoDS_Shape& source,
+                                   const gp_Pnt& inputCenter,
+                                   const Base::Vector3d& direction,
+                                   double scale)
+{
+    clear();
+    projectionKey key;
+    key.source = source;
+    key.direction = direction;
+    key.isoCount = m_isoCount;
+    key.coarse = m_coarse;
+
+    hlrOutput hlr;
+    if (!findCachedHLR(key, inputCenter, hlr)) {
+        auto start = chrono::high_resolution_clock::now();
+        projectUnscaled(key, inputCenter, hlr);
+        auto end   = chrono::high_resolution_clock::now();
+        auto diff  = end - start;
+        double diffOut = chrono::duration <double, milli> (diff).count();
+        Base::Console().Log("TIMING - %s GO spent: %.3f millisecs in HLRBRep_Algo & co\n",m_parentName.c_str(),diffOut);
+        addCachedHLR(key, inputCenter, hlr);
+    }
+    setHLROutput(hlr, scale);
+}
 
-//need these 3d curves to prevent "zero edges" later
-        BRepLib::BuildCurves3d(visHard);
-        BRepLib::BuildCurves3d(visSmooth);
-        BRepLib::BuildCurves3d(visSeam);
-        BRepLib::BuildCurves3d(visOutline);
-        BRepLib::BuildCurves3d(visIso);
-        BRepLib::BuildCurves3d(hidHard);
-        BRepLib::BuildCurves3d(hidSmooth);
-        BRepLib::BuildCurves3d(hidSeam);
-        BRepLib::BuildCurves3d(hidOutline);
-        BRepLib::BuildCurves3d(hidIso);
+//!run HLR for the projections that are not cached yet, in parallel, and cache them.
+void GeometryObject::prefetchProjections(const std::vector<projectionKey>& keys)
+{
+    std::vector<projectionJob> jobs;
+    for (auto& k: keys) {
+        projectionJob job;
+        job.key = k;
+        job.done = false;
+        if (!isCachedHLR(k)) {
+            jobs.push_back(job);
+        }
     }
-    catch (...) {
-        Standard_Failure::Raise("GeometryObject::projectShape - error occurred while extracting edges");
+    if (jobs.size() < 2) {
+        return;                     //nothing to gain, the view projects itself
     }
 
+#if OCC_VERSION_HEX < 0x070000
+    Standard::SetReentrant(Standard_True);
+#endif
+    auto start = chrono::high_resolution_clock::now();
+    QtConcurrent::blockingMap(jobs, &runProjectionJob);
+    auto end   = chrono::high_resolution_clock::now();
+    auto diff  = end - start;
+    double diffOut = chrono::duration <double, milli> (diff).count();
+    Base::Console().Log("TIMING - GO spent: %.3f millisecs projecting %d views\n",diffOut,int(jobs.size()));
+
+    for (auto& job: jobs) {
+        if (job.done) {
+            addCachedHLR(job.key, job.center, job.hlr);
+        }
+    }
+}
+
+void GeometryObject::setHLROutput(const hlrOutput& hlr, double scale)
+{
+    if (scale == 1.0) {
+        visHard    = hlr.visHard;
+        visSmooth  = hlr.visSmooth;
+        visSeam    = hlr.visSeam;
+        visOutline = hlr.visOutline;
+        visIso     = hlr.visIso;
+        hidHard    = hlr.hidHard;
+        hidSmooth  = hlr.hidSmooth;
+        hidSeam    = hlr.hidSeam;
+        hidOutline = hlr.hidOutline;
+        hidIso     = hlr.hidIso;
+        return;
+    }
+
+    //the view axis is centered on the shape, so scaling about the origin matches scaling the source
+    const TopoDS_Shape* from[10] = { &hlr.visHard, &hlr.visSmooth, &hlr.visSeam, &hlr.visOutline, &hlr.visIso,
+                                     &hlr.hidHard, &hlr.hidSmooth, &hlr.hidSeam, &hlr.hidOutline, &hlr.hidIso };
+    TopoDS_Shape* to[10] = { &visHard, &visSmooth, &visSeam, &visOutline, &visIso,
+                             &hidHard, &hidSmooth, &hidSeam, &hidOutline, &hidIso };
+    for (int i = 0; i < 10; i++) {
+        if (from[i]->IsNull()) {
+            to[i]->Nullify();
+        } else {
+            *to[i] = scaleShape(*from[i], scale);
+        }
+    }
 }
 
 //!add edges meeting filter criteria for category, visibility
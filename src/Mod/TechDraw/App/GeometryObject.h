@@ -57,6 +57,22 @@ gp_Ax2 TechDrawExport getViewAxis(const Base::Vector3d origin,
                                   const Base::Vector3d& direction,
                                   const bool flip=true);
 
+//! a source shape as seen from a direction. identifies a cached hidden line projection
+struct projectionKey
+{
+    TopoDS_Shape source;
+    Base::Vector3d direction;
+    int isoCount;
+    bool coarse;
+
+    bool operator==(const projectionKey& k) const {
+        return source.IsEqual(k.source) && (direction == k.direction) &&
+               (isoCount == k.isoCount) && (coarse == k.coarse);
+    }
+};
+
+struct hlrOutput;
+
 class TechDrawExport GeometryObject
 {
 public:
@@ -79,10 +95,16 @@ public:
     void projectShape(const TopoDS_Shape &input,
                                  const gp_Pnt& inputCenter,
                                  const Base::Vector3d &direction);
+    void projectSource(const TopoDS_Shape &source,
+                       const gp_Pnt& inputCenter,
+                       const Base::Vector3d &direction,
+                       double scale);
+    static void prefetchProjections(const std::vector<projectionKey>& keys);
     void extractGeometry(edgeClass category, bool visible);
     void addFaceGeom(Face * f);
     void clearFaceGeom();
     void setIsoCount(int i) { m_isoCount = i; }
+    void setCoarse(bool b) { m_coarse = b; }              //polygonal HLR for drafts
     void setParentName(std::string n);                          //for debug messages
 
 protected:
@@ -99,6 +121,7 @@ protected:
     TopoDS_Shape hidIso;
 
     void addGeomFromCompound(TopoDS_Shape edgeCompound, edgeClass category, bool visible);
+    void setHLROutput(const hlrOutput& hlr, double scale);
 
 
     //similar function in Geometry?
@@ -119,6 +142,7 @@ protected:
 
     std::string m_parentName;
     int m_isoCount;
+    bool m_coarse;
 };
 
 } //namespace TechDrawGeometry
@@ -57,6 +57,69 @@ class TechDrawTestCases(unittest.TestCase):
         self.Doc.recompute()
         self.failUnless(len(self.Page.Views) == 3)
 
+    def checkPlateView(self, count):
+        """Project a plate with count x count holes."""
+        plate = Part.makeBox(200.0, 200.0, 5.0)
+        holes = [Part.makeCylinder(3.0, 5.0, App.Vector(10.0 + 12.0 * i, 10.0 + 12.0 * j, 0.0))
+                 for i in range(count) for j in range(count)]
+        self.Plate = self.Doc.addObject("Part::Feature","Plate%d" % count)
+        self.Plate.Shape = plate.cut(Part.makeCompound(holes))
+        self.View = self.Doc.addObject('TechDraw::DrawViewPart','View%d' % count)
+        rc = self.Page.addView(self.View)
+        self.View.Source = self.Plate
+        self.View.Direction = FreeCAD.Vector(0.0,0.0,1.0)
+        self.Doc.recompute()
+        self.failIf('Invalid' in self.View.State)
+        # the outline of the plate and at least one edge per hole
+        self.failUnless(len(self.View.getVisibleEdges()) >= 4 + len(holes))
+
+    def testDenseViewCase(self):
+        """Project views with many edges."""
+        self.Page = self.Doc.addObject('TechDraw::DrawPage','Page')
+        self.checkPlateView(7)
+        self.checkPlateView(14)
+
+    def testProjGroupCase(self):
+        """Rescale a projection group, which reuses the projections of its views."""
+        self.Box = self.Doc.addObject("Part::Box","Box")
+        self.Page = self.Doc.addObject('TechDraw::DrawPage','Page')
+        self.Group = self.Doc.addObject('TechDraw::DrawProjGroup','ProjGroup')
+        rc = self.Page.addView(self.Group)
+        self.Group.Source = self.Box
+        for p in ["Front", "Top", "Right", "Left", "Rear", "Bottom"]:
+            self.Group.addProjection(p)
+        self.Doc.recompute()
+        scale = self.Group.Scale
+        lengths = [sum(e.Length for e in v.getVisibleEdges()) for v in self.Group.Views]
+        self.Group.ScaleType = "Custom"
+        self.Group.Scale = 2.0
+        self.Doc.recompute()
+        self.failUnless(len(self.Group.Views) == 6)
+        # every face of the box is a square of 10 mm
+        for v, length in zip(self.Group.Views, lengths):
+            self.failIf('Invalid' in v.State)
+            self.failUnless(v.Scale == 2.0)
+            rescaled = sum(e.Length for e in v.getVisibleEdges())
+            self.failUnless(abs(rescaled - 80.0) < 1e-6, "Outline of %s is %f long" % (v.Label, rescaled))
+            self.failUnless(abs(rescaled * scale - length * 2.0) < 1e-6)
+
+    def testCoarseViewCase(self):
+        """Project a freeform shape coarsely, then exactly for output."""
+        self.Torus = self.Doc.addObject("Part::Torus","Torus")
+        self.Page = self.Doc.addObject('TechDraw::DrawPage','Page')
+        self.View = self.Doc.addObject('TechDraw::DrawViewPart','View')
+        rc = self.Page.addView(self.View)
+        self.View.Source = self.Torus
+        self.View.Direction = FreeCAD.Vector(1.0,1.0,1.0)
+        self.View.CoarseView = True
+        self.Doc.recompute()
+        self.failIf('Invalid' in self.View.State)
+        self.failUnless(len(self.View.getVisibleEdges()) > 0, "Coarse view has no edges")
+        self.Page.AllowCoarseViews = False
+        self.Doc.recompute()
+        self.failIf('Invalid' in self.View.State)
+        self.failUnless(len(self.View.getVisibleEdges()) > 0, "Exact view has no edges")
+
     def tearDown(self):
         #closing doc
         FreeCAD.closeDocument("TechDrawTest")
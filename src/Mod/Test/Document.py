@@ -22,7 +22,7 @@
 #*   Juergen Riegel 2003                                                   *
 #***************************************************************************/
 
-import FreeCAD, os, unittest, tempfile
+import FreeCAD, os, unittest, tempfile, zipfile
 
 
 #---------------------------------------------------------------------------
@@ -181,6 +181,41 @@ class DocumentBasicCases(unittest.TestCase):
     else:
       self.failUnless(False)
     del L2
+
+  def testInList(self):
+    L1 = self.Doc.addObject("App::FeatureTest","Label_1")
+    L2 = self.Doc.addObject("App::FeatureTest","Label_2")
+    L3 = self.Doc.addObject("App::FeatureTest","Label_3")
+    L2.Link = L1
+    L3.LinkList = [L1, L2]
+    self.assertEqual([o.Name for o in L1.InList], ["Label_2", "Label_3"])
+    self.assertEqual([o.Name for o in L2.InList], ["Label_3"])
+    self.assertEqual(sorted([o.Name for o in L1.InListRecursive]), ["Label_2", "Label_3"])
+    # the cached recursive lists follow the link changes
+    self.assertEqual([o.Name for o in L2.InListRecursive], ["Label_3"])
+    L3.LinkList = [L1]
+    self.assertEqual(L2.InListRecursive, [])
+    self.assertEqual(sorted([o.Name for o in L1.InListRecursive]), ["Label_2", "Label_3"])
+    L2.Link = None
+    self.assertEqual([o.Name for o in L1.InListRecursive], ["Label_3"])
+    L2.Link = L1
+    L3.LinkList = [L1, L2]
+    L2.Link = None
+    L2.LinkSubList = [(L1, "Edge1"), (L1, "Edge2")]
+    self.assertEqual([o.Name for o in L1.InList], ["Label_2", "Label_2", "Label_3"])
+    L2.LinkSubList = []
+    L3.setExpression("Float", "Label_1.Float")
+    self.assertEqual([o.Name for o in L1.InList], ["Label_3", "Label_3"])
+
+    # removed objects must not show up, undo brings them back
+    self.Doc.openTransaction("Remove")
+    self.Doc.removeObject(L3.Name)
+    self.Doc.commitTransaction()
+    self.assertEqual(L1.InList, [])
+    self.assertEqual(L2.InList, [])
+    self.Doc.undo()
+    self.assertEqual([o.Name for o in L1.InList], ["Label_3", "Label_3"])
+    self.assertEqual([o.Name for o in L2.InList], ["Label_3"])
     
   def testExtensions(self):
     #we try to create a normal python object and add a extension to it 
@@ -395,6 +430,103 @@ class DocumentRecomputeCases(unittest.TestCase):
     self.L1.Link = self.L2
     self.L2.Link = self.L3
 
+  def newDocument(self, name, parallel):
+    param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+    value = param.GetBool("ParallelRecompute", False)
+    param.SetBool("ParallelRecompute", parallel)
+    try:
+      return FreeCAD.newDocument(name)
+    finally:
+      param.SetBool("ParallelRecompute", value)
+
+  def addDiamond(self, doc):
+    # A feeds B and C, both feed D
+    a = doc.addObject("App::FeatureTest","A")
+    b = doc.addObject("App::FeatureTest","B")
+    c = doc.addObject("App::FeatureTest","C")
+    d = doc.addObject("App::FeatureTest","D")
+    b.Link = a
+    c.Link = a
+    d.LinkList = [b, c]
+    b.setExpression("Integer", "A.Integer + 1")
+    c.setExpression("Integer", "A.Integer * 2")
+    d.setExpression("Integer", "B.Integer + C.Integer")
+    return a, b, c, d
+
+  def testDiamond(self):
+    for parallel in (False, True):
+      doc = self.newDocument("RecomputeDiamond", parallel)
+      try:
+        a, b, c, d = self.addDiamond(doc)
+        doc.recompute()
+        a.Integer = 5
+        doc.recompute()
+        self.assertEqual([o.Integer for o in (a, b, c, d)], [5, 6, 10, 16])
+        self.assertEqual([o.ExecCount for o in (a, b, c, d)], [2, 2, 2, 2])
+        self.assertEqual([o.State for o in (a, b, c, d)], [["Up-to-date"]] * 4)
+      finally:
+        FreeCAD.closeDocument(doc.Name)
+
+  def testCycle(self):
+    self.L1.Link = self.L2
+    self.L2.Link = self.L1
+    self.Doc.recompute()
+    self.assertIn("Invalid", self.L1.State)
+    self.assertIn("Invalid", self.L2.State)
+    self.assertEqual(self.L1.ExecCount, 0)
+    self.assertEqual(self.L2.ExecCount, 0)
+
+    # breaking the cycle makes the objects recompute again
+    self.L2.Link = None
+    self.Doc.recompute()
+    self.assertNotIn("Invalid", self.L1.State)
+    self.assertEqual(self.L1.ExecCount, 1)
+
+  def testWorkerException(self):
+    doc = self.newDocument("RecomputeException", True)
+    try:
+      a, b, c, d = self.addDiamond(doc)
+      b.ExceptionType = 2
+      doc.recompute()
+      self.assertIn("Invalid", b.State)
+      self.assertNotIn("Invalid", a.State)
+      self.assertNotIn("Invalid", c.State)
+      self.assertEqual(c.ExecCount, 1)
+      self.assertEqual(c.Integer, a.Integer * 2)
+
+      b.ExceptionType = 0
+      doc.recompute()
+      self.assertEqual(b.State, ["Up-to-date"])
+      self.assertEqual(d.Integer, b.Integer + c.Integer)
+    finally:
+      FreeCAD.closeDocument(doc.Name)
+
+  def testSerialParallel(self):
+    results = []
+    for parallel in (False, True):
+      doc = self.newDocument("RecomputeLayers", parallel)
+      try:
+        # layers of objects, each one depends on two of the layer below
+        layers = [[doc.addObject("App::FeatureTest","L0_%d" % i) for i in range(8)]]
+        for i, obj in enumerate(layers[0]):
+          obj.Integer = i
+        for level in range(1, 6):
+          layer = []
+          below = layers[-1]
+          for i in range(8):
+            obj = doc.addObject("App::FeatureTest","L%d_%d" % (level, i))
+            first, second = below[i], below[(i * 3 + 1) % 8]
+            obj.LinkList = [first, second]
+            obj.setExpression("Integer", "%s.Integer * 2 - %s.Integer" % (first.Name, second.Name))
+            layer.append(obj)
+          layers.append(layer)
+        doc.recompute()
+        layers[0][3].Integer = 100
+        doc.recompute()
+        results.append([(o.Integer, o.ExecCount) for layer in layers for o in layer])
+      finally:
+        FreeCAD.closeDocument(doc.Name)
+    self.assertEqual(results[0], results[1])
 
   def tearDown(self):
     #closing doc
@@ -625,6 +757,37 @@ class UndoRedoCases(unittest.TestCase):
     self.assertEqual(self.Doc.RedoNames,[])
     self.assertEqual(self.Doc.RedoCount,0)
 
+  def testUndoLimit(self):
+    # switch on the Undo
+    self.Doc.UndoMode = 1
+    obj = self.Doc.addObject("App::FeatureTest","test1")
+    for i in range(5):
+      self.Doc.openTransaction("Transaction%d" % i)
+      obj.FloatList = [float(j) for j in range(1000 + i)]
+    self.Doc.commitTransaction()
+    self.assertEqual(len(self.Doc.UndoSizes),self.Doc.UndoCount)
+    self.assertTrue(self.Doc.UndoSizes[0] >= 1003 * 8)
+    self.assertEqual(self.Doc.UndoRedoMemSize,sum(self.Doc.UndoSizes))
+
+    # the oldest Undos are removed when the limit is exceeded
+    self.Doc.UndoLimit = 20000
+    self.Doc.openTransaction("Transaction5")
+    obj.FloatList = []
+    self.Doc.commitTransaction()
+    self.assertEqual(self.Doc.UndoNames,['Transaction5','Transaction4'])
+    self.Doc.undo()
+    self.assertEqual(len(obj.FloatList),1004)
+    self.assertEqual(self.Doc.RedoSizes,[0])
+
+    # limits above 4 GB are kept as they are
+    self.Doc.UndoLimit = 5 * 2**30
+    self.assertEqual(self.Doc.UndoLimit,5 * 2**30)
+    self.assertRaises(ValueError,setattr,self.Doc,"UndoLimit",-1)
+
+    # switch on the Undo OFF
+    self.Doc.UndoMode = 0
+    self.Doc.UndoLimit = 0
+
   def testGroup(self):
     # Add an object to the group
     L2 = self.Doc.addObject("App::FeatureTest","Label_2")
@@ -766,6 +929,72 @@ class DocumentPlatformCases(unittest.TestCase):
     except:
       pass
 
+  def saveAndRestoreLists(self, count):
+    self.Doc.Test.FloatList = [i * 0.25 for i in range(count)]
+    self.Doc.Test.VectorList = [(i, -i, 0.5 * i) for i in range(count // 4)]
+
+    # saving and restoring
+    self.Doc.saveAs(self.DocName)
+    FreeCAD.closeDocument("PlatformTests")
+    self.Doc = FreeCAD.open(self.DocName)
+
+    self.assertEqual(len(self.Doc.Test.FloatList), count)
+    self.assertEqual(self.Doc.Test.FloatList[-1], (count - 1) * 0.25)
+    self.assertEqual(len(self.Doc.Test.VectorList), count // 4)
+    self.assertEqual(self.Doc.Test.VectorList[-1], FreeCAD.Vector(count // 4 - 1, 1 - count // 4, 0.5 * (count // 4 - 1)))
+
+  def testLargeLists(self):
+    self.saveAndRestoreLists(250000)
+    self.saveAndRestoreLists(1000000)
+
+  def testBinaryCompression(self):
+    param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+    level = param.GetInt("BinaryCompressionLevel", 0)
+    param.SetInt("BinaryCompressionLevel", 0)
+    try:
+      self.Doc.Test.FloatList = [i * 0.5 for i in range(100000)]
+      self.Doc.saveAs(self.DocName)
+    finally:
+      param.SetInt("BinaryCompressionLevel", level)
+
+    # binary attachments are stored, the XML files are deflated
+    with zipfile.ZipFile(self.DocName) as archive:
+      self.assertEqual(archive.testzip(), None)
+      methods = dict((i.filename, i.compress_type) for i in archive.infolist())
+    self.assertEqual(methods["Document.xml"], zipfile.ZIP_DEFLATED)
+    self.assertIn(zipfile.ZIP_STORED, methods.values())
+
+    FreeCAD.closeDocument("PlatformTests")
+    self.Doc = FreeCAD.open(self.DocName)
+    self.assertEqual(self.Doc.Test.FloatList[-1], 99999 * 0.5)
+
+  def testDeferredLoading(self):
+    try:
+      import Mesh
+    except ImportError:
+      return
+    mesh = self.Doc.addObject("Mesh::Feature", "Mesh")
+    mesh.Mesh = Mesh.createBox(1.0, 2.0, 3.0)
+    mesh.Placement = FreeCAD.Placement(FreeCAD.Vector(1, 2, 3), FreeCAD.Rotation())
+    self.Doc.saveAs(self.DocName)
+    FreeCAD.closeDocument("PlatformTests")
+
+    param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+    deferred = param.GetBool("DeferredLoading", False)
+    param.SetBool("DeferredLoading", True)
+    try:
+      # saving over the opened file must keep the data that wasn't accessed yet
+      self.Doc = FreeCAD.open(self.DocName)
+      self.Doc.save()
+      FreeCAD.closeDocument("PlatformTests")
+      self.Doc = FreeCAD.open(self.DocName)
+    finally:
+      param.SetBool("DeferredLoading", deferred)
+
+    self.assertEqual(self.Doc.Mesh.Mesh.CountFacets, 12)
+    self.assertEqual(self.Doc.Mesh.Mesh.Placement.Base, FreeCAD.Vector(1, 2, 3))
+    self.assertNotIn("Touched", self.Doc.Mesh.State)
+
   def tearDown(self):
     #closing doc
     FreeCAD.closeDocument("PlatformTests")
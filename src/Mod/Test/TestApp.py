@@ -68,6 +68,8 @@ def All():
     # add the module tests
     tests += [ "TestFem",
                "MeshTestsApp",
+               "TestInspection",
+               "TestPointsApp",
                "TestSketcherApp",
                "TestPartApp",
                "TestPartDesignApp",
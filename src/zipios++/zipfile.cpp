@@ -38,6 +38,13 @@ ZipFile::ZipFile( const string &name , int s_off, int e_off
 }
 
 
+ZipFile::ZipFile( istream &is ) 
+  : _vs( 0, 0 ) {
+
+  init( is ) ;
+}
+
+
 FileCollection *ZipFile::clone() const {
   return new ZipFile( *this ) ;
 }
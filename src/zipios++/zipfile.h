@@ -55,6 +55,16 @@ public:
   explicit ZipFile( const string &name, int s_off = 0, int e_off = 0
 		    /* , ios::open_mode mode  = ios::in | ios::binary */ ) ;
 
+  /** Constructor. Reads the central directory of the zip archive from
+      an already opened stream. getInputStream() cannot be used then,
+      instead the local header offsets of the entries can be passed to
+      a ZipInputStream on the same stream.
+      @param is The stream to read the zip archive from.
+      @throw FColException Thrown if the stream is not a valid zip archive.
+      @throw IOException Thrown if an I/O problem is encountered, while the directory
+      of the zip archive is being read. */
+  explicit ZipFile( istream &is ) ;
+
   virtual FileCollection *clone() const ;
 
   /** Destructor. */
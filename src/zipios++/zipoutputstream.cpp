@@ -55,6 +55,16 @@ void ZipOutputStream::putNextEntry(const std::string& entryName) {
   putNextEntry( ZipCDirEntry(entryName));
 }
 
+void ZipOutputStream::putRawEntry( const ZipCDirEntry &entry, StorageMethod method,
+				   uint32 compressed_size, uint32 size, uint32 crc ) {
+  ozf->putRawEntry( entry, method, compressed_size, size, crc ) ;
+}
+
+
+void ZipOutputStream::putRawData( const char *data, uint32 size ) {
+  ozf->putRawData( data, size ) ;
+}
+
 
 void ZipOutputStream::setComment( const std::string &comment ) {
   ozf->setComment( comment ) ;
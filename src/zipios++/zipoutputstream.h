@@ -54,6 +54,15 @@ public:
   */
   void putNextEntry(const std::string& entryName);
 
+  /** Begins an entry whose data has been compressed already, see
+      ZipOutputStreambuf::putRawEntry(). */
+  void putRawEntry( const ZipCDirEntry &entry, StorageMethod method,
+		    uint32 compressed_size, uint32 size, uint32 crc ) ;
+
+  /** Writes a piece of the data of a raw entry, see
+      ZipOutputStreambuf::putRawData(). */
+  void putRawData( const char *data, uint32 size ) ;
+
   /** Sets the global comment for the Zip archive. */
   void setComment( const std::string& comment ) ;
 
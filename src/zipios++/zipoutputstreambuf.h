@@ -49,6 +49,22 @@ public:
       entry. */
   void putNextEntry( const ZipCDirEntry &entry ) ;
 
+  /** Begins an entry whose data has been compressed already.
+      Closes the current entry (if one is open) and writes the entry
+      header. The data must be written with putRawData() afterwards,
+      in pieces that add up to compressed_size bytes. No entry is open
+      then.
+      @param method STORED if the data is the plain content, DEFLATED
+      if it is a raw deflate stream.
+      @param compressed_size the number of bytes of the data.
+      @param size the uncompressed size of the entry.
+      @param crc the CRC32 of the uncompressed data. */
+  void putRawEntry( const ZipCDirEntry &entry, StorageMethod method,
+		    uint32 compressed_size, uint32 size, uint32 crc ) ;
+
+  /** Writes a piece of the data of the entry begun with putRawEntry(). */
+  void putRawData( const char *data, uint32 size ) ;
+
   /** Sets the global comment for the Zip archive. */
   void setComment( const string &comment ) ;
 